@@ -0,0 +1,10 @@
+TEMPLATE        = app
+TARGET          = $$PWD/../37_io_throughput_demo
+QT             += core
+CONFIG         += c++11 release
+CONFIG         -= app_bundle
+INCLUDEPATH    += $$PWD/../../external/eigen
+INCLUDEPATH    += $$PWD/../../include
+DATA_PATH       = \\\"$$PWD/../data/\\\"
+DEFINES        += DATA_PATH=$$DATA_PATH
+SOURCES        += main.cpp
@@ -0,0 +1,76 @@
+/* This sample program measures the throughput (MB/s) of the OBJ and OFF
+ * readers, using an increasing number of threads. Files are memory mapped
+ * and parsed in parallel, in line aligned chunks (see cinolib/io/read_OBJ.cpp)
+ *
+ * usage: io_throughput [file.obj|file.off] [#runs]
+ *
+ * Enjoy!
+*/
+
+#include <cinolib/io/read_OBJ.h>
+#include <cinolib/io/read_OFF.h>
+#include <cinolib/string_utilities.h>
+#include <cinolib/thread_pool.h>
+#include <cinolib/how_many_seconds.h>
+#include <cinolib/min_max_inf.h>
+#include <sys/stat.h>
+#include <thread>
+
+using namespace cinolib;
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+int main(int argc, char **argv)
+{
+    std::string s = (argc>1) ? std::string(argv[1]) : std::string(DATA_PATH) + "bunny.obj";
+    uint n_runs   = (argc>2) ? atoi(argv[2]) : 5;
+
+    struct stat st;
+    if(stat(s.c_str(), &st)!=0)
+    {
+        std::cout << "ERROR: could not open " << s << std::endl;
+        return -1;
+    }
+    double MB = double(st.st_size)/(1024*1024);
+
+    std::string ext = get_file_extension(s);
+    bool is_obj = (ext.compare("OBJ")==0 || ext.compare("obj")==0);
+    bool is_off = (ext.compare("OFF")==0 || ext.compare("off")==0);
+    if(!is_obj && !is_off)
+    {
+        std::cout << "ERROR: unknown input format" << std::endl;
+        return -1;
+    }
+
+    std::cout << s << " (" << MB << " MB)" << std::endl;
+
+    uint max_threads = std::max(1u, std::thread::hardware_concurrency());
+    for(uint nt=1; ; nt=std::min(2*nt, max_threads))
+    {
+        set_num_threads(nt);
+
+        // the best run is reported (the first one may be slowed down by disk access)
+        double best = inf_double;
+        uint   nv   = 0;
+        uint   np   = 0;
+        for(uint run=0; run<n_runs; ++run)
+        {
+            std::vector<vec3d>             verts;
+            std::vector<std::vector<uint>> polys;
+            typedef std::chrono::high_resolution_clock Time;
+            Time::time_point t0 = Time::now();
+            if(is_obj) read_OBJ(s.c_str(), verts, polys);
+            else       read_OFF(s.c_str(), verts, polys);
+            Time::time_point t1 = Time::now();
+            best = std::min(best, how_many_seconds(t0,t1));
+            nv   = verts.size();
+            np   = polys.size();
+        }
+
+        std::cout << nt << " threads: " << best << "s\t" << MB/best << " MB/s\t("
+                  << nv << " verts, " << np << " polys)" << std::endl;
+
+        if(nt==max_threads) break;
+    }
+    return 0;
+}
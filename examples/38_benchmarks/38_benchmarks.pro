@@ -0,0 +1,8 @@
+TEMPLATE        = app
+TARGET          = $$PWD/../38_benchmarks_demo
+QT             += core
+CONFIG         += c++11 release
+CONFIG         -= app_bundle
+INCLUDEPATH    += $$PWD/../../external/eigen
+INCLUDEPATH    += $$PWD/../../include
+SOURCES        += main.cpp
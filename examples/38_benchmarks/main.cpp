@@ -0,0 +1,896 @@
+/* This sample program is a benchmark suite for the core kernels of CinoLib.
+ * All inputs are synthetic and parameterized by size (wavy grids for surfaces,
+ * regular lattices for volumes, see cinolib/grid_mesh.h), so runs are easy to
+ * reproduce on any machine and need no data files. Each benchmark is executed
+ * for at least min_time seconds (and at least three times), and timings are
+ * reported both on screen and in a JSON file that follows the format of the
+ * Google Benchmark library, so that results of two commits can be compared
+ * with its tools/compare.py script, e.g.
+ *
+ *      compare.py benchmarks old.json new.json
+ *
+ * usage: benchmarks [--filter=substring] [--out=file.json] [--min_time=secs]
+ *                   [--scale=factor] [--threads=n] [--list]
+ *
+ * --filter   runs only the benchmarks whose name contains the substring
+ * --out      output JSON file (default: benchmarks.json)
+ * --min_time minimum time spent in each benchmark (default: 0.5s)
+ * --scale    multiplies all mesh resolutions (default: 1)
+ * --threads  size of the global thread pool (default: all cores)
+ * --list     prints the names of the benchmarks and exits
+ *
+ * NOTE: the remesh/botsch_kobbelt benchmark needs CINOLIB_USES_OPENGL and CINOLIB_USES_QT,
+ * because remesh_Botsch_Kobbelt_2004 operates on a DrawableTrimesh
+ *
+ * Enjoy!
+*/
+
+#include <cinolib/meshes/meshes.h>
+#include <cinolib/grid_mesh.h>
+#include <cinolib/laplacian.h>
+#include <cinolib/vertex_mass.h>
+#include <cinolib/linear_solvers.h>
+#include <cinolib/geodesics.h>
+#include <cinolib/dijkstra.h>
+#include <cinolib/octree.h>
+#include <cinolib/marching_tets.h>
+#include <cinolib/tetrahedralization.h>
+#include <cinolib/io/read_write.h>
+#include <cinolib/thread_pool.h>
+#include <cinolib/how_many_seconds.h>
+#include <cinolib/pi.h>
+#include <cinolib/remesh_isotropic.h>
+#include <cinolib/decimate_qem.h>
+#if defined(CINOLIB_USES_OPENGL) && defined(CINOLIB_USES_QT)
+#include <cinolib/remesh_BotschKobbelt2004.h>
+#endif
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <numeric>
+#include <sstream>
+#include <random>
+#include <thread>
+
+using namespace cinolib;
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// Controls the timed loop of a benchmark, Google Benchmark style:
+//
+//      void my_benchmark(BenchState & state)
+//      {
+//          ... setup (not timed) ...
+//          while(state.keep_running())
+//          {
+//              ... code to measure ...
+//          }
+//      }
+//
+class BenchState
+{
+    public:
+
+        explicit BenchState(const uint size, const double min_time) : size(size), min_time(min_time) {}
+
+        bool keep_running()
+        {
+            if(running) stop_iteration();
+            bool done = (iter_secs.size()>=min_iters && total_secs>=min_time) || iter_secs.size()>=max_iters;
+            if(!done) start_iteration();
+            return !done;
+        }
+
+        // exclude per iteration setup (e.g. restoring an input that is modified) from timings
+        void pause_timing()  { timed_secs += elapsed_secs(); timed_cpu += elapsed_cpu(); }
+        void resume_timing() { t0 = Time::now(); c0 = std::clock(); }
+
+        void set_items_per_iteration(const uint64_t n) { items = n; }
+
+        const uint size;
+
+        std::vector<double> iter_secs;
+        double              cpu_secs = 0;
+        uint64_t            items    = 0;
+
+    private:
+
+        typedef std::chrono::high_resolution_clock Time;
+
+        void start_iteration()
+        {
+            running    = true;
+            timed_secs = 0;
+            timed_cpu  = 0;
+            resume_timing();
+        }
+
+        void stop_iteration()
+        {
+            running = false;
+            double secs = timed_secs + elapsed_secs();
+            iter_secs.push_back(secs);
+            total_secs += secs;
+            cpu_secs   += timed_cpu + elapsed_cpu();
+        }
+
+        double elapsed_secs() const { return how_many_seconds(t0, Time::now()); }
+        double elapsed_cpu()  const { return double(std::clock()-c0)/CLOCKS_PER_SEC; }
+
+        const double min_time;
+        const uint   min_iters = 3;
+        const uint   max_iters = 1000000;
+
+        bool             running    = false;
+        double           total_secs = 0;
+        double           timed_secs = 0; // time spent in the current iteration before the last pause_timing()
+        double           timed_cpu  = 0;
+        Time::time_point t0;
+        std::clock_t     c0;
+};
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+typedef struct
+{
+    std::string                       name;
+    std::vector<uint>                 sizes; // mesh resolutions (before --scale)
+    std::function<void(BenchState &)> run;
+}
+Benchmark;
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//::::::::::::::::::::::::::: SYNTHETIC INPUTS :::::::::::::::::::::::::::
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// n x n quads, each split into two triangles, on a wavy unit square
+void wavy_grid(const uint n, std::vector<vec3d> & verts, std::vector<uint> & tris)
+{
+    Quadmesh<> q;
+    grid_mesh(n, n, q);
+    verts = q.vector_verts();
+    for(vec3d & p : verts)
+    {
+        p /= double(n);
+        p.z() = 0.1 * std::sin(4*M_PI*p.x()) * std::cos(4*M_PI*p.y());
+    }
+    tris.clear();
+    for(uint pid=0; pid<q.num_polys(); ++pid)
+    {
+        const std::vector<uint> & quad = q.adj_p2v(pid);
+        tris.insert(tris.end(), { quad[0], quad[1], quad[2] });
+        tris.insert(tris.end(), { quad[0], quad[2], quad[3] });
+    }
+}
+
+Trimesh<> wavy_trimesh(const uint n)
+{
+    std::vector<vec3d> verts;
+    std::vector<uint>  tris;
+    wavy_grid(n, verts, tris);
+    return Trimesh<>(verts, tris);
+}
+
+Tetmesh<> tet_lattice(const uint n)
+{
+    Tetmesh<> m;
+    grid_mesh(n, n, n, m);
+    return m;
+}
+
+std::vector<vec3d> random_points(const uint n, const AABB & box, const uint seed = 0)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> d(0,1);
+    std::vector<vec3d> points(n);
+    for(vec3d & p : points)
+    {
+        p = box.min + vec3d(d(rng), d(rng), d(rng)) * box.delta();
+    }
+    return points;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//::::::::::::::::::::::::::::: BENCHMARKS :::::::::::::::::::::::::::::::
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+void bench_build_trimesh(BenchState & state)
+{
+    std::vector<vec3d> verts;
+    std::vector<uint>  tris;
+    wavy_grid(state.size, verts, tris);
+    state.set_items_per_iteration(tris.size()/3);
+    while(state.keep_running())
+    {
+        Trimesh<> m(verts, tris);
+    }
+}
+
+void bench_build_tetmesh(BenchState & state)
+{
+    std::vector<vec3d>             verts;
+    std::vector<std::vector<uint>> cubes;
+    std::vector<uint>              tets, cube_tets;
+    grid_mesh_cubes(state.size, state.size, state.size, verts, cubes);
+    for(const auto & cube : cubes)
+    {
+        hex_to_tets(cube, cube_tets);
+        tets.insert(tets.end(), cube_tets.begin(), cube_tets.end());
+    }
+    state.set_items_per_iteration(tets.size()/4);
+    while(state.keep_running())
+    {
+        Tetmesh<> m(verts, tets);
+    }
+}
+
+void bench_build_hexmesh(BenchState & state)
+{
+    std::vector<vec3d>             verts;
+    std::vector<std::vector<uint>> cubes;
+    grid_mesh_cubes(state.size, state.size, state.size, verts, cubes);
+    state.set_items_per_iteration(cubes.size());
+    while(state.keep_running())
+    {
+        Hexmesh<> m(verts, cubes);
+    }
+}
+
+void bench_adjacency_trimesh(BenchState & state)
+{
+    Trimesh<> m = wavy_trimesh(state.size);
+    state.set_items_per_iteration(m.num_verts() + m.num_edges() + m.num_polys());
+    volatile uint64_t sink = 0;
+    while(state.keep_running())
+    {
+        uint64_t sum = 0;
+        for(uint vid=0; vid<m.num_verts(); ++vid) for(uint nbr : m.adj_v2v(vid)) sum += nbr;
+        for(uint vid=0; vid<m.num_verts(); ++vid) for(uint pid : m.adj_v2p(vid)) sum += pid;
+        for(uint eid=0; eid<m.num_edges(); ++eid) for(uint pid : m.adj_e2p(eid)) sum += pid;
+        for(uint pid=0; pid<m.num_polys(); ++pid) for(uint nbr : m.adj_p2p(pid)) sum += nbr;
+        sink = sum;
+    }
+    (void)sink;
+}
+
+void bench_adjacency_tetmesh(BenchState & state)
+{
+    Tetmesh<> m = tet_lattice(state.size);
+    state.set_items_per_iteration(m.num_verts() + m.num_faces() + m.num_polys());
+    volatile uint64_t sink = 0;
+    while(state.keep_running())
+    {
+        uint64_t sum = 0;
+        for(uint vid=0; vid<m.num_verts(); ++vid) for(uint pid : m.adj_v2p(vid)) sum += pid;
+        for(uint fid=0; fid<m.num_faces(); ++fid) for(uint pid : m.adj_f2p(fid)) sum += pid;
+        for(uint pid=0; pid<m.num_polys(); ++pid) for(uint nbr : m.adj_p2p(pid)) sum += nbr;
+        sink = sum;
+    }
+    (void)sink;
+}
+
+void bench_laplacian_trimesh(BenchState & state)
+{
+    Trimesh<> m = wavy_trimesh(state.size);
+    state.set_items_per_iteration(m.num_verts());
+    while(state.keep_running())
+    {
+        Eigen::SparseMatrix<double> L = laplacian(m, COTANGENT);
+    }
+}
+
+void bench_laplacian_tetmesh(BenchState & state)
+{
+    Tetmesh<> m = tet_lattice(state.size);
+    state.set_items_per_iteration(m.num_verts());
+    while(state.keep_running())
+    {
+        Eigen::SparseMatrix<double> L = laplacian(m, COTANGENT);
+    }
+}
+
+void bench_solve_poisson(BenchState & state)
+{
+    // -L x = M 1, with x = 0 along the boundary
+    Trimesh<> m = wavy_trimesh(state.size);
+    Eigen::SparseMatrix<double> L  = -laplacian(m, COTANGENT);
+    Eigen::SparseMatrix<double> MM = mass_matrix(m);
+    Eigen::VectorXd b = MM * Eigen::VectorXd::Ones(m.num_verts());
+    std::map<uint,double> bc;
+    for(uint vid=0; vid<m.num_verts(); ++vid) if(m.vert_is_boundary(vid)) bc[vid] = 0;
+    state.set_items_per_iteration(m.num_verts());
+    while(state.keep_running())
+    {
+        Eigen::VectorXd x;
+        solve_square_system_with_bc(L, b, x, bc);
+    }
+}
+
+void bench_geodesics(BenchState & state)
+{
+    // one-shot heat geodesics (assembly, factorization and solve)
+    Trimesh<> m = wavy_trimesh(state.size);
+    state.set_items_per_iteration(m.num_verts());
+    while(state.keep_running())
+    {
+        compute_geodesics(m, std::vector<uint>(1,0));
+    }
+}
+
+void bench_geodesics_query(BenchState & state)
+{
+    // heat geodesics from a different source at each iteration, with cached factorizations
+    Trimesh<> m = wavy_trimesh(state.size);
+    GeodesicsEngine engine(m);
+    state.set_items_per_iteration(m.num_verts());
+    uint src = 0;
+    while(state.keep_running())
+    {
+        engine.compute(std::vector<uint>(1,src));
+        src = (src + 7919) % m.num_verts();
+    }
+}
+
+void bench_dijkstra(BenchState & state)
+{
+    Trimesh<> m = wavy_trimesh(state.size);
+    state.set_items_per_iteration(m.num_verts());
+    std::vector<double> dist;
+    while(state.keep_running())
+    {
+        dijkstra_exhaustive(m, 0, dist);
+    }
+}
+
+void bench_octree_build(BenchState & state)
+{
+    Trimesh<> m = wavy_trimesh(state.size);
+    state.set_items_per_iteration(m.num_polys());
+    while(state.keep_running())
+    {
+        Octree o;
+        o.build_from_mesh_polys(m);
+    }
+}
+
+void bench_octree_closest_point(BenchState & state)
+{
+    Trimesh<> m = wavy_trimesh(state.size);
+    Octree o;
+    o.build_from_mesh_polys(m);
+    std::vector<vec3d>  points = random_points(10000, m.bbox());
+    std::vector<uint>   ids;
+    std::vector<vec3d>  pos;
+    std::vector<double> dist;
+    state.set_items_per_iteration(points.size());
+    while(state.keep_running())
+    {
+        o.closest_point(points, ids, pos, dist);
+    }
+}
+
+void bench_octree_intersects_ray(BenchState & state)
+{
+    // vertical rays shot from above the surface
+    Trimesh<> m = wavy_trimesh(state.size);
+    Octree o;
+    o.build_from_mesh_polys(m);
+    std::vector<vec3d> origins = random_points(10000, m.bbox(), 1);
+    std::vector<vec3d> dirs(origins.size(), vec3d(0,0,-1));
+    for(vec3d & p : origins) p.z() = 1;
+    std::vector<double> t;
+    std::vector<int>    ids;
+    state.set_items_per_iteration(origins.size());
+    while(state.keep_running())
+    {
+        o.intersects_ray(origins, dirs, t, ids);
+    }
+}
+
+void bench_marching_tets(BenchState & state)
+{
+    // sphere centered in the lattice
+    Tetmesh<> m = tet_lattice(state.size);
+    vec3d c = m.bbox().center();
+    for(uint vid=0; vid<m.num_verts(); ++vid) m.vert_data(vid).uvw[0] = m.vert(vid).dist(c);
+    double iso = 0.4 * state.size;
+    state.set_items_per_iteration(m.num_polys());
+    std::vector<vec3d> verts, norms;
+    std::vector<uint>  tris;
+    while(state.keep_running())
+    {
+        marching_tets(m, iso, verts, tris, norms);
+    }
+}
+
+void bench_marching_tets_multi(BenchState & state)
+{
+    // 16 concentric spheres extracted in a single sweep
+    Tetmesh<> m = tet_lattice(state.size);
+    vec3d c = m.bbox().center();
+    for(uint vid=0; vid<m.num_verts(); ++vid) m.vert_data(vid).uvw[0] = m.vert(vid).dist(c);
+    std::vector<double> isovalues;
+    for(uint i=0; i<16; ++i) isovalues.push_back(0.05*state.size + 0.025*i*state.size);
+    state.set_items_per_iteration(m.num_polys());
+    std::vector<std::vector<vec3d>> verts, norms;
+    std::vector<std::vector<uint>>  tris;
+    while(state.keep_running())
+    {
+        marching_tets(m, isovalues, verts, tris, norms);
+    }
+}
+
+void bench_remesh_isotropic(BenchState & state)
+{
+    // one remeshing iteration, halving the edge length
+    std::vector<vec3d> verts;
+    std::vector<uint>  tris;
+    wavy_grid(state.size, verts, tris);
+    state.set_items_per_iteration(tris.size()/3);
+    while(state.keep_running())
+    {
+        state.pause_timing();
+        Trimesh<> m(verts, tris);
+        RemeshOptions opt;
+        opt.target_edge_length = 0.5 * m.edge_avg_length();
+        opt.max_iterations     = 1;
+        state.resume_timing();
+        remesh_isotropic(m, opt);
+    }
+}
+
+void bench_decimate_qem(BenchState & state)
+{
+    // decimation down to 10% of the input triangles
+    std::vector<vec3d> verts;
+    std::vector<uint>  tris;
+    wavy_grid(state.size, verts, tris);
+    state.set_items_per_iteration(tris.size()/3);
+    while(state.keep_running())
+    {
+        state.pause_timing();
+        Trimesh<> m(verts, tris);
+        DecimationOptions opt;
+        opt.target_num_polys = m.num_polys()/10;
+        state.resume_timing();
+        decimate_qem(m, opt);
+    }
+}
+
+// undoes the collapses recorded by the decimator (from the last to the first),
+// turning the decimated mesh back into the input one (see EdgeCollapseRecord)
+void vertex_splits(const std::vector<EdgeCollapseRecord> & collapses,
+                   std::vector<vec3d>                    & verts,
+                   std::vector<uint>                     & tris)
+{
+    std::vector<std::vector<uint>> v2t(verts.size()+collapses.size());
+    for(uint i=0; i<tris.size(); ++i) v2t.at(tris.at(i)).push_back(i/3);
+
+    for(auto it=collapses.rbegin(); it!=collapses.rend(); ++it)
+    {
+        const EdgeCollapseRecord & r = *it;
+        uint vk = r.vid_kept;
+        uint vr = r.vid_removed;
+        assert(vr==verts.size());
+        verts.push_back(r.pos_removed);
+        verts.at(vk) = r.pos_kept;
+
+        // the triangles around vk that go from vid_opp[0] to vid_opp[1] (counterclockwise)
+        // belonged to vr. On the boundary one of the two is missing: walk from the other one
+        bool ccw = (r.vid_opp[0]!=UINT_MAX);
+        uint cur = ccw ? r.vid_opp[0] : r.vid_opp[1];
+        for(;;)
+        {
+            int  tid = -1;
+            uint a = 0, b = 0; // the triangle is (vk,a,b)
+            for(uint t : v2t.at(vk))
+            {
+                uint j = 0;
+                while(tris.at(3*t+j)!=vk) ++j;
+                a = tris.at(3*t+(j+1)%3);
+                b = tris.at(3*t+(j+2)%3);
+                if((ccw && a==cur) || (!ccw && b==cur)) { tid = t; break; }
+            }
+            if(tid<0) break;
+            std::replace(tris.begin()+3*tid, tris.begin()+3*tid+3, vk, vr);
+            v2t.at(vk).erase(std::find(v2t.at(vk).begin(), v2t.at(vk).end(), uint(tid)));
+            v2t.at(vr).push_back(tid);
+            cur = ccw ? b : a;
+            if(ccw && cur==r.vid_opp[1]) break;
+        }
+
+        // restore the triangles incident to the collapsed edge
+        if(r.vid_opp[0]!=UINT_MAX) tris.insert(tris.end(), { vr, vk, r.vid_opp[0] });
+        if(r.vid_opp[1]!=UINT_MAX) tris.insert(tris.end(), { vk, vr, r.vid_opp[1] });
+        for(uint i=tris.size()-3*((r.vid_opp[0]!=UINT_MAX)+(r.vid_opp[1]!=UINT_MAX)); i<tris.size(); ++i)
+        {
+            v2t.at(tris.at(i)).push_back(i/3);
+        }
+    }
+}
+
+// true if the two meshes have the same triangles (same positions, same orientation)
+bool same_triangles(const std::vector<vec3d> & verts0, const std::vector<uint> & tris0,
+                    const std::vector<vec3d> & verts1, const std::vector<uint> & tris1)
+{
+    typedef std::array<double,3> Point;
+    auto canonical = [](const std::vector<vec3d> & verts, const std::vector<uint> & tris)
+    {
+        std::vector<std::array<Point,3>> res;
+        for(uint i=0; i<tris.size(); i+=3)
+        {
+            std::array<Point,3> t;
+            for(uint j=0; j<3; ++j)
+            {
+                const vec3d & p = verts.at(tris.at(i+j));
+                t[j] = {{ p.x(), p.y(), p.z() }};
+            }
+            // rotate (keeping the orientation) so that the smallest point comes first
+            std::rotate(t.begin(), std::min_element(t.begin(), t.end()), t.end());
+            res.push_back(t);
+        }
+        std::sort(res.begin(), res.end());
+        return res;
+    };
+    return canonical(verts0, tris0) == canonical(verts1, tris1);
+}
+
+void bench_decimate_qem_splits(BenchState & state)
+{
+    // progressive streaming: rebuild the input from the base mesh and the
+    // recorded vertex splits. The result is checked against the input
+    std::vector<vec3d> verts;
+    std::vector<uint>  tris;
+    wavy_grid(state.size, verts, tris);
+
+    QEMDecimator decimator;
+    decimator.init(verts, tris);
+    DecimationOptions opt;
+    opt.target_num_polys = tris.size()/30;
+    opt.record_collapses = true;
+    decimator.decimate(opt);
+    std::vector<vec3d> base_verts;
+    std::vector<uint>  base_tris;
+    std::vector<ipair> features;
+    std::vector<int>   labels;
+    decimator.export_mesh(base_verts, base_tris, features, labels);
+    const std::vector<EdgeCollapseRecord> & splits = decimator.collapse_sequence();
+    state.set_items_per_iteration(splits.size());
+
+    std::vector<vec3d> v;
+    std::vector<uint>  t;
+    while(state.keep_running())
+    {
+        state.pause_timing();
+        v = base_verts;
+        t = base_tris;
+        state.resume_timing();
+        vertex_splits(splits, v, t);
+    }
+
+    if(!same_triangles(verts, tris, v, t))
+    {
+        std::cerr << "ERROR: decimate/qem_splits: replaying the vertex splits does not restore the input mesh" << std::endl;
+        exit(-1);
+    }
+}
+
+#if defined(CINOLIB_USES_OPENGL) && defined(CINOLIB_USES_QT)
+void bench_remesh(BenchState & state)
+{
+    // one remeshing iteration, halving the edge length
+    std::vector<vec3d> verts;
+    std::vector<uint>  tris;
+    wavy_grid(state.size, verts, tris);
+    state.set_items_per_iteration(tris.size()/3);
+    while(state.keep_running())
+    {
+        state.pause_timing();
+        DrawableTrimesh<> m(verts, tris);
+        double l = 0.5 * m.edge_avg_length();
+        state.resume_timing();
+        remesh_Botsch_Kobbelt_2004(m, l, false);
+    }
+}
+#endif
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+std::string bench_tmp_file(const char * ext)
+{
+    return std::string("cinolib_benchmark_tmp.") + ext;
+}
+
+void bench_write_trimesh(BenchState & state, const char * ext)
+{
+    Trimesh<> m = wavy_trimesh(state.size);
+    std::string s = bench_tmp_file(ext);
+    state.set_items_per_iteration(m.num_polys());
+    while(state.keep_running())
+    {
+        m.save(s.c_str());
+    }
+    remove(s.c_str());
+}
+
+void bench_read_OBJ(BenchState & state)
+{
+    std::string s = bench_tmp_file("obj");
+    Trimesh<> m = wavy_trimesh(state.size);
+    m.save(s.c_str());
+    state.set_items_per_iteration(m.num_polys());
+    while(state.keep_running())
+    {
+        std::vector<vec3d>             verts;
+        std::vector<std::vector<uint>> polys;
+        read_OBJ(s.c_str(), verts, polys);
+    }
+    remove(s.c_str());
+}
+
+void bench_read_STL(BenchState & state)
+{
+    std::string s = bench_tmp_file("stl");
+    Trimesh<> m = wavy_trimesh(state.size);
+    m.save(s.c_str());
+    state.set_items_per_iteration(m.num_polys());
+    while(state.keep_running())
+    {
+        std::vector<vec3d> verts;
+        std::vector<uint>  tris;
+        read_STL(s.c_str(), verts, tris);
+    }
+    remove(s.c_str());
+}
+
+void bench_write_MESH(BenchState & state)
+{
+    Tetmesh<> m = tet_lattice(state.size);
+    std::string s = bench_tmp_file("mesh");
+    state.set_items_per_iteration(m.num_polys());
+    while(state.keep_running())
+    {
+        m.save(s.c_str());
+    }
+    remove(s.c_str());
+}
+
+void bench_read_MESH(BenchState & state)
+{
+    std::string s = bench_tmp_file("mesh");
+    Tetmesh<> m = tet_lattice(state.size);
+    m.save(s.c_str());
+    state.set_items_per_iteration(m.num_polys());
+    while(state.keep_running())
+    {
+        std::vector<vec3d>             verts;
+        std::vector<std::vector<uint>> polys;
+        read_MESH(s.c_str(), verts, polys);
+    }
+    remove(s.c_str());
+}
+
+void bench_save_binary(BenchState & state)
+{
+    Tetmesh<> m = tet_lattice(state.size);
+    std::string s = bench_tmp_file("cino");
+    state.set_items_per_iteration(m.num_polys());
+    while(state.keep_running())
+    {
+        m.save_binary(s.c_str());
+    }
+    remove(s.c_str());
+}
+
+void bench_load_binary(BenchState & state)
+{
+    std::string s = bench_tmp_file("cino");
+    Tetmesh<> m = tet_lattice(state.size);
+    m.save_binary(s.c_str());
+    state.set_items_per_iteration(m.num_polys());
+    while(state.keep_running())
+    {
+        Tetmesh<> tmp;
+        tmp.load_binary(s.c_str());
+    }
+    remove(s.c_str());
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+std::vector<Benchmark> all_benchmarks()
+{
+    using namespace std::placeholders;
+    return
+    {
+        { "build/trimesh",          {  64, 512 }, bench_build_trimesh         },
+        { "build/tetmesh",          {  16,  48 }, bench_build_tetmesh         },
+        { "build/hexmesh",          {  16,  64 }, bench_build_hexmesh         },
+        { "adjacency/trimesh",      {  64, 512 }, bench_adjacency_trimesh     },
+        { "adjacency/tetmesh",      {  16,  48 }, bench_adjacency_tetmesh     },
+        { "laplacian/trimesh",      {  64, 512 }, bench_laplacian_trimesh     },
+        { "laplacian/tetmesh",      {  16,  48 }, bench_laplacian_tetmesh     },
+        { "solve/poisson",          {  64, 256 }, bench_solve_poisson         },
+        { "geodesics/heat",         {  64, 256 }, bench_geodesics             },
+        { "geodesics/heat_query",   {  64, 256 }, bench_geodesics_query       },
+        { "dijkstra/exhaustive",    {  64, 512 }, bench_dijkstra              },
+        { "octree/build",           {  64, 512 }, bench_octree_build          },
+        { "octree/closest_point",   {  64, 512 }, bench_octree_closest_point  },
+        { "octree/intersects_ray",  {  64, 512 }, bench_octree_intersects_ray },
+        { "marching_tets",          {  16,  48 }, bench_marching_tets         },
+        { "marching_tets/multi",    {  16,  48 }, bench_marching_tets_multi   },
+        { "remesh/isotropic",       {  64, 256 }, bench_remesh_isotropic      },
+        { "decimate/qem",           {  64, 256 }, bench_decimate_qem          },
+        { "decimate/qem_splits",    {  64, 256 }, bench_decimate_qem_splits   },
+#if defined(CINOLIB_USES_OPENGL) && defined(CINOLIB_USES_QT)
+        { "remesh/botsch_kobbelt",  {  64, 256 }, bench_remesh                },
+#endif
+        { "io/write_OBJ",           {  64, 512 }, std::bind(bench_write_trimesh, _1, "obj") },
+        { "io/read_OBJ",            {  64, 512 }, bench_read_OBJ              },
+        { "io/write_STL",           {  64, 512 }, std::bind(bench_write_trimesh, _1, "stl") },
+        { "io/read_STL",            {  64, 512 }, bench_read_STL              },
+        { "io/write_MESH",          {  16,  48 }, bench_write_MESH            },
+        { "io/read_MESH",           {  16,  48 }, bench_read_MESH             },
+        { "io/save_binary",         {  16,  48 }, bench_save_binary           },
+        { "io/load_binary",         {  16,  48 }, bench_load_binary           },
+    };
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+//:::::::::::::::::::::::::::::: REPORTING :::::::::::::::::::::::::::::::
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+typedef struct
+{
+    std::string name;
+    uint        size;
+    uint        iterations;
+    double      mean;   // seconds per iteration
+    double      median;
+    double      min;
+    double      stddev;
+    double      cpu;    // CPU seconds per iteration (all threads)
+    double      items_per_second;
+}
+BenchResult;
+
+BenchResult summarize(const std::string & name, const BenchState & state)
+{
+    std::vector<double> t = state.iter_secs;
+    std::sort(t.begin(), t.end());
+
+    BenchResult r;
+    r.name       = name;
+    r.size       = state.size;
+    r.iterations = t.size();
+    r.mean       = std::accumulate(t.begin(), t.end(), 0.0) / t.size();
+    r.median     = (t.size()%2==1) ? t[t.size()/2] : 0.5*(t[t.size()/2-1] + t[t.size()/2]);
+    r.min        = t.front();
+    r.cpu        = state.cpu_secs / t.size();
+    double var   = 0;
+    for(double x : t) var += (x-r.mean)*(x-r.mean);
+    r.stddev           = (t.size()>1) ? std::sqrt(var/(t.size()-1)) : 0;
+    r.items_per_second = (state.items>0) ? state.items/r.mean : 0;
+    return r;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+bool write_json(const std::string              & filename,
+                const std::string              & executable,
+                const std::vector<BenchResult> & results)
+{
+    std::ofstream f(filename);
+    if(!f.is_open())
+    {
+        std::cerr << "ERROR : " << __FILE__ << ", line " << __LINE__ << " : write_json() : couldn't write output file " << filename << std::endl;
+        return false;
+    }
+
+    char date[64];
+    std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+    // times are in milliseconds
+    f.precision(10);
+    f << "{\n";
+    f << "  \"context\": {\n";
+    f << "    \"date\": \"" << date << "\",\n";
+    f << "    \"executable\": \"" << executable << "\",\n";
+    f << "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n";
+    f << "    \"num_threads\": " << get_num_threads() << ",\n";
+#ifdef NDEBUG
+    f << "    \"library_build_type\": \"release\"\n";
+#else
+    f << "    \"library_build_type\": \"debug\"\n";
+#endif
+    f << "  },\n";
+    f << "  \"benchmarks\": [\n";
+    for(uint i=0; i<results.size(); ++i)
+    {
+        const BenchResult & r = results.at(i);
+        f << "    {\n";
+        f << "      \"name\": \""             << r.name << "\",\n";
+        f << "      \"run_name\": \""         << r.name << "\",\n";
+        f << "      \"run_type\": \"iteration\",\n";
+        f << "      \"repetitions\": 1,\n";
+        f << "      \"size\": "               << r.size                << ",\n";
+        f << "      \"iterations\": "         << r.iterations          << ",\n";
+        f << "      \"real_time\": "          << r.mean   * 1e3        << ",\n";
+        f << "      \"cpu_time\": "           << r.cpu    * 1e3        << ",\n";
+        f << "      \"median_time\": "        << r.median * 1e3        << ",\n";
+        f << "      \"min_time\": "           << r.min    * 1e3        << ",\n";
+        f << "      \"stddev_time\": "        << r.stddev * 1e3        << ",\n";
+        f << "      \"items_per_second\": "   << r.items_per_second    << ",\n";
+        f << "      \"time_unit\": \"ms\"\n";
+        f << "    }" << (i+1<results.size() ? "," : "") << "\n";
+    }
+    f << "  ]\n";
+    f << "}\n";
+    return true;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+int main(int argc, char **argv)
+{
+    std::string filter   = "";
+    std::string out      = "benchmarks.json";
+    double      min_time = 0.5;
+    double      scale    = 1.0;
+    bool        list     = false;
+
+    for(int i=1; i<argc; ++i)
+    {
+        std::string arg(argv[i]);
+        auto value = [&](const std::string & key) { return arg.substr(key.size()); };
+        if     (arg.find("--filter=")  ==0) filter   = value("--filter=");
+        else if(arg.find("--out=")     ==0) out      = value("--out=");
+        else if(arg.find("--min_time=")==0) min_time = atof(value("--min_time=").c_str());
+        else if(arg.find("--scale=")   ==0) scale    = atof(value("--scale=").c_str());
+        else if(arg.find("--threads=") ==0) set_num_threads(atoi(value("--threads=").c_str()));
+        else if(arg=="--list")              list     = true;
+        else
+        {
+            std::cout << "ERROR: unknown option " << arg << std::endl;
+            return -1;
+        }
+    }
+
+    std::vector<BenchResult> results;
+    for(const Benchmark & b : all_benchmarks())
+    for(uint size : b.sizes)
+    {
+        size = std::max(1u, uint(std::round(size*scale)));
+        std::string name = b.name + "/" + std::to_string(size);
+        if(name.find(filter)==std::string::npos) continue;
+        if(list)
+        {
+            std::cout << name << std::endl;
+            continue;
+        }
+
+        // mute the logs of the library while benchmarks run (results are printed with printf)
+        BenchState state(size, min_time);
+        std::ostringstream log;
+        std::streambuf *cout_buf = std::cout.rdbuf(log.rdbuf());
+        b.run(state);
+        std::cout.rdbuf(cout_buf);
+        BenchResult r = summarize(name, state);
+        results.push_back(r);
+
+        printf("%-32s %12.3f ms %12.3f ms (median) %12.3f ms (cpu) %8u iters", name.c_str(), r.mean*1e3, r.median*1e3, r.cpu*1e3, r.iterations);
+        if(r.items_per_second>0) printf(" %12.4g items/s", r.items_per_second);
+        printf("\n");
+        fflush(stdout);
+    }
+
+    if(list) return 0;
+    if(!write_json(out, argv[0], results)) return -1;
+    std::cout << "results written to " << out << " (" << get_num_threads() << " threads)" << std::endl;
+    return 0;
+}
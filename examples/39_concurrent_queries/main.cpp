@@ -0,0 +1,152 @@
+/* This sample program checks that the const queries of Octree and BVH can be
+ * safely issued from multiple threads. The same set of random queries is
+ * answered three times on the same tree: with a plain sequential loop, with
+ * the batched queries (which split the input across the threads of the global
+ * pool), and with single queries issued concurrently from a parallel_for.
+ * The three results must coincide. The program returns a non zero exit code
+ * (and reports the first mismatch) if they do not
+ *
+ * usage: concurrent_queries [surface mesh] [volume mesh] [#threads] [#queries]
+ *
+ * Enjoy!
+*/
+
+#include <cinolib/meshes/meshes.h>
+#include <cinolib/octree.h>
+#include <cinolib/bvh.h>
+#include <cinolib/thread_pool.h>
+#include <cinolib/min_max_inf.h>
+#include <random>
+#include <thread>
+
+using namespace cinolib;
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+std::vector<vec3d> random_points(const uint n, const AABB & box, const uint seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> d(-0.1,1.1); // also a few points outside the box
+    std::vector<vec3d> points(n);
+    for(vec3d & p : points) p = box.min + vec3d(d(rng), d(rng), d(rng)) * box.delta();
+    return points;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<typename T>
+bool check(const std::string & name, const std::vector<T> & ref, const std::vector<T> & res)
+{
+    for(uint i=0; i<ref.size(); ++i)
+    {
+        if(!(res.at(i)==ref.at(i)))
+        {
+            std::cout << "ERROR: " << name << " differs from the sequential result at query #" << i << std::endl;
+            return false;
+        }
+    }
+    std::cout << name << ": OK" << std::endl;
+    return true;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// runs closest point, contains (on tree_vol) and first hit ray queries (on tree_srf)
+// sequentially, batched and concurrently, and compares the results
+template<class Tree>
+bool test(const std::string & name, const Tree & tree_srf, const Tree & tree_vol, const AABB & box_srf, const AABB & box_vol, const uint n)
+{
+    std::vector<vec3d> points  = random_points(n, box_srf, 0);
+    std::vector<vec3d> inside  = random_points(n, box_vol, 1);
+    std::vector<vec3d> origins = random_points(n, box_srf, 2);
+    std::vector<vec3d> dirs    = random_points(n, AABB(vec3d(-1,-1,-1), vec3d(1,1,1)), 3);
+
+    // sequential reference
+    std::vector<uint>   cp_ids(n);
+    std::vector<vec3d>  cp_pos(n);
+    std::vector<double> cp_dist(n);
+    std::vector<int>    in_ids(n,-1);
+    std::vector<double> ray_t(n,inf_double);
+    std::vector<int>    ray_ids(n,-1);
+    for(uint i=0; i<n; ++i)
+    {
+        uint id;
+        tree_srf.closest_point(points[i], cp_ids[i], cp_pos[i], cp_dist[i]);
+        if(tree_vol.contains(inside[i], false, id)) in_ids[i] = id;
+        if(tree_srf.intersects_ray(origins[i], dirs[i], ray_t[i], id)) ray_ids[i] = id; else ray_t[i] = inf_double;
+    }
+
+    // batched queries
+    std::vector<uint>   b_cp_ids;
+    std::vector<vec3d>  b_cp_pos;
+    std::vector<double> b_cp_dist;
+    std::vector<int>    b_in_ids;
+    std::vector<double> b_ray_t;
+    std::vector<int>    b_ray_ids;
+    tree_srf.closest_point (points, b_cp_ids, b_cp_pos, b_cp_dist);
+    tree_vol.contains      (inside, false, b_in_ids);
+    tree_srf.intersects_ray(origins, dirs, b_ray_t, b_ray_ids);
+
+    // single queries issued concurrently
+    std::vector<uint>   c_cp_ids(n);
+    std::vector<vec3d>  c_cp_pos(n);
+    std::vector<double> c_cp_dist(n);
+    std::vector<int>    c_in_ids(n,-1);
+    std::vector<double> c_ray_t(n,inf_double);
+    std::vector<int>    c_ray_ids(n,-1);
+    parallel_for(0, n, [&](const uint i)
+    {
+        uint id;
+        tree_srf.closest_point(points[i], c_cp_ids[i], c_cp_pos[i], c_cp_dist[i]);
+        if(tree_vol.contains(inside[i], false, id)) c_in_ids[i] = id;
+        if(tree_srf.intersects_ray(origins[i], dirs[i], c_ray_t[i], id)) c_ray_ids[i] = id; else c_ray_t[i] = inf_double;
+    }, 64);
+
+    bool ok = true;
+    ok &= check(name + " batched    closest_point (ids) ", cp_ids,  b_cp_ids);
+    ok &= check(name + " batched    closest_point (pos) ", cp_pos,  b_cp_pos);
+    ok &= check(name + " batched    closest_point (dist)", cp_dist, b_cp_dist);
+    ok &= check(name + " batched    contains            ", in_ids,  b_in_ids);
+    ok &= check(name + " batched    intersects_ray (t)  ", ray_t,   b_ray_t);
+    ok &= check(name + " batched    intersects_ray (ids)", ray_ids, b_ray_ids);
+    ok &= check(name + " concurrent closest_point (ids) ", cp_ids,  c_cp_ids);
+    ok &= check(name + " concurrent closest_point (pos) ", cp_pos,  c_cp_pos);
+    ok &= check(name + " concurrent closest_point (dist)", cp_dist, c_cp_dist);
+    ok &= check(name + " concurrent contains            ", in_ids,  c_in_ids);
+    ok &= check(name + " concurrent intersects_ray (t)  ", ray_t,   c_ray_t);
+    ok &= check(name + " concurrent intersects_ray (ids)", ray_ids, c_ray_ids);
+    return ok;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+int main(int argc, char **argv)
+{
+    std::string s_srf = (argc>1) ? std::string(argv[1]) : std::string(DATA_PATH) + "bunny.obj";
+    std::string s_vol = (argc>2) ? std::string(argv[2]) : std::string(DATA_PATH) + "sphere.mesh";
+    uint n_threads    = (argc>3) ? atoi(argv[3]) : std::max(4u, std::thread::hardware_concurrency());
+    uint n_queries    = (argc>4) ? atoi(argv[4]) : 10000;
+
+    set_num_threads(n_threads);
+    std::cout << get_num_threads() << " threads, " << n_queries << " queries" << std::endl;
+
+    Trimesh<> m_srf(s_srf.c_str());
+    Tetmesh<> m_vol(s_vol.c_str());
+
+    bool ok = true;
+    {
+        Octree o_srf, o_vol;
+        o_srf.build_from_mesh_polys(m_srf);
+        o_vol.build_from_mesh_polys(m_vol);
+        ok &= test("Octree", o_srf, o_vol, m_srf.bbox(), m_vol.bbox(), n_queries);
+    }
+    {
+        BVH b_srf, b_vol;
+        b_srf.build_from_mesh_polys(m_srf);
+        b_vol.build_from_mesh_polys(m_vol);
+        ok &= test("BVH   ", b_srf, b_vol, m_srf.bbox(), m_vol.bbox(), n_queries);
+    }
+
+    std::cout << (ok ? "all queries match" : "MISMATCH FOUND") << std::endl;
+    return ok ? 0 : -1;
+}
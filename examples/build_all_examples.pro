@@ -52,3 +52,6 @@ SUBDIRS += 33_edge_collapse
 SUBDIRS += 34_Hermite_RBF               # requires Tetgen (http://wias-berlin.de/software/index.jsp?id=TetGen&lang=1)
 SUBDIRS += 35_Poisson_sampling
 SUBDIRS += 36_canonical_polygonal_schema
+SUBDIRS += 37_io_throughput
+SUBDIRS += 38_benchmarks
+SUBDIRS += 39_concurrent_queries
@@ -65,6 +65,9 @@ void solve_IRLS(const Eigen::SparseMatrix<double> & A,
     Eigen::VectorXd w(A.rows());
     for(int i=0; i<A.rows(); ++i) w[i] = 1.0;
 
+    // the pattern of AtWA does not depend on the weights: analyze it only once
+    LinearSolver LS(solver);
+
     double res      = 0;
     double prev_res = 0;
     int    iter     = 0;
@@ -73,7 +76,7 @@ void solve_IRLS(const Eigen::SparseMatrix<double> & A,
         prev_res = res;
 
         // minimize L2
-        solve_weighted_least_squares(A, w, b, x, solver);
+        solve_weighted_least_squares(A, w, b, x, LS);
 
         // update weights
         for(int i=0; i<A.rows(); ++i)
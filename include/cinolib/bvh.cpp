@@ -0,0 +1,1122 @@
+/********************************************************************************
+*  This file is part of CinoLib                                                 *
+*  Copyright(C) 2016: Marco Livesu                                              *
+*                                                                               *
+*  The MIT License                                                              *
+*                                                                               *
+*  Permission is hereby granted, free of charge, to any person obtaining a      *
+*  copy of this software and associated documentation files (the "Software"),   *
+*  to deal in the Software without restriction, including without limitation    *
+*  the rights to use, copy, modify, merge, publish, distribute, sublicense,     *
+*  and/or sell copies of the Software, and to permit persons to whom the        *
+*  Software is furnished to do so, subject to the following conditions:         *
+*                                                                               *
+*  The above copyright notice and this permission notice shall be included in   *
+*  all copies or substantial portions of the Software.                          *
+*                                                                               *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR   *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,     *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. IN NO EVENT SHALL THE *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER       *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      *
+*  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS *
+*  IN THE SOFTWARE.                                                             *
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Marco Livesu (marco.livesu@gmail.com)                                     *
+*     http://pers.ge.imati.cnr.it/livesu/                                       *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*********************************************************************************/
+#include <cinolib/bvh.h>
+#include <cinolib/how_many_seconds.h>
+#include <cinolib/thread_pool.h>
+#include <algorithm>
+#include <numeric>
+#include <cmath>
+
+namespace cinolib
+{
+
+const uint BVH_STACK_SIZE = 128; // traversal stack (max_depth is clamped accordingly)
+const uint BVH_TYPE_SHIFT = 30;  // item refs: type in the two most significant bits
+const uint BVH_INDEX_MASK = (1u<<BVH_TYPE_SHIFT)-1;
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// conservative conversion to single precision (rounds outwards)
+CINO_INLINE
+float bvh_round_down(const double d)
+{
+    float f = static_cast<float>(d);
+    return (f>d) ? std::nextafter(f,-inf_float) : f;
+}
+
+CINO_INLINE
+float bvh_round_up(const double d)
+{
+    float f = static_cast<float>(d);
+    return (f<d) ? std::nextafter(f,inf_float) : f;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+double bvh_node_dist_sqrd(const BVHNode & n, const vec3d & p)
+{
+    double d = 0;
+    for(int i=0; i<3; ++i)
+    {
+        double delta = std::max(0.0, std::max(n.bbox_min[i]-p[i], p[i]-n.bbox_max[i]));
+        d += delta*delta;
+    }
+    return d;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+bool bvh_node_contains(const BVHNode & n, const vec3d & p)
+{
+    return p[0]>=n.bbox_min[0] && p[0]<=n.bbox_max[0] &&
+           p[1]>=n.bbox_min[1] && p[1]<=n.bbox_max[1] &&
+           p[2]>=n.bbox_min[2] && p[2]<=n.bbox_max[2];
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+bool bvh_node_intersects_box(const BVHNode & n, const AABB & b)
+{
+    return b.min[0]<=n.bbox_max[0] && b.max[0]>=n.bbox_min[0] &&
+           b.min[1]<=n.bbox_max[1] && b.max[1]>=n.bbox_min[1] &&
+           b.min[2]<=n.bbox_max[2] && b.max[2]>=n.bbox_min[2];
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// slab test. Returns the entry point t_near of the ray in the box, if it is within [0,t_max]
+CINO_INLINE
+bool bvh_node_intersects_ray(const BVHNode & n, const vec3d & p, const vec3d & inv_dir, const double t_max, double & t_near)
+{
+    double t0 = 0.0;
+    double t1 = t_max;
+    for(int i=0; i<3; ++i)
+    {
+        if(std::isinf(inv_dir[i]))
+        {
+            // ray parallel to the slab: no hit if origin is not within it
+            if(p[i]<n.bbox_min[i] || p[i]>n.bbox_max[i]) return false;
+            continue;
+        }
+        double ta = (n.bbox_min[i] - p[i]) * inv_dir[i];
+        double tb = (n.bbox_max[i] - p[i]) * inv_dir[i];
+        if(ta>tb) std::swap(ta,tb);
+        t0 = std::max(t0,ta);
+        t1 = std::min(t1,tb);
+        if(t0>t1) return false;
+    }
+    t_near = t0;
+    return true;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+vec3d bvh_inverse_dir(const vec3d & dir)
+{
+    vec3d inv;
+    for(int i=0; i<3; ++i) inv[i] = (std::fabs(dir[i])<1e-15) ? inf_double : 1.0/dir[i];
+    return inv;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+double bvh_surface_area(const AABB & b)
+{
+    vec3d d = b.max - b.min;
+    return 2.0*(d[0]*d[1] + d[1]*d[2] + d[2]*d[0]);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void bvh_expand(AABB & b, const AABB & other)
+{
+    b.min = b.min.min(other.min);
+    b.max = b.max.max(other.max);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void bvh_expand(AABB & b, const vec3d & p)
+{
+    b.min = b.min.min(p);
+    b.max = b.max.max(p);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+BVH::BVH(const uint max_depth,
+         const uint items_per_leaf)
+: max_depth(std::min(max_depth, BVH_STACK_SIZE/2-1))
+, items_per_leaf(std::max(items_per_leaf, 1u))
+{}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void BVH::add_segment(const uint id, const std::vector<vec3d> & v)
+{
+    segments.push_back(Segment(id,v.data()));
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void BVH::add_triangle(const uint id, const std::vector<vec3d> & v)
+{
+    triangles.push_back(Triangle(id,v.data()));
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void BVH::add_tetrahedron(const uint id, const std::vector<vec3d> & v)
+{
+    tetrahedra.push_back(Tetrahedron(id,v.data()));
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void BVH::build()
+{
+    typedef std::chrono::high_resolution_clock Time;
+    Time::time_point t0 = Time::now();
+
+    nodes.clear();
+    item_refs.clear();
+    tree_depth = 0;
+    n_leaves   = 0;
+
+    uint n = num_items();
+    assert(n <= BVH_INDEX_MASK);
+    if(n>0)
+    {
+        std::vector<uint> refs;
+        refs.reserve(n);
+        for(uint i=0; i<segments.size();   ++i) refs.push_back((SEGMENT     << BVH_TYPE_SHIFT) | i);
+        for(uint i=0; i<triangles.size();  ++i) refs.push_back((TRIANGLE    << BVH_TYPE_SHIFT) | i);
+        for(uint i=0; i<tetrahedra.size(); ++i) refs.push_back((TETRAHEDRON << BVH_TYPE_SHIFT) | i);
+
+        std::vector<AABB>  boxes(n);
+        std::vector<vec3d> centroids(n);
+        for(uint i=0; i<n; ++i)
+        {
+            boxes[i]     = item_aabb(refs[i]);
+            centroids[i] = boxes[i].center();
+        }
+
+        // the tree is built permuting positions in refs, which are eventually
+        // replaced by the actual refs
+        item_refs.resize(n);
+        std::iota(item_refs.begin(), item_refs.end(), 0);
+        nodes.reserve(2*n/items_per_leaf+1);
+        build_node(0, n, 1, boxes, centroids);
+        for(uint & r : item_refs) r = refs[r];
+    }
+    if(use_packets) build_packet_data();
+
+    Time::time_point t1 = Time::now();
+    double t = how_many_seconds(t0,t1);
+
+    std::cout << ":::::::::::::::::::::::::::::::::::::::::::::::::::" << std::endl;
+    std::cout << "BVH created (" << t << "s)                         " << std::endl;
+    std::cout << "#Items                   : " << n                    << std::endl;
+    std::cout << "#Nodes                   : " << nodes.size()         << std::endl;
+    std::cout << "#Leaves                  : " << n_leaves             << std::endl;
+    std::cout << "Max depth                : " << max_depth            << std::endl;
+    std::cout << "Depth                    : " << tree_depth           << std::endl;
+    std::cout << "Prescribed items per leaf: " << items_per_leaf       << std::endl;
+    std::cout << "Max items per leaf       : " << max_items_per_leaf() << std::endl;
+    std::cout << ":::::::::::::::::::::::::::::::::::::::::::::::::::" << std::endl;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+uint BVH::build_node(const uint                 beg,
+                     const uint                 end,
+                     const uint                 depth,
+                     const std::vector<AABB>  & boxes,
+                     const std::vector<vec3d> & centroids)
+{
+    assert(end>beg);
+
+    uint node_id = nodes.size();
+    nodes.push_back(BVHNode());
+    tree_depth = std::max(tree_depth, depth);
+
+    AABB bbox, cbox;
+    for(uint i=beg; i<end; ++i)
+    {
+        bvh_expand(bbox, boxes[item_refs[i]]);
+        bvh_expand(cbox, centroids[item_refs[i]]);
+    }
+    for(int i=0; i<3; ++i)
+    {
+        nodes[node_id].bbox_min[i] = bvh_round_down(bbox.min[i]);
+        nodes[node_id].bbox_max[i] = bvh_round_up(bbox.max[i]);
+    }
+
+    auto make_leaf = [&]()
+    {
+        nodes[node_id].offset = beg;
+        nodes[node_id].count  = end-beg;
+        ++n_leaves;
+        return node_id;
+    };
+
+    uint n = end-beg;
+    if(n<=items_per_leaf || depth>=max_depth) return make_leaf();
+
+    // binned SAH: find the plane that minimizes the SAH cost, testing
+    // BINS-1 candidate planes along each axis
+    const int BINS = 16;
+    int    best_axis = -1;
+    int    best_bin  = -1;
+    double best_cost = inf_double;
+    for(int axis=0; axis<3; ++axis)
+    {
+        double extent = cbox.max[axis] - cbox.min[axis];
+        if(extent<=0) continue;
+        double scale = BINS/extent;
+
+        uint count[BINS] = {0};
+        AABB bin_box[BINS];
+        for(uint i=beg; i<end; ++i)
+        {
+            uint item = item_refs[i];
+            int  bin  = std::min(BINS-1, static_cast<int>((centroids[item][axis]-cbox.min[axis])*scale));
+            ++count[bin];
+            bvh_expand(bin_box[bin], boxes[item]);
+        }
+
+        // sweep from the right to collect areas and counts on the right side of each plane
+        double right_area [BINS];
+        uint   right_count[BINS];
+        AABB   acc;
+        uint   acc_count = 0;
+        for(int b=BINS-1; b>0; --b)
+        {
+            if(count[b]>0) bvh_expand(acc, bin_box[b]);
+            acc_count     += count[b];
+            right_count[b] = acc_count;
+            right_area [b] = (acc_count>0) ? bvh_surface_area(acc) : 0;
+        }
+
+        // sweep from the left, and evaluate the cost of each plane
+        acc = AABB();
+        acc_count = 0;
+        for(int b=0; b<BINS-1; ++b)
+        {
+            if(count[b]>0) bvh_expand(acc, bin_box[b]);
+            acc_count += count[b];
+            if(acc_count==0 || right_count[b+1]==0) continue;
+            double cost = bvh_surface_area(acc)*acc_count + right_area[b+1]*right_count[b+1];
+            if(cost<best_cost)
+            {
+                best_cost = cost;
+                best_axis = axis;
+                best_bin  = b;
+            }
+        }
+    }
+
+    // all centroids coincide: there is no way to separate these items
+    if(best_axis<0) return make_leaf();
+
+    double extent = cbox.max[best_axis] - cbox.min[best_axis];
+    double scale  = BINS/extent;
+    auto   mid_it = std::partition(item_refs.begin()+beg, item_refs.begin()+end, [&](const uint item)
+    {
+        int bin = std::min(BINS-1, static_cast<int>((centroids[item][best_axis]-cbox.min[best_axis])*scale));
+        return bin<=best_bin;
+    });
+    uint mid = std::distance(item_refs.begin(), mid_it);
+    assert(mid>beg && mid<end);
+
+    build_node(beg, mid, depth+1, boxes, centroids);
+    uint right = build_node(mid, end, depth+1, boxes, centroids);
+    nodes[node_id].offset = right;
+    nodes[node_id].count  = 0;
+    return node_id;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+uint BVH::max_items_per_leaf() const
+{
+    uint max = 0;
+    for(const BVHNode & n : nodes) max = std::max(max, n.count);
+    return max;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void BVH::debug_mode(const bool b)
+{
+    print_debug_info = b;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void BVH::packet_mode(const bool b)
+{
+    use_packets = b;
+    if(use_packets) build_packet_data();
+    else            packet_tris.clear();
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void BVH::build_packet_data()
+{
+    packet_tris.clear();
+    if(!segments.empty() || !tetrahedra.empty()) return;
+
+    // triangles are copied in the order of item_refs, so that the
+    // items of each leaf are contiguous in memory
+    packet_tris.resize(9*item_refs.size());
+    for(uint i=0; i<item_refs.size(); ++i)
+    {
+        const Triangle & t = triangles[item_refs[i] & BVH_INDEX_MASK];
+        vec3d e0 = t.v[1] - t.v[0];
+        vec3d e1 = t.v[2] - t.v[0];
+        for(int j=0; j<3; ++j)
+        {
+            packet_tris[9*i+j]   = float(t.v[0][j]);
+            packet_tris[9*i+3+j] = float(e0[j]);
+            packet_tris[9*i+6+j] = float(e1[j]);
+        }
+    }
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void BVH::print_query_info(const std::string & s,
+                           const double        t,
+                           const uint          aabb_queries,
+                           const uint          item_queries) const
+{
+    std::cout << s << "\n\t" << t  << " seconds\n\t"
+              << aabb_queries << " AABB queries\n\t"
+              << item_queries << " item queries" << std::endl;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+vec3d BVH::closest_point(const vec3d & p) const
+{
+    uint   id;
+    vec3d  pos;
+    double dist;
+    closest_point(p, id, pos, dist);
+    return pos;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void BVH::closest_point(const vec3d  & p,          // query point
+                              uint   & id,         // id of the item T closest to p
+                              vec3d  & pos,        // point in T closest to p
+                              double & dist) const // squared distance between pos and p
+{
+    assert(!nodes.empty());
+
+    typedef std::chrono::high_resolution_clock Time;
+    Time::time_point t0 = Time::now();
+
+    uint aabb_queries = 1;
+    uint item_queries = 0;
+
+    // depth first traversal, visiting the closest child first
+    // and pruning all nodes farther than the current best item
+    uint   stack[BVH_STACK_SIZE];
+    double stack_dist[BVH_STACK_SIZE];
+    uint   top = 0;
+    stack[top] = 0;
+    stack_dist[top++] = bvh_node_dist_sqrd(nodes[0],p);
+
+    dist = inf_double;
+    while(top>0)
+    {
+        --top;
+        if(stack_dist[top]>=dist) continue;
+        const BVHNode & node = nodes[stack[top]];
+
+        if(node.count>0)
+        {
+            for(uint i=node.offset; i<node.offset+node.count; ++i)
+            {
+                vec3d  q = item_point_closest_to(item_refs[i], p);
+                double d = q.dist_squared(p);
+                if(d<dist)
+                {
+                    dist = d;
+                    pos  = q;
+                    id   = item_id(item_refs[i]);
+                }
+            }
+            if(print_debug_info) item_queries += node.count;
+        }
+        else
+        {
+            uint   c0 = stack[top]+1;
+            uint   c1 = node.offset;
+            double d0 = bvh_node_dist_sqrd(nodes[c0],p);
+            double d1 = bvh_node_dist_sqrd(nodes[c1],p);
+            if(d0>d1)
+            {
+                std::swap(c0,c1);
+                std::swap(d0,d1);
+            }
+            assert(top+2<=BVH_STACK_SIZE);
+            if(d1<dist) { stack[top] = c1; stack_dist[top++] = d1; }
+            if(d0<dist) { stack[top] = c0; stack_dist[top++] = d0; }
+            if(print_debug_info) aabb_queries += 2;
+        }
+    }
+
+    if(print_debug_info)
+    {
+        Time::time_point t1 = Time::now();
+        print_query_info("Closest point query", how_many_seconds(t0,t1), aabb_queries, item_queries);
+    }
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// this query becomes exact if CINOLIB_USES_EXACT_PREDICATES is defined
+CINO_INLINE
+bool BVH::contains(const vec3d & p, const bool strict, uint & id) const
+{
+    if(nodes.empty()) return false;
+
+    typedef std::chrono::high_resolution_clock Time;
+    Time::time_point t0 = Time::now();
+
+    uint aabb_queries = 0;
+    uint item_queries = 0;
+
+    uint stack[BVH_STACK_SIZE];
+    uint top = 0;
+    stack[top++] = 0;
+
+    while(top>0)
+    {
+        const BVHNode & node = nodes[stack[--top]];
+        if(print_debug_info) ++aabb_queries;
+        if(!bvh_node_contains(node,p)) continue;
+
+        if(node.count>0)
+        {
+            for(uint i=node.offset; i<node.offset+node.count; ++i)
+            {
+                if(print_debug_info) ++item_queries;
+                if(item_contains(item_refs[i], p, strict))
+                {
+                    id = item_id(item_refs[i]);
+                    if(print_debug_info)
+                    {
+                        Time::time_point t1 = Time::now();
+                        print_query_info("Contains query (first item)", how_many_seconds(t0,t1), aabb_queries, item_queries);
+                    }
+                    return true;
+                }
+            }
+        }
+        else
+        {
+            stack[top++] = node.offset;
+            stack[top++] = &node - nodes.data() + 1;
+        }
+    }
+    return false;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// this query becomes exact if CINOLIB_USES_EXACT_PREDICATES is defined
+CINO_INLINE
+bool BVH::contains(const vec3d & p, const bool strict, std::unordered_set<uint> & ids) const
+{
+    ids.clear();
+    if(nodes.empty()) return false;
+
+    typedef std::chrono::high_resolution_clock Time;
+    Time::time_point t0 = Time::now();
+
+    uint aabb_queries = 0;
+    uint item_queries = 0;
+
+    uint stack[BVH_STACK_SIZE];
+    uint top = 0;
+    stack[top++] = 0;
+
+    while(top>0)
+    {
+        const BVHNode & node = nodes[stack[--top]];
+        if(print_debug_info) ++aabb_queries;
+        if(!bvh_node_contains(node,p)) continue;
+
+        if(node.count>0)
+        {
+            for(uint i=node.offset; i<node.offset+node.count; ++i)
+            {
+                if(item_contains(item_refs[i], p, strict)) ids.insert(item_id(item_refs[i]));
+            }
+            if(print_debug_info) item_queries += node.count;
+        }
+        else
+        {
+            stack[top++] = node.offset;
+            stack[top++] = &node - nodes.data() + 1;
+        }
+    }
+
+    if(print_debug_info)
+    {
+        Time::time_point t1 = Time::now();
+        print_query_info("Contains query (all items)", how_many_seconds(t0,t1), aabb_queries, item_queries);
+    }
+
+    return !ids.empty();
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+bool BVH::intersects_ray(const vec3d & p, const vec3d & dir, double & min_t, uint & id) const
+{
+    if(nodes.empty()) return false;
+
+    typedef std::chrono::high_resolution_clock Time;
+    Time::time_point t0 = Time::now();
+
+    uint aabb_queries = 1;
+    uint item_queries = 0;
+
+    vec3d  inv_dir = bvh_inverse_dir(dir);
+    double t;
+    if(!bvh_node_intersects_ray(nodes[0], p, inv_dir, inf_double, t)) return false;
+
+    // depth first traversal, visiting the closest child first
+    // and pruning all nodes beyond the current closest hit
+    uint   stack[BVH_STACK_SIZE];
+    double stack_t[BVH_STACK_SIZE];
+    uint   top = 0;
+    stack[top] = 0;
+    stack_t[top++] = t;
+
+    bool hit = false;
+    min_t = inf_double;
+    while(top>0)
+    {
+        --top;
+        if(stack_t[top]>min_t) continue;
+        const BVHNode & node = nodes[stack[top]];
+
+        if(node.count>0)
+        {
+            for(uint i=node.offset; i<node.offset+node.count; ++i)
+            {
+                if(item_intersects_ray(item_refs[i], p, dir, t) && t<min_t)
+                {
+                    min_t = t;
+                    id    = item_id(item_refs[i]);
+                    hit   = true;
+                }
+            }
+            if(print_debug_info) item_queries += node.count;
+        }
+        else
+        {
+            uint   c0 = stack[top]+1;
+            uint   c1 = node.offset;
+            double tc0 = inf_double, tc1 = inf_double; // only written on a hit
+            bool   h0 = bvh_node_intersects_ray(nodes[c0], p, inv_dir, min_t, tc0);
+            bool   h1 = bvh_node_intersects_ray(nodes[c1], p, inv_dir, min_t, tc1);
+            if(h0 && h1 && tc0>tc1)
+            {
+                std::swap(c0,c1);
+                std::swap(tc0,tc1);
+            }
+            if(h1) { stack[top] = c1; stack_t[top++] = tc1; }
+            if(h0) { stack[top] = c0; stack_t[top++] = tc0; }
+            if(print_debug_info) aabb_queries += 2;
+        }
+    }
+
+    if(print_debug_info)
+    {
+        Time::time_point t1 = Time::now();
+        print_query_info("Intersects ray query", how_many_seconds(t0,t1), aabb_queries, item_queries);
+    }
+
+    return hit;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+bool BVH::intersects_ray(const vec3d & p, const vec3d & dir, std::set<std::pair<double,uint>> & all_hits) const
+{
+    if(nodes.empty()) return false;
+
+    typedef std::chrono::high_resolution_clock Time;
+    Time::time_point t0 = Time::now();
+
+    uint aabb_queries = 0;
+    uint item_queries = 0;
+
+    vec3d inv_dir = bvh_inverse_dir(dir);
+
+    uint stack[BVH_STACK_SIZE];
+    uint top = 0;
+    stack[top++] = 0;
+
+    while(top>0)
+    {
+        const BVHNode & node = nodes[stack[--top]];
+        double t;
+        if(print_debug_info) ++aabb_queries;
+        if(!bvh_node_intersects_ray(node, p, inv_dir, inf_double, t)) continue;
+
+        if(node.count>0)
+        {
+            for(uint i=node.offset; i<node.offset+node.count; ++i)
+            {
+                if(item_intersects_ray(item_refs[i], p, dir, t))
+                {
+                    all_hits.insert(std::make_pair(t,item_id(item_refs[i])));
+                }
+            }
+            if(print_debug_info) item_queries += node.count;
+        }
+        else
+        {
+            stack[top++] = node.offset;
+            stack[top++] = &node - nodes.data() + 1;
+        }
+    }
+
+    if(print_debug_info)
+    {
+        Time::time_point t1 = Time::now();
+        print_query_info("Intersects ray query", how_many_seconds(t0,t1), aabb_queries, item_queries);
+    }
+
+    return !all_hits.empty();
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// this query becomes exact if CINOLIB_USES_EXACT_PREDICATES is defined
+CINO_INLINE
+bool BVH::intersects_triangle(const vec3d t[], const bool ignore_if_valid_complex, std::unordered_set<uint> & ids) const
+{
+    ids.clear();
+    if(nodes.empty()) return false;
+
+    typedef std::chrono::high_resolution_clock Time;
+    Time::time_point t0 = Time::now();
+
+    uint aabb_queries = 0;
+    uint item_queries = 0;
+
+    AABB t_box({t[0], t[1], t[2]});
+
+    uint stack[BVH_STACK_SIZE];
+    uint top = 0;
+    stack[top++] = 0;
+
+    while(top>0)
+    {
+        const BVHNode & node = nodes[stack[--top]];
+        if(print_debug_info) ++aabb_queries;
+        if(!bvh_node_intersects_box(node, t_box)) continue;
+
+        if(node.count>0)
+        {
+            for(uint i=node.offset; i<node.offset+node.count; ++i)
+            {
+                // test the AABBs first, it's cheaper
+                if(item_aabb(item_refs[i]).intersects_box(t_box) &&
+                   item_intersects_triangle(item_refs[i], t, ignore_if_valid_complex))
+                {
+                    ids.insert(item_id(item_refs[i]));
+                }
+            }
+            if(print_debug_info) item_queries += node.count;
+        }
+        else
+        {
+            stack[top++] = node.offset;
+            stack[top++] = &node - nodes.data() + 1;
+        }
+    }
+
+    if(print_debug_info)
+    {
+        Time::time_point t1 = Time::now();
+        print_query_info("Intersects Triangle (exact)", how_many_seconds(t0,t1), aabb_queries, item_queries);
+    }
+
+    return !ids.empty();
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// this query becomes exact if CINOLIB_USES_EXACT_PREDICATES is defined
+CINO_INLINE
+bool BVH::intersects_segment(const vec3d s[], const bool ignore_if_valid_complex, std::unordered_set<uint> & ids) const
+{
+    ids.clear();
+    if(nodes.empty()) return false;
+
+    typedef std::chrono::high_resolution_clock Time;
+    Time::time_point t0 = Time::now();
+
+    uint aabb_queries = 0;
+    uint item_queries = 0;
+
+    AABB s_box(std::vector<vec3d>{s[0], s[1]});
+
+    uint stack[BVH_STACK_SIZE];
+    uint top = 0;
+    stack[top++] = 0;
+
+    while(top>0)
+    {
+        const BVHNode & node = nodes[stack[--top]];
+        if(print_debug_info) ++aabb_queries;
+        if(!bvh_node_intersects_box(node, s_box)) continue;
+
+        if(node.count>0)
+        {
+            for(uint i=node.offset; i<node.offset+node.count; ++i)
+            {
+                // test the AABBs first, it's cheaper
+                if(item_aabb(item_refs[i]).intersects_box(s_box) &&
+                   item_intersects_segment(item_refs[i], s, ignore_if_valid_complex))
+                {
+                    ids.insert(item_id(item_refs[i]));
+                }
+            }
+            if(print_debug_info) item_queries += node.count;
+        }
+        else
+        {
+            stack[top++] = node.offset;
+            stack[top++] = &node - nodes.data() + 1;
+        }
+    }
+
+    if(print_debug_info)
+    {
+        Time::time_point t1 = Time::now();
+        print_query_info("Intersects Segment (exact)", how_many_seconds(t0,t1), aabb_queries, item_queries);
+    }
+
+    return !ids.empty();
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// items are stored by value, so their static type is known and the (qualified)
+// calls below are resolved at compile time, avoiding virtual dispatch
+
+CINO_INLINE
+uint BVH::item_id(const uint ref) const
+{
+    uint i = ref & BVH_INDEX_MASK;
+    switch(ref >> BVH_TYPE_SHIFT)
+    {
+        case SEGMENT     : return segments  [i].id;
+        case TRIANGLE    : return triangles [i].id;
+        case TETRAHEDRON : return tetrahedra[i].id;
+        default: assert(false); return 0;
+    }
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+AABB BVH::item_aabb(const uint ref) const
+{
+    uint i = ref & BVH_INDEX_MASK;
+    switch(ref >> BVH_TYPE_SHIFT)
+    {
+        case SEGMENT     : return segments  [i].Segment::aabb();
+        case TRIANGLE    : return triangles [i].Triangle::aabb();
+        case TETRAHEDRON : return tetrahedra[i].Tetrahedron::aabb();
+        default: assert(false); return AABB();
+    }
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+vec3d BVH::item_point_closest_to(const uint ref, const vec3d & p) const
+{
+    uint i = ref & BVH_INDEX_MASK;
+    switch(ref >> BVH_TYPE_SHIFT)
+    {
+        case SEGMENT     : return segments  [i].Segment::point_closest_to(p);
+        case TRIANGLE    : return triangles [i].Triangle::point_closest_to(p);
+        case TETRAHEDRON : return tetrahedra[i].Tetrahedron::point_closest_to(p);
+        default: assert(false); return vec3d();
+    }
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+bool BVH::item_contains(const uint ref, const vec3d & p, const bool strict) const
+{
+    uint i = ref & BVH_INDEX_MASK;
+    switch(ref >> BVH_TYPE_SHIFT)
+    {
+        case SEGMENT     : return segments  [i].Segment::contains(p,strict);
+        case TRIANGLE    : return triangles [i].Triangle::contains(p,strict);
+        case TETRAHEDRON : return tetrahedra[i].Tetrahedron::contains(p,strict);
+        default: assert(false); return false;
+    }
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+bool BVH::item_intersects_ray(const uint ref, const vec3d & p, const vec3d & dir, double & t) const
+{
+    // NOTE: item primitives intersect the whole line, hits behind
+    // the origin of the ray (i.e. t<0) are discarded here
+    uint  i = ref & BVH_INDEX_MASK;
+    vec3d pos;
+    bool  hit = false;
+    switch(ref >> BVH_TYPE_SHIFT)
+    {
+        case SEGMENT     : hit = segments  [i].Segment::intersects_ray(p,dir,t,pos);     break;
+        case TRIANGLE    : hit = triangles [i].Triangle::intersects_ray(p,dir,t,pos);    break;
+        case TETRAHEDRON : hit = tetrahedra[i].Tetrahedron::intersects_ray(p,dir,t,pos); break;
+        default: assert(false);
+    }
+    return hit && t>=0;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+bool BVH::item_intersects_segment(const uint ref, const vec3d s[], const bool ignore_if_valid_complex) const
+{
+    uint i = ref & BVH_INDEX_MASK;
+    switch(ref >> BVH_TYPE_SHIFT)
+    {
+        case SEGMENT     : return segments  [i].Segment::intersects_segment(s,ignore_if_valid_complex);
+        case TRIANGLE    : return triangles [i].Triangle::intersects_segment(s,ignore_if_valid_complex);
+        case TETRAHEDRON : return tetrahedra[i].Tetrahedron::intersects_segment(s,ignore_if_valid_complex);
+        default: assert(false); return false;
+    }
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+bool BVH::item_intersects_triangle(const uint ref, const vec3d t[], const bool ignore_if_valid_complex) const
+{
+    uint i = ref & BVH_INDEX_MASK;
+    switch(ref >> BVH_TYPE_SHIFT)
+    {
+        case SEGMENT     : return segments  [i].Segment::intersects_triangle(t,ignore_if_valid_complex);
+        case TRIANGLE    : return triangles [i].Triangle::intersects_triangle(t,ignore_if_valid_complex);
+        case TETRAHEDRON : return tetrahedra[i].Tetrahedron::intersects_triangle(t,ignore_if_valid_complex);
+        default: assert(false); return false;
+    }
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void BVH::closest_point(const Span<vec3d>         & points,
+                              std::vector<uint>   & ids,
+                              std::vector<vec3d>  & pos,
+                              std::vector<double> & dist) const
+{
+    ids.resize(points.size());
+    pos.resize(points.size());
+    dist.resize(points.size());
+
+    parallel_for(0, points.size(), [&](const uint i)
+    {
+        closest_point(points[i], ids[i], pos[i], dist[i]);
+    }, 64);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// this query becomes exact if CINOLIB_USES_EXACT_PREDICATES is defined
+CINO_INLINE
+void BVH::contains(const Span<vec3d>      & points,
+                   const bool               strict,
+                         std::vector<int> & ids) const
+{
+    ids.resize(points.size());
+
+    parallel_for(0, points.size(), [&](const uint i)
+    {
+        uint id;
+        ids[i] = contains(points[i], strict, id) ? int(id) : -1;
+    }, 64);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void BVH::intersects_ray(const Span<vec3d>         & origins,
+                         const Span<vec3d>         & dirs,
+                               std::vector<double> & min_t,
+                               std::vector<int>    & ids) const
+{
+    assert(origins.size()==dirs.size());
+
+    min_t.resize(origins.size());
+    ids.resize(origins.size());
+
+    if(use_packets && !packet_tris.empty())
+    {
+        uint n_packets = (origins.size()+RAY_PACKET_WIDTH-1)/RAY_PACKET_WIDTH;
+        parallel_for(0, n_packets, [&](const uint i)
+        {
+            uint beg = i*RAY_PACKET_WIDTH;
+            uint n   = std::min(RAY_PACKET_WIDTH, origins.size()-beg);
+            intersects_ray_packet(origins.data()+beg, dirs.data()+beg, n, min_t.data()+beg, ids.data()+beg);
+        }, 16);
+        return;
+    }
+
+    parallel_for(0, origins.size(), [&](const uint i)
+    {
+        uint id;
+        if(intersects_ray(origins[i], dirs[i], min_t[i], id)) ids[i] = int(id);
+        else
+        {
+            ids[i]   = -1;
+            min_t[i] = inf_double;
+        }
+    }, 64);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void BVH::intersects_ray_packet(const vec3d  * origins,
+                                const vec3d  * dirs,
+                                const uint     n,
+                                      double * min_t,
+                                      int    * ids) const
+{
+    assert(!packet_tris.empty() && n<=RAY_PACKET_WIDTH);
+
+    RayPacket rp;
+    ray_packet_init(rp, origins, dirs, n);
+
+    // children are visited front to back according to the direction of the
+    // first ray, which for coherent packets is a good guess for all rays
+    const vec3d & dir = dirs[0];
+
+    int  hit[RAY_PACKET_WIDTH]; // position in item_refs of the closest hit
+    std::fill(hit, hit+RAY_PACKET_WIDTH, -1);
+
+    FloatLanes t_near;
+    uint stack[BVH_STACK_SIZE];
+    uint top = 0;
+    stack[top++] = 0;
+
+    while(top>0)
+    {
+        uint nid = stack[--top];
+        const BVHNode & node = nodes[nid];
+        if(!ray_packet_intersects_box(rp, node.bbox_min, node.bbox_max, t_near)) continue;
+
+        if(node.count>0)
+        {
+            for(uint i=node.offset; i<node.offset+node.count; ++i)
+            {
+                uint lanes = ray_packet_clip_triangle(rp, &packet_tris[9*i]);
+                for(uint l=0; lanes!=0; ++l, lanes>>=1)
+                {
+                    if(lanes & 1) hit[l] = int(i);
+                }
+            }
+        }
+        else
+        {
+            uint c0 = nid+1;
+            uint c1 = node.offset;
+            // split axis: the one along which the two children are most separated
+            int    axis = 0;
+            double sep  = 0;
+            for(int j=0; j<3; ++j)
+            {
+                double d = (nodes[c1].bbox_min[j] + nodes[c1].bbox_max[j]) -
+                           (nodes[c0].bbox_min[j] + nodes[c0].bbox_max[j]);
+                if(std::fabs(d)>std::fabs(sep))
+                {
+                    sep  = d;
+                    axis = j;
+                }
+            }
+            if(sep*dir[axis]<0) std::swap(c0,c1);
+            stack[top++] = c1;
+            stack[top++] = c0;
+        }
+    }
+
+    float t[RAY_PACKET_WIDTH];
+    lanes_store(rp.t_max, t);
+    for(uint l=0; l<n; ++l)
+    {
+        if(hit[l]<0)
+        {
+            ids[l]   = -1;
+            min_t[l] = inf_double;
+            continue;
+        }
+        // refine the hit in double precision
+        uint   ref = item_refs[hit[l]];
+        double t_dbl;
+        vec3d  pos;
+        bool   ok  = triangles[ref & BVH_INDEX_MASK].Triangle::intersects_ray(origins[l], dirs[l], t_dbl, pos);
+        ids[l]   = int(item_id(ref));
+        min_t[l] = (ok && t_dbl>=0) ? t_dbl : double(t[l]);
+    }
+}
+
+}
@@ -0,0 +1,281 @@
+/********************************************************************************
+*  This file is part of CinoLib                                                 *
+*  Copyright(C) 2016: Marco Livesu                                              *
+*                                                                               *
+*  The MIT License                                                              *
+*                                                                               *
+*  Permission is hereby granted, free of charge, to any person obtaining a      *
+*  copy of this software and associated documentation files (the "Software"),   *
+*  to deal in the Software without restriction, including without limitation    *
+*  the rights to use, copy, modify, merge, publish, distribute, sublicense,     *
+*  and/or sell copies of the Software, and to permit persons to whom the        *
+*  Software is furnished to do so, subject to the following conditions:         *
+*                                                                               *
+*  The above copyright notice and this permission notice shall be included in   *
+*  all copies or substantial portions of the Software.                          *
+*                                                                               *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR   *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,     *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. IN NO EVENT SHALL THE *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER       *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      *
+*  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS *
+*  IN THE SOFTWARE.                                                             *
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Marco Livesu (marco.livesu@gmail.com)                                     *
+*     http://pers.ge.imati.cnr.it/livesu/                                       *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*********************************************************************************/
+#ifndef CINO_BVH_H
+#define CINO_BVH_H
+
+#include <cinolib/meshes/meshes.h>
+#include <cinolib/geometry/segment.h>
+#include <cinolib/geometry/triangle.h>
+#include <cinolib/geometry/tetrahedron.h>
+#include <cinolib/ray_packet.h>
+#include <cinolib/span.h>
+#include <set>
+#include <unordered_set>
+
+namespace cinolib
+{
+
+/* Node of a flat BVH. Nodes are stored in a single array in depth-first order,
+ * so the first child of an inner node always follows its parent, and only the
+ * index of the second child needs to be stored. Bounding boxes are stored in
+ * single precision, conservatively rounded outwards, to fit a node in 32 bytes
+*/
+
+typedef struct
+{
+    float bbox_min[3];
+    float bbox_max[3];
+    uint  offset; // inner nodes: index of the second child. Leaves: index of the first item in BVH::item_refs
+    uint  count;  // number of items in the leaf (zero for inner nodes)
+}
+BVHNode;
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+/* Bounding Volume Hierarchy built with the binned Surface Area Heuristic (SAH).
+ *
+ * BVH offers the same interface as Octree (it can be used as a drop in
+ * replacement), but:
+ *
+ *  - the tree is a flat array of 32 bytes nodes (no pointers, no allocation per node)
+ *  - each item is referenced by exactly one leaf (no duplicates across cells)
+ *  - items are stored by value, and are queried without virtual calls
+ *
+ * Once the tree is built, all const queries can be safely issued concurrently
+ * from multiple threads, as long as nobody modifies the tree at the same time.
+ * Traversals use fixed size stacks, hence queries do not allocate any memory
+ *
+ * Packet mode (see packet_mode) speeds up batched ray queries on triangle soups
+ * (e.g. ambient occlusion, visibility, picking): consecutive rays are grouped in
+ * packets of RAY_PACKET_WIDTH rays, which traverse the tree together and are
+ * tested against a single precision copy of the triangles with SSE/AVX kernels
+ * (see ray_packet.h). Only the final hit of each ray is refined in double
+ * precision, so results may differ from scalar queries for rays that graze an
+ * edge or a vertex of the mesh. Coherent rays (i.e. rays with similar origin and
+ * direction, such as those cast from a pixel grid) should be consecutive
+ *
+ * Usage:
+ *
+ *  i)   Create an empty BVH
+ *  ii)  Use the add_segment/triangle/tetrahedron facilities to populate it
+ *  iii) Call build to make the tree
+ *
+ * Ref: On fast Construction of SAH-based Bounding Volume Hierarchies
+ *      I. Wald
+ *      IEEE Symposium on Interactive Ray Tracing, 2007
+*/
+
+class BVH
+{
+    public:
+
+        explicit BVH(const uint max_depth      = 64,
+                     const uint items_per_leaf = 4);
+
+        virtual ~BVH() {}
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        void add_segment    (const uint id, const std::vector<vec3d> & v);
+        void add_triangle   (const uint id, const std::vector<vec3d> & v);
+        void add_tetrahedron(const uint id, const std::vector<vec3d> & v);
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        void build();
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        template<class M, class V, class E, class P>
+        void build_from_mesh_polys(const AbstractPolygonMesh<M,V,E,P> & m)
+        {
+            assert(num_items()==0);
+            triangles.reserve(m.num_polys());
+            for(uint pid=0; pid<m.num_polys(); ++pid)
+            {
+                for(uint i=0; i<m.poly_tessellation(pid).size()/3; ++i)
+                {
+                    vec3d v0 = m.vert(m.poly_tessellation(pid).at(3*i+0));
+                    vec3d v1 = m.vert(m.poly_tessellation(pid).at(3*i+1));
+                    vec3d v2 = m.vert(m.poly_tessellation(pid).at(3*i+2));
+                    add_triangle(pid, {v0,v1,v2});
+                }
+            }
+            build();
+        }
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        template<class M, class V, class E, class P>
+        void build_from_mesh_polys(const AbstractPolyhedralMesh<M,V,E,P> & m)
+        {
+            assert(num_items()==0);
+            tetrahedra.reserve(m.num_polys());
+            for(uint pid=0; pid<m.num_polys(); ++pid)
+            {
+                switch(m.mesh_type())
+                {
+                    case TETMESH : add_tetrahedron(pid, m.poly_verts(pid)); break;
+                    default: assert(false && "Unsupported element");
+                }
+            }
+            build();
+        }
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        template<class M, class V, class E, class P>
+        void build_from_mesh_edges(const AbstractMesh<M,V,E,P> & m)
+        {
+            assert(num_items()==0);
+            segments.reserve(m.num_edges());
+            for(uint eid=0; eid<m.num_edges(); ++eid)
+            {
+                add_segment(eid, m.edge_verts(eid));
+            }
+            build();
+        }
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        uint num_items()  const { return segments.size() + triangles.size() + tetrahedra.size(); }
+        uint num_nodes()  const { return nodes.size(); }
+        uint num_leaves() const { return n_leaves;  }
+        uint depth()      const { return tree_depth; }
+
+        uint max_items_per_leaf() const;
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        void debug_mode(const bool b);
+
+        // enables SIMD ray packets for batched intersects_ray queries. Only BVHs
+        // made of triangles use it, all the other queries are not affected
+        void packet_mode(const bool b);
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        void print_query_info(const std::string & s,
+                              const double        t,
+                              const uint          aabb_queries,
+                              const uint          item_queries) const;
+
+        // QUERIES :::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        // returns pos, id and squared distance of the item that is closest to query point p
+        void  closest_point(const vec3d & p, uint & id, vec3d & pos, double & dist) const;
+        vec3d closest_point(const vec3d & p) const;
+
+        // returns respectively the first item and the full list of items containing query point p
+        // note: this query becomes exact if CINOLIB_USES_EXACT_PREDICATES is defined
+        bool contains(const vec3d & p, const bool strict, uint & id) const;
+        bool contains(const vec3d & p, const bool strict, std::unordered_set<uint> & ids) const;
+
+        // returns respectively the first and the full list of intersections
+        // between items in the BVH and a ray R(t) := p + t * dir
+        bool intersects_ray(const vec3d & p, const vec3d & dir, double & min_t, uint & id) const; // first hit
+        bool intersects_ray(const vec3d & p, const vec3d & dir, std::set<std::pair<double,uint>> & all_hits) const;
+
+        // note: these queries becomes exact if CINOLIB_USES_EXACT_PREDICATES is defined
+        bool intersects_segment (const vec3d s[], const bool ignore_if_valid_complex, std::unordered_set<uint> & ids) const;
+        bool intersects_triangle(const vec3d t[], const bool ignore_if_valid_complex, std::unordered_set<uint> & ids) const;
+
+        // BATCHED QUERIES :::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        // same as the queries above, for a whole set of points (or rays), split across
+        // the threads of the global pool. Results are stored in flat arrays, having one
+        // entry per query. Points not contained in any item and rays that do not hit any
+        // item get id -1 (and t = inf for rays)
+        void closest_point (const Span<vec3d> & points, std::vector<uint> & ids, std::vector<vec3d> & pos, std::vector<double> & dist) const;
+        void contains      (const Span<vec3d> & points, const bool strict, std::vector<int> & ids) const;
+        void intersects_ray(const Span<vec3d> & origins, const Span<vec3d> & dirs, std::vector<double> & min_t, std::vector<int> & ids) const;
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+    protected:
+
+        // items are stored by value, grouped by type. Leaves index item_refs, which
+        // encodes both the type (two most significant bits) and the position of the
+        // item in the vector of its type
+        std::vector<Segment>     segments;
+        std::vector<Triangle>    triangles;
+        std::vector<Tetrahedron> tetrahedra;
+        std::vector<uint>        item_refs;
+        std::vector<BVHNode>     nodes;
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        uint max_depth;      // maximum allowed depth of the tree
+        uint items_per_leaf; // leaves with at most this many items are never split
+        uint tree_depth = 0; // actual depth of the tree
+        uint n_leaves   = 0; // actual number of leaves
+        bool print_debug_info = false;
+        bool use_packets      = false;
+
+        // packet mode: triangle (v0, v1-v0, v2-v0) of each item ref, in single precision
+        std::vector<float> packet_tris;
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        uint build_node(const uint beg, const uint end, const uint depth,
+                        const std::vector<AABB>  & boxes,
+                        const std::vector<vec3d> & centroids);
+
+        void build_packet_data();
+
+        void intersects_ray_packet(const vec3d  * origins,
+                                   const vec3d  * dirs,
+                                   const uint     n,
+                                         double * min_t,
+                                         int    * ids) const;
+
+        // non virtual dispatch of the item primitives
+        uint  item_id                 (const uint ref) const;
+        AABB  item_aabb               (const uint ref) const;
+        vec3d item_point_closest_to   (const uint ref, const vec3d & p) const;
+        bool  item_contains           (const uint ref, const vec3d & p, const bool strict) const;
+        bool  item_intersects_ray     (const uint ref, const vec3d & p, const vec3d & dir, double & t) const;
+        bool  item_intersects_segment (const uint ref, const vec3d s[], const bool ignore_if_valid_complex) const;
+        bool  item_intersects_triangle(const uint ref, const vec3d t[], const bool ignore_if_valid_complex) const;
+};
+
+}
+
+#ifndef  CINO_STATIC_LIB
+#include "bvh.cpp"
+#endif
+
+#endif // CINO_BVH_H
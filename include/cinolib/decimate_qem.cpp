@@ -0,0 +1,751 @@
+/********************************************************************************
+*  This file is part of CinoLib                                                 *
+*  Copyright(C) 2016: Marco Livesu                                              *
+*                                                                               *
+*  The MIT License                                                              *
+*                                                                               *
+*  Permission is hereby granted, free of charge, to any person obtaining a      *
+*  copy of this software and associated documentation files (the "Software"),   *
+*  to deal in the Software without restriction, including without limitation    *
+*  the rights to use, copy, modify, merge, publish, distribute, sublicense,     *
+*  and/or sell copies of the Software, and to permit persons to whom the        *
+*  Software is furnished to do so, subject to the following conditions:         *
+*                                                                               *
+*  The above copyright notice and this permission notice shall be included in   *
+*  all copies or substantial portions of the Software.                          *
+*                                                                               *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR   *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,     *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. IN NO EVENT SHALL THE *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER       *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      *
+*  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS *
+*  IN THE SOFTWARE.                                                             *
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Marco Livesu (marco.livesu@gmail.com)                                     *
+*     http://pers.ge.imati.cnr.it/livesu/                                       *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*********************************************************************************/
+#include <cinolib/decimate_qem.h>
+#include <cinolib/thread_pool.h>
+#include <cinolib/trace_profiler.h>
+#include <cinolib/how_many_seconds.h>
+#include <cinolib/vector_serialization.h>
+#include <algorithm>
+#include <climits>
+
+namespace cinolib
+{
+
+CINO_INLINE
+std::ostream & operator<<(std::ostream & in, const DecimationStats & stats)
+{
+    in << stats.num_collapses << " collapses ["
+       << stats.secs          << "s]  "
+       << stats.num_verts     << "V / "
+       << stats.num_polys     << "P  max error: "
+       << stats.max_error;
+    return in;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void QEMDecimator::init(const std::vector<vec3d> & verts,
+                        const std::vector<uint>  & tris,
+                        const std::vector<ipair> & feature_edges,
+                        const std::vector<int>   & tri_labels)
+{
+    assert(tris.size()%3==0);
+    uint nv = verts.size();
+    uint nt = tris.size()/3;
+
+    this->pos  = verts;
+    this->tris = tris;
+    labels     = tri_labels;
+    if(labels.empty()) labels.assign(nt,-1);
+    assert(labels.size()==nt);
+
+    v2t.assign(nv, std::vector<uint>());
+    for(uint tid=0; tid<nt; ++tid)
+    for(uint i=0; i<3; ++i)
+    {
+        v2t.at(tris.at(3*tid+i)).push_back(tid);
+    }
+
+    vert_dead.assign(nv, 0);
+    tri_dead.assign(nt, 0);
+    nv_alive = nv;
+    nt_alive = nt;
+
+    boundary.assign(nv, 0);
+    for(uint tid=0; tid<nt; ++tid)
+    for(uint i=0; i<3; ++i)
+    {
+        uint vid0 = tris.at(3*tid+i);
+        uint vid1 = tris.at(3*tid+(i+1)%3);
+        uint t[2];
+        if(edge_tris(vid0,vid1,t)==1) boundary.at(vid0) = boundary.at(vid1) = 1;
+    }
+
+    features.clear();
+    for(const ipair & e : feature_edges) features.insert(edge_key(e.first, e.second));
+
+    records.clear();
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+DecimationStats QEMDecimator::decimate(const DecimationOptions & opt)
+{
+    CINO_PROFILE_ZONE("QEMDecimator::decimate");
+    typedef std::chrono::high_resolution_clock Time;
+    Time::time_point t0 = Time::now();
+
+    if(!opt.preserve_marked_features) features.clear();
+    init_quadrics(opt.feature_weight);
+    version.assign(pos.size(), 0);
+    visit.assign(pos.size(), 0);
+    visit_id = 0;
+
+    // min heap of collapses, ordered by quadric error
+    auto heap_cmp = [](const HeapEntry & a, const HeapEntry & b) { return a.cost > b.cost; };
+    std::vector<HeapEntry> heap;
+    {
+        CINO_PROFILE_ZONE("QEMDecimator::init_heap");
+        std::vector<ipair> e;
+        edges(e);
+        std::vector<uint8_t> valid(e.size());
+        heap.resize(e.size());
+        parallel_for(0, e.size(), [&](const uint i)
+        {
+            uint   vid_kept, vid_removed;
+            vec3d  p;
+            double cost;
+            valid[i] = collapse_plan(e[i].first, e[i].second, opt.optimal_placement, vid_kept, vid_removed, p, cost);
+            heap[i]  = { float(cost), e[i].first, e[i].second, 0, 0 };
+        });
+        uint n = 0;
+        for(uint i=0; i<heap.size(); ++i) if(valid[i]) heap[n++] = heap[i];
+        heap.resize(n);
+        std::make_heap(heap.begin(), heap.end(), heap_cmp);
+    }
+
+    DecimationStats stats;
+    std::vector<uint> nbrs;
+    while(!heap.empty() && nt_alive > opt.target_num_polys)
+    {
+        std::pop_heap(heap.begin(), heap.end(), heap_cmp);
+        HeapEntry entry = heap.back();
+        heap.pop_back();
+
+        // outdated entry (the quadric of an endpoint changed after it was pushed)
+        if(vert_dead.at(entry.vid0) || vert_dead.at(entry.vid1)) continue;
+        if(version.at(entry.vid0)!=entry.version0 || version.at(entry.vid1)!=entry.version1) continue;
+
+        uint   vid_kept, vid_removed;
+        vec3d  p;
+        double cost;
+        if(!collapse_plan(entry.vid0, entry.vid1, opt.optimal_placement, vid_kept, vid_removed, p, cost)) continue;
+        if(cost > opt.max_error) break;
+        uint t[2], nt;
+        if(!collapse_is_valid(vid_kept, vid_removed, p, t, nt)) continue;
+
+        collapse(vid_kept, vid_removed, p, t, nt, cost, opt.record_collapses);
+        ++stats.num_collapses;
+        stats.max_error = std::max(stats.max_error, cost);
+
+        // the quadric of vid_kept changed: refresh the costs of its edges
+        vert_neighbors(vid_kept, nbrs);
+        for(uint nbr : nbrs)
+        {
+            uint kept, removed;
+            if(!collapse_plan(vid_kept, nbr, opt.optimal_placement, kept, removed, p, cost)) continue;
+            heap.push_back({ float(cost), vid_kept, nbr, version.at(vid_kept), version.at(nbr) });
+            std::push_heap(heap.begin(), heap.end(), heap_cmp);
+        }
+    }
+
+    stats.num_verts = nv_alive;
+    stats.num_polys = nt_alive;
+    stats.secs      = how_many_seconds(t0, Time::now());
+    return stats;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void QEMDecimator::export_mesh(std::vector<vec3d> & verts,
+                               std::vector<uint>  & tris,
+                               std::vector<ipair> & feature_edges,
+                               std::vector<int>   & tri_labels)
+{
+    // surviving verts first (in their original order), followed by the
+    // removed ones, sorted from the last collapsed to the first collapsed
+    uint nv = 0;
+    std::vector<uint> vmap(pos.size(), UINT_MAX);
+    for(uint vid=0; vid<pos.size(); ++vid)
+    {
+        if(vert_dead.at(vid)) continue;
+        vmap.at(vid)    = nv;
+        pos.at(nv)      = pos.at(vid);
+        boundary.at(nv) = boundary.at(vid);
+        ++nv;
+    }
+    uint next = nv;
+    for(auto it=records.rbegin(); it!=records.rend(); ++it)
+    {
+        if(vmap.at(it->vid_removed)==UINT_MAX) vmap.at(it->vid_removed) = next++;
+    }
+    for(EdgeCollapseRecord & r : records)
+    {
+        r.vid_kept    = vmap.at(r.vid_kept);
+        r.vid_removed = vmap.at(r.vid_removed);
+        if(r.vid_opp[0]!=UINT_MAX) r.vid_opp[0] = vmap.at(r.vid_opp[0]);
+        if(r.vid_opp[1]!=UINT_MAX) r.vid_opp[1] = vmap.at(r.vid_opp[1]);
+    }
+    pos.resize(nv);
+    boundary.resize(nv);
+
+    uint nt = 0;
+    for(uint tid=0; tid<tri_dead.size(); ++tid)
+    {
+        if(tri_dead.at(tid)) continue;
+        for(uint i=0; i<3; ++i) this->tris.at(3*nt+i) = vmap.at(this->tris.at(3*tid+i));
+        labels.at(nt) = labels.at(tid);
+        ++nt;
+    }
+    this->tris.resize(3*nt);
+    labels.resize(nt);
+
+    std::unordered_set<uint64_t> tmp;
+    feature_edges.clear();
+    for(uint64_t key : features)
+    {
+        uint vid0 = vmap.at(key >> 32);
+        uint vid1 = vmap.at(key & 0xFFFFFFFF);
+        if(vid0>=nv || vid1>=nv) continue;
+        tmp.insert(edge_key(vid0,vid1));
+        feature_edges.push_back(std::make_pair(std::min(vid0,vid1), std::max(vid0,vid1)));
+    }
+    features.swap(tmp);
+    std::sort(feature_edges.begin(), feature_edges.end());
+
+    v2t.assign(nv, std::vector<uint>());
+    for(uint tid=0; tid<nt; ++tid)
+    for(uint i=0; i<3; ++i)
+    {
+        v2t.at(this->tris.at(3*tid+i)).push_back(tid);
+    }
+    vert_dead.assign(nv, 0);
+    tri_dead.assign(nt, 0);
+    assert(nv==nv_alive && nt==nt_alive);
+
+    verts      = pos;
+    tris       = this->tris;
+    tri_labels = labels;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void QEMDecimator::quadric_add_plane(Quadric & Q, const vec3d & n, const double d, const double w)
+{
+    // plane n.p + d = 0 (with |n| = 1)
+    Q.q[0] += w * n[0] * n[0];
+    Q.q[1] += w * n[0] * n[1];
+    Q.q[2] += w * n[0] * n[2];
+    Q.q[3] += w * n[0] * d;
+    Q.q[4] += w * n[1] * n[1];
+    Q.q[5] += w * n[1] * n[2];
+    Q.q[6] += w * n[1] * d;
+    Q.q[7] += w * n[2] * n[2];
+    Q.q[8] += w * n[2] * d;
+    Q.q[9] += w * d    * d;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void QEMDecimator::quadric_add(Quadric & Q, const Quadric & Q1)
+{
+    for(uint i=0; i<10; ++i) Q.q[i] += Q1.q[i];
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+double QEMDecimator::quadric_error(const Quadric & Q, const vec3d & p)
+{
+    const double x = p[0], y = p[1], z = p[2];
+    double err = Q.q[0]*x*x + 2*Q.q[1]*x*y + 2*Q.q[2]*x*z + 2*Q.q[3]*x
+               + Q.q[4]*y*y + 2*Q.q[5]*y*z + 2*Q.q[6]*y
+               + Q.q[7]*z*z + 2*Q.q[8]*z
+               + Q.q[9];
+    return std::max(err, 0.0); // may be slightly negative due to roundoff
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+bool QEMDecimator::quadric_minimizer(const Quadric & Q, vec3d & p)
+{
+    // solves A p = -b with Cramer's rule, where A is the upper
+    // left 3x3 block of Q and b the first three entries of its last column
+    const double a00 = Q.q[0], a01 = Q.q[1], a02 = Q.q[2];
+    const double a11 = Q.q[4], a12 = Q.q[5], a22 = Q.q[7];
+    const double b0 = -Q.q[3], b1 = -Q.q[6], b2 = -Q.q[8];
+
+    double c00 = a11*a22 - a12*a12;
+    double c01 = a02*a12 - a01*a22;
+    double c02 = a01*a12 - a02*a11;
+    double det = a00*c00 + a01*c01 + a02*c02;
+
+    // A is positive semi definite: compare det with its trace to detect
+    // (nearly) singular systems, e.g. flat regions or straight creases
+    double tr = a00 + a11 + a22;
+    if(tr<=0 || std::fabs(det) <= 1e-10 * tr*tr*tr) return false;
+
+    double c11 = a00*a22 - a02*a02;
+    double c12 = a01*a02 - a00*a12;
+    double c22 = a00*a11 - a01*a01;
+    p = vec3d(c00*b0 + c01*b1 + c02*b2,
+              c01*b0 + c11*b1 + c12*b2,
+              c02*b0 + c12*b1 + c22*b2) / det;
+    return true;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void QEMDecimator::init_quadrics(const double feature_weight)
+{
+    CINO_PROFILE_ZONE("QEMDecimator::init_quadrics");
+
+    // number of boundary/feature edges incident to each vert. Verts along
+    // a line have two, corners (and non manifold verts) are locked in place
+    const uint locked = 1000;
+    cdeg.assign(pos.size(), 0);
+    std::vector<ipair> e;
+    edges(e);
+    for(const ipair & p : e)
+    {
+        uint t[2];
+        uint n = edge_tris(p.first, p.second, t);
+        if(n>2)
+        {
+            cdeg.at(p.first) = cdeg.at(p.second) = locked;
+        }
+        else if(n==1 || features.count(edge_key(p.first, p.second))>0)
+        {
+            if(cdeg.at(p.first)  < locked) ++cdeg.at(p.first);
+            if(cdeg.at(p.second) < locked) ++cdeg.at(p.second);
+        }
+    }
+
+    Quadric zero;
+    std::fill(zero.q, zero.q+10, 0.0);
+    quadrics.assign(pos.size(), zero);
+    parallel_for(0, pos.size(), [&](const uint vid)
+    {
+        if(vert_dead[vid]) return;
+        Quadric & Q = quadrics[vid];
+        for(uint tid : v2t[vid])
+        {
+            // area weighted plane of the triangle
+            vec3d  n    = tri_normal(tid);
+            double area = 0.5 * n.normalize();
+            if(area==0) continue;
+            quadric_add_plane(Q, n, -n.dot(pos[vid]), area);
+
+            // penalty planes, orthogonal to the triangle and passing through its constrained edges
+            for(uint i=0; i<3; ++i)
+            {
+                uint vid0 = tris[3*tid+i];
+                uint vid1 = tris[3*tid+(i+1)%3];
+                if(vid0!=vid && vid1!=vid) continue;
+                if(!edge_is_constrained(vid0,vid1)) continue;
+                vec3d  u  = pos[vid1] - pos[vid0];
+                double l2 = u.dot(u);
+                vec3d  m  = u.cross(n);
+                if(m.normalize()==0) continue;
+                quadric_add_plane(Q, m, -m.dot(pos[vid0]), feature_weight * l2);
+            }
+        }
+    });
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+bool QEMDecimator::collapse_plan(const uint     vid0,
+                                 const uint     vid1,
+                                 const bool     optimal_placement,
+                                       uint   & vid_kept,
+                                       uint   & vid_removed,
+                                       vec3d  & p,
+                                       double & cost) const
+{
+    // a vert can be removed if it is not on a boundary/feature line, or if
+    // it is a regular vert of a line and the edge runs along the same line
+    bool constrained = edge_is_constrained(vid0, vid1);
+    bool removable0  = constrained ? (cdeg[vid0]==2) : (cdeg[vid0]==0);
+    bool removable1  = constrained ? (cdeg[vid1]==2) : (cdeg[vid1]==0);
+    if(!removable0 && !removable1) return false;
+
+    Quadric Q = quadrics[vid0];
+    quadric_add(Q, quadrics[vid1]);
+
+    vid_kept    = removable0 ? vid1 : vid0;
+    vid_removed = removable0 ? vid0 : vid1;
+
+    // verts that cannot be removed cannot move either
+    if(!removable0 || !removable1)
+    {
+        p    = pos[vid_kept];
+        cost = quadric_error(Q, p);
+        return true;
+    }
+
+    vec3d mid = 0.5 * (pos[vid0] + pos[vid1]);
+    if(optimal_placement && quadric_minimizer(Q, p) && p.dist(mid) <= pos[vid0].dist(pos[vid1]))
+    {
+        cost = quadric_error(Q, p);
+        return true;
+    }
+
+    p    = mid;
+    cost = quadric_error(Q, p);
+    for(uint vid : {vid0, vid1})
+    {
+        double err = quadric_error(Q, pos[vid]);
+        if(err < cost)
+        {
+            cost = err;
+            p    = pos[vid];
+        }
+    }
+    return true;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+bool QEMDecimator::collapse_is_valid(const uint vid_kept, const uint vid_removed, const vec3d & p, uint t[2], uint & nt)
+{
+    nt = edge_tris(vid_kept, vid_removed, t);
+    if(nt==0 || nt>2) return false;
+
+    // verts opposite to the edge must not remain without triangles (or, if inner, with less than three)
+    uint opp[2];
+    for(uint i=0; i<nt; ++i)
+    {
+        opp[i] = tri_opposite_vert(t[i], vid_kept, vid_removed);
+        if(v2t[opp[i]].size() <= (boundary[opp[i]] ? 1u : 3u)) return false;
+    }
+    if(nt==2 && opp[0]==opp[1]) return false;
+
+    // link condition: the only verts adjacent to both endpoints must be the ones
+    // opposite to the edge. Neighbors are marked with three consecutive ids: adjacent
+    // to vid_kept, adjacent to both, adjacent to vid_removed only
+    if(visit_id > UINT_MAX-3)
+    {
+        std::fill(visit.begin(), visit.end(), 0);
+        visit_id = 0;
+    }
+    const uint in_kept = ++visit_id;
+    const uint in_both = ++visit_id;
+    const uint in_rem  = ++visit_id;
+    uint n_kept = 0, n_both = 0, n_rem = 0;
+    for(uint tid : v2t[vid_kept])
+    for(uint i=0; i<3; ++i)
+    {
+        uint vid = tris[3*tid+i];
+        if(vid==vid_kept || visit[vid]==in_kept) continue;
+        visit[vid] = in_kept;
+        ++n_kept;
+    }
+    for(uint tid : v2t[vid_removed])
+    for(uint i=0; i<3; ++i)
+    {
+        uint vid = tris[3*tid+i];
+        if(vid==vid_removed || visit[vid]==in_both || visit[vid]==in_rem) continue;
+        if(visit[vid]==in_kept) { visit[vid] = in_both; ++n_both; }
+        else                    { visit[vid] = in_rem;  ++n_rem;  }
+    }
+    if(n_both!=nt) return false;
+    uint valence = n_kept + n_rem - 2; // both endpoints are counted, once each
+    if(valence < ((boundary[vid_kept] || boundary[vid_removed]) ? 2u : 3u)) return false;
+
+    // surviving triangles must not flip (nor rotate too much)
+    for(uint vid : {vid_kept, vid_removed})
+    for(uint tid : v2t[vid])
+    {
+        if(tid==t[0] || (nt==2 && tid==t[1])) continue;
+        vec3d v[3];
+        for(uint i=0; i<3; ++i)
+        {
+            uint id = tris[3*tid+i];
+            v[i] = (id==vid_kept || id==vid_removed) ? p : pos[id];
+        }
+        vec3d n_old = tri_normal(tid);
+        vec3d n_new = (v[1]-v[0]).cross(v[2]-v[0]);
+        if(n_old.dot(n_new) <= 0.2 * n_old.length() * n_new.length()) return false;
+    }
+    return true;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void QEMDecimator::collapse(const uint   vid_kept,
+                            const uint   vid_removed,
+                            const vec3d & p,
+                            const uint   t[2],
+                            const uint   nt,
+                            const double cost,
+                            const bool   record)
+{
+    bool constrained = edge_is_constrained(vid_kept, vid_removed);
+
+    if(record)
+    {
+        EdgeCollapseRecord r;
+        r.vid_kept    = vid_kept;
+        r.vid_removed = vid_removed;
+        r.vid_opp[0]  = UINT_MAX;
+        r.vid_opp[1]  = UINT_MAX;
+        r.pos_kept    = pos.at(vid_kept);
+        r.pos_removed = pos.at(vid_removed);
+        r.error       = cost;
+        for(uint i=0; i<nt; ++i)
+        {
+            // slot 0 for the triangle traversing the edge from vid_removed to vid_kept
+            uint opp = tri_opposite_vert(t[i], vid_kept, vid_removed);
+            bool fwd = false;
+            for(uint j=0; j<3; ++j)
+            {
+                if(tris[3*t[i]+j]==vid_removed && tris[3*t[i]+(j+1)%3]==vid_kept) fwd = true;
+            }
+            r.vid_opp[fwd ? 0 : 1] = opp;
+        }
+        records.push_back(r);
+    }
+
+    for(uint i=0; i<nt; ++i)
+    {
+        tri_dead.at(t[i]) = 1;
+        --nt_alive;
+        for(uint j=0; j<3; ++j) vert_remove_tri(tris.at(3*t[i]+j), t[i]);
+    }
+    for(uint tid : v2t.at(vid_removed))
+    {
+        std::replace(tris.begin()+3*tid, tris.begin()+3*tid+3, vid_removed, vid_kept);
+        v2t.at(vid_kept).push_back(tid);
+    }
+    std::vector<uint>().swap(v2t.at(vid_removed));
+    vert_dead.at(vid_removed) = 1;
+    --nv_alive;
+
+    pos.at(vid_kept) = p;
+    quadric_add(quadrics.at(vid_kept), quadrics.at(vid_removed));
+    ++version.at(vid_kept);
+    if(constrained) cdeg.at(vid_kept) += cdeg.at(vid_removed) - 2;
+    if(boundary.at(vid_removed)) boundary.at(vid_kept) = 1;
+
+    // feature edges of vid_removed now belong to vid_kept
+    if(!features.empty())
+    {
+        features.erase(edge_key(vid_kept, vid_removed));
+        std::vector<uint> nbrs;
+        vert_neighbors(vid_kept, nbrs);
+        for(uint nbr : nbrs)
+        {
+            if(features.erase(edge_key(vid_removed, nbr))>0) features.insert(edge_key(vid_kept, nbr));
+        }
+    }
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+uint64_t QEMDecimator::edge_key(const uint vid0, const uint vid1)
+{
+    return (uint64_t(std::min(vid0,vid1)) << 32) | std::max(vid0,vid1);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void QEMDecimator::edges(std::vector<ipair> & e) const
+{
+    // interior edges are listed by the triangle that traverses them from the
+    // smaller to the bigger vid. Boundary edges have only one triangle
+    e.clear();
+    e.reserve(nt_alive*3/2 + 1);
+    for(uint tid=0; tid<tri_dead.size(); ++tid)
+    {
+        if(tri_dead[tid]) continue;
+        for(uint i=0; i<3; ++i)
+        {
+            uint vid0 = tris[3*tid+i];
+            uint vid1 = tris[3*tid+(i+1)%3];
+            uint t[2];
+            if(vid0<vid1 || (boundary[vid0] && boundary[vid1] && edge_tris(vid0,vid1,t)==1))
+            {
+                e.push_back(std::make_pair(vid0,vid1));
+            }
+        }
+    }
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+uint QEMDecimator::edge_tris(const uint vid0, const uint vid1, uint t[2]) const
+{
+    uint count = 0;
+    for(uint tid : v2t[vid0])
+    {
+        if(tris[3*tid]==vid1 || tris[3*tid+1]==vid1 || tris[3*tid+2]==vid1)
+        {
+            if(count<2) t[count] = tid;
+            ++count;
+        }
+    }
+    return count;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+bool QEMDecimator::edge_is_constrained(const uint vid0, const uint vid1) const
+{
+    if(!features.empty() && features.count(edge_key(vid0,vid1))>0) return true;
+    if(!boundary[vid0] || !boundary[vid1]) return false;
+    uint t[2];
+    return edge_tris(vid0,vid1,t)==1;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+uint QEMDecimator::tri_opposite_vert(const uint tid, const uint vid0, const uint vid1) const
+{
+    for(uint i=0; i<3; ++i)
+    {
+        uint vid = tris[3*tid+i];
+        if(vid!=vid0 && vid!=vid1) return vid;
+    }
+    assert(false);
+    return 0;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+vec3d QEMDecimator::tri_normal(const uint tid) const
+{
+    const vec3d & p0 = pos[tris[3*tid  ]];
+    const vec3d & p1 = pos[tris[3*tid+1]];
+    const vec3d & p2 = pos[tris[3*tid+2]];
+    return (p1-p0).cross(p2-p0);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void QEMDecimator::vert_neighbors(const uint vid, std::vector<uint> & nbrs) const
+{
+    nbrs.clear();
+    for(uint tid : v2t[vid])
+    for(uint i=0; i<3; ++i)
+    {
+        uint nbr = tris[3*tid+i];
+        if(nbr!=vid) nbrs.push_back(nbr);
+    }
+    std::sort(nbrs.begin(), nbrs.end());
+    nbrs.erase(std::unique(nbrs.begin(), nbrs.end()), nbrs.end());
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void QEMDecimator::vert_remove_tri(const uint vid, const uint tid)
+{
+    std::vector<uint> & list = v2t[vid];
+    auto it = std::find(list.begin(), list.end(), tid);
+    assert(it!=list.end());
+    *it = list.back();
+    list.pop_back();
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class M, class V, class E, class P>
+CINO_INLINE
+DecimationStats decimate_qem(Trimesh<M,V,E,P>                & m,
+                             const DecimationOptions         & opt,
+                             std::vector<EdgeCollapseRecord> * collapses)
+{
+    CINO_PROFILE_ZONE("decimate_qem");
+
+    std::vector<uint> tris;
+    std::vector<int>  labels(m.num_polys());
+    tris.reserve(3*m.num_polys());
+    for(uint pid=0; pid<m.num_polys(); ++pid)
+    {
+        for(uint vid : m.adj_p2v_span(pid)) tris.push_back(vid);
+        labels.at(pid) = m.poly_data(pid).label;
+    }
+
+    // feature lines may be flagged as MARKED, CREASE, or both
+    bool has_marked = false;
+    bool has_crease = false;
+    std::vector<ipair> features;
+    for(uint eid=0; eid<m.num_edges(); ++eid)
+    {
+        const E & data = m.edge_data(eid);
+        if(data.flags[MARKED] || data.flags[CREASE]) features.push_back(std::make_pair(m.edge_vert_id(eid,0), m.edge_vert_id(eid,1)));
+        if(data.flags[MARKED]) has_marked = true;
+        if(data.flags[CREASE]) has_crease = true;
+    }
+
+    QEMDecimator decimator;
+    decimator.init(m.vector_verts(), tris, features, labels);
+    DecimationOptions o = opt;
+    if(collapses!=nullptr) o.record_collapses = true;
+    DecimationStats stats = decimator.decimate(o);
+
+    std::vector<vec3d> verts;
+    decimator.export_mesh(verts, tris, features, labels);
+    if(collapses!=nullptr) *collapses = decimator.collapse_sequence();
+
+    M data = m.mesh_data();
+    m.clear();
+    m.init(verts, polys_from_serialized_vids(tris,3));
+    m.mesh_data() = data;
+
+    if(labels.size()==m.num_polys())
+    {
+        for(uint pid=0; pid<m.num_polys(); ++pid) m.poly_data(pid).label = labels.at(pid);
+    }
+    for(const ipair & e : features)
+    {
+        int eid = m.edge_id(e.first, e.second);
+        if(eid<0) continue;
+        m.edge_data(eid).flags[MARKED] = has_marked;
+        m.edge_data(eid).flags[CREASE] = has_crease;
+    }
+    return stats;
+}
+
+}
@@ -0,0 +1,232 @@
+/********************************************************************************
+*  This file is part of CinoLib                                                 *
+*  Copyright(C) 2016: Marco Livesu                                              *
+*                                                                               *
+*  The MIT License                                                              *
+*                                                                               *
+*  Permission is hereby granted, free of charge, to any person obtaining a      *
+*  copy of this software and associated documentation files (the "Software"),   *
+*  to deal in the Software without restriction, including without limitation    *
+*  the rights to use, copy, modify, merge, publish, distribute, sublicense,     *
+*  and/or sell copies of the Software, and to permit persons to whom the        *
+*  Software is furnished to do so, subject to the following conditions:         *
+*                                                                               *
+*  The above copyright notice and this permission notice shall be included in   *
+*  all copies or substantial portions of the Software.                          *
+*                                                                               *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR   *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,     *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. IN NO EVENT SHALL THE *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER       *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      *
+*  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS *
+*  IN THE SOFTWARE.                                                             *
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Marco Livesu (marco.livesu@gmail.com)                                     *
+*     http://pers.ge.imati.cnr.it/livesu/                                       *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*********************************************************************************/
+#ifndef CINO_DECIMATE_QEM_H
+#define CINO_DECIMATE_QEM_H
+
+#include <cinolib/cino_inline.h>
+#include <cinolib/meshes/trimesh.h>
+#include <cinolib/min_max_inf.h>
+#include <cinolib/ipair.h>
+#include <unordered_set>
+#include <iostream>
+#include <vector>
+#include <stdint.h>
+
+namespace cinolib
+{
+
+/* Triangle mesh decimation based on quadric error metrics:
+ *
+ * Surface Simplification Using Quadric Error Metrics
+ * M.Garland, P.S.Heckbert
+ * SIGGRAPH 1997
+ *
+ * Each vertex stores the (area weighted) quadric of the planes of its incident
+ * triangles. Edges are collapsed in order of increasing quadric error, placing
+ * the surviving vertex at the position that minimizes the sum of the quadrics of
+ * the edge endpoints. Collapses are kept in a heap that is updated lazily: each
+ * vertex has a version number, which is increased every time its quadric changes,
+ * and heap entries referring to an older version are discarded when popped.
+ * Collapses that would change the mesh topology (link condition) or flip any
+ * triangle are rejected.
+ *
+ * Boundaries and feature lines (marked edges) are preserved: their verts can only
+ * slide along them (collapsing a feature edge), corners never move, and penalty
+ * quadrics (planes orthogonal to the surface through each feature edge) keep the
+ * lines in place. Decimation stops when the mesh reaches a target number of
+ * triangles, when the cheapest collapse exceeds an error bound, or when no valid
+ * collapse is left.
+ *
+ * Similarly to IsotropicRemesher, the decimator works on its own lean copy of the
+ * mesh connectivity (removed elements are just flagged as deleted) and compacts
+ * the mesh once, at the end. The sequence of collapses can be recorded and used
+ * to stream the mesh progressively (i.e. as a base mesh plus vertex splits)
+*/
+
+typedef struct
+{
+    uint   target_num_polys         = 0;          // stop as soon as the mesh has this many triangles (or less)
+    double max_error                = inf_double; // stop as soon as the cheapest collapse has a bigger quadric error
+    bool   preserve_marked_features = true;       // edges flagged as MARKED or CREASE are treated as feature lines
+    double feature_weight           = 1e3;        // weight of the penalty quadrics along boundaries and feature lines
+    bool   optimal_placement        = true;       // if false, verts are placed at the best among edge endpoints and midpoint
+    bool   record_collapses         = false;      // keep the collapse sequence (see collapse_sequence())
+}
+DecimationOptions;
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+typedef struct
+{
+    uint   num_collapses = 0;
+    uint   num_verts     = 0;
+    uint   num_polys     = 0;
+    double max_error     = 0; // biggest quadric error among the collapses performed
+    double secs          = 0;
+}
+DecimationStats;
+
+CINO_INLINE
+std::ostream & operator<<(std::ostream & in, const DecimationStats & stats);
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// A collapse removes vid_removed, moves vid_kept and deletes the triangles
+// (vid_removed, vid_kept, vid_opp[0]) and (vid_kept, vid_removed, vid_opp[1]).
+// On the boundary only one of them exists, and the vid_opp of the other one is
+// UINT_MAX (i.e. the slot tells the orientation of the surviving triangle).
+// The inverse operation (vertex split) restores vid_removed at pos_removed, and
+// vid_kept at pos_kept
+typedef struct
+{
+    uint   vid_kept;
+    uint   vid_removed;
+    uint   vid_opp[2];
+    vec3d  pos_kept;    // position of vid_kept before the collapse
+    vec3d  pos_removed;
+    double error;
+}
+EdgeCollapseRecord;
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+class QEMDecimator
+{
+    public:
+
+        explicit QEMDecimator() {}
+
+        void init(const std::vector<vec3d> & verts,
+                  const std::vector<uint>  & tris,
+                  const std::vector<ipair> & feature_edges = std::vector<ipair>(),
+                  const std::vector<int>   & tri_labels    = std::vector<int>());
+
+        DecimationStats decimate(const DecimationOptions & opt);
+
+        // mesh in its current state (compacted). Verts that survived keep their
+        // relative order. If collapses were recorded, they are renamed so that
+        // undoing them from the last one to the first (i.e. applying vertex splits
+        // to the exported mesh) restores the removed verts with consecutive ids,
+        // starting from verts.size()
+        void export_mesh(std::vector<vec3d> & verts,
+                         std::vector<uint>  & tris,
+                         std::vector<ipair> & feature_edges,
+                         std::vector<int>   & tri_labels);
+
+        const std::vector<EdgeCollapseRecord> & collapse_sequence() const { return records; }
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        uint num_verts() const { return nv_alive; }
+        uint num_polys() const { return nt_alive; }
+
+    private:
+
+        typedef struct { double q[10]; } Quadric; // upper triangle of the symmetric 4x4 matrix
+
+        typedef struct
+        {
+            float    cost;
+            uint     vid0, vid1;
+            uint16_t version0, version1; // a (rare) wrap around only affects the order of collapses
+        }
+        HeapEntry;
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        static void   quadric_add_plane(Quadric & Q, const vec3d & n, const double d, const double w);
+        static void   quadric_add      (Quadric & Q, const Quadric & Q1);
+        static double quadric_error    (const Quadric & Q, const vec3d & p);
+        static bool   quadric_minimizer(const Quadric & Q, vec3d & p);
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        void init_quadrics(const double feature_weight);
+        bool collapse_plan(const uint vid0, const uint vid1, const bool optimal_placement, uint & vid_kept, uint & vid_removed, vec3d & p, double & cost) const;
+        bool collapse_is_valid(const uint vid_kept, const uint vid_removed, const vec3d & p, uint t[2], uint & nt);
+        void collapse(const uint vid_kept, const uint vid_removed, const vec3d & p, const uint t[2], const uint nt, const double cost, const bool record);
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        static uint64_t edge_key(const uint vid0, const uint vid1);
+
+        void  edges(std::vector<ipair> & e) const; // each alive edge, once
+        uint  edge_tris(const uint vid0, const uint vid1, uint t[2]) const;
+        bool  edge_is_constrained(const uint vid0, const uint vid1) const;
+        uint  tri_opposite_vert(const uint tid, const uint vid0, const uint vid1) const;
+        vec3d tri_normal(const uint tid) const; // not normalized (length is twice the area)
+        void  vert_neighbors(const uint vid, std::vector<uint> & nbrs) const;
+        void  vert_remove_tri(const uint vid, const uint tid);
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        std::vector<vec3d>              pos;
+        std::vector<uint>               tris;      // three vids per triangle
+        std::vector<int>                labels;    // one per triangle
+        std::vector<std::vector<uint>>  v2t;       // vert to triangle adjacency
+        std::vector<uint8_t>            vert_dead;
+        std::vector<uint8_t>            tri_dead;
+        std::vector<uint8_t>            boundary;  // vert on the boundary
+        std::vector<uint>               cdeg;      // number of boundary/feature edges incident to each vert
+        std::vector<uint16_t>           version;   // increased every time the quadric of a vert changes
+        std::vector<Quadric>            quadrics;
+        std::unordered_set<uint64_t>    features;  // feature edges (see edge_key)
+        std::vector<EdgeCollapseRecord> records;
+        std::vector<uint>               visit;     // scratch marks for the link condition
+        uint                            visit_id = 0;
+        uint                            nv_alive = 0;
+        uint                            nt_alive = 0;
+};
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// convenience wrapper: decimates m in place. Poly labels and feature lines (MARKED
+// and/or CREASE edges) are preserved. NOTE: if both flags are in use, surviving
+// feature edges get both. If collapses is not null, the collapse sequence is recorded too.
+// If the mesh is drawable, call updateGL() afterwards to refresh its rendering
+template<class M, class V, class E, class P>
+CINO_INLINE
+DecimationStats decimate_qem(Trimesh<M,V,E,P>                & m,
+                             const DecimationOptions         & opt       = DecimationOptions(),
+                             std::vector<EdgeCollapseRecord> * collapses = nullptr);
+
+}
+
+#ifndef  CINO_STATIC_LIB
+#include "decimate_qem.cpp"
+#endif
+
+#endif // CINO_DECIMATE_QEM_H
@@ -34,32 +34,25 @@
 *     Italy                                                                     *
 *********************************************************************************/
 #include <cinolib/dijkstra.h>
+#include <cinolib/indexed_heap.h>
 #include <cinolib/min_max_inf.h>
 #include <cinolib/stl_container_utilities.h>
+#include <cinolib/thread_pool.h>
 
 namespace cinolib
 {
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
-// LITTLE NOTE ON MY DIJKSTRA IMPLEMENTATIONS: why std::set and not
-// std::unordered_set or std::priority_queue?
-//
-// The reason why I am using std::set is that Dijkstra requires priority
-// update, which is supported by none of the STL containers. Options are:
-//
-//  1) remove an element and re-add it with updated priority. In this
-//     case std::set has the best remove performances
-//
-//  2) leave "dead" copies of an element in the container, and just add a
-//     new copy each time its priority needs an update. Regardless the waste
-//     of memory, which is an issue by itself, in this case at each iteration
-//     you need a mechanism that allows you to discard the current element
-//     if it is not the one with the most recent priority...
-//
-// I therefore decided to go for (1).
-// See also:
-// https://stackoverflow.com/questions/649640/how-to-do-an-efficient-priority-update-in-stl-priority-queue
+// LITTLE NOTE ON MY DIJKSTRA IMPLEMENTATIONS: Dijkstra requires priority
+// update, which is supported by none of the STL containers. The original
+// implementations used a std::set, removing and re-inserting an element each
+// time its priority changed, which costs a node allocation and a tree
+// rebalancing per relaxation. All the variants below use an IndexedHeap
+// (see indexed_heap.h) instead: a 4-ary heap stored in flat arrays sized
+// to the number of elements, which supports decrease-key in place. Ties are
+// broken by element id, exactly as it happened with std::set<pair<double,uint>>,
+// so distances and paths did not change.
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
@@ -69,34 +62,20 @@ void dijkstra_exhaustive(const AbstractMesh<M,V,E,P> & m,
                          const uint                    source,
                                std::vector<double>   & dist)
 {
-    dist = std::vector<double>(m.num_verts(), inf_double);
-    dist.at(source) = 0.0;
-
-    std::set<std::pair<double,uint>> q;
-    q.insert(std::make_pair(0.0,source));
-
-    while(!q.empty())
-    {
-        uint vid = q.begin()->second;
-        q.erase(q.begin());
+    dijkstra_exhaustive(m, std::vector<uint>(1,source), dist);
+}
 
-        for(uint nbr : m.adj_v2v(vid))
-        {
-            double new_dist = dist.at(vid) + m.vert(vid).dist(m.vert(nbr));
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
-            if(dist.at(nbr) > new_dist)
-            {
-                if(dist.at(nbr) < inf_double) // otherwise it won't be found (one order of magnitude faster than initializing the queue with all the elements with inf dist)
-                {
-                    auto it = q.find(std::make_pair(dist.at(nbr),nbr));
-                    assert(it!=q.end());
-                    q.erase(it);
-                }
-                dist.at(nbr) = new_dist;
-                q.insert(std::make_pair(new_dist,nbr));
-            }
-        }
-    }
+template<class M, class V, class E, class P>
+CINO_INLINE
+void dijkstra_exhaustive(const AbstractMesh<M,V,E,P> & m,
+                         const std::vector<uint>     & sources,
+                               std::vector<double>   & dist)
+{
+    dist.resize(m.num_verts());
+    IndexedHeap<> q(m.num_verts());
+    dijkstra_exhaustive(m, sources, dist.data(), q);
 }
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
@@ -105,33 +84,31 @@ template<class M, class V, class E, class P>
 CINO_INLINE
 void dijkstra_exhaustive(const AbstractMesh<M,V,E,P> & m,
                          const std::vector<uint>     & sources,
-                               std::vector<double>   & dist)
+                               double                * dist,
+                               IndexedHeap<>         & q)
 {
-    dist = std::vector<double>(m.num_verts(), inf_double);
-    for(uint vid : sources) dist.at(vid) = 0.0;
+    std::fill(dist, dist+m.num_verts(), inf_double);
 
-    std::set<std::pair<double,uint>> q;
-    for(uint vid : sources) q.insert(std::make_pair(0.0,vid));
+    q.clear();
+    for(uint vid : sources)
+    {
+        assert(vid<m.num_verts());
+        dist[vid] = 0.0;
+        q.update(vid, 0.0);
+    }
 
     while(!q.empty())
     {
-        uint vid = q.begin()->second;
-        q.erase(q.begin());
+        uint vid = q.pop();
 
         for(uint nbr : m.adj_v2v(vid))
         {
-            double new_dist = dist.at(vid) + m.vert(vid).dist(m.vert(nbr));
+            double new_dist = dist[vid] + m.vert(vid).dist(m.vert(nbr));
 
-            if(dist.at(nbr) > new_dist)
+            if(dist[nbr] > new_dist)
             {
-                if(dist.at(nbr) < inf_double) // otherwise it won't be found (one order of magnitude faster than initializing the queue with all the elements with inf dist)
-                {
-                    auto it = q.find(std::make_pair(dist.at(nbr),nbr));
-                    assert(it!=q.end());
-                    q.erase(it);
-                }
-                dist.at(nbr) = new_dist;
-                q.insert(std::make_pair(new_dist,nbr));
+                dist[nbr] = new_dist;
+                q.update(nbr, new_dist);
             }
         }
     }
@@ -139,6 +116,56 @@ void dijkstra_exhaustive(const AbstractMesh<M,V,E,P> & m,
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
+template<class M, class V, class E, class P>
+CINO_INLINE
+void dijkstra_exhaustive_batch(const AbstractMesh<M,V,E,P>          & m,
+                               const std::vector<std::vector<uint>> & source_sets,
+                                     std::vector<double>            & dist)
+{
+    size_t nv = m.num_verts();
+    dist.resize(source_sets.size()*nv);
+
+    std::vector<IndexedHeap<>> q(get_num_threads(), IndexedHeap<>(nv));
+    global_thread_pool().run(source_sets.size(), [&](const uint i, const uint tid)
+    {
+        dijkstra_exhaustive(m, source_sets.at(i), dist.data() + i*nv, q.at(tid));
+    });
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class M, class V, class E, class P>
+CINO_INLINE
+void dijkstra_exhaustive_batch(const AbstractMesh<M,V,E,P> & m,
+                               const std::vector<uint>     & sources,
+                                     std::vector<double>   & dist)
+{
+    std::vector<std::vector<uint>> source_sets(sources.size());
+    for(uint i=0; i<sources.size(); ++i) source_sets.at(i).push_back(sources.at(i));
+    dijkstra_exhaustive_batch(m, source_sets, dist);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class M, class V, class E, class P>
+CINO_INLINE
+void dijkstra_exhaustive_batch(const AbstractMesh<M,V,E,P>                                          & m,
+                               const std::vector<std::vector<uint>>                                 & source_sets,
+                               const std::function<void(uint, const std::vector<double> &, uint)> & callback)
+{
+    uint nv = m.num_verts();
+    uint nt = get_num_threads();
+    std::vector<IndexedHeap<>>       q   (nt, IndexedHeap<>(nv));
+    std::vector<std::vector<double>> dist(nt, std::vector<double>(nv));
+    global_thread_pool().run(source_sets.size(), [&](const uint i, const uint tid)
+    {
+        dijkstra_exhaustive(m, source_sets.at(i), dist.at(tid).data(), q.at(tid));
+        callback(i, dist.at(tid), tid);
+    });
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
 template<class M, class V, class E, class F, class P>
 CINO_INLINE
 void dijkstra_exhaustive_srf_only(const AbstractPolyhedralMesh<M,V,E,F,P> & m,
@@ -146,33 +173,29 @@ void dijkstra_exhaustive_srf_only(const AbstractPolyhedralMesh<M,V,E,F,P> & m,
                                         std::vector<double>               & dist)
 {
     dist = std::vector<double>(m.num_verts(), inf_double);
-    for(uint vid : sources) dist.at(vid) = 0.0;
 
-    std::set<std::pair<double,uint>> q;
-    for(uint vid : sources) q.insert(std::make_pair(0.0,vid));
+    IndexedHeap<> q(m.num_verts());
+    for(uint vid : sources)
+    {
+        dist.at(vid) = 0.0;
+        q.update(vid, 0.0);
+    }
 
     while(!q.empty())
     {
-        uint vid = q.begin()->second;
-        q.erase(q.begin());
+        uint vid = q.pop();
 
         for(uint eid : m.adj_v2e(vid))
         {
             if(m.edge_is_on_srf(eid))
             {
                 uint   nbr      = m.vert_opposite_to(eid,vid);
-                double new_dist = dist.at(vid) + m.vert(vid).dist(m.vert(nbr));
+                double new_dist = dist[vid] + m.vert(vid).dist(m.vert(nbr));
 
-                if(dist.at(nbr) > new_dist)
+                if(dist[nbr] > new_dist)
                 {
-                    if(dist.at(nbr) < inf_double) // otherwise it won't be found (one order of magnitude faster than initializing the queue with all the elements with inf dist)
-                    {
-                        auto it = q.find(std::make_pair(dist.at(nbr),nbr));
-                        assert(it!=q.end());
-                        q.erase(it);
-                    }
-                    dist.at(nbr) = new_dist;
-                    q.insert(std::make_pair(new_dist,nbr));
+                    dist[nbr] = new_dist;
+                    q.update(nbr, new_dist);
                 }
             }
         }
@@ -181,86 +204,114 @@ void dijkstra_exhaustive_srf_only(const AbstractPolyhedralMesh<M,V,E,F,P> & m,
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
-template<class M, class V, class E, class P>
+// Grows two shortest path trees, one from the source and one from the destination,
+// always expanding the smallest front. The search stops as soon as the sum of the
+// two front distances exceeds the shortest source-dest connection found so far
+//
+template<class M, class V, class E, class P, class Blocked>
 CINO_INLINE
-double dijkstra(const AbstractMesh<M,V,E,P> & m,
-                const uint                    source,
-                const uint                    dest,
-                      std::vector<uint>     & path)
+double dijkstra_bidirectional(const AbstractMesh<M,V,E,P> & m,
+                              const uint                    source,
+                              const uint                    dest,
+                              const Blocked               & blocked,
+                                    std::vector<uint>     & path)
 {
     path.clear();
+    if(source==dest)
+    {
+        path.push_back(source);
+        return 0.0;
+    }
 
-    std::vector<int> prev(m.num_verts(), -1);
+    std::vector<int>    prev[2] = { std::vector<int>   (m.num_verts(), -1),
+                                    std::vector<int>   (m.num_verts(), -1) };
+    std::vector<double> dist[2] = { std::vector<double>(m.num_verts(), inf_double),
+                                    std::vector<double>(m.num_verts(), inf_double) };
+    IndexedHeap<>       q[2]    = { IndexedHeap<>(m.num_verts()),
+                                    IndexedHeap<>(m.num_verts()) };
+    dist[0].at(source) = 0.0; q[0].push(source, 0.0);
+    dist[1].at(dest)   = 0.0; q[1].push(dest,   0.0);
 
-    std::vector<double> dist(m.num_verts(), inf_double);
-    dist.at(source) = 0.0;
-
-    std::set<std::pair<double,uint>> q;
-    q.insert(std::make_pair(0.0,source));
+    double best = inf_double;
+    int    meet = -1;
 
-    while(!q.empty())
+    while(!q[0].empty() && !q[1].empty())
     {
-        uint vid = q.begin()->second;
-        q.erase(q.begin());
+        if(q[0].top_key() + q[1].top_key() >= best) break;
 
-        if(vid==dest)
-        {
-            int tmp = vid;
-            do { path.push_back(tmp); tmp = prev.at(tmp); } while (tmp != -1);
-            std::reverse(path.begin(), path.end());
-            return dist.at(dest);
-        }
+        uint side = (q[0].size() <= q[1].size()) ? 0 : 1;
+        uint vid  = q[side].pop();
 
-        for(uint nbr : m.adj_v2v(vid))
+        for(uint eid : m.adj_v2e(vid))
         {
-            double new_dist = dist.at(vid) + m.vert(vid).dist(m.vert(nbr));
+            uint nbr = m.vert_opposite_to(eid,vid);
+            // the backward tree walks edges in the opposite direction
+            if(side==0 ? blocked(eid,vid,nbr) : blocked(eid,nbr,vid)) continue;
 
-            if(dist.at(nbr) > new_dist)
+            double new_dist = dist[side][vid] + m.vert(vid).dist(m.vert(nbr));
+
+            if(dist[side][nbr] > new_dist)
             {
-                if(dist.at(nbr) < inf_double) // otherwise it won't be found (one order of magnitude faster than initializing the queue with all the elements with inf dist)
-                {
-                    auto it = q.find(std::make_pair(dist.at(nbr),nbr));
-                    assert(it!=q.end());
-                    q.erase(it);
-                }
-                dist.at(nbr) = new_dist;
-                prev.at(nbr) = vid;
-                q.insert(std::make_pair(new_dist,nbr));
+                dist[side][nbr] = new_dist;
+                prev[side][nbr] = vid;
+                q[side].update(nbr, new_dist);
+            }
+
+            double len = dist[side][nbr] + dist[1-side][nbr];
+            if(len < best)
+            {
+                best = len;
+                meet = nbr;
             }
         }
     }
-    assert(false && "Dijkstra did not converge!");
-    return 0.0;
+
+    if(meet==-1)
+    {
+        assert(false && "Dijkstra did not converge!");
+        return 0.0;
+    }
+
+    int tmp = meet;
+    do { path.push_back(tmp); tmp = prev[0].at(tmp); } while (tmp != -1);
+    std::reverse(path.begin(), path.end());
+    tmp = prev[1].at(meet);
+    while(tmp != -1) { path.push_back(tmp); tmp = prev[1].at(tmp); }
+    return best;
 }
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
-// Shortest path (with barriers). The path cannot
-// pass throuh vertices for which mask[v] = true
+// Point to point shortest path shared by all the dijkstra() variants. Edges for
+// which blocked(eid,from,to) is true cannot be walked from vertex from to vertex to
 //
-template<class M, class V, class E, class P>
+template<class M, class V, class E, class P, class Blocked>
 CINO_INLINE
-double dijkstra(const AbstractMesh<M,V,E,P> & m,
-                const uint                    source,
-                const uint                    dest,
-                const std::vector<bool>     & mask,
-                      std::vector<uint>     & path)
+double dijkstra_point_to_point(const AbstractMesh<M,V,E,P> & m,
+                               const uint                    source,
+                               const uint                    dest,
+                               const Blocked               & blocked,
+                               const DijkstraMode            mode,
+                                     std::vector<uint>     & path)
 {
     path.clear();
-    assert(mask.size() == m.num_verts());
+    if(mode==DIJKSTRA_BIDIRECTIONAL) return dijkstra_bidirectional(m, source, dest, blocked, path);
 
-    std::vector<int> prev(m.num_verts(), -1);
+    // A* uses the euclidean distance to dest as heuristic, which never overestimates
+    // the remaining path length (and is consistent), so the result is still optimal
+    bool   astar = (mode==DIJKSTRA_ASTAR);
+    vec3d  goal  = m.vert(dest);
 
+    std::vector<int>    prev(m.num_verts(), -1);
     std::vector<double> dist(m.num_verts(), inf_double);
     dist.at(source) = 0.0;
 
-    std::set<std::pair<double,uint>> q;
-    q.insert(std::make_pair(0.0,source));
+    IndexedHeap<> q(m.num_verts());
+    q.push(source, astar ? m.vert(source).dist(goal) : 0.0);
 
     while(!q.empty())
     {
-        uint vid = q.begin()->second;
-        q.erase(q.begin());
+        uint vid = q.pop();
 
         if(vid==dest)
         {
@@ -270,23 +321,18 @@ double dijkstra(const AbstractMesh<M,V,E,P> & m,
             return dist.at(dest);
         }
 
-        for(uint nbr : m.adj_v2v(vid))
+        for(uint eid : m.adj_v2e(vid))
         {
-            if(mask.at(nbr)) continue;
+            uint nbr = m.vert_opposite_to(eid,vid);
+            if(blocked(eid,vid,nbr)) continue;
 
-            double new_dist = dist.at(vid) + m.vert(vid).dist(m.vert(nbr));
+            double new_dist = dist[vid] + m.vert(vid).dist(m.vert(nbr));
 
-            if(dist.at(nbr) > new_dist)
+            if(dist[nbr] > new_dist)
             {
-                if(dist.at(nbr) < inf_double) // otherwise it won't be found (one order of magnitude faster than initializing the queue with all the elements with inf dist)
-                {
-                    auto it = q.find(std::make_pair(dist.at(nbr),nbr));
-                    assert(it!=q.end());
-                    q.erase(it);
-                }
-                dist.at(nbr) = new_dist;
-                prev.at(nbr) = vid;
-                q.insert(std::make_pair(new_dist,nbr));
+                dist[nbr] = new_dist;
+                prev[nbr] = vid;
+                q.update(nbr, astar ? new_dist + m.vert(nbr).dist(goal) : new_dist);
             }
         }
     }
@@ -296,6 +342,37 @@ double dijkstra(const AbstractMesh<M,V,E,P> & m,
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
+template<class M, class V, class E, class P>
+CINO_INLINE
+double dijkstra(const AbstractMesh<M,V,E,P> & m,
+                const uint                    source,
+                const uint                    dest,
+                      std::vector<uint>     & path,
+                const DijkstraMode            mode)
+{
+    return dijkstra_point_to_point(m, source, dest, [](const uint, const uint, const uint){ return false; }, mode, path);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// Shortest path (with barriers). The path cannot
+// pass throuh vertices for which mask[v] = true
+//
+template<class M, class V, class E, class P>
+CINO_INLINE
+double dijkstra(const AbstractMesh<M,V,E,P> & m,
+                const uint                    source,
+                const uint                    dest,
+                const std::vector<bool>     & mask,
+                      std::vector<uint>     & path,
+                const DijkstraMode            mode)
+{
+    assert(mask.size() == m.num_verts());
+    return dijkstra_point_to_point(m, source, dest, [&mask](const uint, const uint, const uint to){ return mask[to]; }, mode, path);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
 // Shortest path (with barriers on edges). The path cannot
 // pass throuh edges for which mask[e] = true
 //
@@ -305,57 +382,11 @@ double dijkstra_mask_on_edges(const AbstractMesh<M,V,E,P> & m,
                               const uint                    source,
                               const uint                    dest,
                               const std::vector<bool>     & mask, // if mask[e] = true, path cannot pass through edge e
-                                    std::vector<uint>     & path)
+                                    std::vector<uint>     & path,
+                              const DijkstraMode            mode)
 {
-    path.clear();
     assert(mask.size() == m.num_edges());
-
-    std::vector<int> prev(m.num_verts(), -1);
-
-    std::vector<double> dist(m.num_verts(), inf_double);
-    dist.at(source) = 0.0;
-
-    std::set<std::pair<double,uint>> q;
-    q.insert(std::make_pair(0.0,source));
-
-    while(!q.empty())
-    {
-        uint vid = q.begin()->second;
-        q.erase(q.begin());
-
-        if(vid==dest)
-        {
-            int tmp = vid;
-            do { path.push_back(tmp); tmp = prev.at(tmp); } while (tmp != -1);
-            std::reverse(path.begin(), path.end());
-            return dist.at(dest);
-        }
-
-        for(uint nbr : m.adj_v2v(vid))
-        {
-            int eid = m.edge_id(vid,nbr);
-            assert(eid>=0);
-
-            if(mask.at(eid)) continue;
-
-            double new_dist = dist.at(vid) + m.vert(vid).dist(m.vert(nbr));
-
-            if(dist.at(nbr) > new_dist)
-            {
-                if(dist.at(nbr) < inf_double) // otherwise it won't be found (one order of magnitude faster than initializing the queue with all the elements with inf dist)
-                {
-                    auto it = q.find(std::make_pair(dist.at(nbr),nbr));
-                    assert(it!=q.end());
-                    q.erase(it);
-                }
-                dist.at(nbr) = new_dist;
-                prev.at(nbr) = vid;
-                q.insert(std::make_pair(new_dist,nbr));
-            }
-        }
-    }
-    assert(false && "Dijkstra did not converge!");
-    return 0.0;
+    return dijkstra_point_to_point(m, source, dest, [&mask](const uint eid, const uint, const uint){ return mask[eid]; }, mode, path);
 }
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
@@ -380,13 +411,12 @@ double dijkstra(const AbstractMesh<M,V,E,P> & m,
     std::vector<double> dist(m.num_verts(), inf_double);
     dist.at(source) = 0.0;
 
-    std::set<std::pair<double,uint>> q;
-    q.insert(std::make_pair(0.0,source));
+    IndexedHeap<> q(m.num_verts());
+    q.push(source, 0.0);
 
     while(!q.empty())
     {
-        uint vid = q.begin()->second;
-        q.erase(q.begin());
+        uint vid = q.pop();
 
         if(CONTAINS(dest,vid))
         {
@@ -400,19 +430,13 @@ double dijkstra(const AbstractMesh<M,V,E,P> & m,
         {
             if(mask.at(nbr)) continue;
 
-            double new_dist = dist.at(vid) + m.vert(vid).dist(m.vert(nbr));
+            double new_dist = dist[vid] + m.vert(vid).dist(m.vert(nbr));
 
-            if(dist.at(nbr) > new_dist)
+            if(dist[nbr] > new_dist)
             {
-                if(dist.at(nbr) < inf_double) // otherwise it won't be found (one order of magnitude faster than initializing the queue with all the elements with inf dist)
-                {
-                    auto it = q.find(std::make_pair(dist.at(nbr),nbr));
-                    assert(it!=q.end());
-                    q.erase(it);
-                }
-                dist.at(nbr) = new_dist;
-                prev.at(nbr) = vid;
-                q.insert(std::make_pair(new_dist,nbr));
+                dist[nbr] = new_dist;
+                prev[nbr] = vid;
+                q.update(nbr, new_dist);
             }
         }
     }
@@ -428,34 +452,7 @@ void dijkstra_exhaustive_on_dual(const AbstractMesh<M,V,E,P> & m,
                                  const uint                    source,
                                        std::vector<double>   & dist)
 {
-    dist = std::vector<double>(m.num_polys(), inf_double);
-    dist.at(source) = 0.0;
-
-    std::set<std::pair<double,uint>> q;
-    q.insert(std::make_pair(0.0,source));
-
-    while(!q.empty())
-    {
-        uint vid = q.begin()->second;
-        q.erase(q.begin());
-
-        for(uint nbr : m.adj_p2p(vid))
-        {
-            double new_dist = dist.at(vid) + m.poly_centroid(vid).dist(m.poly_centroid(nbr));
-
-            if(dist.at(nbr) > new_dist)
-            {
-                if(dist.at(nbr) < inf_double) // otherwise it won't be found (one order of magnitude faster than initializing the queue with all the elements with inf dist)
-                {
-                    auto it = q.find(std::make_pair(dist.at(nbr),nbr));
-                    assert(it!=q.end());
-                    q.erase(it);
-                }
-                dist.at(nbr) = new_dist;
-                q.insert(std::make_pair(new_dist,nbr));
-            }
-        }
-    }
+    dijkstra_exhaustive_on_dual(m, std::vector<uint>(1,source), dist);
 }
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
@@ -468,33 +465,25 @@ void dijkstra_exhaustive_on_dual(const AbstractMesh<M,V,E,P> & m,
 {
     dist = std::vector<double>(m.num_polys(), inf_double);
 
-    std::set<std::pair<double,uint>> q;
-
-    for(uint s : sources)
+    IndexedHeap<> q(m.num_polys());
+    for(uint pid : sources)
     {
-        dist.at(s) = 0.0;
-        q.insert(std::make_pair(0.0,s));
+        dist.at(pid) = 0.0;
+        q.update(pid, 0.0);
     }
 
     while(!q.empty())
     {
-        uint vid = q.begin()->second;
-        q.erase(q.begin());
+        uint pid = q.pop();
 
-        for(uint nbr : m.adj_p2p(vid))
+        for(uint nbr : m.adj_p2p(pid))
         {
-            double new_dist = dist.at(vid) + m.poly_centroid(vid).dist(m.poly_centroid(nbr));
+            double new_dist = dist[pid] + m.poly_centroid(pid).dist(m.poly_centroid(nbr));
 
-            if(dist.at(nbr) > new_dist)
+            if(dist[nbr] > new_dist)
             {
-                if(dist.at(nbr) < inf_double) // otherwise it won't be found (one order of magnitude faster than initializing the queue with all the elements with inf dist)
-                {
-                    auto it = q.find(std::make_pair(dist.at(nbr),nbr));
-                    assert(it!=q.end());
-                    q.erase(it);
-                }
-                dist.at(nbr) = new_dist;
-                q.insert(std::make_pair(new_dist,nbr));
+                dist[nbr] = new_dist;
+                q.update(nbr, new_dist);
             }
         }
     }
@@ -509,49 +498,7 @@ double dijkstra_on_dual(const AbstractMesh<M,V,E,P> & m,
                         const uint                    dest,
                               std::vector<uint>     & path)
 {
-    path.clear();
-
-    std::vector<int> prev(m.num_polys(), -1);
-
-    std::vector<double> dist(m.num_polys(), inf_double);
-    dist.at(source) = 0.0;
-
-    std::set<std::pair<double,uint>> q;
-    q.insert(std::make_pair(0.0,source));
-
-    while(!q.empty())
-    {
-        uint vid = q.begin()->second;
-        q.erase(q.begin());
-
-        if(vid==dest)
-        {
-            int tmp = vid;
-            do { path.push_back(tmp); tmp = prev.at(tmp); } while (tmp != -1);
-            std::reverse(path.begin(), path.end());
-            return dist.at(dest);
-        }
-
-        for(uint nbr : m.adj_p2p(vid))
-        {
-            double new_dist = dist.at(vid) + m.poly_centroid(vid).dist(m.poly_centroid(nbr));
-
-            if(dist.at(nbr) > new_dist)
-            {
-                if(dist.at(nbr) < inf_double) // otherwise it won't be found (one order of magnitude faster than initializing the queue with all the elements with inf dist)
-                {
-                    auto it = q.find(std::make_pair(dist.at(nbr),nbr));
-                    assert(it!=q.end());
-                    q.erase(it);
-                }
-                dist.at(nbr) = new_dist;
-                prev.at(nbr) = vid;
-                q.insert(std::make_pair(new_dist,nbr));
-            }
-        }
-    }
-    assert(false && "Dijkstra did not converge!");
-    return 0.0;
+    return dijkstra_on_dual(m, source, std::set<uint>({dest}), std::vector<bool>(m.num_polys(),false), path);
 }
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
@@ -564,51 +511,7 @@ double dijkstra_on_dual(const AbstractMesh<M,V,E,P> & m,
                         const std::vector<bool>     & mask,
                               std::vector<uint>     & path)
 {
-    path.clear();
-
-    std::vector<int> prev(m.num_polys(), -1);
-
-    std::vector<double> dist(m.num_polys(), inf_double);
-    dist.at(source) = 0.0;
-
-    std::set<std::pair<double,uint>> q;
-    q.insert(std::make_pair(0.0,source));
-
-    while(!q.empty())
-    {
-        uint vid = q.begin()->second;
-        q.erase(q.begin());
-
-        if(vid==dest)
-        {
-            int tmp = vid;
-            do { path.push_back(tmp); tmp = prev.at(tmp); } while (tmp != -1);
-            std::reverse(path.begin(), path.end());
-            return dist.at(dest);
-        }
-
-        for(uint nbr : m.adj_p2p(vid))
-        {
-            if(mask.at(nbr)) continue;
-
-            double new_dist = dist.at(vid) + m.poly_centroid(vid).dist(m.poly_centroid(nbr));
-
-            if(dist.at(nbr) > new_dist)
-            {
-                if(dist.at(nbr) < inf_double) // otherwise it won't be found (one order of magnitude faster than initializing the queue with all the elements with inf dist)
-                {
-                    auto it = q.find(std::make_pair(dist.at(nbr),nbr));
-                    assert(it!=q.end());
-                    q.erase(it);
-                }
-                dist.at(nbr) = new_dist;
-                prev.at(nbr) = vid;
-                q.insert(std::make_pair(new_dist,nbr));
-            }
-        }
-    }
-    assert(false && "Dijkstra did not converge!");
-    return 0.0;
+    return dijkstra_on_dual(m, source, std::set<uint>({dest}), mask, path);
 }
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
@@ -622,45 +525,39 @@ double dijkstra_on_dual(const AbstractMesh<M,V,E,P> & m,
                               std::vector<uint>     & path)
 {
     path.clear();
+    assert(mask.size() == m.num_polys());
 
     std::vector<int> prev(m.num_polys(), -1);
 
     std::vector<double> dist(m.num_polys(), inf_double);
     dist.at(source) = 0.0;
 
-    std::set<std::pair<double,uint>> q;
-    q.insert(std::make_pair(0.0,source));
+    IndexedHeap<> q(m.num_polys());
+    q.push(source, 0.0);
 
     while(!q.empty())
     {
-        uint vid = q.begin()->second;
-        q.erase(q.begin());
+        uint pid = q.pop();
 
-        if(CONTAINS(dest,vid))
+        if(CONTAINS(dest,pid))
         {
-            int tmp = vid;
+            int tmp = pid;
             do { path.push_back(tmp); tmp = prev.at(tmp); } while (tmp != -1);
             std::reverse(path.begin(), path.end());
-            return dist.at(vid);
+            return dist.at(pid);
         }
 
-        for(uint nbr : m.adj_p2p(vid))
+        for(uint nbr : m.adj_p2p(pid))
         {
             if(mask.at(nbr)) continue;
 
-            double new_dist = dist.at(vid) + m.poly_centroid(vid).dist(m.poly_centroid(nbr));
+            double new_dist = dist[pid] + m.poly_centroid(pid).dist(m.poly_centroid(nbr));
 
-            if(dist.at(nbr) > new_dist)
+            if(dist[nbr] > new_dist)
             {
-                if(dist.at(nbr) < inf_double) // otherwise it won't be found (one order of magnitude faster than initializing the queue with all the elements with inf dist)
-                {
-                    auto it = q.find(std::make_pair(dist.at(nbr),nbr));
-                    assert(it!=q.end());
-                    q.erase(it);
-                }
-                dist.at(nbr) = new_dist;
-                prev.at(nbr) = vid;
-                q.insert(std::make_pair(new_dist,nbr));
+                dist[nbr] = new_dist;
+                prev[nbr] = pid;
+                q.update(nbr, new_dist);
             }
         }
     }
@@ -677,49 +574,7 @@ double dijkstra_on_dual(const AbstractMesh<M,V,E,P> & m,
                         const std::set<uint>        & dest,
                               std::vector<uint>     & path)
 {
-    path.clear();
-
-    std::vector<int> prev(m.num_polys(), -1);
-
-    std::vector<double> dist(m.num_polys(), inf_double);
-    dist.at(source) = 0.0;
-
-    std::set<std::pair<double,uint>> q;
-    q.insert(std::make_pair(0.0,source));
-
-    while(!q.empty())
-    {
-        uint vid = q.begin()->second;
-        q.erase(q.begin());
-
-        if(CONTAINS(dest,vid))
-        {
-            int tmp = vid;
-            do { path.push_back(tmp); tmp = prev.at(tmp); } while (tmp != -1);
-            std::reverse(path.begin(), path.end());
-            return dist.at(vid);
-        }
-
-        for(uint nbr : m.adj_p2p(vid))
-        {
-            double new_dist = dist.at(vid) + m.poly_centroid(vid).dist(m.poly_centroid(nbr));
-
-            if(dist.at(nbr) > new_dist)
-            {
-                if(dist.at(nbr) < inf_double) // otherwise it won't be found (one order of magnitude faster than initializing the queue with all the elements with inf dist)
-                {
-                    auto it = q.find(std::make_pair(dist.at(nbr),nbr));
-                    assert(it!=q.end());
-                    q.erase(it);
-                }
-                dist.at(nbr) = new_dist;
-                prev.at(nbr) = vid;
-                q.insert(std::make_pair(new_dist,nbr));
-            }
-        }
-    }
-    assert(false && "Dijkstra did not converge!");
-    return 0.0;
+    return dijkstra_on_dual(m, source, dest, std::vector<bool>(m.num_polys(),false), path);
 }
 
 }
@@ -36,16 +36,29 @@
 #ifndef CINO_DIJKSTRA_H
 #define CINO_DIJKSTRA_H
 
+#include <functional>
 #include <set>
 #include <sys/types.h>
 #include <vector>
 #include <cinolib/cino_inline.h>
+#include <cinolib/indexed_heap.h>
 #include <cinolib/meshes/abstract_mesh.h>
 #include <cinolib/meshes/abstract_polyhedralmesh.h>
 
 namespace cinolib
 {
 
+// Search strategies for point to point queries. They all return the exact
+// shortest path, but visit different portions of the graph to find it
+//
+typedef enum
+{
+    DIJKSTRA_PLAIN,         // classic Dijkstra, from source to dest
+    DIJKSTRA_ASTAR,         // A*, guided by the euclidean distance to dest
+    DIJKSTRA_BIDIRECTIONAL, // two Dijkstras, from source and dest, that stop when their fronts meet
+}
+DijkstraMode;
+
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 //:::::::::::::::: DIJKSTRAs ON PRIMAL GRAPH (VERTICES) ::::::::::::::::::
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
@@ -66,6 +79,44 @@ void dijkstra_exhaustive(const AbstractMesh<M,V,E,P> & m,
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
+// low level version of the above: dist must point to num_verts() doubles, and the
+// queue is cleared and reused, so that repeated calls do not allocate any memory
+template<class M, class V, class E, class P>
+CINO_INLINE
+void dijkstra_exhaustive(const AbstractMesh<M,V,E,P> & m,
+                         const std::vector<uint>     & sources,
+                               double                * dist,
+                               IndexedHeap<>         & q);
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// Many distance fields at once: one independent Dijkstra per source set, executed
+// in parallel by the global thread pool (see thread_pool.h). Each thread reuses
+// its own queue across runs. Fields are returned as a dense row-major matrix, with
+// the field of source_sets[i] stored in dist[i*num_verts() ... (i+1)*num_verts())
+template<class M, class V, class E, class P>
+CINO_INLINE
+void dijkstra_exhaustive_batch(const AbstractMesh<M,V,E,P>          & m,
+                               const std::vector<std::vector<uint>> & source_sets,
+                                     std::vector<double>            & dist);
+
+// same as above, with one field per source
+template<class M, class V, class E, class P>
+CINO_INLINE
+void dijkstra_exhaustive_batch(const AbstractMesh<M,V,E,P> & m,
+                               const std::vector<uint>     & sources,
+                                     std::vector<double>   & dist);
+
+// Streaming version, for when the whole matrix would not fit in memory: callback(i,dist,thread_id)
+// is invoked as soon as the field of source_sets[i] is ready. The field lives in a per-thread
+// buffer that is overwritten after the callback returns, and callbacks for different source
+// sets may be executed concurrently (use thread_id to index per-thread accumulators)
+template<class M, class V, class E, class P>
+CINO_INLINE
+void dijkstra_exhaustive_batch(const AbstractMesh<M,V,E,P>                                          & m,
+                               const std::vector<std::vector<uint>>                                 & source_sets,
+                               const std::function<void(uint, const std::vector<double> &, uint)> & callback);
+
 template<class M, class V, class E, class F, class P>
 CINO_INLINE
 void dijkstra_exhaustive_srf_only(const AbstractPolyhedralMesh<M,V,E,F,P> & m,
@@ -79,7 +130,8 @@ CINO_INLINE
 double dijkstra(const AbstractMesh<M,V,E,P> & m,
                 const uint                    source,
                 const uint                    dest,
-                      std::vector<uint>     & path);
+                      std::vector<uint>     & path,
+                const DijkstraMode            mode = DIJKSTRA_PLAIN);
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
@@ -89,7 +141,8 @@ double dijkstra(const AbstractMesh<M,V,E,P> & m,
                 const uint                    source,
                 const uint                    dest,
                 const std::vector<bool>     & mask, // if mask[v] = true, path cannot pass through it
-                      std::vector<uint>     & path);
+                      std::vector<uint>     & path,
+                const DijkstraMode            mode = DIJKSTRA_PLAIN);
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
@@ -109,7 +162,8 @@ double dijkstra_mask_on_edges(const AbstractMesh<M,V,E,P> & m,
                               const uint                    source,
                               const uint                    dest,
                               const std::vector<bool>     & mask, // if mask[e] = true, path cannot pass through edge e
-                                    std::vector<uint>     & path);
+                                    std::vector<uint>     & path,
+                              const DijkstraMode            mode = DIJKSTRA_PLAIN);
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 //::::::::::::: DIJKSTRAs ON DUAL GRAPH (POLYGONS/POLYHEDRA) :::::::::::::
@@ -39,6 +39,7 @@
 #include <cinolib/laplacian.h>
 #include <cinolib/vertex_mass.h>
 #include <cinolib/linear_solvers.h>
+#include <cinolib/thread_pool.h>
 
 namespace cinolib
 {
@@ -109,61 +110,146 @@ ScalarField compute_geodesics_amortized(      Mesh              & m,
                                         const float               time_scalar)
 {
     // first call, heavy solve (matrix factorization + gradient matrix)
-    if (cache.heat_flow_cache == NULL)
+    if(!cache.engine.is_ready()) cache.engine.init(m, laplacian_mode, time_scalar);
+
+    // solve by back-substitution using pre-factored matrices
+    return cache.engine.compute(heat_charges);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class Mesh>
+CINO_INLINE
+GeodesicsEngine::GeodesicsEngine(const Mesh & m, const int laplacian_mode, const float time_scalar)
+    : heat_flow(SIMPLICIAL_LLT), integration(SIMPLICIAL_LDLT)
+{
+    init(m, laplacian_mode, time_scalar);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void GeodesicsEngine::clear()
+{
+    ready = false;
+    nv    = 0;
+    heat_flow.clear();
+    integration.clear();
+    G  = Eigen::SparseMatrix<double>();
+    Gt = Eigen::SparseMatrix<double>();
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class Mesh>
+CINO_INLINE
+void GeodesicsEngine::init(const Mesh & m, const int laplacian_mode, const float time_scalar)
+{
+    clear();
+
+    // optimize position and scale to get better numerical precision
+    // (on a copy: the input mesh is left untouched)
+    Mesh tmp(m);
+    double d = tmp.bbox().diag();
+    vec3d  c = tmp.bbox().center();
+    tmp.translate(-c);
+    tmp.scale(1.0/d);
+
+    // use the squared avg edge length as time step, as suggested in the original paper
+    double time = tmp.edge_avg_length();
+    time *= time;
+    time *= time_scalar;
+
+    Eigen::SparseMatrix<double> L  = laplacian(tmp, laplacian_mode);
+    Eigen::SparseMatrix<double> MM = mass_matrix(tmp);
+
+    bool ok = heat_flow.factorize(MM - time * L);
+    ok = integration.factorize(-L) && ok;
+    if(!ok)
     {
-        // optimize position and scale to get better numerical precision
-        double d = m.bbox().diag();
-        vec3d  c = m.bbox().center();
-        m.translate(-c);
-        m.scale(1.0/d);
-
-        // use the squared avg edge length as time step, as suggested in the original paper
-        double time = m.edge_avg_length();
-        time *= time;
-        time *= time_scalar;
-
-        Eigen::SparseMatrix<double> L   = laplacian(m, laplacian_mode);
-        Eigen::SparseMatrix<double> MM  = mass_matrix(m);
-        Eigen::VectorXd             rhs = Eigen::VectorXd::Zero(m.num_verts());
-
-        for(uint vid : heat_charges) rhs[vid] = 1.0;
-
-        ScalarField heat(m.num_verts());
-        cache.heat_flow_cache = new Eigen::SimplicialLLT<Eigen::SparseMatrix<double>>(MM - time * L);
-        assert(cache.heat_flow_cache->info() == Eigen::Success);
-        heat = cache.heat_flow_cache->solve(rhs).eval();
-
-        cache.gradient_matrix = gradient_matrix(m);
-        VectorField grad = cache.gradient_matrix * heat;
-        grad.normalize();
-
-        ScalarField geodesics(m.num_verts());
-        cache.integration_cache = new Eigen::SimplicialLDLT<Eigen::SparseMatrix<double>>(-L);
-        assert(cache.integration_cache->info() == Eigen::Success);
-        geodesics = cache.integration_cache->solve(cache.gradient_matrix.transpose() * grad).eval();
-        geodesics.normalize_in_01();
-
-        // restore original scale and position
-        m.scale(d);
-        m.translate(c);
-        return geodesics;
+        std::cerr << "ERROR : " << __FILE__ << ", line " << __LINE__ << " : GeodesicsEngine::init() : factorization failed" << std::endl;
+        return;
     }
-    else // solve by back-substitution using pre-factored matrices
+
+    G     = gradient_matrix(tmp);
+    Gt    = G.transpose();
+    nv    = m.num_verts();
+    ready = true;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+ScalarField GeodesicsEngine::compute(const std::vector<uint> & heat_charges) const
+{
+    std::vector<std::vector<uint>> batch = { heat_charges };
+    return compute(batch).front();
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+std::vector<ScalarField> GeodesicsEngine::compute(const std::vector<std::vector<uint>> & heat_charges) const
+{
+    if(!ready)
     {
-        Eigen::VectorXd rhs = Eigen::VectorXd::Zero(m.num_verts());
-        for(uint vid : heat_charges) rhs[vid] = 1.0;
-        ScalarField heat = cache.heat_flow_cache->solve(rhs).eval();
+        std::cerr << "ERROR : " << __FILE__ << ", line " << __LINE__ << " : GeodesicsEngine::compute() : engine not initialized" << std::endl;
+        return std::vector<ScalarField>();
+    }
 
-        VectorField grad = cache.gradient_matrix * heat;
-        grad.normalize();
+    // source sets are split into blocks, which are processed in parallel
+    // (each block with a single blocked solve, one column per source set)
+    std::vector<ScalarField> res(heat_charges.size(), ScalarField(nv));
+    parallel_for_ranges(0, heat_charges.size(), [&](const uint beg, const uint end, const uint)
+    {
+        compute_block(heat_charges, beg, end, res);
+    }, 4);
+    return res;
+}
 
-        ScalarField geodesics(m.num_verts());
-        geodesics = cache.integration_cache->solve(cache.gradient_matrix.transpose() * grad).eval();
-        geodesics.normalize_in_01();
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
-        return geodesics;
+CINO_INLINE
+void GeodesicsEngine::compute_block(const std::vector<std::vector<uint>> & heat_charges,
+                                    const uint                             beg,
+                                    const uint                             end,
+                                          std::vector<ScalarField>       & res) const
+{
+    // heat flow, one column per source set
+    uint k = end - beg;
+    Eigen::MatrixXd charges = Eigen::MatrixXd::Zero(nv,k);
+    for(uint j=0; j<k; ++j)
+    for(uint vid : heat_charges.at(beg+j))
+    {
+        assert(vid < nv);
+        charges(vid,j) = 1.0;
     }
+    Eigen::MatrixXd heat;
+    heat_flow.solve(charges, heat);
 
+    // normalized gradients (see VectorField::normalize for the choice of v /= v.length())
+    Eigen::MatrixXd grad = G * heat;
+    for(uint j=0; j<k; ++j)
+    for(Eigen::Index i=0; i<grad.rows(); i+=3)
+    {
+        vec3d tmp(grad(i,j), grad(i+1,j), grad(i+2,j));
+        grad(i  ,j) /= tmp.length();
+        grad(i+1,j) /= tmp.length();
+        grad(i+2,j) /= tmp.length();
+    }
+
+    // integration
+    Eigen::MatrixXd dist;
+    integration.solve(Gt * grad, dist);
+
+    for(uint j=0; j<k; ++j)
+    {
+        // normalize in [0,1] (same as ScalarField::normalize_in_01, but silent)
+        double min   = dist.col(j).minCoeff();
+        double max   = dist.col(j).maxCoeff();
+        double delta = max - min;
+        for(uint vid=0; vid<nv; ++vid) res.at(beg+j)[vid] = (dist(vid,j) - min) / delta;
+    }
 }
 
 }
@@ -41,6 +41,7 @@
 #include <cinolib/cino_inline.h>
 #include <cinolib/scalar_field.h>
 #include <cinolib/symbols.h>
+#include <cinolib/linear_solvers.h>
 #include <Eigen/Sparse>
 
 namespace cinolib
@@ -79,11 +80,67 @@ ScalarField compute_geodesics(      Mesh              & m,
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
+/* Heat based geodesics engine. It owns the factorized heat flow and Poisson
+ * operators and the gradient matrix of a mesh, and computes geodesic distances
+ * from any set of sources with back substitutions only. Many source sets can
+ * be processed with a single blocked solve (one column per source set).
+ *
+ * Operators are computed on a private copy of the mesh, translated and scaled
+ * for better numerical precision, hence the input mesh is never modified.
+ * Once initialized, the engine is read-only: multiple threads can query it
+ * concurrently. Output fields are normalized in [0,1], as in compute_geodesics.
+*/
+
+class GeodesicsEngine
+{
+    public:
+
+        explicit GeodesicsEngine() : heat_flow(SIMPLICIAL_LLT), integration(SIMPLICIAL_LDLT) {}
+
+        template<class Mesh>
+        explicit GeodesicsEngine(const Mesh  & m,
+                                 const int     laplacian_mode = COTANGENT,
+                                 const float   time_scalar = 1.0);
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        template<class Mesh>
+        void init(const Mesh  & m,
+                  const int     laplacian_mode = COTANGENT,
+                  const float   time_scalar = 1.0);
+
+        void clear();
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        bool is_ready()  const { return ready; }
+        uint num_verts() const { return nv; }
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        ScalarField              compute(const std::vector<uint>              & heat_charges) const;
+        std::vector<ScalarField> compute(const std::vector<std::vector<uint>> & heat_charges) const; // one field per source set
+
+    private:
+
+        void compute_block(const std::vector<std::vector<uint>> & heat_charges,
+                           const uint                             beg,
+                           const uint                             end,
+                                 std::vector<ScalarField>       & res) const;
+
+        bool                        ready = false;
+        uint                        nv    = 0;
+        LinearSolver                heat_flow;   // M - t*L
+        LinearSolver                integration; // -L
+        Eigen::SparseMatrix<double> G;           // gradient
+        Eigen::SparseMatrix<double> Gt;          // G transposed (divergence)
+};
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
 typedef struct
 {
-    Eigen::SimplicialLLT<Eigen::SparseMatrix<double>>  *heat_flow_cache   = NULL;
-    Eigen::SimplicialLDLT<Eigen::SparseMatrix<double>> *integration_cache = NULL;
-    Eigen::SparseMatrix<double>                         gradient_matrix;
+    GeodesicsEngine engine;
 }
 GeodesicsCache;
 
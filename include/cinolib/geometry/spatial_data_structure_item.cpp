@@ -34,6 +34,7 @@
 *     Italy                                                                     *
 *********************************************************************************/
 #include <cinolib/geometry/spatial_data_structure_item.h>
+#include <cinolib/geometry/vec3.h>
 
 namespace cinolib
 {
@@ -267,4 +267,26 @@ void render(const RenderData & data)
     }
 }
 
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+size_t bytes_used(const RenderData & data)
+{
+    return bytes_used(data.tris)         + bytes_used(data.tri_coords) +
+           bytes_used(data.tri_v_norms)  + bytes_used(data.tri_v_colors) +
+           bytes_used(data.tri_text)     + bytes_used(data.segs) +
+           bytes_used(data.seg_coords)   + bytes_used(data.seg_colors);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+size_t bytes_allocated(const RenderData & data)
+{
+    return bytes_allocated(data.tris)         + bytes_allocated(data.tri_coords) +
+           bytes_allocated(data.tri_v_norms)  + bytes_allocated(data.tri_v_colors) +
+           bytes_allocated(data.tri_text)     + bytes_allocated(data.segs) +
+           bytes_allocated(data.seg_coords)   + bytes_allocated(data.seg_colors);
+}
+
 }
@@ -52,6 +52,7 @@
 #include <cinolib/cino_inline.h>
 #include <cinolib/color.h>
 #include <cinolib/textures/textures.h>
+#include <cinolib/meshes/mesh_memory.h>
 
 namespace cinolib
 {
@@ -96,6 +97,13 @@ RenderData;
 CINO_INLINE
 void render(const RenderData & data);
 
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// memory used/allocated by the buffers of a RenderData (see mesh_memory.h)
+
+CINO_INLINE size_t bytes_used     (const RenderData & data);
+CINO_INLINE size_t bytes_allocated(const RenderData & data);
+
 }
 
 #ifndef  CINO_STATIC_LIB
@@ -42,6 +42,7 @@
 *     Italy                                                                     *
 *********************************************************************************/
 #include <cinolib/gradient.h>
+#include <cinolib/thread_pool.h>
 
 namespace cinolib
 {
@@ -54,78 +55,112 @@ template<class M, class V, class E, class P>
 CINO_INLINE
 Eigen::SparseMatrix<double> gradient_matrix(const AbstractPolygonMesh<M,V,E,P> & m, const bool per_poly)
 {
-    if(per_poly)
+    SparseAssembler G;
+    gradient_matrix_pattern(m, G, per_poly);
+    gradient_matrix_update(m, G, per_poly);
+    return G.matrix();
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class M, class V, class E, class P>
+CINO_INLINE
+void gradient_matrix_pattern(const AbstractPolygonMesh<M,V,E,P> & m, SparseAssembler & G, const bool per_poly)
+{
+    // per poly : rows 3*pid+{0,1,2} contain the verts of pid
+    // per vert : rows 3*vid+{0,1,2} contain the verts of all the polys incident to vid
+    uint n_elems = per_poly ? m.num_polys() : m.num_verts();
+    AdjacencyCSR rows;
+    rows.offsets.resize(3*n_elems+1);
+    rows.offsets.front() = 0;
+    for(uint id=0; id<n_elems; ++id)
     {
-        Eigen::SparseMatrix<double> G(m.num_polys()*3, m.num_verts());
-        std::vector<Entry> entries;
+        uint beg = rows.entries.size();
+        if(per_poly)
+        {
+            for(uint vid : m.adj_p2v(id)) rows.entries.push_back(vid);
+        }
+        else
+        {
+            for(uint pid : m.adj_v2p(id))
+            for(uint vid : m.adj_p2v(pid)) rows.entries.push_back(vid);
+        }
+        uint end = rows.entries.size();
+        for(uint i=1; i<3; ++i)
+        {
+            for(uint j=beg; j<end; ++j) rows.entries.push_back(rows.entries.at(j));
+        }
+        for(uint i=0; i<3; ++i) rows.offsets.at(3*id+i+1) = beg + (i+1)*(end-beg);
+    }
+    G.init(m.num_verts(), rows);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class M, class V, class E, class P>
+CINO_INLINE
+void gradient_matrix_update(const AbstractPolygonMesh<M,V,E,P> & m, SparseAssembler & G, const bool per_poly)
+{
+    assert(G.num_rows() == 3*(per_poly ? m.num_polys() : m.num_verts()) &&
+           G.num_cols() == m.num_verts() && "Gradient pattern does not match the mesh!");
+
+    // contribution of vertex poly_vert_id(pid,(off+1)%n) to the gradient of poly pid
+    auto vert_contr = [&m](const uint pid, const uint off, uint & curr) -> vec3d
+    {
+        vec3d n    = m.poly_data(pid).normal;
+        uint  prev = m.poly_vert_id(pid,off);
+              curr = m.poly_vert_id(pid,(off+1)%m.verts_per_poly(pid));
+        uint  next = m.poly_vert_id(pid,(off+2)%m.verts_per_poly(pid));
+        vec3d u    = m.vert(next) - m.vert(curr);
+        vec3d v    = m.vert(curr) - m.vert(prev);
+        vec3d u_90 = u.cross(n); u_90.normalize();
+        vec3d v_90 = v.cross(n); v_90.normalize();
+        return u_90 * u.length() + v_90 * v.length();
+    };
 
-        for(uint pid=0; pid<m.num_polys(); ++pid)
+    auto clear_rows = [&G](const uint id)
+    {
+        for(uint row=3*id; row<3*id+3; ++row)
+        for(uint k=0; k<G.row_cols(row).size(); ++k) G.at_slot(row,k) = 0.0;
+    };
+
+    if(per_poly)
+    {
+        parallel_for(0, m.num_polys(), [&](const uint pid)
         {
+            clear_rows(pid);
             double area = std::max(m.poly_area(pid), 1e-5) * 2.0; // (2 is the average term : two verts for each edge)
-            vec3d n     = m.poly_data(pid).normal;
-
             for(uint off=0; off<m.verts_per_poly(pid); ++off)
             {
-                uint  prev = m.poly_vert_id(pid,off);
-                uint  curr = m.poly_vert_id(pid,(off+1)%m.verts_per_poly(pid));
-                uint  next = m.poly_vert_id(pid,(off+2)%m.verts_per_poly(pid));
-                vec3d u    = m.vert(next) - m.vert(curr);
-                vec3d v    = m.vert(curr) - m.vert(prev);
-                vec3d u_90 = u.cross(n); u_90.normalize();
-                vec3d v_90 = v.cross(n); v_90.normalize();
-
-                vec3d per_vert_sum_over_edge_normals = u_90 * u.length() + v_90 * v.length();
-                per_vert_sum_over_edge_normals /= area;
-
+                uint  curr;
+                vec3d g = vert_contr(pid, off, curr);
+                g /= area;
                 uint row = 3 * pid;
-                entries.push_back(Entry(row, curr, per_vert_sum_over_edge_normals.x())); ++row;
-                entries.push_back(Entry(row, curr, per_vert_sum_over_edge_normals.y())); ++row;
-                entries.push_back(Entry(row, curr, per_vert_sum_over_edge_normals.z()));
+                G.at(row, curr) += g.x(); ++row;
+                G.at(row, curr) += g.y(); ++row;
+                G.at(row, curr) += g.z();
             }
-        }
-
-        G.setFromTriplets(entries.begin(), entries.end());
-        return G;
+        }, 256);
     }
     else // per vertex
     {
-        Eigen::SparseMatrix<double> G(m.num_verts()*3, m.num_verts());
-        std::vector<Entry> entries;
-
-        for(uint vid=0; vid<m.num_verts(); ++vid)
+        parallel_for(0, m.num_verts(), [&](const uint vid)
         {
-            std::vector<std::pair<uint,vec3d>> vert_contr;
-            double area=0.f;
-            for(uint pid : m.adj_v2p(vid))
-            {
-                area   += std::max(m.poly_area(pid), 1e-5) * 2.0;
-                vec3d n = m.poly_data(pid).normal;
-
-                for(uint off=0; off<m.verts_per_poly(pid); ++off)
-                {
-                    uint  prev = m.poly_vert_id(pid,off);
-                    uint  curr = m.poly_vert_id(pid,(off+1)%m.verts_per_poly(pid));
-                    uint  next = m.poly_vert_id(pid,(off+2)%m.verts_per_poly(pid));
-                    vec3d u    = m.vert(next) - m.vert(curr);
-                    vec3d v    = m.vert(curr) - m.vert(prev);
-                    vec3d u_90 = u.cross(n); u_90.normalize();
-                    vec3d v_90 = v.cross(n); v_90.normalize();
-
-                    // note: Eigen::setFromTriplets will take care of summing contributs w.r.t. multiple polys
-                    vert_contr.push_back(std::make_pair(curr, u_90*u.length()+v_90*v.length()));
-                }
-            }
+            clear_rows(vid);
+            double area = 0.0;
+            for(uint pid : m.adj_v2p(vid)) area += std::max(m.poly_area(pid), 1e-5) * 2.0;
             uint row = vid * 3;
-            for(auto c : vert_contr)
+            for(uint pid : m.adj_v2p(vid))
+            for(uint off=0; off<m.verts_per_poly(pid); ++off)
             {
-                entries.push_back(Entry(row  , c.first, c.second.x()/area));
-                entries.push_back(Entry(row+1, c.first, c.second.y()/area));
-                entries.push_back(Entry(row+2, c.first, c.second.z()/area));
+                // contributions w.r.t. multiple polys are summed in the same entry
+                uint  curr;
+                vec3d g = vert_contr(pid, off, curr);
+                G.at(row  , curr) += g.x()/area;
+                G.at(row+1, curr) += g.y()/area;
+                G.at(row+2, curr) += g.z()/area;
             }
-        }
-
-        G.setFromTriplets(entries.begin(), entries.end());
-        return G;
+        }, 256);
     }
 }
 
@@ -135,72 +170,18 @@ template<class M, class V, class E, class F, class P>
 CINO_INLINE
 Eigen::SparseMatrix<double> gradient_matrix(const AbstractPolyhedralMesh<M,V,E,F,P> & m, const bool per_poly)
 {
+    SparseAssembler G;
+    gradient_matrix_pattern(m, G);
+    gradient_matrix_update(m, G);
+
     if(per_poly)
     {
-        Eigen::SparseMatrix<double> G(m.num_polys()*3, m.num_verts());
-        std::vector<Entry> entries;
-
-        for(uint pid=0; pid<m.num_polys(); ++pid)
-        {
-            double vol = std::max(m.poly_volume(pid), 1e-5);
-
-            for(uint vid : m.adj_p2v(pid))
-            {
-                vec3d per_vert_sum_over_f_normals(0,0,0);
-                for(uint fid : m.adj_p2f(pid))
-                {
-                    if (m.face_contains_vert(fid,vid))
-                    {
-                        vec3d  n   = m.poly_face_normal(pid,fid);
-                        double a   = m.face_area(fid);
-                        double avg = static_cast<double>(m.verts_per_face(fid));
-                        per_vert_sum_over_f_normals += (n*a)/avg;
-                    }
-                }
-                per_vert_sum_over_f_normals /= vol;
-                uint row = 3 * pid;
-                entries.push_back(Entry(row, vid, per_vert_sum_over_f_normals.x())); ++row;
-                entries.push_back(Entry(row, vid, per_vert_sum_over_f_normals.y())); ++row;
-                entries.push_back(Entry(row, vid, per_vert_sum_over_f_normals.z()));
-            }
-        }
-
-        G.setFromTriplets(entries.begin(), entries.end());
-        return G;
+        return G.matrix();
     }
     else // per vert
     {
-        Eigen::SparseMatrix<double> G(m.num_polys()*3, m.num_verts());
-        std::vector<Entry> entries;
-
-        for(uint pid=0; pid<m.num_polys(); ++pid)
-        {
-            double vol = std::max(m.poly_volume(pid), 1e-5);
-
-            for(uint vid : m.adj_p2v(pid))
-            {
-                vec3d per_vert_sum_over_f_normals(0,0,0);
-                for(uint fid : m.adj_p2f(pid))
-                {
-                    if (m.face_contains_vert(fid,vid))
-                    {
-                        vec3d  n   = m.poly_face_normal(pid,fid);
-                        double a   = m.face_area(fid);
-                        double avg = static_cast<double>(m.verts_per_face(fid));
-                        per_vert_sum_over_f_normals += (n*a)/avg;
-                    }
-                }
-                per_vert_sum_over_f_normals /= vol;
-                uint row = 3 * pid;
-                entries.push_back(Entry(row, vid, per_vert_sum_over_f_normals.x())); ++row;
-                entries.push_back(Entry(row, vid, per_vert_sum_over_f_normals.y())); ++row;
-                entries.push_back(Entry(row, vid, per_vert_sum_over_f_normals.z()));
-            }
-        }
-        G.setFromTriplets(entries.begin(), entries.end());
-
         Eigen::SparseMatrix<double> A(m.num_verts()*3, m.num_polys()*3);
-        entries.clear();
+        std::vector<Entry> entries;
 
         for(uint vid=0;vid<m.num_verts();++vid)
         {
@@ -219,8 +200,64 @@ Eigen::SparseMatrix<double> gradient_matrix(const AbstractPolyhedralMesh<M,V,E,F
             }
         }
         A.setFromTriplets(entries.begin(), entries.end());
-        return A*G;
+        return A*G.matrix();
+    }
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class M, class V, class E, class F, class P>
+CINO_INLINE
+void gradient_matrix_pattern(const AbstractPolyhedralMesh<M,V,E,F,P> & m, SparseAssembler & G)
+{
+    // rows 3*pid+{0,1,2} contain the verts of pid
+    AdjacencyCSR rows;
+    rows.offsets.resize(3*m.num_polys()+1);
+    rows.offsets.front() = 0;
+    for(uint pid=0; pid<m.num_polys(); ++pid)
+    {
+        for(uint i=0; i<3; ++i)
+        {
+            for(uint vid : m.adj_p2v(pid)) rows.entries.push_back(vid);
+            rows.offsets.at(3*pid+i+1) = rows.entries.size();
+        }
     }
+    G.init(m.num_verts(), rows);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class M, class V, class E, class F, class P>
+CINO_INLINE
+void gradient_matrix_update(const AbstractPolyhedralMesh<M,V,E,F,P> & m, SparseAssembler & G)
+{
+    assert(G.num_rows() == 3*m.num_polys() && G.num_cols() == m.num_verts() &&
+           "Gradient pattern does not match the mesh!");
+
+    parallel_for(0, m.num_polys(), [&](const uint pid)
+    {
+        double vol = std::max(m.poly_volume(pid), 1e-5);
+
+        for(uint vid : m.adj_p2v(pid))
+        {
+            vec3d per_vert_sum_over_f_normals(0,0,0);
+            for(uint fid : m.adj_p2f(pid))
+            {
+                if (m.face_contains_vert(fid,vid))
+                {
+                    vec3d  n   = m.poly_face_normal(pid,fid);
+                    double a   = m.face_area(fid);
+                    double avg = static_cast<double>(m.verts_per_face(fid));
+                    per_vert_sum_over_f_normals += (n*a)/avg;
+                }
+            }
+            per_vert_sum_over_f_normals /= vol;
+            uint row = 3 * pid;
+            G.at(row, vid) = per_vert_sum_over_f_normals.x(); ++row;
+            G.at(row, vid) = per_vert_sum_over_f_normals.y(); ++row;
+            G.at(row, vid) = per_vert_sum_over_f_normals.z();
+        }
+    }, 64);
 }
 
 }
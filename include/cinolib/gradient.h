@@ -48,6 +48,7 @@
 #include <cinolib/cino_inline.h>
 #include <cinolib/meshes/abstract_polyhedralmesh.h>
 #include <cinolib/meshes/abstract_polygonmesh.h>
+#include <cinolib/sparse_assembler.h>
 
 namespace cinolib
 {
@@ -87,6 +88,35 @@ template<class M, class V, class E, class F, class P>
 CINO_INLINE
 Eigen::SparseMatrix<double> gradient_matrix(const AbstractPolyhedralMesh<M,V,E,F,P> & m, const bool per_poly = true);
 
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// reusable pattern versions of gradient_matrix(), for iterative methods (see laplacian_pattern()).
+// For volume meshes only the per poly gradient is supported
+
+template<class M, class V, class E, class P>
+CINO_INLINE
+void gradient_matrix_pattern(const AbstractPolygonMesh<M,V,E,P> & m,
+                             SparseAssembler                    & G,
+                             const bool                           per_poly = true);
+
+template<class M, class V, class E, class P>
+CINO_INLINE
+void gradient_matrix_update(const AbstractPolygonMesh<M,V,E,P> & m,
+                            SparseAssembler                    & G,
+                            const bool                           per_poly = true);
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class M, class V, class E, class F, class P>
+CINO_INLINE
+void gradient_matrix_pattern(const AbstractPolyhedralMesh<M,V,E,F,P> & m,
+                             SparseAssembler                         & G);
+
+template<class M, class V, class E, class F, class P>
+CINO_INLINE
+void gradient_matrix_update(const AbstractPolyhedralMesh<M,V,E,F,P> & m,
+                            SparseAssembler                         & G);
+
 }
 
 #ifndef  CINO_STATIC_LIB
@@ -35,6 +35,7 @@
 *********************************************************************************/
 #include <cinolib/grid_mesh.h>
 #include <cinolib/serialize_index.h>
+#include <cinolib/tetrahedralization.h>
 #include <vector>
 
 namespace cinolib
@@ -64,4 +65,80 @@ void grid_mesh(const uint                quads_per_row,
     m = Quadmesh<M,V,E,P>(points, polys);
 }
 
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void grid_mesh_cubes(const uint                             cubes_per_x,
+                     const uint                             cubes_per_y,
+                     const uint                             cubes_per_z,
+                           std::vector<vec3d>             & points,
+                           std::vector<std::vector<uint>> & cubes)
+{
+    auto vid = [&](const uint x, const uint y, const uint z) -> uint
+    {
+        return (z*(cubes_per_y+1) + y)*(cubes_per_x+1) + x;
+    };
+
+    points.clear();
+    points.reserve((cubes_per_x+1)*(cubes_per_y+1)*(cubes_per_z+1));
+    for(uint z=0; z<=cubes_per_z; ++z)
+    for(uint y=0; y<=cubes_per_y; ++y)
+    for(uint x=0; x<=cubes_per_x; ++x)
+    {
+        points.push_back(vec3d(x,y,z));
+    }
+
+    // vertex ordering as in HEXA_FACES (standard_elements_tables.h)
+    cubes.clear();
+    cubes.reserve(cubes_per_x*cubes_per_y*cubes_per_z);
+    for(uint z=0; z<cubes_per_z; ++z)
+    for(uint y=0; y<cubes_per_y; ++y)
+    for(uint x=0; x<cubes_per_x; ++x)
+    {
+        cubes.push_back(
+        {
+            vid(x,y  ,z  ), vid(x+1,y  ,z  ), vid(x+1,y+1,z  ), vid(x,y+1,z  ),
+            vid(x,y  ,z+1), vid(x+1,y  ,z+1), vid(x+1,y+1,z+1), vid(x,y+1,z+1)
+        });
+    }
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class M, class V, class E, class F, class P>
+CINO_INLINE
+void grid_mesh(const uint                 cubes_per_x,
+               const uint                 cubes_per_y,
+               const uint                 cubes_per_z,
+                     Hexmesh<M,V,E,F,P> & m)
+{
+    std::vector<vec3d>             points;
+    std::vector<std::vector<uint>> cubes;
+    grid_mesh_cubes(cubes_per_x, cubes_per_y, cubes_per_z, points, cubes);
+    m = Hexmesh<M,V,E,F,P>(points, cubes);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class M, class V, class E, class F, class P>
+CINO_INLINE
+void grid_mesh(const uint                 cubes_per_x,
+               const uint                 cubes_per_y,
+               const uint                 cubes_per_z,
+                     Tetmesh<M,V,E,F,P> & m)
+{
+    std::vector<vec3d>             points;
+    std::vector<std::vector<uint>> cubes;
+    grid_mesh_cubes(cubes_per_x, cubes_per_y, cubes_per_z, points, cubes);
+
+    std::vector<uint> tets, cube_tets;
+    tets.reserve(cubes.size()*24);
+    for(const auto & cube : cubes)
+    {
+        hex_to_tets(cube, cube_tets);
+        tets.insert(tets.end(), cube_tets.begin(), cube_tets.end());
+    }
+    m = Tetmesh<M,V,E,F,P>(points, tets);
+}
+
 }
@@ -39,6 +39,8 @@
 #include <sys/types.h>
 #include <cinolib/cino_inline.h>
 #include <cinolib/meshes/quadmesh.h>
+#include <cinolib/meshes/hexmesh.h>
+#include <cinolib/meshes/tetmesh.h>
 
 namespace cinolib
 {
@@ -51,6 +53,36 @@ void grid_mesh(const uint                quads_per_row,
                const uint                quads_per_col,
                      Quadmesh<M,V,E,P> & m);
 
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// regular lattice of unit cubes spanning [0,cubes_per_x] x [0,cubes_per_y] x [0,cubes_per_z]
+
+CINO_INLINE
+void grid_mesh_cubes(const uint                             cubes_per_x,
+                     const uint                             cubes_per_y,
+                     const uint                             cubes_per_z,
+                           std::vector<vec3d>             & points,
+                           std::vector<std::vector<uint>> & cubes);
+
+template<class M, class V, class E, class F, class P>
+CINO_INLINE
+void grid_mesh(const uint                 cubes_per_x,
+               const uint                 cubes_per_y,
+               const uint                 cubes_per_z,
+                     Hexmesh<M,V,E,F,P> & m);
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// same as above, with each cube split into five or six tets (see hex_to_tets
+// in tetrahedralization.h). The resulting tetmesh is conforming
+
+template<class M, class V, class E, class F, class P>
+CINO_INLINE
+void grid_mesh(const uint                 cubes_per_x,
+               const uint                 cubes_per_y,
+               const uint                 cubes_per_z,
+                     Tetmesh<M,V,E,F,P> & m);
+
 }
 
 #ifndef  CINO_STATIC_LIB
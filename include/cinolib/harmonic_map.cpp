@@ -82,32 +82,29 @@ std::vector<vec3d> harmonic_map_3d(const AbstractMesh<M,V,E,P> & m,
     assert(laplacian_mode == COTANGENT || laplacian_mode == UNIFORM);
     assert(solver == SIMPLICIAL_LLT || solver == SIMPLICIAL_LDLT || solver == SparseLU || solver == BiCGSTAB);
 
-    ScalarField f(3*m.num_verts());
-
-    Eigen::SparseMatrix<double> L   = laplacian(m, laplacian_mode, 3);
+    // the three components are independent: factorize the scalar operator
+    // once and solve for x, y and z at once (rather than a 3N x 3N system)
+    Eigen::SparseMatrix<double> L   = laplacian(m, laplacian_mode);
     Eigen::SparseMatrix<double> Ln = -L;
-    Eigen::VectorXd             rhs = Eigen::VectorXd::Zero(3*m.num_verts());
+    Eigen::MatrixXd             rhs = Eigen::MatrixXd::Zero(m.num_verts(),3);
 
     for(uint i=1; i<n; ++i) Ln  = Ln * (-L); // keep it PSD
 
-    uint y_off = m.num_verts();
-    uint z_off = m.num_verts() + y_off;
-    std::map<uint,double> bc_1d;
+    std::map<uint,std::vector<double>> bc_3d;
     for(auto obj : bc)
     {
         uint  vid = obj.first;
         vec3d pos = obj.second;
-        bc_1d[      vid] = pos.x();
-        bc_1d[y_off+vid] = pos.y();
-        bc_1d[z_off+vid] = pos.z();
+        bc_3d[vid] = { pos.x(), pos.y(), pos.z() };
     }
 
-    solve_square_system_with_bc(Ln, rhs, f, bc_1d, solver);
+    Eigen::MatrixXd f;
+    solve_square_system_with_bc(Ln, rhs, f, bc_3d, solver);
 
     std::vector<vec3d> res(m.num_verts());
     for(uint vid=0; vid<m.num_verts(); ++vid)
     {
-        res.at(vid) = vec3d(f[vid], f[y_off+vid], f[z_off+vid]);
+        res.at(vid) = vec3d(f(vid,0), f(vid,1), f(vid,2));
     }
 
     return res;
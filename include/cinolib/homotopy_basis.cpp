@@ -35,8 +35,12 @@
 *********************************************************************************/
 #include <cinolib/homotopy_basis.h>
 #include <cinolib/shortest_path_tree.h>
+#include <cinolib/dijkstra.h>
 #include <cinolib/mst.h>
 #include <cinolib/stl_container_utilities.h>
+#include <functional>
+#include <mutex>
+#include <numeric>
 
 namespace cinolib
 {
@@ -90,22 +94,22 @@ double homotopy_basis(AbstractPolygonMesh<M,V,E,P>   & m,
 {
     assert(root<m.num_verts());
 
-    shortest_path_tree(m, root, tree);
+    // distances and paths to the root are read off the shortest path tree
+    std::vector<double> dist;
+    std::vector<int>    parent;
+    shortest_path_tree(m, root, tree, dist, parent);
 
     // Compute the cotree as the Maximum Spanning Tree of the dual of M,
     // without considering dual edges that cross edges of primal tree.
     //
     // I'm using a classical Minimum Spanning Tree algorithm (Prim's) with negative weights
     std::vector<float> edge_weights(m.num_edges(),0);
-    std::vector<bool>  edge_mask(m.num_edges()); // restrict Dijkstra to the edges in tree only
-    for(uint eid=0; eid<m.num_edges(); ++eid) edge_mask.at(eid) = !tree.at(eid);
     for(uint eid=0; eid<m.num_edges(); ++eid)
     {
         if(tree.at(eid)) continue;
-        std::vector<uint> tmp;
         edge_weights.at(eid) -= m.edge_length(eid);
-        edge_weights.at(eid) -= dijkstra_mask_on_edges(m, m.edge_vert_id(eid,0), root, edge_mask, tmp);
-        edge_weights.at(eid) -= dijkstra_mask_on_edges(m, m.edge_vert_id(eid,1), root, edge_mask, tmp);
+        edge_weights.at(eid) -= dist.at(m.edge_vert_id(eid,0));
+        edge_weights.at(eid) -= dist.at(m.edge_vert_id(eid,1));
     }
     MST_on_dual_mask_on_edges(m, edge_weights, tree, cotree); // use tree as edge mask
 
@@ -122,10 +126,13 @@ double homotopy_basis(AbstractPolygonMesh<M,V,E,P>   & m,
     double length = 0.0;
     for(uint eid : generators)
     {
+        uint v0 = m.edge_vert_id(eid,0);
+        uint v1 = m.edge_vert_id(eid,1);
+        length += m.edge_length(eid) + dist.at(v0) + dist.at(v1);
+
         std::vector<uint> e0_to_root, e1_to_root;
-        length += m.edge_length(eid);
-        length += dijkstra_mask_on_edges(m, m.edge_vert_id(eid,0), root, edge_mask, e0_to_root);
-        length += dijkstra_mask_on_edges(m, m.edge_vert_id(eid,1), root, edge_mask, e1_to_root);
+        for(int vid=v0; vid!=-1; vid=parent.at(vid)) e0_to_root.push_back(vid);
+        for(int vid=v1; vid!=-1; vid=parent.at(vid)) e1_to_root.push_back(vid);
         e1_to_root.pop_back();
         std::reverse(e1_to_root.begin(), e1_to_root.end());
         std::copy(e1_to_root.begin(), e1_to_root.end(), std::back_inserter(e0_to_root));
@@ -136,6 +143,66 @@ double homotopy_basis(AbstractPolygonMesh<M,V,E,P>   & m,
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
+template<class M, class V, class E, class P>
+CINO_INLINE
+double homotopy_basis_length(const AbstractPolygonMesh<M,V,E,P> & m,
+                             const uint                           root,
+                             const std::vector<double>          & dist,
+                             const double                         max_length)
+{
+    std::vector<bool> tree;
+    std::vector<int>  parent;
+    shortest_path_tree_from_dist(m, root, dist, tree, parent);
+
+    // The cotree is the Maximum Spanning Tree of the dual of M (w.r.t. the length of the
+    // loop closed by each edge), and the generators are the edges left out by both trees.
+    // Here the dual tree is grown with Kruskal's algorithm: edges are visited from the
+    // longest loop to the shortest one, and those that would close a cycle in the dual
+    // graph are generators. Only the length of the basis is accumulated, which permits
+    // to stop as soon as it exceeds max_length
+    std::vector<std::pair<double,uint>> loops;
+    for(uint eid=0; eid<m.num_edges(); ++eid)
+    {
+        if(tree.at(eid)) continue;
+        double l = m.edge_length(eid) + dist.at(m.edge_vert_id(eid,0)) + dist.at(m.edge_vert_id(eid,1));
+        loops.push_back(std::make_pair(l,eid));
+    }
+    std::sort(loops.begin(), loops.end(), std::greater<std::pair<double,uint>>());
+
+    std::vector<uint> dual_root(m.num_polys());
+    std::iota(dual_root.begin(), dual_root.end(), 0);
+    auto find = [&dual_root](uint pid)
+    {
+        while(dual_root.at(pid)!=pid)
+        {
+            dual_root.at(pid) = dual_root.at(dual_root.at(pid)); // path halving
+            pid = dual_root.at(pid);
+        }
+        return pid;
+    };
+
+    double length = 0.0;
+    for(const auto & l : loops)
+    {
+        const std::vector<uint> & polys = m.adj_e2p(l.second);
+        if(polys.size()==2)
+        {
+            uint r0 = find(polys.front());
+            uint r1 = find(polys.back());
+            if(r0!=r1)
+            {
+                dual_root.at(r0) = r1; // edge in cotree
+                continue;
+            }
+        }
+        length += l.first;
+        if(length > max_length) return inf_double;
+    }
+    return length;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
 template<class M, class V, class E, class P>
 CINO_INLINE
 void homotopy_basis(AbstractPolygonMesh<M,V,E,P> & m,
@@ -146,30 +213,36 @@ void homotopy_basis(AbstractPolygonMesh<M,V,E,P> & m,
     //
     if(data.globally_shortest)
     {
-        double best_length = inf_double;
-        uint   best_root;
-        std::vector<std::vector<uint>> best_basis;
-        std::vector<bool>              best_tree;
-        std::vector<bool>              best_cotree;
-
-        for(uint vid=0; vid<m.num_verts(); ++vid)
+        // roots are processed in parallel, and each search stops as soon as its
+        // basis is longer than the best one found so far. Ties are broken in
+        // favor of the root with lowest ID, so the result does not depend on
+        // the number of threads
+        std::mutex mutex;
+        double     best_length = inf_double;
+        uint       best_root   = 0;
+
+        std::vector<std::vector<uint>> roots(m.num_verts());
+        for(uint vid=0; vid<m.num_verts(); ++vid) roots.at(vid).push_back(vid);
+        dijkstra_exhaustive_batch(m, roots, [&](const uint vid, const std::vector<double> & dist, const uint)
         {
-            double length = homotopy_basis(m, vid, data.loops, data.tree, data.cotree);
+            double max_length;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                max_length = best_length;
+            }
+            double length = homotopy_basis_length(m, vid, dist, max_length);
 
-            if(length < best_length)
+            std::lock_guard<std::mutex> lock(mutex);
+            if(length < best_length || (length == best_length && vid < best_root))
             {
                 best_root   = vid;
                 best_length = length;
-                best_basis  = data.loops;
-                best_tree   = data.tree;
-                best_cotree = data.cotree;
             }
-        }
-        data.loops  = best_basis;
+        });
+
+        // build the loops for the winning root only
         data.root   = best_root;
-        data.length = best_length;
-        data.tree   = best_tree;
-        data.cotree = best_cotree;
+        data.length = homotopy_basis(m, best_root, data.loops, data.tree, data.cotree);
     }
     else
     {
@@ -38,6 +38,7 @@
 
 #include <cinolib/meshes/abstract_polygonmesh.h>
 #include <cinolib/meshes/trimesh.h>
+#include <cinolib/min_max_inf.h>
 
 namespace cinolib
 {
@@ -111,7 +112,7 @@ std::ostream & operator<<(std::ostream & in, const RefinementStats & stats);
 typedef struct
 {
     // INPUT: SETTINGS
-    bool  globally_shortest  = false; // cost for globally shortest is O(n^2 log n). When this is set to true, root will contain the root of the globally shortest basis
+    bool  globally_shortest  = false; // cost for globally shortest is O(n^2 log n), split among the available threads (see set_num_threads). When this is set to true, root will contain the root of the globally shortest basis
     uint  root               = 0;     // cost for a base centered at root is O(n log n)
 
     // INPUT: REFINEMENT OPTIONS AND STATISTICS
@@ -153,6 +154,18 @@ double homotopy_basis(AbstractPolygonMesh<M,V,E,P>   & m,
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
+// length of the basis centered at root, given the distances from root to all mesh vertices.
+// Loops are not built. If the length exceeds max_length the search is interrupted and
+// inf_double is returned (used to prune roots when searching the globally shortest basis)
+template<class M, class V, class E, class P>
+CINO_INLINE
+double homotopy_basis_length(const AbstractPolygonMesh<M,V,E,P> & m,
+                             const uint                           root,
+                             const std::vector<double>          & dist,
+                             const double                         max_length = inf_double);
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
 // globally detaches loops in the homotopy basis
 template<class M, class V, class E, class P>
 CINO_INLINE
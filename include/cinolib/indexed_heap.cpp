@@ -0,0 +1,152 @@
+/********************************************************************************
+*  This file is part of CinoLib                                                 *
+*  Copyright(C) 2016: Marco Livesu                                              *
+*                                                                               *
+*  The MIT License                                                              *
+*                                                                               *
+*  Permission is hereby granted, free of charge, to any person obtaining a      *
+*  copy of this software and associated documentation files (the "Software"),   *
+*  to deal in the Software without restriction, including without limitation    *
+*  the rights to use, copy, modify, merge, publish, distribute, sublicense,     *
+*  and/or sell copies of the Software, and to permit persons to whom the        *
+*  Software is furnished to do so, subject to the following conditions:         *
+*                                                                               *
+*  The above copyright notice and this permission notice shall be included in   *
+*  all copies or substantial portions of the Software.                          *
+*                                                                               *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR   *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,     *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. IN NO EVENT SHALL THE *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER       *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      *
+*  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS *
+*  IN THE SOFTWARE.                                                             *
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Marco Livesu (marco.livesu@gmail.com)                                     *
+*     http://pers.ge.imati.cnr.it/livesu/                                       *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*********************************************************************************/
+#include <cinolib/indexed_heap.h>
+#include <algorithm>
+#include <cassert>
+
+namespace cinolib
+{
+
+template<uint D>
+const uint IndexedHeap<D>::NOT_IN_HEAP;
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<uint D>
+CINO_INLINE
+void IndexedHeap<D>::resize(const uint n)
+{
+    heap.clear();
+    pos.assign(n, NOT_IN_HEAP);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<uint D>
+CINO_INLINE
+void IndexedHeap<D>::clear()
+{
+    for(const Entry & e : heap) pos[e.id] = NOT_IN_HEAP;
+    heap.clear();
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<uint D>
+CINO_INLINE
+void IndexedHeap<D>::push(const uint id, const double key)
+{
+    assert(id<pos.size() && !contains(id));
+    heap.push_back(Entry());
+    sift_up(heap.size()-1, Entry{key,id});
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<uint D>
+CINO_INLINE
+void IndexedHeap<D>::update(const uint id, const double key)
+{
+    if(!contains(id))
+    {
+        push(id, key);
+        return;
+    }
+    assert(key<=heap[pos[id]].key);
+    sift_up(pos[id], Entry{key,id});
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<uint D>
+CINO_INLINE
+uint IndexedHeap<D>::pop()
+{
+    assert(!empty());
+    uint id = heap.front().id;
+    pos[id] = NOT_IN_HEAP;
+    Entry last = heap.back();
+    heap.pop_back();
+    if(!heap.empty()) sift_down(0, last);
+    return id;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// moves e up from position i, shifting down the parents with bigger key
+//
+template<uint D>
+CINO_INLINE
+void IndexedHeap<D>::sift_up(uint i, const Entry e)
+{
+    while(i>0)
+    {
+        uint parent = (i-1)/D;
+        if(!less(e, heap[parent])) break;
+        heap[i] = heap[parent];
+        pos[heap[i].id] = i;
+        i = parent;
+    }
+    heap[i] = e;
+    pos[e.id] = i;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// moves e down from position i, shifting up the smallest children
+//
+template<uint D>
+CINO_INLINE
+void IndexedHeap<D>::sift_down(uint i, const Entry e)
+{
+    uint n = heap.size();
+    while(true)
+    {
+        uint first = D*i+1;
+        if(first>=n) break;
+        uint last  = std::min(first+D, n);
+        uint best  = first;
+        for(uint c=first+1; c<last; ++c) if(less(heap[c], heap[best])) best = c;
+        if(!less(heap[best], e)) break;
+        heap[i] = heap[best];
+        pos[heap[i].id] = i;
+        i = best;
+    }
+    heap[i] = e;
+    pos[e.id] = i;
+}
+
+}
@@ -0,0 +1,109 @@
+/********************************************************************************
+*  This file is part of CinoLib                                                 *
+*  Copyright(C) 2016: Marco Livesu                                              *
+*                                                                               *
+*  The MIT License                                                              *
+*                                                                               *
+*  Permission is hereby granted, free of charge, to any person obtaining a      *
+*  copy of this software and associated documentation files (the "Software"),   *
+*  to deal in the Software without restriction, including without limitation    *
+*  the rights to use, copy, modify, merge, publish, distribute, sublicense,     *
+*  and/or sell copies of the Software, and to permit persons to whom the        *
+*  Software is furnished to do so, subject to the following conditions:         *
+*                                                                               *
+*  The above copyright notice and this permission notice shall be included in   *
+*  all copies or substantial portions of the Software.                          *
+*                                                                               *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR   *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,     *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. IN NO EVENT SHALL THE *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER       *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      *
+*  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS *
+*  IN THE SOFTWARE.                                                             *
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Marco Livesu (marco.livesu@gmail.com)                                     *
+*     http://pers.ge.imati.cnr.it/livesu/                                       *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*********************************************************************************/
+#ifndef CINO_INDEXED_HEAP_H
+#define CINO_INDEXED_HEAP_H
+
+#include <cinolib/cino_inline.h>
+#include <sys/types.h>
+#include <vector>
+
+namespace cinolib
+{
+
+/* Min priority queue of element ids in [0,n), with decrease-key. Ids are
+ * stored in a D-ary heap (D=4 by default, which is shallower and more cache
+ * friendly than a binary heap), and the position of each id in the heap is
+ * tracked in a flat array, so that the priority of an element already in the
+ * queue can be updated in place in O(log n), without any memory allocation.
+ * Equal keys are extracted in increasing id order.
+ *
+ * The queue can be reused (e.g. across many Dijkstra runs) with clear(),
+ * which costs O(size) rather than O(n).
+*/
+
+template<uint D = 4>
+class IndexedHeap
+{
+    public:
+
+        explicit IndexedHeap(const uint n = 0) { resize(n); }
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        void resize(const uint n); // empties the queue, and sets the range of ids to [0,n)
+        void clear();
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        bool   empty()                 const { return heap.empty(); }
+        uint   size()                  const { return heap.size();  }
+        bool   contains(const uint id) const { return pos[id] != NOT_IN_HEAP; }
+        uint   top()                   const { return heap.front().id; }
+        double top_key()               const { return heap.front().key; }
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        void push  (const uint id, const double key); // id must not be in the queue
+        void update(const uint id, const double key); // push id, or decrease its key if already in the queue
+        uint pop   ();                                // removes and returns the id with smallest key
+
+    protected:
+
+        static const uint NOT_IN_HEAP = ~0u;
+
+        typedef struct
+        {
+            double key;
+            uint   id;
+        }
+        Entry;
+
+        static bool less(const Entry & a, const Entry & b) { return a.key<b.key || (a.key==b.key && a.id<b.id); }
+
+        void sift_up  (uint i, const Entry e);
+        void sift_down(uint i, const Entry e);
+
+        std::vector<Entry> heap; // ids and priorities, in heap order
+        std::vector<uint>  pos;  // position of each id in the heap (NOT_IN_HEAP if absent)
+};
+
+}
+
+#ifndef  CINO_STATIC_LIB
+#include "indexed_heap.cpp"
+#endif
+
+#endif // CINO_INDEXED_HEAP_H
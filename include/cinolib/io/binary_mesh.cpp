@@ -0,0 +1,306 @@
+/********************************************************************************
+*  This file is part of CinoLib                                                 *
+*  Copyright(C) 2016: Marco Livesu                                              *
+*                                                                               *
+*  The MIT License                                                              *
+*                                                                               *
+*  Permission is hereby granted, free of charge, to any person obtaining a      *
+*  copy of this software and associated documentation files (the "Software"),   *
+*  to deal in the Software without restriction, including without limitation    *
+*  the rights to use, copy, modify, merge, publish, distribute, sublicense,     *
+*  and/or sell copies of the Software, and to permit persons to whom the        *
+*  Software is furnished to do so, subject to the following conditions:         *
+*                                                                               *
+*  The above copyright notice and this permission notice shall be included in   *
+*  all copies or substantial portions of the Software.                          *
+*                                                                               *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR   *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,     *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. IN NO EVENT SHALL THE *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER       *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      *
+*  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS *
+*  IN THE SOFTWARE.                                                             *
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Marco Livesu (marco.livesu@gmail.com)                                     *
+*     http://pers.ge.imati.cnr.it/livesu/                                       *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*********************************************************************************/
+#include <cinolib/io/binary_mesh.h>
+#include <algorithm>
+#include <iostream>
+#include <stdio.h>
+
+namespace cinolib
+{
+
+CINO_INLINE
+void BinaryMeshWriter::add(const uint32_t tag, const void * data, const uint32_t elem_size, const uint64_t count)
+{
+    BinaryMeshSection s;
+    s.tag       = tag;
+    s.elem_size = elem_size;
+    s.count     = count;
+    s.offset    = 0; // set by write()
+    sections.push_back(s);
+    payload.push_back(static_cast<const char*>(data));
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void BinaryMeshWriter::add(const uint32_t tag, const AdjacencyCSR & csr)
+{
+    add(tag,                 csr.offsets);
+    add(tag|BIN_CSR_ENTRIES, csr.entries);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void BinaryMeshWriter::add(const uint32_t tag, const std::vector<std::vector<uint>> & rows)
+{
+    size_t n = 0;
+    for(const auto & r : rows) n += r.size();
+
+    owned.emplace_back((rows.size()+1)*sizeof(uint));
+    uint * off = reinterpret_cast<uint*>(owned.back().data());
+    add(tag, off, sizeof(uint), rows.size()+1);
+
+    owned.emplace_back(n*sizeof(uint));
+    uint * ent = reinterpret_cast<uint*>(owned.back().data());
+    add(tag|BIN_CSR_ENTRIES, ent, sizeof(uint), n);
+
+    off[0] = 0;
+    for(size_t i=0; i<rows.size(); ++i)
+    {
+        if(!rows[i].empty()) memcpy(ent + off[i], rows[i].data(), rows[i].size()*sizeof(uint));
+        off[i+1] = off[i] + rows[i].size();
+    }
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void BinaryMeshWriter::add(const uint32_t tag, const std::vector<std::vector<bool>> & rows)
+{
+    size_t n = 0;
+    for(const auto & r : rows) n += r.size();
+    owned.emplace_back(n);
+    char * buf = owned.back().data();
+    for(const auto & r : rows) for(bool b : r) *buf++ = b ? 1 : 0;
+    add(tag, owned.back().data(), 1, n);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+bool BinaryMeshWriter::write(const char * filename) const
+{
+    FILE * f = fopen(filename, "wb");
+    if(!f)
+    {
+        std::cerr << "ERROR : " << __FILE__ << ", line " << __LINE__ << " : write_binary() : couldn't open output file " << filename << std::endl;
+        return false;
+    }
+
+    BinaryMeshHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, "CINOMESH", 8);
+    h.version      = BIN_MESH_VERSION;
+    h.endianness   = 0x01020304;
+    h.mesh_type    = mesh_type;
+    h.num_sections = sections.size();
+
+    auto align = [](const uint64_t pos) { return (pos + BIN_MESH_ALIGNMENT-1) / BIN_MESH_ALIGNMENT * BIN_MESH_ALIGNMENT; };
+
+    std::vector<BinaryMeshSection> table = sections;
+    uint64_t pos = align(sizeof(h) + table.size()*sizeof(BinaryMeshSection));
+    for(auto & s : table)
+    {
+        s.offset = pos;
+        pos = align(pos + s.count*s.elem_size);
+    }
+
+    bool ok = (fwrite(&h, sizeof(h), 1, f)==1);
+    if(!table.empty()) ok = ok && (fwrite(table.data(), sizeof(BinaryMeshSection), table.size(), f)==table.size());
+    pos = sizeof(h) + table.size()*sizeof(BinaryMeshSection);
+
+    const char zeros[BIN_MESH_ALIGNMENT] = {0};
+    for(size_t i=0; i<table.size() && ok; ++i)
+    {
+        const BinaryMeshSection & s = table.at(i);
+        ok = ok && (fwrite(zeros, 1, s.offset-pos, f)==s.offset-pos); // padding
+        size_t bytes = s.count*s.elem_size;
+        if(bytes>0) ok = ok && (fwrite(payload.at(i), 1, bytes, f)==bytes);
+        pos = s.offset + bytes;
+    }
+    fclose(f);
+
+    if(!ok) std::cerr << "ERROR : " << __FILE__ << ", line " << __LINE__ << " : write_binary() : failed writing " << filename << std::endl;
+    return ok;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+BinaryMeshReader::BinaryMeshReader(const char * filename) : file(filename)
+{
+    if(!file.is_open())
+    {
+        std::cerr << "ERROR : " << __FILE__ << ", line " << __LINE__ << " : read_binary() : couldn't open input file " << filename << std::endl;
+        return;
+    }
+
+    BinaryMeshHeader h;
+    if(file.size()<sizeof(h)) return;
+    memcpy(&h, file.begin(), sizeof(h));
+    if(memcmp(h.magic, "CINOMESH", 8)!=0)
+    {
+        std::cerr << "ERROR : " << __FILE__ << ", line " << __LINE__ << " : read_binary() : " << filename << " is not a CinoLib binary mesh" << std::endl;
+        return;
+    }
+    if(h.version>BIN_MESH_VERSION || h.endianness!=0x01020304)
+    {
+        std::cerr << "ERROR : " << __FILE__ << ", line " << __LINE__ << " : read_binary() : unsupported version or byte order in " << filename << std::endl;
+        return;
+    }
+
+    uint64_t table_end = sizeof(h) + uint64_t(h.num_sections)*sizeof(BinaryMeshSection);
+    if(table_end>file.size()) return;
+    sections.resize(h.num_sections);
+    if(h.num_sections>0) memcpy(sections.data(), file.begin()+sizeof(h), h.num_sections*sizeof(BinaryMeshSection));
+
+    // make sure no section points outside of the file (truncated or corrupted files)
+    for(const auto & s : sections)
+    {
+        if(s.offset<table_end || s.offset>file.size()) return;
+        if(s.elem_size>0 && s.count > (file.size()-s.offset)/s.elem_size) return;
+    }
+
+    type = h.mesh_type;
+    ok   = true;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+const BinaryMeshSection * BinaryMeshReader::section(const uint32_t tag) const
+{
+    if(!ok) return nullptr;
+    for(const auto & s : sections) if(s.tag==tag) return &s;
+    return nullptr;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+const BinaryMeshSection * BinaryMeshReader::section(const uint32_t tag, const uint32_t elem_size) const
+{
+    const BinaryMeshSection * s = section(tag);
+    if(s!=nullptr && s->elem_size!=elem_size)
+    {
+        std::cerr << "WARNING : read_binary() : section " << tag << " has unexpected element size, skipped" << std::endl;
+        return nullptr;
+    }
+    return s;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+bool BinaryMeshReader::read(const uint32_t tag, AdjacencyCSR & csr) const
+{
+    const BinaryMeshSection * off = section(tag, sizeof(uint));
+    const BinaryMeshSection * ent = section(tag|BIN_CSR_ENTRIES, sizeof(uint));
+    if(off==nullptr || ent==nullptr || off->count==0) return false;
+
+    AdjacencyCSR tmp;
+    read(tag,                 tmp.offsets);
+    read(tag|BIN_CSR_ENTRIES, tmp.entries);
+
+    // validate the offsets before trusting them
+    if(tmp.offsets.front()!=0 || tmp.offsets.back()!=tmp.entries.size()) return false;
+    for(size_t i=1; i<tmp.offsets.size(); ++i) if(tmp.offsets[i]<tmp.offsets[i-1]) return false;
+
+    std::swap(csr, tmp);
+    return true;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+bool BinaryMeshReader::read(const uint32_t tag, std::vector<std::vector<uint>> & rows) const
+{
+    AdjacencyCSR csr;
+    if(!read(tag, csr)) return false;
+    csr.unpack(rows);
+    return true;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+bool BinaryMeshReader::read(const uint32_t tag, const AdjacencyCSR & shape, std::vector<std::vector<bool>> & rows) const
+{
+    const BinaryMeshSection * s = section(tag, 1);
+    if(s==nullptr || s->count!=shape.num_entries()) return false;
+    const char * buf = data(s);
+    rows.resize(shape.num_rows());
+    for(uint i=0; i<shape.num_rows(); ++i)
+    {
+        rows[i].resize(shape.row_size(i));
+        for(uint j=0; j<rows[i].size(); ++j) rows[i][j] = (buf[shape.offsets[i]+j]!=0);
+    }
+    return true;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+bool BinaryMeshReader::ids_below(const std::vector<uint> & ids, const uint max_id)
+{
+    return std::all_of(ids.begin(), ids.end(), [max_id](const uint id){ return id<max_id; });
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+bool BinaryMeshReader::read(const uint32_t tag, std::vector<uint> & ids, const uint max_id) const
+{
+    std::vector<uint> tmp;
+    if(!read(tag, tmp) || !ids_below(tmp, max_id)) return false;
+    std::swap(ids, tmp);
+    return true;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+bool BinaryMeshReader::read(const uint32_t tag, AdjacencyCSR & csr, const uint max_id) const
+{
+    AdjacencyCSR tmp;
+    if(!read(tag, tmp) || !ids_below(tmp.entries, max_id)) return false;
+    std::swap(csr, tmp);
+    return true;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+bool BinaryMeshReader::read(const uint32_t tag, std::vector<std::vector<uint>> & rows, const uint max_id) const
+{
+    AdjacencyCSR csr;
+    if(!read(tag, csr, max_id)) return false;
+    csr.unpack(rows);
+    return true;
+}
+
+}
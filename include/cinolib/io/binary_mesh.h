@@ -0,0 +1,328 @@
+/********************************************************************************
+*  This file is part of CinoLib                                                 *
+*  Copyright(C) 2016: Marco Livesu                                              *
+*                                                                               *
+*  The MIT License                                                              *
+*                                                                               *
+*  Permission is hereby granted, free of charge, to any person obtaining a      *
+*  copy of this software and associated documentation files (the "Software"),   *
+*  to deal in the Software without restriction, including without limitation    *
+*  the rights to use, copy, modify, merge, publish, distribute, sublicense,     *
+*  and/or sell copies of the Software, and to permit persons to whom the        *
+*  Software is furnished to do so, subject to the following conditions:         *
+*                                                                               *
+*  The above copyright notice and this permission notice shall be included in   *
+*  all copies or substantial portions of the Software.                          *
+*                                                                               *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR   *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,     *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. IN NO EVENT SHALL THE *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER       *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      *
+*  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS *
+*  IN THE SOFTWARE.                                                             *
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Marco Livesu (marco.livesu@gmail.com)                                     *
+*     http://pers.ge.imati.cnr.it/livesu/                                       *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*********************************************************************************/
+#ifndef CINO_BINARY_MESH_H
+#define CINO_BINARY_MESH_H
+
+#include <cinolib/cino_inline.h>
+#include <cinolib/color.h>
+#include <cinolib/geometry/vec3.h>
+#include <cinolib/meshes/adjacency_csr.h>
+#include <cinolib/io/mapped_file.h>
+#include <cinolib/thread_pool.h>
+#include <bitset>
+#include <cstring>
+#include <deque>
+#include <stdint.h>
+#include <vector>
+
+namespace cinolib
+{
+
+/* Native binary container for CinoLib meshes (.cino files).
+ *
+ * The file starts with a fixed size header, followed by a table of sections.
+ * Each section is a flat array of fixed size elements (coordinates, CSR offsets
+ * and entries, per element attributes...) stored with the memory layout used by
+ * the mesh classes and aligned at 64 bytes, so that loading a mesh amounts to
+ * mapping the file and copying each section into its destination container. No
+ * text is parsed and, if adjacency tables were saved, no connectivity is derived.
+ *
+ * Sections are identified by a tag. Readers skip the tags they do not know and
+ * fall back to recomputing the data associated to missing tags, hence new
+ * sections can be added without breaking backward compatibility. Files are
+ * written in the byte order of the host, and refused if read on a machine with
+ * different endianness.
+ *
+ * Mesh classes expose this format through save_binary()/load_binary(), which are
+ * also invoked by save()/load() when the file extension is .cino
+*/
+
+enum
+{
+    // elements (CSR tables are stored as two sections: offsets with the table
+    // tag, entries with the table tag OR-ed with BIN_CSR_ENTRIES)
+    BIN_VERTS          = 0x0001, // vec3d per vert
+    BIN_EDGES          = 0x0002, // 2 uint per edge
+    BIN_POLYS          = 0x0003, // CSR
+    BIN_FACES          = 0x0004, // CSR (volume meshes only)
+    BIN_WINDING        = 0x0005, // 1 byte per poly face (volume meshes only)
+    BIN_POLY_TRIS      = 0x0006, // CSR, per poly triangulation (surface meshes only)
+    BIN_FACE_TRIS      = 0x0007, // CSR, per face triangulation (volume meshes only)
+    // adjacency (CSR)
+    BIN_V2V            = 0x0101,
+    BIN_V2E            = 0x0102,
+    BIN_V2F            = 0x0103,
+    BIN_V2P            = 0x0104,
+    BIN_E2F            = 0x0105,
+    BIN_E2P            = 0x0106,
+    BIN_F2E            = 0x0107,
+    BIN_F2F            = 0x0108,
+    BIN_F2P            = 0x0109,
+    BIN_P2V            = 0x010A,
+    BIN_P2E            = 0x010B,
+    BIN_P2P            = 0x010C,
+    // per element attributes
+    BIN_VERT_NORMAL    = 0x0201,
+    BIN_VERT_COLOR     = 0x0202,
+    BIN_VERT_UVW       = 0x0203,
+    BIN_VERT_LABEL     = 0x0204,
+    BIN_VERT_QUALITY   = 0x0205,
+    BIN_VERT_FLAGS     = 0x0206,
+    BIN_EDGE_COLOR     = 0x0302,
+    BIN_EDGE_LABEL     = 0x0304,
+    BIN_EDGE_FLAGS     = 0x0306,
+    BIN_FACE_NORMAL    = 0x0401,
+    BIN_FACE_COLOR     = 0x0402,
+    BIN_FACE_LABEL     = 0x0404,
+    BIN_FACE_QUALITY   = 0x0405,
+    BIN_FACE_FLAGS     = 0x0406,
+    BIN_FACE_AO        = 0x0407,
+    BIN_POLY_NORMAL    = 0x0501,
+    BIN_POLY_COLOR     = 0x0502,
+    BIN_POLY_LABEL     = 0x0504,
+    BIN_POLY_QUALITY   = 0x0505,
+    BIN_POLY_FLAGS     = 0x0506,
+    BIN_POLY_AO        = 0x0507,
+    //
+    BIN_CSR_ENTRIES    = 0x8000,
+};
+
+static const uint32_t BIN_MESH_VERSION   = 1;
+static const uint32_t BIN_MESH_ALIGNMENT = 64;
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+typedef struct
+{
+    char     magic[8];     // "CINOMESH"
+    uint32_t version;      // BIN_MESH_VERSION
+    uint32_t endianness;   // 0x01020304, as written by the host
+    uint32_t mesh_type;    // see MeshType
+    uint32_t num_sections; // entries in the section table that follows the header
+    uint64_t reserved;
+}
+BinaryMeshHeader;
+
+typedef struct
+{
+    uint32_t tag;       // see the BIN_* enum above
+    uint32_t elem_size; // bytes per element
+    uint64_t count;     // number of elements
+    uint64_t offset;    // position of the first byte of the section, from the beginning of the file
+}
+BinaryMeshSection;
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// Conversion of the attribute fields to/from their binary representation.
+// Attribute structs are user defined (see mesh_attributes.h), hence they
+// cannot be dumped as they are: each field is stored in its own section
+
+template<typename T> struct BinaryField {};
+
+template<> struct BinaryField<vec3d>
+{
+    static const uint32_t size = 3*sizeof(double);
+    static void encode(const vec3d & v, char * b) { double xyz[3] = { v.x(), v.y(), v.z() }; memcpy(b, xyz, size); }
+    static void decode(const char * b, vec3d & v) { double xyz[3]; memcpy(xyz, b, size); v = vec3d(xyz[0], xyz[1], xyz[2]); }
+};
+
+template<> struct BinaryField<Color>
+{
+    static const uint32_t size = 4*sizeof(float);
+    static void encode(const Color & c, char * b) { memcpy(b, c.rgba, size); }
+    static void decode(const char * b, Color & c) { memcpy(c.rgba, b, size); }
+};
+
+template<> struct BinaryField<int>
+{
+    static const uint32_t size = sizeof(int32_t);
+    static void encode(const int & i, char * b) { int32_t tmp = i; memcpy(b, &tmp, size); }
+    static void decode(const char * b, int & i) { int32_t tmp; memcpy(&tmp, b, size); i = tmp; }
+};
+
+template<> struct BinaryField<float>
+{
+    static const uint32_t size = sizeof(float);
+    static void encode(const float & f, char * b) { memcpy(b, &f, size); }
+    static void decode(const char * b, float & f) { memcpy(&f, b, size); }
+};
+
+template<> struct BinaryField<std::bitset<8>>
+{
+    static const uint32_t size = 1;
+    static void encode(const std::bitset<8> & f, char * b) { *b = static_cast<char>(f.to_ulong()); }
+    static void decode(const char * b, std::bitset<8> & f) { f = std::bitset<8>(static_cast<unsigned char>(*b)); }
+};
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+class BinaryMeshWriter
+{
+    public:
+
+        explicit BinaryMeshWriter(const uint32_t mesh_type) : mesh_type(mesh_type) {}
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        // data is NOT copied: it must stay alive (and unchanged) until write() is called
+        void add(const uint32_t tag, const void * data, const uint32_t elem_size, const uint64_t count);
+
+        template<typename T>
+        void add(const uint32_t tag, const std::vector<T> & v) { add(tag, v.data(), sizeof(T), v.size()); }
+
+        void add(const uint32_t tag, const AdjacencyCSR & csr);
+
+        // these are converted into an internal buffer, that is released by the writer
+        void add(const uint32_t tag, const std::vector<std::vector<uint>> & rows);
+        void add(const uint32_t tag, const std::vector<std::vector<bool>> & rows); // serialized, one byte per entry
+
+        template<class A, typename T>
+        void add_attribute(const uint32_t tag, const std::vector<A> & data, T A::*field);
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        bool write(const char * filename) const;
+
+    protected:
+
+        uint32_t                       mesh_type;
+        std::vector<BinaryMeshSection> sections;
+        std::vector<const char*>       payload; // one per section
+        std::deque<std::vector<char>>  owned;   // buffers created by the writer (deque: no reallocation)
+};
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+class BinaryMeshReader
+{
+    public:
+
+        explicit BinaryMeshReader(const char * filename);
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        bool     is_open()   const { return ok; }
+        uint32_t mesh_type() const { return type; }
+        bool     has(const uint32_t tag) const { return section(tag)!=nullptr; }
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        // all readers return false (leaving the output untouched) if the
+        // section does not exist or its element size does not match
+
+        template<typename T>
+        bool read(const uint32_t tag, std::vector<T> & v) const;
+
+        bool read(const uint32_t tag, AdjacencyCSR & csr) const;
+        bool read(const uint32_t tag, std::vector<std::vector<uint>> & rows) const;
+        bool read(const uint32_t tag, const AdjacencyCSR & shape, std::vector<std::vector<bool>> & rows) const;
+
+        // same as above, for sections that store element ids. Files in which any
+        // id is not lower than max_id (the number of elements it refers to) are
+        // considered corrupted, and rejected as if the section did not exist
+        bool read(const uint32_t tag, std::vector<uint>              & ids,  const uint max_id) const;
+        bool read(const uint32_t tag, AdjacencyCSR                   & csr,  const uint max_id) const;
+        bool read(const uint32_t tag, std::vector<std::vector<uint>> & rows, const uint max_id) const;
+
+        static bool ids_below(const std::vector<uint> & ids, const uint max_id);
+
+        // fills the given field of each element of data (data.size() must match the section size)
+        template<class A, typename T>
+        bool read_attribute(const uint32_t tag, std::vector<A> & data, T A::*field) const;
+
+    protected:
+
+        const BinaryMeshSection * section(const uint32_t tag) const;
+        const BinaryMeshSection * section(const uint32_t tag, const uint32_t elem_size) const;
+        const char              * data   (const BinaryMeshSection * s) const { return file.begin() + s->offset; }
+
+        MappedFile                     file;
+        bool                           ok   = false;
+        uint32_t                       type = 0;
+        std::vector<BinaryMeshSection> sections;
+};
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class A, typename T>
+CINO_INLINE
+void BinaryMeshWriter::add_attribute(const uint32_t tag, const std::vector<A> & data, T A::*field)
+{
+    const uint32_t size = BinaryField<T>::size;
+    owned.emplace_back(data.size()*size);
+    char * buf = owned.back().data();
+    for(size_t i=0; i<data.size(); ++i) BinaryField<T>::encode(data[i].*field, buf + i*size);
+    add(tag, buf, size, data.size());
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<typename T>
+CINO_INLINE
+bool BinaryMeshReader::read(const uint32_t tag, std::vector<T> & v) const
+{
+    const BinaryMeshSection * s = section(tag, sizeof(T));
+    if(s==nullptr) return false;
+    v.resize(s->count);
+    if(s->count>0) memcpy(v.data(), data(s), s->count*sizeof(T));
+    return true;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class A, typename T>
+CINO_INLINE
+bool BinaryMeshReader::read_attribute(const uint32_t tag, std::vector<A> & d, T A::*field) const
+{
+    const uint32_t size = BinaryField<T>::size;
+    const BinaryMeshSection * s = section(tag, size);
+    if(s==nullptr || s->count!=d.size()) return false;
+    const char * buf = data(s);
+    parallel_for(0, d.size(), [&](const uint i)
+    {
+        BinaryField<T>::decode(buf + size_t(i)*size, d[i].*field);
+    }, 4096);
+    return true;
+}
+
+}
+
+#ifndef  CINO_STATIC_LIB
+#include "binary_mesh.cpp"
+#endif
+
+#endif // CINO_BINARY_MESH_H
@@ -34,6 +34,13 @@
 *     Italy                                                                     *
 *********************************************************************************/
 #include <cinolib/io/io_utilities.h>
+#include <algorithm>
+#include <clocale>
+#include <cmath>
+#include <cstdlib>
+#include <locale>
+#include <sstream>
+#include <stdint.h>
 #include <string.h>
 
 namespace cinolib
@@ -108,4 +115,152 @@ bool eat_uint(FILE * f, uint & i)
     return true;
 }
 
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void skip_blanks(const char * & s, const char * end)
+{
+    while(s<end && (*s==' ' || *s=='\t' || *s=='\r')) ++s;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+const char * skip_line(const char * s, const char * end)
+{
+    const char * nl = static_cast<const char*>(memchr(s, '\n', end-s));
+    return (nl) ? nl+1 : end;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void split_in_lines(const char * beg, const char * end, const uint n_chunks, std::vector<const char*> & bounds)
+{
+    bounds.clear();
+    bounds.push_back(beg);
+    size_t n = end-beg;
+    for(uint i=1; i<n_chunks; ++i)
+    {
+        const char * s = beg + n*i/n_chunks;
+        if(s<=bounds.back()) continue;
+        if(s[-1]!='\n') s = skip_line(s, end);
+        if(s>bounds.back() && s<end) bounds.push_back(s);
+    }
+    bounds.push_back(end);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+bool parse_int(const char * & s, const char * end, int & i)
+{
+    const char * c = s;
+    skip_blanks(c, end);
+    bool neg = false;
+    if(c<end && (*c=='-' || *c=='+')) neg = (*c++=='-');
+    if(c==end || *c<'0' || *c>'9') return false;
+    long long v = 0;
+    while(c<end && *c>='0' && *c<='9') v = 10*v + (*c++ - '0');
+    i = int(neg ? -v : v);
+    s = c;
+    return true;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// Numbers with at most 15 significant digits and a small exponent (the vast majority
+// of numbers found in mesh files) are converted exactly with a single floating point
+// operation (Clinger's fast path). All other numbers are converted with strtod, or
+// with a stream in the classic "C" locale if "." is not the current decimal separator
+CINO_INLINE
+bool parse_double(const char * & s, const char * end, double & d)
+{
+    static const double pow10[] =
+    {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    const char * c = s;
+    skip_blanks(c, end);
+    const char * token = c;
+
+    bool neg = false;
+    if(c<end && (*c=='-' || *c=='+')) neg = (*c++=='-');
+
+    uint64_t mantissa = 0;
+    int      n_digits = 0; // significant digits in the mantissa
+    int      exp10    = 0;
+    bool     any      = false;
+    while(c<end && *c>='0' && *c<='9')
+    {
+        any = true;
+        if(n_digits<19) { mantissa = 10*mantissa + (*c-'0'); if(mantissa>0) ++n_digits; }
+        else ++exp10;
+        ++c;
+    }
+    if(c<end && *c=='.')
+    {
+        ++c;
+        while(c<end && *c>='0' && *c<='9')
+        {
+            any = true;
+            if(n_digits<19) { mantissa = 10*mantissa + (*c-'0'); if(mantissa>0) ++n_digits; --exp10; }
+            ++c;
+        }
+    }
+    if(!any)
+    {
+        if(c==end || (*c!='i' && *c!='I' && *c!='n' && *c!='N')) return false;
+        // inf, nan, hex floats... (rare in mesh files). The
+        // text is copied, as it may not be null terminated
+        char buf[64];
+        size_t n = std::min<size_t>(end-token, 63);
+        memcpy(buf, token, n);
+        buf[n] = '\0';
+        char * stop;
+        d = strtod(buf, &stop);
+        if(stop==buf) return false;
+        s = token + (stop-buf);
+        return true;
+    }
+    if(c<end && (*c=='e' || *c=='E'))
+    {
+        const char * e = c+1;
+        bool e_neg = false;
+        if(e<end && (*e=='-' || *e=='+')) e_neg = (*e++=='-');
+        if(e<end && *e>='0' && *e<='9')
+        {
+            int v = 0;
+            while(e<end && *e>='0' && *e<='9') { if(v<100000) v = 10*v + (*e-'0'); ++e; }
+            exp10 += e_neg ? -v : v;
+            c = e;
+        }
+    }
+
+    if(n_digits<=15 && exp10>=-22 && exp10<=22)
+    {
+        d = double(mantissa);
+        d = (exp10<0) ? d/pow10[-exp10] : d*pow10[exp10];
+        if(neg) d = -d;
+    }
+    else
+    {
+        std::string str(token, c);
+        if(*localeconv()->decimal_point=='.')
+        {
+            d = strtod(str.c_str(), nullptr);
+        }
+        else
+        {
+            std::istringstream ss(str);
+            ss.imbue(std::locale::classic());
+            ss >> d;
+        }
+    }
+    s = c;
+    return true;
+}
+
 }
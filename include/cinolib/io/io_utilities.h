@@ -37,6 +37,8 @@
 #define CINO_IO_UTILITIES_H
 
 #include <iostream>
+#include <vector>
+#include <sys/types.h>
 #include <cinolib/cino_inline.h>
 
 namespace cinolib
@@ -72,6 +74,35 @@ bool eat_uint(FILE * f, uint & i);
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
+// Locale independent parsers for text stored in memory (e.g. a MappedFile).
+// They skip leading blanks (spaces, tabs and carriage returns, not newlines),
+// parse the number starting at s and move s past it. If there is no number
+// they return false, leaving s unchanged
+
+CINO_INLINE
+bool parse_double(const char * & s, const char * end, double & d);
+
+CINO_INLINE
+bool parse_int(const char * & s, const char * end, int & i);
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void skip_blanks(const char * & s, const char * end);
+
+// returns the first character of the line following the one containing s
+CINO_INLINE
+const char * skip_line(const char * s, const char * end);
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// splits [beg,end) in at most n_chunks ranges of similar size, all starting at the beginning
+// of a line. Ranges are [bounds[i], bounds[i+1]), with bounds.front()=beg and bounds.back()=end
+CINO_INLINE
+void split_in_lines(const char * beg, const char * end, const uint n_chunks, std::vector<const char*> & bounds);
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
 }
 
 #ifndef  CINO_STATIC_LIB
@@ -0,0 +1,84 @@
+/********************************************************************************
+*  This file is part of CinoLib                                                 *
+*  Copyright(C) 2016: Marco Livesu                                              *
+*                                                                               *
+*  The MIT License                                                              *
+*                                                                               *
+*  Permission is hereby granted, free of charge, to any person obtaining a      *
+*  copy of this software and associated documentation files (the "Software"),   *
+*  to deal in the Software without restriction, including without limitation    *
+*  the rights to use, copy, modify, merge, publish, distribute, sublicense,     *
+*  and/or sell copies of the Software, and to permit persons to whom the        *
+*  Software is furnished to do so, subject to the following conditions:         *
+*                                                                               *
+*  The above copyright notice and this permission notice shall be included in   *
+*  all copies or substantial portions of the Software.                          *
+*                                                                               *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR   *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,     *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. IN NO EVENT SHALL THE *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER       *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      *
+*  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS *
+*  IN THE SOFTWARE.                                                             *
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Marco Livesu (marco.livesu@gmail.com)                                     *
+*     http://pers.ge.imati.cnr.it/livesu/                                       *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*********************************************************************************/
+#ifndef CINO_MAPPED_FILE_H
+#define CINO_MAPPED_FILE_H
+
+#include <cinolib/cino_inline.h>
+#include <stddef.h>
+#include <vector>
+
+namespace cinolib
+{
+
+/* Read-only view of the content of a file. On POSIX systems the file is
+ * memory mapped (no copy, pages are loaded by the OS on demand), on other
+ * systems (or if mmap fails) it is read in memory with a single fread.
+ * The content is released when the object is destroyed.
+*/
+
+class MappedFile
+{
+    public:
+
+        explicit MappedFile(const char * filename);
+        ~MappedFile();
+
+        MappedFile(const MappedFile &) = delete;
+        MappedFile & operator=(const MappedFile &) = delete;
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        bool         is_open() const { return ok;   }
+        const char * begin()   const { return ptr;  }
+        const char * end()     const { return ptr + bytes; }
+        size_t       size()    const { return bytes; }
+
+    protected:
+
+        bool              ok     = false;
+        const char      * ptr    = nullptr;
+        size_t            bytes  = 0;
+        bool              mapped = false;
+        std::vector<char> buffer; // used only if the file is not mapped
+};
+
+}
+
+#ifndef  CINO_STATIC_LIB
+#include "mapped_file.cpp"
+#endif
+
+#endif // CINO_MAPPED_FILE_H
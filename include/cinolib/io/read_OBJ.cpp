@@ -42,8 +42,12 @@
 *     Italy                                                                     *
 *********************************************************************************/
 #include <cinolib/io/read_OBJ.h>
+#include <cinolib/io/io_utilities.h>
+#include <cinolib/io/mapped_file.h>
 #include <cinolib/to_openGL_unified_verts.h>
 #include <cinolib/string_utilities.h>
+#include <cinolib/thread_pool.h>
+#include <algorithm>
 #include <sstream>
 #include <string.h>
 #include <iostream>
@@ -54,16 +58,152 @@ namespace cinolib
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
-// https://stackoverflow.com/questions/9310327/sscanf-optional-column
-//
+// chunk of an OBJ file, parsed independently from the others. Polygons are stored
+// in flat arrays (corner ids + number of corners per polygon). Corners given with
+// negative (i.e. relative) ids are listed in rel_*, as they must be shifted by the
+// number of elements defined in the previous chunks. Material related lines are
+// stored as they are, and processed sequentially after parsing
+typedef struct
+{
+    std::vector<vec3d> pos, tex, nor;
+    std::vector<uint>  poly_pos,  poly_tex,  poly_nor;
+    std::vector<uint>  n_pos,     n_tex,     n_nor;
+    std::vector<uint>  rel_pos,   rel_tex,   rel_nor;
+    std::vector<std::pair<uint,const char*>> mtl_lines; // (#polys before the line, line)
+}
+OBJChunk;
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// parses a corner of a face, in one of the forms v, v/vt, v//vn, v/vt/vn
+// ids are 1-based (or negative if relative), 0 means that the id is missing
 CINO_INLINE
-void read_point_id(char * s, int & v, int & vt, int & vn)
+bool read_OBJ_corner(const char * & s, const char * end, int & v, int & vt, int & vn)
 {
-    v = vt = vn = -1;
-         if(sscanf(s, "%d/%d/%d", &v, &vt, &vn) == 3) { --v; --vt; --vn; }
-    else if(sscanf(s, "%d/%d",    &v, &vt     ) == 2) { --v; --vt;       }
-    else if(sscanf(s, "%d//%d",   &v, &vn     ) == 2) { --v; --vn;       }
-    else if(sscanf(s, "%d",       &v          ) == 1) { --v;             }
+    v = vt = vn = 0;
+    if(!parse_int(s, end, v)) return false;
+    if(s<end && *s=='/')
+    {
+        ++s;
+        if(s<end && *s!='/') parse_int(s, end, vt);
+        if(s<end && *s=='/')
+        {
+            ++s;
+            parse_int(s, end, vn);
+        }
+    }
+    while(s<end && *s!=' ' && *s!='\t' && *s!='\r' && *s!='\n') ++s; // skip garbage, if any
+    return true;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void read_OBJ_chunk(const char * beg, const char * end, OBJChunk & chunk)
+{
+    // converts a (1-based or relative) OBJ id into a 0-based id
+    auto push_id = [](const int id, const uint count, std::vector<uint> & ids, std::vector<uint> & rel)
+    {
+        if(id>0) ids.push_back(id-1);
+        else
+        {
+            rel.push_back(ids.size());
+            ids.push_back(uint(int(count)+id));
+        }
+    };
+
+    const char * s = beg;
+    while(s<end)
+    {
+        const char * line = s;
+        skip_blanks(s, end);
+        if(s+1<end && s[0]=='v')
+        {
+            double xyz[3] = { 0, 0, 0 };
+            int    n      = 0;
+            switch(s[1])
+            {
+                case ' ' :
+                case '\t':
+                {
+                    s += 1;
+                    while(n<3 && parse_double(s, end, xyz[n])) ++n;
+                    if(n==3) chunk.pos.push_back(vec3d(xyz[0], xyz[1], xyz[2]));
+                    break;
+                }
+                case 't':
+                {
+                    s += 2;
+                    while(n<3 && parse_double(s, end, xyz[n])) ++n;
+                    if(n>=2) chunk.tex.push_back(vec3d(xyz[0], xyz[1], xyz[2]));
+                    break;
+                }
+                case 'n':
+                {
+                    s += 2;
+                    while(n<3 && parse_double(s, end, xyz[n])) ++n;
+                    if(n==3) chunk.nor.push_back(vec3d(xyz[0], xyz[1], xyz[2]));
+                    break;
+                }
+            }
+        }
+        else if(s+1<end && s[0]=='f' && (s[1]==' ' || s[1]=='\t'))
+        {
+            s += 1;
+            uint n_pos = 0, n_tex = 0, n_nor = 0;
+            int  v, vt, vn;
+            while(read_OBJ_corner(s, end, v, vt, vn))
+            {
+                if(v !=0) { push_id(v,  chunk.pos.size(), chunk.poly_pos, chunk.rel_pos); ++n_pos; }
+                if(vt!=0) { push_id(vt, chunk.tex.size(), chunk.poly_tex, chunk.rel_tex); ++n_tex; }
+                if(vn!=0) { push_id(vn, chunk.nor.size(), chunk.poly_nor, chunk.rel_nor); ++n_nor; }
+            }
+            if(n_pos>0) chunk.n_pos.push_back(n_pos);
+            if(n_tex>0) chunk.n_tex.push_back(n_tex);
+            if(n_nor>0) chunk.n_nor.push_back(n_nor);
+        }
+        else if(s<end && (s[0]=='u' || s[0]=='m'))
+        {
+            chunk.mtl_lines.push_back(std::make_pair(uint(chunk.n_pos.size()), line));
+        }
+        s = skip_line(s, end);
+    }
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// moves the polygons of each chunk (stored as flat arrays) into polys,
+// shifting relative ids by the number of elements in previous chunks
+CINO_INLINE
+void read_OBJ_merge_polys(std::vector<OBJChunk>          & chunks,
+                          std::vector<uint>  OBJChunk::* ids,
+                          std::vector<uint>  OBJChunk::* sizes,
+                          std::vector<uint>  OBJChunk::* rel,
+                          std::vector<vec3d> OBJChunk::* elems,
+                          std::vector<std::vector<uint>> & polys)
+{
+    std::vector<uint> poly_offset(chunks.size()+1, 0);
+    std::vector<uint> elem_offset(chunks.size()+1, 0);
+    for(uint i=0; i<chunks.size(); ++i)
+    {
+        poly_offset[i+1] = poly_offset[i] + (chunks[i].*sizes).size();
+        elem_offset[i+1] = elem_offset[i] + (chunks[i].*elems).size();
+    }
+    polys.resize(poly_offset.back());
+
+    global_thread_pool().run(chunks.size(), [&](const uint i, const uint)
+    {
+        OBJChunk & c = chunks[i];
+        for(uint j : c.*rel) (c.*ids)[j] += elem_offset[i];
+        uint k = 0;
+        for(uint j=0; j<(c.*sizes).size(); ++j)
+        {
+            uint n = (c.*sizes)[j];
+            polys[poly_offset[i]+j].assign((c.*ids).begin()+k, (c.*ids).begin()+k+n);
+            k += n;
+        }
+        std::vector<uint>().swap(c.*ids);
+    });
 }
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
@@ -113,8 +253,6 @@ void read_OBJ(const char                     * filename,
               std::string                    & specular_path, // path of the image encoding the specular texture component
               std::string                    & normal_path)   // path of the image encoding the normal   texture component
 {
-    setlocale(LC_NUMERIC, "en_US.UTF-8"); // makes sure "." is the decimal separator
-
     pos.clear();
     tex.clear();
     nor.clear();
@@ -126,90 +264,82 @@ void read_OBJ(const char                     * filename,
     specular_path.clear();
     normal_path.clear();
 
-    FILE *f = fopen(filename, "r");
+    MappedFile f(filename);
 
-    if(!f)
+    if(!f.is_open())
     {
         std::cerr << "ERROR : " << __FILE__ << ", line " << __LINE__ << " : read_OBJ() : couldn't open input file " << filename << std::endl;
         exit(-1);
     }
 
+    // the file is split in line aligned chunks, which are parsed in parallel
+    // (if the global thread pool has more than one thread) and then merged
+    uint n_chunks = (get_num_threads()>1 && f.size()>(1<<20)) ? 4*get_num_threads() : 1;
+    std::vector<const char*> bounds;
+    split_in_lines(f.begin(), f.end(), n_chunks, bounds);
+    std::vector<OBJChunk> chunks(bounds.size()-1);
+    global_thread_pool().run(chunks.size(), [&](const uint i, const uint)
+    {
+        read_OBJ_chunk(bounds[i], bounds[i+1], chunks[i]);
+    });
+
+    std::vector<uint> pos_offset(chunks.size()+1, 0);
+    std::vector<uint> tex_offset(chunks.size()+1, 0);
+    std::vector<uint> nor_offset(chunks.size()+1, 0);
+    for(uint i=0; i<chunks.size(); ++i)
+    {
+        pos_offset[i+1] = pos_offset[i] + chunks[i].pos.size();
+        tex_offset[i+1] = tex_offset[i] + chunks[i].tex.size();
+        nor_offset[i+1] = nor_offset[i] + chunks[i].nor.size();
+    }
+    pos.resize(pos_offset.back());
+    tex.resize(tex_offset.back());
+    nor.resize(nor_offset.back());
+    global_thread_pool().run(chunks.size(), [&](const uint i, const uint)
+    {
+        std::copy(chunks[i].pos.begin(), chunks[i].pos.end(), pos.begin()+pos_offset[i]);
+        std::copy(chunks[i].tex.begin(), chunks[i].tex.end(), tex.begin()+tex_offset[i]);
+        std::copy(chunks[i].nor.begin(), chunks[i].nor.end(), nor.begin()+nor_offset[i]);
+    });
+
+    read_OBJ_merge_polys(chunks, &OBJChunk::poly_pos, &OBJChunk::n_pos, &OBJChunk::rel_pos, &OBJChunk::pos, poly_pos);
+    read_OBJ_merge_polys(chunks, &OBJChunk::poly_tex, &OBJChunk::n_tex, &OBJChunk::rel_tex, &OBJChunk::tex, poly_tex);
+    read_OBJ_merge_polys(chunks, &OBJChunk::poly_nor, &OBJChunk::n_nor, &OBJChunk::rel_nor, &OBJChunk::nor, poly_nor);
+
+    // materials are processed sequentially, in the order they appear in the file
     std::map<std::string,Color> color_map;
     Color curr_color = Color::WHITE();     // set WHITE as default color
     bool has_per_face_color = false;       // true if a mtllib is found. If "has_per_face_color" stays
                                            // false the "poly_color" vector will be emptied before returning.
-    char line[1024];
-    while(fgets(line, 1024, f))
+    uint first_poly = 0;
+    for(const OBJChunk & c : chunks)
     {
-        switch(line[0])
+        for(const auto & l : c.mtl_lines)
         {
-            case 'v':
-            {
-                // http://stackoverflow.com/questions/16839658/printf-width-specifier-to-maintain-precision-of-floating-point-value
-                //
-                double a, b, c;
-                     if(sscanf(line, "v  %lf %lf %lf", &a, &b, &c) == 3) pos.push_back(vec3d(a,b,c));
-                else if(sscanf(line, "vt %lf %lf %lf", &a, &b, &c) == 3) tex.push_back(vec3d(a,b,c));
-                else if(sscanf(line, "vt %lf %lf %lf", &a, &b, &c) == 2) tex.push_back(vec3d(a,b,0));
-                else if(sscanf(line, "vn %lf %lf %lf", &a, &b, &c) == 3) nor.push_back(vec3d(a,b,c));
-                break;
-            }
-
-            case 'f':
-            {
-                std::string s(line);
-                s = s.substr(1,s.size()-1); // discard the 'f' letter
-                std::istringstream ss(s);
-                std::vector<uint> p_pos, p_tex, p_nor;
-                for(std::string sub_str; ss >> sub_str;)
-                {
-                    int v_pos, v_tex, v_nor;
-                    read_point_id(strdup(sub_str.c_str()), v_pos, v_tex, v_nor);
-                    if (v_pos >= 0) p_pos.push_back(v_pos);
-                    if (v_tex >= 0) p_tex.push_back(v_tex);
-                    if (v_nor >= 0) p_nor.push_back(v_nor);
-                }
-                if (!p_tex.empty()) poly_tex.push_back(p_tex);
-                if (!p_nor.empty()) poly_nor.push_back(p_nor);
-                if (!p_pos.empty())
-                {
-                    poly_pos.push_back(p_pos);
-                    poly_col.push_back(curr_color);
-                }
-                break;
-            }
-
-            case 'u':
+            poly_col.resize(first_poly + l.first, curr_color);
+            std::string line(l.second, skip_line(l.second, f.end()));
+            char buf[1024];
+            if (sscanf(line.c_str(), " usemtl %1023s", buf) == 1)
             {
-                char mat_c[1024];
-                if (sscanf(line, "usemtl %s", mat_c) == 1)
+                auto query = color_map.find(std::string(buf));
+                if (query != color_map.end())
                 {
-                    auto query = color_map.find(std::string(mat_c));
-                    if (query != color_map.end())
-                    {
-                        curr_color = query->second;
-                    }
-                    else std::cerr << "WARNING: could not find material: " << mat_c << std::endl;
+                    curr_color = query->second;
                 }
-                break;
+                else std::cerr << "WARNING: could not find material: " << buf << std::endl;
             }
-
-            case 'm':
+            else if (sscanf(line.c_str(), " mtllib %1023[^\r\n]", buf) == 1)
             {
-                char mtu_c[1024];
-                if (sscanf(line, "mtllib %[^\n]s", mtu_c) == 1)
-                {
-                    std::string s0(filename);
-                    std::string s1(mtu_c);
-                    std::string s2 = get_file_path(s0) + get_file_name(s1);
-                    read_MTU(s2.c_str(), color_map, diffuse_path, specular_path, normal_path);
-                    has_per_face_color = true;
-                }
-                break;
+                std::string s0(filename);
+                std::string s1(buf);
+                std::string s2 = get_file_path(s0) + get_file_name(s1);
+                read_MTU(s2.c_str(), color_map, diffuse_path, specular_path, normal_path);
+                has_per_face_color = true;
             }
         }
+        first_poly += c.n_pos.size();
     }
-    fclose(f);
+    poly_col.resize(poly_pos.size(), curr_color);
     if (!has_per_face_color) poly_col.clear();
 }
 
@@ -34,9 +34,14 @@
 *     Italy                                                                     *
 *********************************************************************************/
 #include <cinolib/io/read_OFF.h>
+#include <cinolib/io/io_utilities.h>
+#include <cinolib/io/mapped_file.h>
+#include <cinolib/thread_pool.h>
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <iostream>
 #include <string>
-#include <sstream>
-#include <fstream>
 #include <stdio.h>
 
 namespace cinolib
@@ -53,6 +58,43 @@ void read_OFF(const char                     * filename,
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
+// chunk of the body of an OFF file (i.e. the lists of vertices and polygons), parsed
+// independently from the others. The file is only tokenized here: for each non empty
+// line, all its leading numbers are stored. Whether a line is a vertex or a polygon
+// can only be decided after parsing, when the number of lines in previous chunks is known
+typedef struct
+{
+    std::vector<double> values;
+    std::vector<uint>   line_size;  // number of values in each line
+    // state at the beginning of the chunk (set after parsing)
+    uint n_verts  = 0;
+    uint n_polys  = 0;
+    uint n_colors = 0;
+}
+OFFChunk;
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void read_OFF_chunk(const char * beg, const char * end, OFFChunk & chunk)
+{
+    const char * s = beg;
+    while(s<end)
+    {
+        uint   n = 0;
+        double d;
+        while(parse_double(s, end, d))
+        {
+            chunk.values.push_back(d);
+            ++n;
+        }
+        if(n>0) chunk.line_size.push_back(n);
+        s = skip_line(s, end);
+    }
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
 CINO_INLINE
 void read_OFF(const char                     * filename,
               std::vector<vec3d>             & verts,
@@ -63,68 +105,123 @@ void read_OFF(const char                     * filename,
     polys.clear();
     poly_colors.clear();
 
-    setlocale(LC_NUMERIC, "en_US.UTF-8"); // makes sure "." is the decimal separator
-
-    std::ifstream f(filename);
+    MappedFile f(filename);
     if(!f.is_open())
     {
         std::cerr << "ERROR : " << __FILE__ << ", line " << __LINE__ << " : read_OFF() : couldn't open input file " << filename << std::endl;
         exit(-1);
     }
 
-    std::string line;
-    uint        nv, np, ne;
-
     // read header and number of elements
-    do getline(f, line, '\n'); while(line.find("OFF")==std::string::npos);
-    do getline(f, line, '\n'); while(sscanf(line.c_str(), "%d %d %d\n", &nv, &np, &ne)!=3);
-
-    // read verts
-    for(uint i=0; i<nv; ++i)
+    const char * s = f.begin();
+    while(s<f.end())
     {
-        getline(f, line, '\n');
-        std::stringstream ss(line);
-
-        double x, y, z;
-        if(ss >> x >> y >> z)
+        std::string line(s, skip_line(s, f.end()));
+        s = skip_line(s, f.end());
+        if(line.find("OFF")!=std::string::npos) break;
+    }
+    int  counts[3]  = {0,0,0};
+    bool has_counts = false;
+    while(s<f.end())
+    {
+        const char * c = s;
+        s = skip_line(s, f.end());
+        if(parse_int(c, f.end(), counts[0]) &&
+           parse_int(c, f.end(), counts[1]) &&
+           parse_int(c, f.end(), counts[2]))
         {
-            verts.push_back(vec3d(x,y,z));
+            has_counts = true;
+            break;
         }
-        else --i;
     }
+    if(!has_counts || counts[0]<0 || counts[1]<0)
+    {
+        std::cerr << "ERROR : " << __FILE__ << ", line " << __LINE__ << " : read_OFF() : missing or invalid element counts in " << filename << std::endl;
+        exit(-1);
+    }
+    uint nv = counts[0];
+    uint np = counts[1];
 
-    // read polys
-    for(uint i=0; i<np; ++i)
+    // tokenize the rest of the file in parallel (if the global
+    // thread pool has more than one thread)
+    uint n_chunks = (get_num_threads()>1 && f.end()-s>(1<<20)) ? 4*get_num_threads() : 1;
+    std::vector<const char*> bounds;
+    split_in_lines(s, f.end(), n_chunks, bounds);
+    std::vector<OFFChunk> chunks(bounds.size()-1);
+    global_thread_pool().run(chunks.size(), [&](const uint i, const uint)
     {
-        getline(f, line, '\n');
-        std::stringstream ss(line);
+        read_OFF_chunk(bounds[i], bounds[i+1], chunks[i]);
+    });
 
-        uint n_corners;
-        if(ss >> n_corners)
+    // lines with at least three numbers are vertices (others are skipped), until
+    // nv vertices are found. Then, lines with at least one number are polygons:
+    // the number of corners, their ids and optionally a color (3 or 4 values).
+    // This pass only counts them, so that chunks can be converted in parallel
+    uint n_verts = 0, n_polys = 0, n_colors = 0;
+    for(OFFChunk & c : chunks)
+    {
+        c.n_verts  = n_verts;
+        c.n_polys  = n_polys;
+        c.n_colors = n_colors;
+        const double * val = c.values.data();
+        for(uint n : c.line_size)
         {
-            uint vid;
-            std::vector<uint> p;
-            for(uint j=0; j<n_corners; ++j)
+            if(n_verts<nv)
             {
-                ss >> vid;
-                p.push_back(vid);
+                if(n>=3) ++n_verts;
             }
-            polys.push_back(p);
-
-            float val;
-            std::vector<float> attr;
-            while(ss >> val) attr.push_back(val);
-
-            switch(attr.size())
+            else if(n_polys<np)
             {
-                case 1 : break; // TODO: READ LABEL (cast to int)!!!
-                case 3 : poly_colors.push_back(Color(attr.at(0), attr.at(1), attr.at(2))); break;
-                case 4 : poly_colors.push_back(Color(attr.at(0), attr.at(1), attr.at(2), attr.at(3))); break;
-                default: break;
+                // the corner count is converted to uint below: make sure it is a non negative integer
+                if(!(val[0]>=0) || val[0]>double(UINT_MAX) || val[0]!=std::floor(val[0]))
+                {
+                    std::cerr << "ERROR : " << __FILE__ << ", line " << __LINE__ << " : read_OFF() : invalid corner count (" << val[0] << ") in " << filename << std::endl;
+                    exit(-1);
+                }
+                ++n_polys;
+                uint n_attr = n - std::min(n, 1+uint(val[0]));
+                if(n_attr==3 || n_attr==4) ++n_colors;
             }
+            val += n;
         }
-        else --i;
     }
+
+    verts.resize(n_verts);
+    polys.resize(n_polys);
+    poly_colors.resize(n_colors);
+    global_thread_pool().run(chunks.size(), [&](const uint i, const uint)
+    {
+        OFFChunk & c = chunks[i];
+        uint vid = c.n_verts;
+        uint pid = c.n_polys;
+        uint cid = c.n_colors;
+        const double * val = c.values.data();
+        for(uint n : c.line_size)
+        {
+            if(vid<nv)
+            {
+                if(n>=3) verts[vid++] = vec3d(val[0], val[1], val[2]);
+            }
+            else if(pid<np)
+            {
+                uint n_corners = std::min(n-1, uint(val[0]));
+                polys[pid].resize(n_corners);
+                for(uint j=0; j<n_corners; ++j) polys[pid][j] = uint(val[1+j]);
+                ++pid;
+
+                const double * attr = val + 1 + n_corners;
+                switch(n - 1 - n_corners)
+                {
+                    case 1 : break; // TODO: READ LABEL (cast to int)!!!
+                    case 3 : poly_colors[cid++] = Color(float(attr[0]), float(attr[1]), float(attr[2])); break;
+                    case 4 : poly_colors[cid++] = Color(float(attr[0]), float(attr[1]), float(attr[2]), float(attr[3])); break;
+                    default: break;
+                }
+            }
+            val += n;
+        }
+        std::vector<double>().swap(c.values);
+    });
 }
 
 }
@@ -43,7 +43,10 @@
 *********************************************************************************/
 #include <cinolib/io/read_STL.h>
 #include <cinolib/io/io_utilities.h>
-#include <map>
+#include <cinolib/io/mapped_file.h>
+#include <cinolib/weld_vertices.h>
+#include <cinolib/thread_pool.h>
+#include <cstring>
 
 namespace cinolib
 {
@@ -80,7 +83,8 @@ void read_STL(const char         * filename,
         exit(-1);
     }
 
-    std::map<vec3d,uint> vmap;
+    // triangle corners, welded at the end
+    std::vector<vec3d> corners;
 
     if(seek_keyword(fp, "solid")) // ASCII file
     {
@@ -102,69 +106,44 @@ void read_STL(const char         * filename,
                 if(!eat_double(fp, v.x())) assert(false && "could not parse x coord");
                 if(!eat_double(fp, v.y())) assert(false && "could not parse y coord");
                 if(!eat_double(fp, v.z())) assert(false && "could not parse z coord");
-
-                auto it = vmap.find(v);
-                if(it == vmap.end())
-                {
-                    uint fresh_id = vmap.size();
-                    vmap[v] = fresh_id;
-                    verts.push_back(v);
-                    tris.push_back(fresh_id);
-                }
-                else tris.push_back(it->second);
+                corners.push_back(v);
             }
             if(!seek_keyword(fp, "endloop"))  assert(false && "could not find keyword ENDLOOP");
             if(!seek_keyword(fp, "endfacet")) assert(false && "could not find keyword ENDFACET");
         }
-        fclose(fp);
     }
+    fclose(fp);
 
-    if(tris.empty()) // BINARY file
+    if(corners.empty()) // BINARY file
     {
-        // close file in ASCII mode and reopen it in binary mode
-        fclose(fp);
-        FILE *fp = fopen(filename, "rb");
-        assert(fp!=NULL);
-
-        // read header
-        char header[80];
-        if(fread(header, 1, 80, fp)!=80) assert(false && "error reading STL binary header");
-
-        // read triangles
-        unsigned int nt;
-        if(fread(&nt, sizeof(unsigned int), 1, fp)!=1) assert(false && "error reading number of triangles");
-        for(unsigned int i=0; i<nt; ++i)
+        // 80 bytes header, number of triangles, and then 50 bytes per triangle:
+        // normal and verts (12 floats) plus a 2 bytes attribute (discarded)
+        MappedFile f(filename);
+        assert(f.is_open());
+
+        uint32_t nt = 0;
+        if(f.size()>=84) std::memcpy(&nt, f.begin()+80, sizeof(uint32_t));
+        if(f.size()<84 || f.size()<84+50*uint64_t(nt))
         {
-            // read normal
-            float nf[3];
-            if(fread(&nf, sizeof(float), 3, fp)!=3) assert(false && "error reading normal");
-            vec3d n(nf[0], nf[1], nf[2]);
-            normals.push_back(n);
-
-            // read verts
-            for(int j=0; j<3; ++j)
-            {
-                float vf[3];
-                if(fread(&vf, sizeof(float), 3, fp)!=3) assert(false && "error reading vertex");
-
-                vec3d v(vf[0], vf[1], vf[2]);
-                auto it = vmap.find(v);
-                if(it == vmap.end())
-                {
-                    uint fresh_id = vmap.size();
-                    vmap[v] = fresh_id;
-                    verts.push_back(v);
-                    tris.push_back(fresh_id);
-                }
-                else tris.push_back(it->second);
-            }
-
-            // read (and discard) attribute
-            unsigned short attribute;
-            if(fread(&attribute, sizeof(unsigned short), 1, fp)!=1) assert(false && "error reading attribute");
+            std::cerr << "ERROR : " << __FILE__ << ", line " << __LINE__ << " : load_STL() : truncated binary file " << filename << std::endl;
+            normals.clear();
+            return;
         }
-        fclose(fp);
+
+        normals.resize(nt);
+        corners.resize(3*nt);
+        const char * body = f.begin() + 84;
+        parallel_for(0, nt, [&](const uint i)
+        {
+            float xyz[12];
+            std::memcpy(xyz, body + 50*uint64_t(i), 12*sizeof(float));
+            normals[i] = vec3d(xyz[0], xyz[1], xyz[2]);
+            for(int j=0; j<3; ++j) corners[3*i+j] = vec3d(xyz[3+3*j], xyz[4+3*j], xyz[5+3*j]);
+        });
     }
+
+    // merge coincident corners (verts are sorted by first appearance)
+    weld_vertices(corners, verts, tris);
 }
 
 }
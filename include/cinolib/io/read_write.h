@@ -64,6 +64,10 @@
 #include <cinolib/io/write_VTK.h>
 
 
+// NATIVE BINARY FORMAT (all mesh types)
+#include <cinolib/io/binary_mesh.h>
+
+
 // SKELETON READERS
 #include <cinolib/io/read_LIVESU2012.h>
 #include <cinolib/io/read_TAGLIASACCHI2012.h>
@@ -35,7 +35,9 @@
 *********************************************************************************/
 #include <cinolib/laplacian.h>
 #include <cinolib/symbols.h>
+#include <cinolib/thread_pool.h>
 #include <Eigen/Sparse>
+#include <atomic>
 
 namespace cinolib
 {
@@ -87,13 +89,78 @@ template<class M, class V, class E, class P>
 CINO_INLINE
 Eigen::SparseMatrix<double> laplacian(const AbstractMesh<M,V,E,P> & m, const int mode, const int n)
 {
-    std::vector<Entry> entries = laplacian_matrix_entries(m, mode, n);
+    SparseAssembler L;
+    laplacian_pattern(m, L, n);
+    laplacian_update(m, mode, L);
+    return L.matrix();
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class M, class V, class E, class P>
+CINO_INLINE
+void laplacian_pattern(const AbstractMesh<M,V,E,P> & m, SparseAssembler & L, const int n)
+{
+    assert(n>0);
+    uint nv = m.num_verts();
 
-    uint nv = n*m.num_verts();
-    Eigen::SparseMatrix<double> L(nv,nv);
-    L.setFromTriplets(entries.begin(), entries.end());
+    // row vid contains the vertex itself and its one ring (replicated in each diagonal block)
+    AdjacencyCSR rows;
+    rows.offsets.resize(n*nv+1);
+    rows.offsets.front() = 0;
+    rows.entries.reserve(n*(nv + 2*m.num_edges()));
+    for(int i=0; i<n; ++i)
+    {
+        uint base = nv*i;
+        for(uint vid=0; vid<nv; ++vid)
+        {
+            rows.entries.push_back(base + vid);
+            for(uint nbr : m.adj_v2v_span(vid)) rows.entries.push_back(base + nbr);
+            rows.offsets.at(base+vid+1) = rows.entries.size();
+        }
+    }
+    L.init(n*nv, rows);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
-    return L;
+template<class M, class V, class E, class P>
+CINO_INLINE
+void laplacian_update(const AbstractMesh<M,V,E,P> & m, const int mode, SparseAssembler & L)
+{
+    uint nv = m.num_verts();
+    uint n  = (nv>0) ? L.num_rows()/nv : 0;
+    assert(n*nv == L.num_rows() && "Laplacian pattern does not match the mesh!");
+
+    std::atomic<uint> null_rows(0);
+    parallel_for_ranges(0, nv, [&](const uint beg, const uint end, const uint)
+    {
+        std::vector<std::pair<uint,double>> wgts;
+        for(uint vid=beg; vid<end; ++vid)
+        {
+            m.vert_weights(vid, mode, wgts);
+            double sum = 0.0;
+            for(auto item : wgts) sum -= item.second;
+            if(sum == 0.0)
+            {
+                ++null_rows;
+                sum = 1.0;
+            }
+            for(uint i=0; i<n; ++i)
+            {
+                uint base = nv*i;
+                uint row  = base + vid;
+                for(uint k=0; k<L.row_cols(row).size(); ++k) L.at_slot(row,k) = 0.0;
+                for(auto item : wgts) L.at(row, base + item.first) = item.second;
+                L.at(row,row) = sum;
+            }
+        }
+    }, 256);
+
+    if(null_rows>0)
+    {
+        std::cerr << "WARNING: " << null_rows << " null row(s) in the matrix! (disconnected vertex? I put 1 in the diagonal)" << std::endl;
+    }
 }
 
 }
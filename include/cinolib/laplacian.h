@@ -37,6 +37,7 @@
 #define CINO_LAPLACIAN_H
 
 #include <cinolib/meshes/abstract_mesh.h>
+#include <cinolib/sparse_assembler.h>
 #include <Eigen/Sparse>
 #include <vector>
 
@@ -65,6 +66,25 @@ CINO_INLINE
 std::vector<Eigen::Triplet<double>> laplacian_matrix_entries(const AbstractMesh<M,V,E,P> & m,
                                                              const int mode,
                                                              const int n);
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// Iterative methods (e.g. MCF) recompute the Laplacian many times on a mesh whose
+// connectivity never changes. In these cases, build the sparsity pattern once with
+// laplacian_pattern() and refresh the numerical values (in parallel) with laplacian_update().
+// L.matrix() is the very same matrix returned by laplacian(m,mode,n)
+
+template<class M, class V, class E, class P>
+CINO_INLINE
+void laplacian_pattern(const AbstractMesh<M,V,E,P> & m,
+                       SparseAssembler             & L,
+                       const int                     n = 1);
+
+template<class M, class V, class E, class P>
+CINO_INLINE
+void laplacian_update(const AbstractMesh<M,V,E,P> & m,
+                      const int                     mode,
+                      SparseAssembler             & L);
 }
 
 #ifndef  CINO_STATIC_LIB
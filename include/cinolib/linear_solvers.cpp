@@ -35,6 +35,10 @@
 *********************************************************************************/
 #include <cinolib/linear_solvers.h>
 #include <cinolib/stl_container_utilities.h>
+#include <cinolib/trace_profiler.h>
+#include <algorithm>
+#include <iostream>
+#include <limits>
 
 namespace cinolib
 {
@@ -44,133 +48,356 @@ typedef Eigen::Triplet<double> Entry;
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
 CINO_INLINE
-void solve_square_system(const Eigen::SparseMatrix<double> & A,
-                         const Eigen::VectorXd             & b,
-                               Eigen::VectorXd             & x,
-                         int   solver)
+LinearSolver::LinearSolver(const int solver) : type(solver)
+{
+    assert(solver == SIMPLICIAL_LLT || solver == SIMPLICIAL_LDLT || solver == SparseLU || solver == BiCGSTAB);
+    //bicgstab.setMaxIterations(100);
+    bicgstab.setTolerance(1e-5);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void LinearSolver::clear()
+{
+    factorized       = false;
+    n_analyses       = 0;
+    n_factorizations = 0;
+    pattern_rows     = -1;
+    pattern_cols     = -1;
+    full_size        = 0;
+    std::vector<int>().swap(pattern_outer);
+    std::vector<int>().swap(pattern_inner);
+    std::vector<int>().swap(col_map);
+    std::vector<uint>().swap(bc_ids);
+    bc_vals.resize(0);
+    A_bc   = Eigen::SparseMatrix<double>();
+    A_free = Eigen::SparseMatrix<double>();
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+bool LinearSolver::factorize(const Eigen::SparseMatrix<double> & A)
 {
     assert(A.rows() == A.cols());
 
-    switch (solver)
+    full_size = A.rows();
+    col_map.clear();
+    bc_ids.clear();
+    bc_vals.resize(0);
+    A_bc.resize(0,0);
+
+    if(A.isCompressed())
+    {
+        A_free = Eigen::SparseMatrix<double>();
+        return factorize_reduced(A);
+    }
+    A_free = A;
+    A_free.makeCompressed();
+    return factorize_reduced(A_free);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+bool LinearSolver::factorize(const Eigen::SparseMatrix<double> & A,
+                             const std::map<uint,double>       & bc)
+{
+    assert(A.rows() == A.cols());
+
+    full_size = A.rows();
+    col_map.assign(full_size, 0);
+    bc_ids.clear();
+    bc_vals.resize(bc.size());
+    for(auto obj : bc)
+    {
+        assert(obj.first < full_size);
+        col_map.at(obj.first) = -1 - (int)bc_ids.size();
+        bc_vals[bc_ids.size()] = obj.second;
+        bc_ids.push_back(obj.first);
+    }
+    int fresh_id = 0;
+    for(Eigen::Index col=0; col<full_size; ++col)
+    {
+        if(col_map.at(col)>=0) col_map.at(col) = fresh_id++;
+    }
+
+    // split A into the free block and the block that couples
+    // free and constrained variables (which goes in the rhs).
+    // Columns are visited in order and the row map is monotone,
+    // hence both blocks can be filled directly in compressed form
+    A_free.resize(fresh_id, fresh_id);
+    A_bc.resize(fresh_id, bc_ids.size());
+    A_free.reserve(A.nonZeros());
+    A_bc.reserve(A.nonZeros());
+    for(Eigen::Index col=0; col<full_size; ++col)
+    {
+        int c = col_map.at(col);
+        Eigen::SparseMatrix<double> & block = (c>=0) ? A_free : A_bc;
+        if(c<0) c = -1-c;
+        block.startVec(c);
+        for(Eigen::SparseMatrix<double>::InnerIterator it(A,col); it; ++it)
+        {
+            int r = col_map.at(it.row());
+            if(r>=0) block.insertBack(r,c) = it.value();
+        }
+    }
+    A_free.finalize();
+    A_bc.finalize();
+
+    return factorize_reduced(A_free);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+bool LinearSolver::same_pattern(const Eigen::SparseMatrix<double> & A) const
+{
+    assert(A.isCompressed());
+    if(A.rows()!=pattern_rows || A.cols()!=pattern_cols) return false;
+    if((Eigen::Index)pattern_inner.size()!=A.nonZeros()) return false;
+    return std::equal(pattern_outer.begin(), pattern_outer.end(), A.outerIndexPtr()) &&
+           std::equal(pattern_inner.begin(), pattern_inner.end(), A.innerIndexPtr());
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+bool LinearSolver::factorize_reduced(const Eigen::SparseMatrix<double> & A)
+{
+    CINO_PROFILE_ZONE("LinearSolver::factorize");
+    factorized = false;
+
+    bool analyze = !same_pattern(A);
+    if(analyze)
+    {
+        pattern_rows = A.rows();
+        pattern_cols = A.cols();
+        pattern_outer.assign(A.outerIndexPtr(), A.outerIndexPtr() + A.outerSize() + 1);
+        pattern_inner.assign(A.innerIndexPtr(), A.innerIndexPtr() + A.nonZeros());
+        ++n_analyses;
+    }
+
+    Eigen::ComputationInfo info = Eigen::InvalidInput;
+    switch(type)
     {
         case SIMPLICIAL_LLT:
         {
-            Eigen::SimplicialLLT< Eigen::SparseMatrix<double> > solver(A);
-            assert(solver.info() == Eigen::Success);
-            x = solver.solve(b).eval();
+            if(analyze) llt.analyzePattern(A);
+            llt.factorize(A);
+            info = llt.info();
             break;
         }
 
         case SIMPLICIAL_LDLT:
         {
-            Eigen::SimplicialLDLT< Eigen::SparseMatrix<double> > solver(A);
-            assert(solver.info() == Eigen::Success);
-            x = solver.solve(b).eval();
+            if(analyze) ldlt.analyzePattern(A);
+            ldlt.factorize(A);
+            info = ldlt.info();
             break;
         }
 
-        case BiCGSTAB:
+        case SparseLU:
         {
-            Eigen::BiCGSTAB< Eigen::SparseMatrix<double> , Eigen::IncompleteLUT<double> > solver;
-            //solver.setMaxIterations(100);
-            solver.setTolerance(1e-5);
-            solver.compute(A);
-            assert(solver.info() == Eigen::Success);
-            x = solver.solve(b).eval();
+            if(analyze) lu.analyzePattern(A);
+            lu.factorize(A);
+            info = lu.info();
             break;
         }
 
-        case SparseLU:
+        case BiCGSTAB:
         {
-            Eigen::SparseMatrix<double> Ac = A;
-            Ac.makeCompressed();
-            Eigen::SparseLU<Eigen::SparseMatrix<double>, Eigen::COLAMDOrdering<int> > solver;
-            solver.analyzePattern(Ac);
-            solver.factorize(Ac);
-            x = solver.solve(b);
+            // the solver keeps a reference to the matrix: make sure it outlives this call.
+            // The incomplete LU preconditioner is purely numerical (nothing to reuse)
+            if(&A != &A_free) A_free = A;
+            bicgstab.compute(A_free);
+            info = bicgstab.info();
             break;
         }
 
         default: assert(false && "Unknown Solver");
     }
+
+    ++n_factorizations;
+    if(info != Eigen::Success)
+    {
+        std::cerr << "ERROR : " << __FILE__ << ", line " << __LINE__ << " : LinearSolver::factorize() : " << txt[type] << " failed" << std::endl;
+        return false;
+    }
+    factorized = true;
+    return true;
 }
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
+template<class Dense>
 CINO_INLINE
-void solve_square_system_with_bc(const Eigen::SparseMatrix<double> & A,
-                                 const Eigen::VectorXd             & b,
-                                       Eigen::VectorXd             & x,
-                                 const std::map<uint,double>       & bc, // Dirichlet boundary conditions
-                                 int   solver)
+bool LinearSolver::solve_reduced(const Dense & B, Dense & X) const
 {
-    std::vector<int> col_map(A.rows(), -1);
-    uint fresh_id = 0;
-    for(uint col=0; col<A.cols(); ++col)
+    CINO_PROFILE_ZONE("LinearSolver::solve");
+    switch(type)
     {
-        if (DOES_NOT_CONTAIN(bc, col))
-        {
-            col_map[col] = fresh_id++;
-        }
+        case SIMPLICIAL_LLT:  X = llt.solve(B);      return llt.info()      == Eigen::Success;
+        case SIMPLICIAL_LDLT: X = ldlt.solve(B);     return ldlt.info()     == Eigen::Success;
+        case SparseLU:        X = lu.solve(B);       return lu.info()       == Eigen::Success;
+        case BiCGSTAB:        X = bicgstab.solve(B); return bicgstab.info() == Eigen::Success;
+        default: assert(false && "Unknown Solver");
     }
+    return false;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
-    uint size = A.rows() - bc.size();
+CINO_INLINE
+bool LinearSolver::solve(const Eigen::VectorXd & b, Eigen::VectorXd & x) const
+{
+    Eigen::MatrixXd X;
+    bool ok = solve(Eigen::MatrixXd(b), X);
+    x = X.col(0);
+    return ok;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+bool LinearSolver::solve(const Eigen::MatrixXd & B, Eigen::MatrixXd & X) const
+{
+    if(bc_ids.empty()) return solve(B, Eigen::MatrixXd(), X);
+    return solve(B, bc_vals.replicate(1,B.cols()), X);
+}
 
-    std::vector<Entry> Aprime_entries;
-    Eigen::VectorXd    bprime(size);
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
-    for(uint row=0; row<A.rows(); ++row)
+CINO_INLINE
+bool LinearSolver::solve(const Eigen::MatrixXd & B, const Eigen::MatrixXd & BC, Eigen::MatrixXd & X) const
+{
+    if(!factorized)
     {
-        if (col_map[row] >= 0)
-        {
-            bprime[ col_map[row] ] = b[row];
-        }
+        std::cerr << "ERROR : " << __FILE__ << ", line " << __LINE__ << " : LinearSolver::solve() : no valid factorization" << std::endl;
+        X = Eigen::MatrixXd::Constant(B.rows(), B.cols(), std::numeric_limits<double>::quiet_NaN());
+        return false;
     }
+    assert(B.rows() == full_size);
 
-    //
-    // iterate over the non-zero entries
-    // of sparse matrix A
-    //
-    for (uint i=0; i<A.outerSize(); ++i)
-    {
-        for (Eigen::SparseMatrix<double>::InnerIterator it(A,i); it; ++it)
-        {
-            uint    row = it.row();
-            uint    col = it.col();
-            double val = it.value();
+    if(bc_ids.empty()) return solve_reduced(B, X);
 
-            if (col_map[row] < 0) continue;
+    assert(BC.rows() == (Eigen::Index)bc_ids.size() && BC.cols() == B.cols());
 
-            if (col_map[col] < 0)
-            {
-                bprime[ col_map[row] ] -= bc.at(col) * val;
-            }
-            else
+    // restrict to the free variables, moving the constrained ones to the rhs
+    Eigen::MatrixXd B_free(A_free.rows(), B.cols());
+    for(Eigen::Index row=0; row<full_size; ++row)
+    {
+        if(col_map[row]>=0) B_free.row(col_map[row]) = B.row(row);
+    }
+    for(Eigen::Index k=0; k<A_bc.outerSize(); ++k)
+    {
+        for(Eigen::SparseMatrix<double>::InnerIterator it(A_bc,k); it; ++it)
+        {
+            for(Eigen::Index j=0; j<B.cols(); ++j)
             {
-                Aprime_entries.push_back(Entry(col_map[row], col_map[col], val));
+                B_free(it.row(),j) -= BC(k,j) * it.value();
             }
         }
     }
 
-    Eigen::SparseMatrix<double> Aprime(size, size);
-    Aprime.setFromTriplets(Aprime_entries.begin(), Aprime_entries.end());
+    Eigen::MatrixXd X_free;
+    bool ok = solve_reduced(B_free, X_free);
 
-    Eigen::VectorXd tmp_x(size);
+    X.resize(full_size, B.cols());
+    for(Eigen::Index row=0; row<full_size; ++row)
+    {
+        int i = col_map[row];
+        if(i>=0) X.row(row) = X_free.row(i);
+        else     X.row(row) = BC.row(-1-i);
+    }
+    return ok;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
-    solve_square_system(Aprime, bprime, tmp_x, solver);
+CINO_INLINE
+void solve_square_system(const Eigen::SparseMatrix<double> & A,
+                         const Eigen::VectorXd             & b,
+                               Eigen::VectorXd             & x,
+                         int   solver)
+{
+    assert(A.rows() == A.cols());
 
-    x.resize(A.cols());
-    for(uint col=0; col<A.cols(); ++col)
+    LinearSolver s(solver);
+    if(!s.factorize(A))
     {
-        if (col_map[col] >= 0)
-        {
-            x[col] = tmp_x[ col_map[col] ];
-        }
-        else
-        {
-            x[col] = bc.at(col);
-        }
+        // factorize() already reported the failure: keep the output sized, but flag it as invalid
+        x = Eigen::VectorXd::Constant(A.rows(), std::numeric_limits<double>::quiet_NaN());
+        return;
+    }
+    s.solve(b, x);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void solve_square_system_with_bc(const Eigen::SparseMatrix<double> & A,
+                                 const Eigen::VectorXd             & b,
+                                       Eigen::VectorXd             & x,
+                                 const std::map<uint,double>       & bc, // Dirichlet boundary conditions
+                                 int   solver)
+{
+    LinearSolver s(solver);
+    if(!s.factorize(A, bc))
+    {
+        x = Eigen::VectorXd::Constant(A.rows(), std::numeric_limits<double>::quiet_NaN());
+        return;
+    }
+    s.solve(b, x);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void solve_square_system(const Eigen::SparseMatrix<double> & A,
+                         const Eigen::MatrixXd             & B,
+                               Eigen::MatrixXd             & X,
+                         int   solver)
+{
+    assert(A.rows() == A.cols());
+
+    LinearSolver s(solver);
+    if(!s.factorize(A))
+    {
+        X = Eigen::MatrixXd::Constant(A.rows(), B.cols(), std::numeric_limits<double>::quiet_NaN());
+        return;
+    }
+    s.solve(B, X);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void solve_square_system_with_bc(const Eigen::SparseMatrix<double>        & A,
+                                 const Eigen::MatrixXd                    & B,
+                                       Eigen::MatrixXd                    & X,
+                                 const std::map<uint,std::vector<double>> & bc, // Dirichlet boundary conditions
+                                 int   solver)
+{
+    std::map<uint,double> bc_ids;
+    Eigen::MatrixXd       BC(bc.size(), B.cols());
+    uint k = 0;
+    for(const auto & obj : bc)
+    {
+        assert(obj.second.size() == (size_t)B.cols());
+        bc_ids[obj.first] = 0.0;
+        for(Eigen::Index j=0; j<B.cols(); ++j) BC(k,j) = obj.second.at(j);
+        ++k;
+    }
+
+    LinearSolver s(solver);
+    if(!s.factorize(A, bc_ids))
+    {
+        X = Eigen::MatrixXd::Constant(A.rows(), B.cols(), std::numeric_limits<double>::quiet_NaN());
+        return;
     }
+    s.solve(B, BC, X);
 }
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
@@ -237,6 +464,47 @@ void solve_weighted_least_squares_with_bc(const Eigen::SparseMatrix<double> & A,
     solve_square_system_with_bc(AtWA, AtWb, x, bc, solver);
 }
 
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void solve_weighted_least_squares(const Eigen::SparseMatrix<double> & A,
+                                  const Eigen::VectorXd             & w,
+                                  const Eigen::VectorXd             & b,
+                                        Eigen::VectorXd             & x,
+                                        LinearSolver                & solver)
+{
+    Eigen::SparseMatrix<double> At   = A.transpose();
+    Eigen::SparseMatrix<double> AtWA = At * w.asDiagonal() * A;
+    Eigen::VectorXd             AtWb = At * w.asDiagonal() * b;
+
+    if(!solver.factorize(AtWA))
+    {
+        x = Eigen::VectorXd::Constant(AtWA.rows(), std::numeric_limits<double>::quiet_NaN());
+        return;
+    }
+    solver.solve(AtWb, x);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void solve_weighted_least_squares_with_bc(const Eigen::SparseMatrix<double> & A,
+                                          const Eigen::VectorXd             & w,
+                                          const Eigen::VectorXd             & b,
+                                                Eigen::VectorXd             & x,
+                                          const std::map<uint,double>       & bc, // Dirichlet boundary conditions
+                                                LinearSolver                & solver)
+{
+    Eigen::SparseMatrix<double> At   = A.transpose();
+    Eigen::SparseMatrix<double> AtWA = At * w.asDiagonal() * A;
+    Eigen::VectorXd             AtWb = At * w.asDiagonal() * b;
 
+    if(!solver.factorize(AtWA, bc))
+    {
+        x = Eigen::VectorXd::Constant(AtWA.rows(), std::numeric_limits<double>::quiet_NaN());
+        return;
+    }
+    solver.solve(AtWb, x);
+}
 
 }
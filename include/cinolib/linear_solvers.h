@@ -38,6 +38,7 @@
 
 #include <string>
 #include <map>
+#include <vector>
 #include <sys/types.h>
 #include <cinolib/cino_inline.h>
 #include <Eigen/Sparse>
@@ -78,6 +79,92 @@ static const std::string txt[4] =
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
+/* Reusable solver for square sparse systems. Factorizing a matrix consists of
+ * a symbolic analysis (fill reducing ordering, elimination tree), which only
+ * depends on the sparsity pattern, and a numerical factorization. factorize()
+ * remembers the pattern of the last matrix it has seen, and repeats the
+ * symbolic analysis only if the pattern of the new matrix is different. This
+ * way, iterative algorithms that refactor a matrix with fixed connectivity at
+ * each step (e.g. MCF, IRLS, smoothing) pay the analysis only once. Once a
+ * matrix is factorized, any number of right hand sides can be solved, either
+ * one by one or in blocks (one rhs per column).
+ *
+ * Dirichlet boundary conditions can be passed to factorize(). The constrained
+ * variables are eliminated from the system, and solve() moves their (fixed)
+ * contribution to the right hand side, returning full size solutions. If no
+ * valid factorization is available solve() returns false and fills the
+ * solution with NaNs, so that it keeps the size callers expect.
+ *
+ * solve() does not modify the solver, hence once a matrix is factorized it can
+ * be called concurrently by multiple threads (with the only exception of
+ * BiCGSTAB, which stores the outcome of the last solve internally).
+*/
+
+class LinearSolver
+{
+    public:
+
+        explicit LinearSolver(const int solver = SIMPLICIAL_LLT);
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        bool factorize(const Eigen::SparseMatrix<double> & A);
+        bool factorize(const Eigen::SparseMatrix<double> & A,
+                       const std::map<uint,double>       & bc); // Dirichlet boundary conditions
+
+        bool solve(const Eigen::VectorXd & b, Eigen::VectorXd & x) const;
+        bool solve(const Eigen::MatrixXd & B, Eigen::MatrixXd & X) const; // one rhs (and solution) per column
+
+        // block solve with different Dirichlet values for each rhs. BC(k,j) is the value
+        // of the k-th constrained variable (in ascending order of index) for the j-th rhs
+        bool solve(const Eigen::MatrixXd & B, const Eigen::MatrixXd & BC, Eigen::MatrixXd & X) const;
+
+        void clear();
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        int  solver_type()        const { return type; }
+        bool is_factorized()      const { return factorized; }
+        uint num_analyses()       const { return n_analyses; }
+        uint num_factorizations() const { return n_factorizations; }
+
+    private:
+
+        bool factorize_reduced(const Eigen::SparseMatrix<double> & A);
+        bool same_pattern     (const Eigen::SparseMatrix<double> & A) const;
+
+        template<class Dense>
+        bool solve_reduced(const Dense & B, Dense & X) const;
+
+        int  type;
+        bool factorized       = false;
+        uint n_analyses       = 0;
+        uint n_factorizations = 0;
+
+        Eigen::SimplicialLLT <Eigen::SparseMatrix<double>>                                  llt;
+        Eigen::SimplicialLDLT<Eigen::SparseMatrix<double>>                                  ldlt;
+        Eigen::SparseLU      <Eigen::SparseMatrix<double>, Eigen::COLAMDOrdering<int>>      lu;
+        Eigen::BiCGSTAB      <Eigen::SparseMatrix<double>, Eigen::IncompleteLUT<double>>    bicgstab;
+
+        // sparsity pattern of the last analyzed matrix
+        Eigen::Index     pattern_rows = -1;
+        Eigen::Index     pattern_cols = -1;
+        std::vector<int> pattern_outer;
+        std::vector<int> pattern_inner;
+
+        // Dirichlet boundary conditions
+        Eigen::Index                full_size = 0;
+        std::vector<int>            col_map;  // full index => reduced index (-1-k for the k-th constrained variable)
+        std::vector<uint>           bc_ids;   // constrained variables
+        Eigen::VectorXd             bc_vals;  // their values
+        Eigen::SparseMatrix<double> A_bc;     // free rows x constrained cols (moved to the rhs)
+        Eigen::SparseMatrix<double> A_free;   // free rows x free cols
+};
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// If A cannot be factorized the error is reported on std::cerr, and the
+// solution is filled with NaNs (this holds for all the functions below)
 CINO_INLINE
 void solve_square_system(const Eigen::SparseMatrix<double> & A,
                          const Eigen::VectorXd             & b,
@@ -95,6 +182,26 @@ void solve_square_system_with_bc(const Eigen::SparseMatrix<double> & A,
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
+// Batched versions of the functions above, for vector valued problems: A is factorized only
+// once and the system is solved for each column of B (e.g. B can be N x 3 for 3D problems,
+// instead of using a 3N x 3N system with A replicated along the diagonal). In the bc variant
+// each constrained variable has one value per column of B
+
+CINO_INLINE
+void solve_square_system(const Eigen::SparseMatrix<double> & A,
+                         const Eigen::MatrixXd             & B,
+                               Eigen::MatrixXd             & X,
+                         int   solver = SIMPLICIAL_LLT);
+
+CINO_INLINE
+void solve_square_system_with_bc(const Eigen::SparseMatrix<double>            & A,
+                                 const Eigen::MatrixXd                        & B,
+                                       Eigen::MatrixXd                        & X,
+                                 const std::map<uint,std::vector<double>>     & bc, // Dirichlet boundary conditions
+                                 int   solver = SIMPLICIAL_LLT);
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
 CINO_INLINE
 void solve_least_squares(const Eigen::SparseMatrix<double> & A,
                          const Eigen::VectorXd             & b,
@@ -129,6 +236,29 @@ void solve_weighted_least_squares_with_bc(const Eigen::SparseMatrix<double> & A,
                                           const std::map<uint,double>       & bc, // Dirichlet boundary conditions
                                           int   solver = SIMPLICIAL_LLT);
 
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// same as above, but reuses the symbolic analysis stored in solver (the
+// pattern of AtWA does not depend on w, hence it is analyzed only once
+// when these functions are called in a loop, as in IRLS)
+
+CINO_INLINE
+void solve_weighted_least_squares(const Eigen::SparseMatrix<double> & A,
+                                  const Eigen::VectorXd             & w,
+                                  const Eigen::VectorXd             & b,
+                                        Eigen::VectorXd             & x,
+                                        LinearSolver                & solver);
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void solve_weighted_least_squares_with_bc(const Eigen::SparseMatrix<double> & A,
+                                          const Eigen::VectorXd             & w,
+                                          const Eigen::VectorXd             & b,
+                                                Eigen::VectorXd             & x,
+                                          const std::map<uint,double>       & bc, // Dirichlet boundary conditions
+                                                LinearSolver                & solver);
+
 }
 
 #ifndef  CINO_STATIC_LIB
@@ -43,7 +43,10 @@
 *     Italy                                                                     *
 *********************************************************************************/
 #include <cinolib/marching_tets.h>
-#include <array>
+#include <cinolib/thread_pool.h>
+#include <algorithm>
+#include <climits>
+#include <numeric>
 
 namespace cinolib
 {
@@ -70,27 +73,49 @@ enum // Look-up Table
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
-template<class M, class V, class E, class F, class P>
+// triangles generated by a tet with configuration c, expressed as triplets
+// of local edges (see TET_EDGES). Returns the number of triangles (0, 1 or 2)
 CINO_INLINE
-void make_triangle(const Tetmesh<M,V,E,F,P> & m,
-                   const double               isovalue,
-                   const uint                 vids[],
-                   const double               func[],
-                   const std::array<uint,3> & e,
-                   std::map<ipair,uint>     & e2v_map,
-                   std::vector<vec3d>       & verts,
-                   std::vector<uint>        & tris,
-                   std::vector<vec3d>       & norms);
+uint marching_tets_table(const unsigned char c, const bool swapped, uint t[2][3])
+{
+    auto set = [&t](const uint i, const uint e0, const uint e1, const uint e2)
+    {
+        t[i][0] = e0;
+        t[i][1] = e1;
+        t[i][2] = e2;
+    };
+
+    switch (c)
+    {
+        case C_1000 : set(0,2,0,4); return 1;
+        case C_0111 : swapped ? set(0,2,0,4) : set(0,0,2,4); return 1;
+        case C_1011 : swapped ? set(0,1,2,3) : set(0,2,1,3); return 1;
+        case C_0100 : set(0,1,2,3); return 1;
+        case C_1101 : swapped ? set(0,0,1,5) : set(0,1,0,5); return 1;
+        case C_0010 : set(0,0,1,5); return 1;
+        case C_0001 : set(0,5,3,4); return 1;
+        case C_1110 : swapped ? set(0,5,3,4) : set(0,3,5,4); return 1;
+        case C_0101 : set(0,5,2,4); set(1,2,5,1); return 2;
+        case C_1010 : set(0,2,5,4); set(1,5,2,1); return 2;
+        case C_0011 : set(0,3,4,1); set(1,1,4,0); return 2;
+        case C_1100 : set(0,4,3,1); set(1,4,1,0); return 2;
+        case C_1001 : set(0,3,2,0); set(1,5,3,0); return 2;
+        case C_0110 : set(0,2,3,0); set(1,3,5,0); return 2;
+        default : return 0;
+    }
+}
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
+// classifies tet pid w.r.t. isovalue, and returns the triangles it generates (see marching_tets_table)
 template<class M, class V, class E, class F, class P>
 CINO_INLINE
-void marching_tets(const Tetmesh<M,V,E,F,P> & m,
-                   const double               isovalue,
-                   std::vector<vec3d>       & verts,
-                   std::vector<uint>        & tris,
-                   std::vector<vec3d>       & norms)
+uint marching_tets_classify(const Tetmesh<M,V,E,F,P> & m,
+                            const std::vector<double> & f,
+                            const uint                  pid,
+                            const double                func[],
+                            const double                isovalue,
+                            uint                        t[2][3])
 {
     /* FIXME: for all configurations where two verts >= isoval
      * and the other two are < isoval, this method will try to
@@ -103,219 +128,250 @@ void marching_tets(const Tetmesh<M,V,E,F,P> & m,
      * vertex (<,>,=). In this case each configuration will be 100% correct
     */
 
-    std::vector<unsigned char> c(m.num_polys(),0x0);
-    std::vector<bool> swapped(m.num_polys(), false);
-
-    for(uint pid=0; pid<m.num_polys(); ++pid)
+    unsigned char c = 0x0;
+    if (isovalue >= func[0]) c |= C_1000;
+    if (isovalue >= func[1]) c |= C_0100;
+    if (isovalue >= func[2]) c |= C_0010;
+    if (isovalue >= func[3]) c |= C_0001;
+
+    /* If the isosurface does not intersect the tet,
+     * one should get C_1111 using ">=", and C_0000
+     * inverting to "<=".
+     *
+     * This does not happen if the isosurface passes
+     * exhactly through one face. In this case one will
+     * get C_1111 using ">=", and something like
+     * C_0111 using "<=".
+     *
+     * Normally this does not create any trouble, as the
+     * face-adjacent tet will trigger the generation of
+     * that triangle. But if the tet is exposed on the
+     * surface, then that triangle will be missing in the
+     * final iso-surface.
+     *
+     * To avoid these missing triangles, whenever I get
+     * a C_1111 I invert the sign, and assign to the tet
+     * the configuration produced using "<="
+    */
+    bool swapped = (c == C_1111);
+    if (swapped)
     {
-        double func[] =
-        {
-            m.vert_data(m.poly_vert_id(pid,0)).uvw[0],
-            m.vert_data(m.poly_vert_id(pid,1)).uvw[0],
-            m.vert_data(m.poly_vert_id(pid,2)).uvw[0],
-            m.vert_data(m.poly_vert_id(pid,3)).uvw[0]
-        };
-
-        if (isovalue >= func[0]) c.at(pid) |= C_1000;
-        if (isovalue >= func[1]) c.at(pid) |= C_0100;
-        if (isovalue >= func[2]) c.at(pid) |= C_0010;
-        if (isovalue >= func[3]) c.at(pid) |= C_0001;
-
-        /* If the isosurface does not intersect the tet,
-         * one should get C_1111 using ">=", and C_0000
-         * inverting to "<=".
-         *
-         * This does not happen if the isosurface passes
-         * exhactly through one face. In this case one will
-         * get C_1111 using ">=", and something like
-         * C_0111 using "<=".
-         *
-         * Normally this does not create any trouble, as the
-         * face-adjacent tet will trigger the generation of
-         * that triangle. But if the tet is exposed on the
-         * surface, then that triangle will be missing in the
-         * final iso-surface.
-         *
-         * To avoid these missing triangles, whenever I get
-         * a C_1111 I invert the sign, and assign to the tet
-         * the configuration produced using "<="
-        */
-        if (c.at(pid) == C_1111)
-        {
-            swapped.at(pid) = true;
-            c.at(pid) = 0x0;
-            if (isovalue <= func[0]) c.at(pid) |= C_1000;
-            if (isovalue <= func[1]) c.at(pid) |= C_0100;
-            if (isovalue <= func[2]) c.at(pid) |= C_0010;
-            if (isovalue <= func[3]) c.at(pid) |= C_0001;
-        }
+        c = 0x0;
+        if (isovalue <= func[0]) c |= C_1000;
+        if (isovalue <= func[1]) c |= C_0100;
+        if (isovalue <= func[2]) c |= C_0010;
+        if (isovalue <= func[3]) c |= C_0001;
     }
 
-    std::map<ipair,uint> e2v_map;
-
-    for(uint pid=0; pid<m.num_polys(); ++pid)
+    bool v_on_iso[] =
     {
-        uint vids[] =
-        {
-            m.poly_vert_id(pid,0),
-            m.poly_vert_id(pid,1),
-            m.poly_vert_id(pid,2),
-            m.poly_vert_id(pid,3)
-        };
-
-        double func[] =
-        {
-            m.vert_data(vids[0]).uvw[0],
-            m.vert_data(vids[1]).uvw[0],
-            m.vert_data(vids[2]).uvw[0],
-            m.vert_data(vids[3]).uvw[0]
-        };
-
-        bool v_on_iso[] =
-        {
-            func[0] == isovalue,
-            func[1] == isovalue,
-            func[2] == isovalue,
-            func[3] == isovalue
-        };
-
-        int adj_tet[] // not uint because it may be -1 if there is no adjacent tet!
-        {
-            m.poly_adj_through_face(pid, m.poly_face_id(pid,0)),
-            m.poly_adj_through_face(pid, m.poly_face_id(pid,1)),
-            m.poly_adj_through_face(pid, m.poly_face_id(pid,2)),
-            m.poly_adj_through_face(pid, m.poly_face_id(pid,3)),
-        };
-
-        // Avoid triangle duplication and collapsed triangle generation when the iso-surface
-        // passes EXACTLY through a vertex/edge/face shared between many tetrahedra.
-        //
-        switch (c.at(pid))
-        {
-            // iso-surface passes on a face : make sure only one tet (MUST BE the one with higher id) triggers triangle generation...
-            // Notice that if the adjacent tet is collapsed (C_1111), then it make sense to use the current one regardless the tid order
-            case C_1110 : if (v_on_iso[0] && v_on_iso[1] && v_on_iso[2] && (int)pid < adj_tet[0] && c.at(adj_tet[0]) != C_1111) c.at(pid) = C_0000; break;
-            case C_1101 : if (v_on_iso[0] && v_on_iso[1] && v_on_iso[3] && (int)pid < adj_tet[1] && c.at(adj_tet[1]) != C_1111) c.at(pid) = C_0000; break;
-            case C_1011 : if (v_on_iso[0] && v_on_iso[2] && v_on_iso[3] && (int)pid < adj_tet[2] && c.at(adj_tet[2]) != C_1111) c.at(pid) = C_0000; break;
-            case C_0111 : if (v_on_iso[1] && v_on_iso[2] && v_on_iso[3] && (int)pid < adj_tet[3] && c.at(adj_tet[3]) != C_1111) c.at(pid) = C_0000; break;
-
-            // iso-surface passes on a edge : do nothing
-            case C_0101 : if (v_on_iso[1] && v_on_iso[3]) c.at(pid) = C_0000; break;
-            case C_1010 : if (v_on_iso[0] && v_on_iso[2]) c.at(pid) = C_0000; break;
-            case C_0011 : if (v_on_iso[2] && v_on_iso[3]) c.at(pid) = C_0000; break;
-            case C_1100 : if (v_on_iso[0] && v_on_iso[1]) c.at(pid) = C_0000; break;
-            case C_1001 : if (v_on_iso[0] && v_on_iso[3]) c.at(pid) = C_0000; break;
-            case C_0110 : if (v_on_iso[1] && v_on_iso[2]) c.at(pid) = C_0000; break;
-
-            // iso-surface passes on a vertex : do nothing
-            case C_1000 : if (v_on_iso[0]) c.at(pid) = C_0000; break;
-            case C_0100 : if (v_on_iso[1]) c.at(pid) = C_0000; break;
-            case C_0010 : if (v_on_iso[2]) c.at(pid) = C_0000; break;
-            case C_0001 : if (v_on_iso[3]) c.at(pid) = C_0000; break;
-
-            default : break;
-        }
-
-        // triangle generation
-        switch (c.at(pid))
-        {
-            case C_1000 : { make_triangle(m, isovalue, vids, func, {2,0,4}, e2v_map, verts, tris, norms); break; }
-            case C_0111 : { swapped.at(pid)?
-                            make_triangle(m, isovalue, vids, func, {2,0,4}, e2v_map, verts, tris, norms) :
-                            make_triangle(m, isovalue, vids, func, {0,2,4}, e2v_map, verts, tris, norms); break; }
-            case C_1011 : { swapped.at(pid)?
-                            make_triangle(m, isovalue, vids, func, {1,2,3}, e2v_map, verts, tris, norms) :
-                            make_triangle(m, isovalue, vids, func, {2,1,3}, e2v_map, verts, tris, norms); break; }
-            case C_0100 : { make_triangle(m, isovalue, vids, func, {1,2,3}, e2v_map, verts, tris, norms); break; }
-            case C_1101 : { swapped.at(pid)?
-                            make_triangle(m, isovalue, vids, func, {0,1,5}, e2v_map, verts, tris, norms) :
-                            make_triangle(m, isovalue, vids, func, {1,0,5}, e2v_map, verts, tris, norms); break; }
-            case C_0010 : { make_triangle(m, isovalue, vids, func, {0,1,5}, e2v_map, verts, tris, norms); break; }
-            case C_0001 : { make_triangle(m, isovalue, vids, func, {5,3,4}, e2v_map, verts, tris, norms); break; }
-            case C_1110 : { swapped.at(pid)?
-                            make_triangle(m, isovalue, vids, func, {5,3,4}, e2v_map, verts, tris, norms) :
-                            make_triangle(m, isovalue, vids, func, {3,5,4}, e2v_map, verts, tris, norms); break; }
-            case C_0101 : { make_triangle(m, isovalue, vids, func, {5,2,4}, e2v_map, verts, tris, norms);
-                            make_triangle(m, isovalue, vids, func, {2,5,1}, e2v_map, verts, tris, norms); break; }
-            case C_1010 : { make_triangle(m, isovalue, vids, func, {2,5,4}, e2v_map, verts, tris, norms);
-                            make_triangle(m, isovalue, vids, func, {5,2,1}, e2v_map, verts, tris, norms); break; }
-            case C_0011 : { make_triangle(m, isovalue, vids, func, {3,4,1}, e2v_map, verts, tris, norms);
-                            make_triangle(m, isovalue, vids, func, {1,4,0}, e2v_map, verts, tris, norms); break; }
-            case C_1100 : { make_triangle(m, isovalue, vids, func, {4,3,1}, e2v_map, verts, tris, norms);
-                            make_triangle(m, isovalue, vids, func, {4,1,0}, e2v_map, verts, tris, norms); break; }
-            case C_1001 : { make_triangle(m, isovalue, vids, func, {3,2,0}, e2v_map, verts, tris, norms);
-                            make_triangle(m, isovalue, vids, func, {5,3,0}, e2v_map, verts, tris, norms); break; }
-            case C_0110 : { make_triangle(m, isovalue, vids, func, {2,3,0}, e2v_map, verts, tris, norms);
-                            make_triangle(m, isovalue, vids, func, {3,5,0}, e2v_map, verts, tris, norms); break; }
-            default : break;
-        }
+        func[0] == isovalue,
+        func[1] == isovalue,
+        func[2] == isovalue,
+        func[3] == isovalue
+    };
+
+    // true if the tet adjacent through the i-th face has higher id and is not collapsed (C_1111).
+    // Notice that a tet ends up in C_1111 only if all its verts lie on the iso-surface
+    auto adj_generates = [&](const uint i)
+    {
+        int adj = m.poly_adj_through_face(pid, m.poly_face_id(pid,i)); // -1 if there is no adjacent tet
+        if ((int)pid >= adj) return false;
+        for(uint vid : m.adj_p2v(adj)) if (f[vid] != isovalue) return true;
+        return false;
+    };
+
+    // Avoid triangle duplication and collapsed triangle generation when the iso-surface
+    // passes EXACTLY through a vertex/edge/face shared between many tetrahedra.
+    //
+    switch (c)
+    {
+        // iso-surface passes on a face : make sure only one tet (MUST BE the one with higher id) triggers triangle generation...
+        // Notice that if the adjacent tet is collapsed (C_1111), then it make sense to use the current one regardless the tid order
+        case C_1110 : if (v_on_iso[0] && v_on_iso[1] && v_on_iso[2] && adj_generates(0)) c = C_0000; break;
+        case C_1101 : if (v_on_iso[0] && v_on_iso[1] && v_on_iso[3] && adj_generates(1)) c = C_0000; break;
+        case C_1011 : if (v_on_iso[0] && v_on_iso[2] && v_on_iso[3] && adj_generates(2)) c = C_0000; break;
+        case C_0111 : if (v_on_iso[1] && v_on_iso[2] && v_on_iso[3] && adj_generates(3)) c = C_0000; break;
+
+        // iso-surface passes on a edge : do nothing
+        case C_0101 : if (v_on_iso[1] && v_on_iso[3]) c = C_0000; break;
+        case C_1010 : if (v_on_iso[0] && v_on_iso[2]) c = C_0000; break;
+        case C_0011 : if (v_on_iso[2] && v_on_iso[3]) c = C_0000; break;
+        case C_1100 : if (v_on_iso[0] && v_on_iso[1]) c = C_0000; break;
+        case C_1001 : if (v_on_iso[0] && v_on_iso[3]) c = C_0000; break;
+        case C_0110 : if (v_on_iso[1] && v_on_iso[2]) c = C_0000; break;
+
+        // iso-surface passes on a vertex : do nothing
+        case C_1000 : if (v_on_iso[0]) c = C_0000; break;
+        case C_0100 : if (v_on_iso[1]) c = C_0000; break;
+        case C_0010 : if (v_on_iso[2]) c = C_0000; break;
+        case C_0001 : if (v_on_iso[3]) c = C_0000; break;
+
+        default : break;
     }
+
+    return marching_tets_table(c, swapped, t);
 }
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
 template<class M, class V, class E, class F, class P>
 CINO_INLINE
-void make_triangle(const Tetmesh<M,V,E,F,P> & m,
+void marching_tets(const Tetmesh<M,V,E,F,P> & m,
                    const double               isovalue,
-                   const uint                 vids[],
-                   const double               func[],
-                   const std::array<uint,3> & e,
-                   std::map<ipair,uint>     & e2v_map,
                    std::vector<vec3d>       & verts,
                    std::vector<uint>        & tris,
                    std::vector<vec3d>       & norms)
 {
-    assert(isovalue >= *std::min_element(func, func+4));
-    assert(isovalue <= *std::max_element(func, func+4));
+    std::vector<std::vector<vec3d>> iso_verts(1);
+    std::vector<std::vector<uint>>  iso_tris(1);
+    std::vector<std::vector<vec3d>> iso_norms(1);
+    marching_tets(m, std::vector<double>(1,isovalue), iso_verts, iso_tris, iso_norms);
+
+    // append to the output lists
+    uint base = verts.size();
+    for(uint & vid : iso_tris[0]) vid += base;
+    verts.insert(verts.end(), iso_verts[0].begin(), iso_verts[0].end());
+    tris.insert (tris.end(),  iso_tris[0].begin(),  iso_tris[0].end());
+    norms.insert(norms.end(), iso_norms[0].begin(), iso_norms[0].end());
+}
 
-    vec3d tri_verts[3];
-    uint  fresh_vid = verts.size();
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
-    for(uint i=0; i<3; ++i)
+template<class M, class V, class E, class F, class P>
+CINO_INLINE
+void marching_tets(const Tetmesh<M,V,E,F,P>        & m,
+                   const std::vector<double>       & isovalues,
+                   std::vector<std::vector<vec3d>> & verts,
+                   std::vector<std::vector<uint>>  & tris,
+                   std::vector<std::vector<vec3d>> & norms)
+{
+    uint n_iso = isovalues.size();
+    verts.resize(n_iso);
+    tris.resize(n_iso);
+    norms.resize(n_iso);
+    if(n_iso==0) return;
+
+    std::vector<double> f(m.num_verts());
+    parallel_for(0, m.num_verts(), [&](const uint vid)
     {
-        uint v_a = vids[TET_EDGES[e[i]][0]];
-        uint v_b = vids[TET_EDGES[e[i]][1]];
-
-        // avoid duplicated vertices. If an edge has already
-        // been visited retrieve its id and coordinates
-        //
-        ipair pair  = unique_pair(v_a, v_b);
-        auto  query = e2v_map.find(pair);
+        f[vid] = m.vert_data(vid).uvw[0];
+    });
+
+    // isovalues are sorted, so that each tet only visits the ones in its range
+    std::vector<uint> order(n_iso);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](const uint a, const uint b){ return isovalues[a] < isovalues[b]; });
+    std::vector<double> sorted(n_iso);
+    for(uint i=0; i<n_iso; ++i) sorted[i] = isovalues[order[i]];
+
+    // Tets are split into fixed blocks. The first sweep counts the triangles generated
+    // by each block for each isovalue, and the second one writes them directly in their
+    // final position, which is the same they would have in a sequential visit. Triangle
+    // corners temporarily store the id of the mesh edge that contains them
+    const uint block    = 4096;
+    const uint n_blocks = (m.num_polys()+block-1)/block;
+    std::vector<uint> offset(n_iso*(n_blocks+1), 0); // offset[i*(n_blocks+1)+b] : first triangle of block b for isovalue i
+
+    auto sweep = [&](const uint b, const bool write)
+    {
+        std::vector<uint> cursor(n_iso);
+        if(write) for(uint i=0; i<n_iso; ++i) cursor[i] = offset[i*(n_blocks+1)+b];
 
-        if (query != e2v_map.end())
-        {
-            uint vid = query->second;
-            tri_verts[i] = vec3d(verts.at(vid));
-            tris.push_back(vid);
-        }
-        else
+        uint end = std::min(m.num_polys(), (b+1)*block);
+        for(uint pid=b*block; pid<end; ++pid)
         {
-            double f_a = func[TET_EDGES[e[i]][0]];
-            double f_b = func[TET_EDGES[e[i]][1]];
-
-            if (f_a < f_b)
+            uint vids[] =
+            {
+                m.poly_vert_id(pid,0),
+                m.poly_vert_id(pid,1),
+                m.poly_vert_id(pid,2),
+                m.poly_vert_id(pid,3)
+            };
+            double func[] = { f[vids[0]], f[vids[1]], f[vids[2]], f[vids[3]] };
+
+            auto range = std::minmax_element(func, func+4);
+            auto beg   = std::lower_bound(sorted.begin(), sorted.end(), *range.first);
+            auto last  = std::upper_bound(beg, sorted.end(), *range.second);
+
+            uint eids[6];
+            bool has_eids = false;
+            for(auto it=beg; it!=last; ++it)
             {
-                std::swap(v_a, v_b);
-                std::swap(f_a, f_b);
+                uint t[2][3];
+                uint i = order[it-sorted.begin()];
+                uint n = marching_tets_classify(m, f, pid, func, *it, t);
+                if(n==0) continue;
+                if(!write)
+                {
+                    offset[i*(n_blocks+1)+b+1] += n;
+                    continue;
+                }
+                if(!has_eids)
+                {
+                    for(uint e=0; e<6; ++e) eids[e] = m.poly_edge_id(pid, vids[TET_EDGES[e][0]], vids[TET_EDGES[e][1]]);
+                    has_eids = true;
+                }
+                for(uint j=0; j<n; ++j)
+                {
+                    uint * tri = tris[i].data() + 3*cursor[i]++;
+                    tri[0] = eids[t[j][0]];
+                    tri[1] = eids[t[j][1]];
+                    tri[2] = eids[t[j][2]];
+                }
             }
+        }
+    };
 
-            double alpha = (isovalue - f_a) / (f_b - f_a);
-
-            tri_verts[i] = (1.0 - alpha) * m.vert(v_a) + alpha * m.vert(v_b);
-
-            verts.push_back(tri_verts[i]);
+    global_thread_pool().run(n_blocks, [&](const uint b, const uint){ sweep(b,false); });
+    for(uint i=0; i<n_iso; ++i)
+    {
+        uint * o = offset.data() + i*(n_blocks+1);
+        std::partial_sum(o, o+n_blocks+1, o);
+        tris[i].resize(3*o[n_blocks]);
+    }
+    global_thread_pool().run(n_blocks, [&](const uint b, const uint){ sweep(b,true); });
 
-            tris.push_back(fresh_vid);
-            e2v_map[pair] = fresh_vid++;
+    // turn edges into vertices (numbered in order of first appearance), and compute
+    // vertex positions and triangle normals
+    std::vector<uint> e2v(m.num_edges(), UINT_MAX);
+    std::vector<uint> v2e;
+    for(uint i=0; i<n_iso; ++i)
+    {
+        v2e.clear();
+        for(uint & id : tris[i])
+        {
+            uint & vid = e2v[id];
+            if(vid==UINT_MAX)
+            {
+                vid = v2e.size();
+                v2e.push_back(id);
+            }
+            id = vid;
         }
-    }
+        for(uint eid : v2e) e2v[eid] = UINT_MAX;
 
-    vec3d u  = tri_verts[1] - tri_verts[0]; u.normalize();
-    vec3d w  = tri_verts[2] - tri_verts[0]; w.normalize();
-    vec3d n = u.cross(w);
-    n.normalize();
-    norms.push_back(n);
+        verts[i].resize(v2e.size());
+        parallel_for(0, v2e.size(), [&](const uint vid)
+        {
+            uint v_a = m.edge_vert_id(v2e[vid],0);
+            uint v_b = m.edge_vert_id(v2e[vid],1);
+            if (f[v_a] < f[v_b]) std::swap(v_a, v_b);
+            double alpha = (isovalues[i] - f[v_a]) / (f[v_b] - f[v_a]);
+            verts[i][vid] = (1.0 - alpha) * m.vert(v_a) + alpha * m.vert(v_b);
+        });
+
+        norms[i].resize(tris[i].size()/3);
+        parallel_for(0, norms[i].size(), [&](const uint tid)
+        {
+            const uint * tri = tris[i].data() + 3*tid;
+            vec3d u = verts[i][tri[1]] - verts[i][tri[0]]; u.normalize();
+            vec3d w = verts[i][tri[2]] - verts[i][tri[0]]; w.normalize();
+            vec3d n = u.cross(w);
+            n.normalize();
+            norms[i][tid] = n;
+        });
+    }
 }
 
 }
@@ -37,7 +37,6 @@
 #define CINO_MARCHING_TETS_H
 
 #include <vector>
-#include <map>
 #include <sys/types.h>
 #include <cinolib/cino_inline.h>
 #include <cinolib/ipair.h>
@@ -46,6 +45,8 @@
 namespace cinolib
 {
 
+// extracts the level set of the scalar field stored in vert_data().uvw[0] at isovalue.
+// Vertices, triangles and normals are appended to the output lists
 template<class M, class V, class E, class F, class P>
 CINO_INLINE
 void marching_tets(const Tetmesh<M,V,E,F,P> & m,
@@ -53,6 +54,22 @@ void marching_tets(const Tetmesh<M,V,E,F,P> & m,
                    std::vector<vec3d>       & verts,
                    std::vector<uint>        & tris,
                    std::vector<vec3d>       & norms);
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// extracts multiple level sets in a single (parallel) sweep of the tets. verts[i],
+// tris[i] and norms[i] contain the iso-surface at isovalues[i], and are overwritten
+// (their memory is reused, if the same lists are passed frame after frame). Iso-verts
+// are shared through the mesh edges they lie on, and are ordered as triangles are
+// generated tet after tet, hence each level set coincides with the one generated by
+// the single isovalue version
+template<class M, class V, class E, class F, class P>
+CINO_INLINE
+void marching_tets(const Tetmesh<M,V,E,F,P>        & m,
+                   const std::vector<double>       & isovalues,
+                   std::vector<std::vector<vec3d>> & verts,
+                   std::vector<std::vector<uint>>  & tris,
+                   std::vector<std::vector<vec3d>> & norms);
 }
 
 #ifndef  CINO_STATIC_LIB
@@ -38,6 +38,7 @@
 #include <cinolib/linear_solvers.h>
 #include <cinolib/vertex_mass.h>
 #include <cinolib/symbols.h>
+#include <iostream>
 
 namespace cinolib
 {
@@ -57,8 +58,15 @@ void MCF(AbstractPolygonMesh<M,V,E,P> & m,
     time *= time;
     time *= time_scalar;
 
-    Eigen::SparseMatrix<double> L  = laplacian(m, COTANGENT);
-    Eigen::SparseMatrix<double> MM = mass_matrix(m);
+    // connectivity never changes: build the sparsity patterns once, and only refresh values at each iteration
+    SparseAssembler L, MM;
+    laplacian_pattern(m, L);
+    laplacian_update(m, COTANGENT, L);
+    mass_matrix_pattern(m, MM);
+    mass_matrix_update(m, MM);
+
+    // same for the factorization: the symbolic analysis is done only once
+    LinearSolver LLT(SIMPLICIAL_LLT);
 
     for(uint i=1; i<=n_iters; ++i)
     {
@@ -67,29 +75,29 @@ void MCF(AbstractPolygonMesh<M,V,E,P> & m,
         m.center_bbox();        
 
         // backward euler time integration of heat flow equation
-        Eigen::SimplicialLLT<Eigen::SparseMatrix<double>> LLT(MM - time_scalar * L);
+        if(!LLT.factorize(MM.matrix() - time_scalar * L.matrix()))
+        {
+            std::cerr << "ERROR : " << __FILE__ << ", line " << __LINE__ << " : MCF() : factorization failed, stopping at iteration " << i << std::endl;
+            break;
+        }
 
         uint nv = m.num_verts();
-        Eigen::VectorXd x(nv);
-        Eigen::VectorXd y(nv);
-        Eigen::VectorXd z(nv);
-
+        Eigen::MatrixXd xyz(nv,3);
         for(uint vid=0; vid<nv; ++vid)
         {
             vec3d pos = m.vert(vid);
-            x[vid] = pos.x();
-            y[vid] = pos.y();
-            z[vid] = pos.z();
+            xyz(vid,0) = pos.x();
+            xyz(vid,1) = pos.y();
+            xyz(vid,2) = pos.z();
         }
 
-        x = LLT.solve(MM * x);
-        y = LLT.solve(MM * y);
-        z = LLT.solve(MM * z);
+        // solve for x, y and z at once
+        LLT.solve(MM.matrix() * xyz, xyz);
 
         double residual = 0.0;
         for(uint vid=0; vid<m.num_verts(); ++vid)
         {
-            vec3d new_pos(x[vid], y[vid], z[vid]);
+            vec3d new_pos(xyz(vid,0), xyz(vid,1), xyz(vid,2));
             residual += (m.vert(vid) - new_pos).length();
             m.vert(vid) = new_pos;
         }
@@ -98,8 +106,8 @@ void MCF(AbstractPolygonMesh<M,V,E,P> & m,
 
         if (i<n_iters) // update matrices for the next iteration
         {
-            MM = mass_matrix(m);
-            if (!conformalized) L = laplacian(m, COTANGENT);
+            mass_matrix_update(m, MM);
+            if (!conformalized) laplacian_update(m, COTANGENT, L);
         }
     }
 
@@ -60,6 +60,18 @@ void AbstractDrawablePolygonMesh<Mesh>::init_drawable_stuff()
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
+template<class Mesh>
+CINO_INLINE
+MeshMemoryUsage AbstractDrawablePolygonMesh<Mesh>::memory_usage() const
+{
+    MeshMemoryUsage mu = Mesh::memory_usage();
+    memory_usage_add(mu, "drawlist",        drawlist);
+    memory_usage_add(mu, "drawlist_marked", drawlist_marked);
+    return mu;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
 template<class Mesh>
 CINO_INLINE
 void AbstractDrawablePolygonMesh<Mesh>::draw(const float) const
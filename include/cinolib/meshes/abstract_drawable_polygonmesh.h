@@ -82,6 +82,10 @@ class AbstractDrawablePolygonMesh : public virtual Mesh, public DrawableObject
 
         //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
+        MeshMemoryUsage memory_usage() const override; // includes rendering buffers
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
         void updateGL();        // regenerates rendering data for both mesh and marked elements
         void updateGL_mesh();   // regenerates rendering data for mesh elements
         void updateGL_marked(); // regenerates rendering data for marked mesh elements
@@ -62,6 +62,19 @@ void AbstractDrawablePolyhedralMesh<Mesh>::init_drawable_stuff()
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
+template<class Mesh>
+CINO_INLINE
+MeshMemoryUsage AbstractDrawablePolyhedralMesh<Mesh>::memory_usage() const
+{
+    MeshMemoryUsage mu = Mesh::memory_usage();
+    memory_usage_add(mu, "drawlist_in",     drawlist_in);
+    memory_usage_add(mu, "drawlist_out",    drawlist_out);
+    memory_usage_add(mu, "drawlist_marked", drawlist_marked);
+    return mu;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
 template<class Mesh>
 CINO_INLINE
 void AbstractDrawablePolyhedralMesh<Mesh>::draw(const float) const
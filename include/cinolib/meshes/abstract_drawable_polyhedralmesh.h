@@ -82,6 +82,10 @@ class AbstractDrawablePolyhedralMesh : public virtual Mesh, public DrawableObjec
 
         //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
+        MeshMemoryUsage memory_usage() const override; // includes rendering buffers
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
         void updateGL();         // regenerates rendering data for mesh inside/outside and marked elements
         void updateGL_in();      // regenerates rendering data for mesh inside
         void updateGL_out();     // regenerates rendering data for mesh outside
@@ -37,6 +37,8 @@
 #include <cinolib/meshes/mesh_attributes.h>
 #include <cinolib/stl_container_utilities.h>
 #include <cinolib/min_max_inf.h>
+#include <cinolib/how_many_seconds.h>
+#include <algorithm>
 #include <map>
 #include <unordered_set>
 #include <unordered_map>
@@ -94,6 +96,393 @@ void AbstractMesh<M,V,E,P>::clear()
     e2p.clear();
     p2e.clear();
     p2p.clear();
+    //
+    init_info = MeshInitStats();
+    //
+    compact = false;
+    csr_polys.clear();
+    csr_v2v.clear();
+    csr_v2e.clear();
+    csr_v2p.clear();
+    csr_e2p.clear();
+    csr_p2e.clear();
+    csr_p2p.clear();
+    //
+    v_deleted.clear();
+    e_deleted.clear();
+    p_deleted.clear();
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class M, class V, class E, class P>
+CINO_INLINE
+void AbstractMesh<M,V,E,P>::save_binary(const char * filename, const bool adjacency) const
+{
+    BinaryMeshWriter out(mesh_type());
+    binary_export(out, adjacency);
+    out.write(filename);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class M, class V, class E, class P>
+CINO_INLINE
+void AbstractMesh<M,V,E,P>::load_binary(const char * filename, const bool keep_compact)
+{
+    std::chrono::high_resolution_clock::time_point t0 = std::chrono::high_resolution_clock::now();
+
+    clear();
+    m_data.filename = std::string(filename);
+
+    BinaryMeshReader in(filename);
+    if(!in.is_open())
+    {
+        std::cerr << "ERROR : " << __FILE__ << ", line " << __LINE__ << " : load_binary() : couldn't read " << filename << std::endl;
+        return;
+    }
+
+    // generic meshes can host their specialized counterparts (e.g. a Polygonmesh can load a Trimesh)
+    bool compatible = (in.mesh_type() == (uint32_t)mesh_type()) ||
+                      (mesh_type()==POLYGONMESH    && (in.mesh_type()==TRIMESH || in.mesh_type()==QUADMESH)) ||
+                      (mesh_type()==POLYHEDRALMESH && (in.mesh_type()==TETMESH || in.mesh_type()==HEXMESH));
+    if(!compatible)
+    {
+        std::cerr << "ERROR : " << __FILE__ << ", line " << __LINE__ << " : load_binary() : " << filename << " contains a different type of mesh" << std::endl;
+        return;
+    }
+
+    if(!binary_import(in))
+    {
+        std::cerr << "ERROR : " << __FILE__ << ", line " << __LINE__ << " : load_binary() : " << filename << " is corrupted or incomplete" << std::endl;
+        clear();
+        return;
+    }
+
+    if(keep_compact) adj_compact();
+    else             adj_expand();
+    update_bbox();
+
+    std::chrono::high_resolution_clock::time_point t1 = std::chrono::high_resolution_clock::now();
+
+    init_info.num_verts  = num_verts();
+    init_info.num_edges  = num_edges();
+    init_info.num_polys  = num_polys();
+    init_info.secs_total = how_many_seconds(t0,t1);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class M, class V, class E, class P>
+CINO_INLINE
+void AbstractMesh<M,V,E,P>::binary_export_connectivity(BinaryMeshWriter & out, const bool adjacency) const
+{
+    out.add(BIN_VERTS, verts);
+    out.add(BIN_EDGES, edges);
+    if(compact) out.add(BIN_POLYS, csr_polys);
+    else        out.add(BIN_POLYS, polys);
+
+    if(!adjacency) return;
+
+    if(compact)
+    {
+        out.add(BIN_V2V, csr_v2v);
+        out.add(BIN_V2E, csr_v2e);
+        out.add(BIN_V2P, csr_v2p);
+        out.add(BIN_E2P, csr_e2p);
+        out.add(BIN_P2E, csr_p2e);
+        out.add(BIN_P2P, csr_p2p);
+    }
+    else
+    {
+        out.add(BIN_V2V, v2v);
+        out.add(BIN_V2E, v2e);
+        out.add(BIN_V2P, v2p);
+        out.add(BIN_E2P, e2p);
+        out.add(BIN_P2E, p2e);
+        out.add(BIN_P2P, p2p);
+    }
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class M, class V, class E, class P>
+CINO_INLINE
+void AbstractMesh<M,V,E,P>::binary_export_attributes(BinaryMeshWriter & out) const
+{
+    out.add_attribute(BIN_VERT_NORMAL,  v_data, &V::normal);
+    out.add_attribute(BIN_VERT_COLOR,   v_data, &V::color);
+    out.add_attribute(BIN_VERT_UVW,     v_data, &V::uvw);
+    out.add_attribute(BIN_VERT_LABEL,   v_data, &V::label);
+    out.add_attribute(BIN_VERT_QUALITY, v_data, &V::quality);
+    out.add_attribute(BIN_VERT_FLAGS,   v_data, &V::flags);
+    out.add_attribute(BIN_EDGE_COLOR,   e_data, &E::color);
+    out.add_attribute(BIN_EDGE_LABEL,   e_data, &E::label);
+    out.add_attribute(BIN_EDGE_FLAGS,   e_data, &E::flags);
+    out.add_attribute(BIN_POLY_COLOR,   p_data, &P::color);
+    out.add_attribute(BIN_POLY_LABEL,   p_data, &P::label);
+    out.add_attribute(BIN_POLY_QUALITY, p_data, &P::quality);
+    out.add_attribute(BIN_POLY_FLAGS,   p_data, &P::flags);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class M, class V, class E, class P>
+CINO_INLINE
+bool AbstractMesh<M,V,E,P>::binary_import_connectivity(const BinaryMeshReader & in)
+{
+    // elements and adjacency are copied straight into the compact (CSR) tables.
+    // All ids are bounds checked, except for the entries of csr_polys (which
+    // may be verts or faces, depending on the mesh type) that are checked by
+    // the specialized binary_import()
+    assert(verts.empty() && !compact);
+    if(!in.read(BIN_VERTS, verts) ||
+       !in.read(BIN_EDGES, edges, verts.size()) || edges.size()%2!=0 ||
+       !in.read(BIN_POLYS, csr_polys))
+    {
+        return false;
+    }
+    uint nv = verts.size();
+    uint ne = edges.size()/2;
+    uint np = csr_polys.num_rows();
+    if(!in.read(BIN_V2V, csr_v2v, nv) || csr_v2v.num_rows()!=nv ||
+       !in.read(BIN_V2E, csr_v2e, ne) || csr_v2e.num_rows()!=nv ||
+       !in.read(BIN_V2P, csr_v2p, np) || csr_v2p.num_rows()!=nv ||
+       !in.read(BIN_E2P, csr_e2p, np) || csr_e2p.num_rows()!=ne ||
+       !in.read(BIN_P2E, csr_p2e, ne) || csr_p2e.num_rows()!=np ||
+       !in.read(BIN_P2P, csr_p2p, np) || csr_p2p.num_rows()!=np)
+    {
+        return false;
+    }
+    compact = true;
+
+    v_data.resize(num_verts());
+    e_data.resize(num_edges());
+    p_data.resize(num_polys());
+    return true;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class M, class V, class E, class P>
+CINO_INLINE
+void AbstractMesh<M,V,E,P>::binary_import_attributes(const BinaryMeshReader & in, const bool edge_attributes)
+{
+    // missing sections leave the attributes at their default values
+    in.read_attribute(BIN_VERT_NORMAL,  v_data, &V::normal);
+    in.read_attribute(BIN_VERT_COLOR,   v_data, &V::color);
+    in.read_attribute(BIN_VERT_UVW,     v_data, &V::uvw);
+    in.read_attribute(BIN_VERT_LABEL,   v_data, &V::label);
+    in.read_attribute(BIN_VERT_QUALITY, v_data, &V::quality);
+    in.read_attribute(BIN_VERT_FLAGS,   v_data, &V::flags);
+    if(edge_attributes)
+    {
+        in.read_attribute(BIN_EDGE_COLOR, e_data, &E::color);
+        in.read_attribute(BIN_EDGE_LABEL, e_data, &E::label);
+        in.read_attribute(BIN_EDGE_FLAGS, e_data, &E::flags);
+    }
+    in.read_attribute(BIN_POLY_COLOR,   p_data, &P::color);
+    in.read_attribute(BIN_POLY_LABEL,   p_data, &P::label);
+    in.read_attribute(BIN_POLY_QUALITY, p_data, &P::quality);
+    in.read_attribute(BIN_POLY_FLAGS,   p_data, &P::flags);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class M, class V, class E, class P>
+CINO_INLINE
+void AbstractMesh<M,V,E,P>::adj_compact()
+{
+    if(compact) return;
+
+    // build each table and immediately release its mutable counterpart,
+    // so that the peak memory never exceeds the size of the biggest table
+    csr_polys.build(polys); std::vector<std::vector<uint>>().swap(polys);
+    csr_v2v.build(v2v);     std::vector<std::vector<uint>>().swap(v2v);
+    csr_v2e.build(v2e);     std::vector<std::vector<uint>>().swap(v2e);
+    csr_v2p.build(v2p);     std::vector<std::vector<uint>>().swap(v2p);
+    csr_e2p.build(e2p);     std::vector<std::vector<uint>>().swap(e2p);
+    csr_p2e.build(p2e);     std::vector<std::vector<uint>>().swap(p2e);
+    csr_p2p.build(p2p);     std::vector<std::vector<uint>>().swap(p2p);
+
+    compact = true;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class M, class V, class E, class P>
+CINO_INLINE
+void AbstractMesh<M,V,E,P>::adj_expand()
+{
+    if(!compact) return;
+
+    csr_polys.unpack(polys); csr_polys.clear();
+    csr_v2v.unpack(v2v);     csr_v2v.clear();
+    csr_v2e.unpack(v2e);     csr_v2e.clear();
+    csr_v2p.unpack(v2p);     csr_v2p.clear();
+    csr_e2p.unpack(e2p);     csr_e2p.clear();
+    csr_p2e.unpack(p2e);     csr_p2e.clear();
+    csr_p2p.unpack(p2p);     csr_p2p.clear();
+
+    compact = false;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class M, class V, class E, class P>
+CINO_INLINE
+void AbstractMesh<M,V,E,P>::set_deferred_removal(const bool b)
+{
+    if(defer_removal && !b) collect_garbage();
+    defer_removal = b;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class M, class V, class E, class P>
+CINO_INLINE
+uint AbstractMesh<M,V,E,P>::num_deleted_verts() const
+{
+    return std::count(v_deleted.begin(), v_deleted.end(), true);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class M, class V, class E, class P>
+CINO_INLINE
+uint AbstractMesh<M,V,E,P>::num_deleted_edges() const
+{
+    return std::count(e_deleted.begin(), e_deleted.end(), true);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class M, class V, class E, class P>
+CINO_INLINE
+uint AbstractMesh<M,V,E,P>::num_deleted_polys() const
+{
+    return std::count(p_deleted.begin(), p_deleted.end(), true);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class M, class V, class E, class P>
+CINO_INLINE
+void AbstractMesh<M,V,E,P>::mark_deleted(std::vector<bool> & deleted, const uint id, const uint size)
+{
+    assert(id < size);
+    if(deleted.size() < size) deleted.resize(size, false);
+    deleted.at(id) = true;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class M, class V, class E, class P>
+CINO_INLINE
+std::vector<int> AbstractMesh<M,V,E,P>::garbage_id_map(const std::vector<bool> & deleted, const uint size, uint & new_size)
+{
+    std::vector<int> map(size);
+    new_size = 0;
+    for(uint id=0; id<size; ++id)
+    {
+        map.at(id) = (id < deleted.size() && deleted[id]) ? -1 : static_cast<int>(new_size++);
+    }
+    return map;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class M, class V, class E, class P>
+CINO_INLINE
+void AbstractMesh<M,V,E,P>::garbage_rename(std::vector<uint> & ids, const std::vector<int> & map)
+{
+    for(uint & id : ids)
+    {
+        assert(map.at(id)>=0 && "reference to a deleted element");
+        id = map[id];
+    }
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class M, class V, class E, class P>
+template<class T>
+CINO_INLINE
+void AbstractMesh<M,V,E,P>::garbage_compact(std::vector<T> & v, const std::vector<int> & map, const uint new_size)
+{
+    // ids only decrease, hence elements can be moved in place
+    assert(v.size()==map.size());
+    for(uint id=0; id<map.size(); ++id)
+    {
+        if(map[id]>=0 && static_cast<uint>(map[id])!=id) v[map[id]] = std::move(v[id]);
+    }
+    v.resize(new_size);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class M, class V, class E, class P>
+CINO_INLINE
+MeshMemoryUsage AbstractMesh<M,V,E,P>::memory_usage() const
+{
+    MeshMemoryUsage mu;
+    memory_usage_add(mu, "verts",  verts);
+    memory_usage_add(mu, "edges",  edges);
+    memory_usage_add(mu, "m_data", sizeof(M), sizeof(M));
+    memory_usage_add(mu, "v_data", v_data);
+    memory_usage_add(mu, "e_data", e_data);
+    memory_usage_add(mu, "p_data", p_data);
+    if(compact)
+    {
+        memory_usage_add(mu, "polys (csr)", csr_polys);
+        memory_usage_add(mu, "v2v (csr)",   csr_v2v);
+        memory_usage_add(mu, "v2e (csr)",   csr_v2e);
+        memory_usage_add(mu, "v2p (csr)",   csr_v2p);
+        memory_usage_add(mu, "e2p (csr)",   csr_e2p);
+        memory_usage_add(mu, "p2e (csr)",   csr_p2e);
+        memory_usage_add(mu, "p2p (csr)",   csr_p2p);
+    }
+    else
+    {
+        memory_usage_add(mu, "polys", polys);
+        memory_usage_add(mu, "v2v",   v2v);
+        memory_usage_add(mu, "v2e",   v2e);
+        memory_usage_add(mu, "v2p",   v2p);
+        memory_usage_add(mu, "e2p",   e2p);
+        memory_usage_add(mu, "p2e",   p2e);
+        memory_usage_add(mu, "p2p",   p2p);
+    }
+    if(!v_deleted.empty()) memory_usage_add(mu, "v_deleted", v_deleted);
+    if(!e_deleted.empty()) memory_usage_add(mu, "e_deleted", e_deleted);
+    if(!p_deleted.empty()) memory_usage_add(mu, "p_deleted", p_deleted);
+    return mu;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class M, class V, class E, class P>
+CINO_INLINE
+void AbstractMesh<M,V,E,P>::shrink_to_fit()
+{
+    cinolib::shrink_to_fit(verts);
+    cinolib::shrink_to_fit(edges);
+    cinolib::shrink_to_fit(v_data);
+    cinolib::shrink_to_fit(e_data);
+    cinolib::shrink_to_fit(p_data);
+    cinolib::shrink_to_fit(polys);
+    cinolib::shrink_to_fit(v2v);
+    cinolib::shrink_to_fit(v2e);
+    cinolib::shrink_to_fit(v2p);
+    cinolib::shrink_to_fit(e2p);
+    cinolib::shrink_to_fit(p2e);
+    cinolib::shrink_to_fit(p2p);
+    cinolib::shrink_to_fit(csr_polys);
+    cinolib::shrink_to_fit(csr_v2v);
+    cinolib::shrink_to_fit(csr_v2e);
+    cinolib::shrink_to_fit(csr_v2p);
+    cinolib::shrink_to_fit(csr_e2p);
+    cinolib::shrink_to_fit(csr_p2e);
+    cinolib::shrink_to_fit(csr_p2p);
 }
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
@@ -447,8 +836,8 @@ std::vector<uint> AbstractMesh<M,V,E,P>::adj_e2e(const uint eid) const
     std::unordered_set<uint> unique_e_list;
     uint v0 = this->edge_vert_id(eid,0);
     uint v1 = this->edge_vert_id(eid,1);
-    for(uint nbr : this->adj_v2e(v0)) if(nbr != eid) unique_e_list.insert(nbr);
-    for(uint nbr : this->adj_v2e(v1)) if(nbr != eid) unique_e_list.insert(nbr);
+    for(uint nbr : this->adj_v2e_span(v0)) if(nbr != eid) unique_e_list.insert(nbr);
+    for(uint nbr : this->adj_v2e_span(v1)) if(nbr != eid) unique_e_list.insert(nbr);
     std::vector<uint> e_list(unique_e_list.begin(), unique_e_list.end());
     return e_list;
 }
@@ -468,7 +857,7 @@ std::set<uint> AbstractMesh<M,V,E,P>::vert_n_ring(const uint vid, const uint n)
         std::set<uint> next_active_set;
 
         for(uint curr : active_set)
-        for(uint nbr  : adj_v2v(curr))
+        for(uint nbr  : adj_v2v_span(curr))
         {
             if (DOES_NOT_CONTAIN(ring,nbr) && nbr != vid) next_active_set.insert(nbr);
             ring.insert(nbr);
@@ -485,7 +874,7 @@ template<class M, class V, class E, class P>
 CINO_INLINE
 bool AbstractMesh<M,V,E,P>::verts_are_adjacent(const uint vid0, const uint vid1) const
 {
-    for(uint nbr : adj_v2v(vid0)) if (vid1==nbr) return true;
+    for(uint nbr : adj_v2v_span(vid0)) if (vid1==nbr) return true;
     return false;
 }
 
@@ -521,7 +910,7 @@ void AbstractMesh<M,V,E,P>::vert_weights_uniform(const uint vid, std::vector<std
 {
     wgts.clear();
     double w = 1.0; // / (double)nbrs.size(); // <= WARNING: makes the matrix non-symmetric!!!!!
-    for(uint nbr : adj_v2v(vid))
+    for(uint nbr : adj_v2v_span(vid))
     {
         wgts.push_back(std::make_pair(nbr,w));
     }
@@ -533,7 +922,7 @@ template<class M, class V, class E, class P>
 CINO_INLINE
 bool AbstractMesh<M,V,E,P>::vert_is_local_min(const uint vid, const int tex_coord) const
 {
-    for(uint nbr : adj_v2v(vid))
+    for(uint nbr : adj_v2v_span(vid))
     {
         switch (tex_coord)
         {
@@ -552,7 +941,7 @@ template<class M, class V, class E, class P>
 CINO_INLINE
 bool AbstractMesh<M,V,E,P>::vert_is_local_max(const uint vid, const int tex_coord) const
 {
-    for(uint nbr : adj_v2v(vid))
+    for(uint nbr : adj_v2v_span(vid))
     {
         switch (tex_coord)
         {
@@ -571,8 +960,8 @@ template<class M, class V, class E, class P>
 CINO_INLINE
 uint AbstractMesh<M,V,E,P>::vert_valence(const uint vid) const
 {
-    assert(adj_v2v(vid).size() == adj_v2e(vid).size());
-    return adj_v2v(vid).size();
+    assert(adj_v2v_span(vid).size() == adj_v2e_span(vid).size());
+    return adj_v2v_span(vid).size();
 }
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
@@ -731,7 +1120,7 @@ CINO_INLINE
 int AbstractMesh<M,V,E,P>::edge_id(const uint vid0, const uint vid1) const
 {
     assert(vid0 != vid1);
-    for(uint eid : adj_v2e(vid0))
+    for(uint eid : adj_v2e_span(vid0))
     {
         if(edge_contains_vert(eid,vid0) && edge_contains_vert(eid,vid1))
         {
@@ -766,7 +1155,7 @@ template<class M, class V, class E, class P>
 CINO_INLINE
 uint AbstractMesh<M,V,E,P>::edge_valence(const uint eid) const
 {
-    return this->adj_e2p(eid).size();
+    return this->adj_e2p_span(eid).size();
 }
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
@@ -935,7 +1324,7 @@ template<class M, class V, class E, class P>
 CINO_INLINE
 uint AbstractMesh<M,V,E,P>::poly_vert_id(const uint pid, const uint offset) const
 {
-    return adj_p2v(pid).at(offset);
+    return adj_p2v_span(pid).at(offset);
 }
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
@@ -960,7 +1349,7 @@ CINO_INLINE
 vec3d AbstractMesh<M,V,E,P>::poly_centroid(const uint pid) const
 {
     vec3d c(0,0,0);
-    for(uint vid : adj_p2v(pid)) c += vert(vid);
+    for(uint vid : adj_p2v_span(pid)) c += vert(vid);
     c /= static_cast<double>(verts_per_poly(pid));
     return c;
 }
@@ -1030,11 +1419,11 @@ std::vector<uint> AbstractMesh<M,V,E,P>::poly_verts_id(const uint pid, const boo
 {
     if(sort_by_vid)
     {
-        std::vector<uint> v_list = this->adj_p2v(pid);
+        std::vector<uint> v_list = this->adj_p2v_span(pid).to_vector();
         SORT_VEC(v_list);
         return v_list;
     }
-    return this->adj_p2v(pid);
+    return this->adj_p2v_span(pid).to_vector();
 }
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
@@ -1045,7 +1434,7 @@ std::vector<uint> AbstractMesh<M,V,E,P>::poly_v2v(const uint pid, const uint vid
 {
     assert(this->poly_contains_vert(pid,vid));
     std::vector<uint> verts;
-    for(uint eid : this->adj_v2e(vid))
+    for(uint eid : this->adj_v2e_span(vid))
     {
         if(this->poly_contains_edge(pid,eid)) verts.push_back(this->vert_opposite_to(eid,vid));
     }
@@ -1060,7 +1449,7 @@ std::vector<uint> AbstractMesh<M,V,E,P>::poly_v2e(const uint pid, const uint vid
 {
     assert(this->poly_contains_vert(pid,vid));
     std::vector<uint> edges;
-    for(uint eid : this->adj_v2e(vid))
+    for(uint eid : this->adj_v2e_span(vid))
     {
         if(this->poly_contains_edge(pid,eid)) edges.push_back(eid);
     }
@@ -1085,7 +1474,7 @@ uint AbstractMesh<M,V,E,P>::poly_edge_id(const uint fid, const uint vid0, const
     assert(poly_contains_vert(fid,vid0));
     assert(poly_contains_vert(fid,vid1));
 
-    for(uint eid : adj_p2e(fid))
+    for(uint eid : adj_p2e_span(fid))
     {
         if (edge_contains_vert(eid,vid0) && edge_contains_vert(eid,vid1)) return eid;
     }
@@ -1100,7 +1489,7 @@ template<class M, class V, class E, class P>
 CINO_INLINE
 bool AbstractMesh<M,V,E,P>::poly_contains_edge(const uint pid, const uint eid) const
 {
-    for(uint e : adj_p2e(pid)) if (e == eid) return true;
+    for(uint e : adj_p2e_span(pid)) if (e == eid) return true;
     return false;
 }
 
@@ -1110,7 +1499,7 @@ template<class M, class V, class E, class P>
 CINO_INLINE
 bool AbstractMesh<M,V,E,P>::poly_contains_edge(const uint pid, const uint vid0, const uint vid1) const
 {
-    for(uint eid : adj_p2e(pid))
+    for(uint eid : adj_p2e_span(pid))
     {
         if (edge_contains_vert(eid, vid0) &&
             edge_contains_vert(eid, vid1))
@@ -1217,7 +1606,7 @@ template<class M, class V, class E, class P>
 CINO_INLINE
 bool AbstractMesh<M,V,E,P>::poly_contains_vert(const uint pid, const uint vid) const
 {
-    for(uint v : adj_p2v(pid)) if(v == vid) return true;
+    for(uint v : adj_p2v_span(pid)) if(v == vid) return true;
     return false;
 }
 
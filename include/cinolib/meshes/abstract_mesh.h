@@ -45,6 +45,11 @@
 #include <cinolib/color.h>
 #include <cinolib/symbols.h>
 #include <cinolib/ipair.h>
+#include <cinolib/span.h>
+#include <cinolib/meshes/adjacency_csr.h>
+#include <cinolib/meshes/batch_init.h>
+#include <cinolib/meshes/mesh_memory.h>
+#include <cinolib/io/binary_mesh.h>
 
 typedef enum
 {
@@ -61,6 +66,19 @@ MeshType;
 namespace cinolib
 {
 
+// old to new element ids, as returned by collect_garbage().
+// Deleted elements are mapped to -1
+typedef struct
+{
+    std::vector<int> vmap;
+    std::vector<int> emap;
+    std::vector<int> fmap; // polyhedral meshes only
+    std::vector<int> pmap;
+}
+MeshIdMaps;
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
 template<class M, // mesh attributes
          class V, // vert attributes
          class E, // edge attributes
@@ -87,6 +105,44 @@ class AbstractMesh
         std::vector<std::vector<uint>> p2e; // poly to edge adjacency
         std::vector<std::vector<uint>> p2p; // poly to poly adjacency
 
+        // compressed (read-only) counterparts of the adjacency tables above.
+        // When the mesh is compact these are the only valid copies of polys
+        // and relations, and the vectors of vectors above are left empty
+        bool         compact = false;
+        AdjacencyCSR csr_polys;
+        AdjacencyCSR csr_v2v;
+        AdjacencyCSR csr_v2e;
+        AdjacencyCSR csr_v2p;
+        AdjacencyCSR csr_e2p;
+        AdjacencyCSR csr_p2e;
+        AdjacencyCSR csr_p2p;
+
+        Span<uint> polys_span(const uint pid) const { return compact ? csr_polys.row(pid) : Span<uint>(polys.at(pid)); }
+
+        // tombstones for deferred removal (see set_deferred_removal()).
+        // They are allocated at the first removal, and freed by collect_garbage()
+        bool              defer_removal = false;
+        std::vector<bool> v_deleted;
+        std::vector<bool> e_deleted;
+        std::vector<bool> p_deleted;
+
+        // helpers for collect_garbage()
+                         static void             mark_deleted   (std::vector<bool> & deleted, const uint id, const uint size);
+                         static std::vector<int> garbage_id_map (const std::vector<bool> & deleted, const uint size, uint & new_size);
+                         static void             garbage_rename (std::vector<uint> & ids, const std::vector<int> & map);
+        template<class T> static void             garbage_compact(std::vector<T> & v, const std::vector<int> & map, const uint new_size);
+
+        MeshInitStats init_info; // filled by init()
+
+        // native binary format (see io/binary_mesh.h). The helpers handle the data
+        // shared by all meshes, the virtual methods add the mesh specific sections
+        virtual void binary_export(BinaryMeshWriter & out, const bool adjacency) const = 0;
+        virtual bool binary_import(const BinaryMeshReader & in) = 0;
+                void binary_export_connectivity(BinaryMeshWriter & out, const bool adjacency) const;
+                void binary_export_attributes  (BinaryMeshWriter & out) const;
+                bool binary_import_connectivity(const BinaryMeshReader & in);
+                void binary_import_attributes  (const BinaryMeshReader & in, const bool edge_attributes = true);
+
     public:
 
         typedef M M_type;
@@ -111,6 +167,14 @@ class AbstractMesh
         virtual void load(const char * filename) = 0;
         virtual void save(const char * filename) const = 0;
 
+        // native binary format (.cino). Saving the adjacency makes files bigger
+        // but loading faster, as connectivity is copied rather than derived. The
+        // mesh can be loaded directly in compact mode (see adj_compact())
+        void save_binary(const char * filename, const bool adjacency = true) const;
+        void load_binary(const char * filename, const bool keep_compact = false);
+
+        const MeshInitStats & init_stats() const { return init_info; }
+
         //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
                 void update_bbox();
@@ -133,13 +197,13 @@ class AbstractMesh
         //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
         virtual uint verts_per_poly(const uint pid) const = 0;
-        virtual uint edges_per_poly(const uint pid) const { return this->p2e.at(pid).size(); }
+        virtual uint edges_per_poly(const uint pid) const { return this->adj_p2e_span(pid).size(); }
 
         //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
         uint num_verts() const { return verts.size();     }
         uint num_edges() const { return edges.size() / 2; }
-        uint num_polys() const { return polys.size();     }
+        uint num_polys() const { return compact ? csr_polys.num_rows() : polys.size(); }
 
         //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
@@ -193,6 +257,61 @@ class AbstractMesh
 
         //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
+        // Compact mode: polys and adjacency tables are moved into a compressed
+        // sparse row (CSR) layout, which is much lighter and cache friendly, but
+        // read-only. While the mesh is compact, only the *_span accessors below
+        // (and the queries built on top of them) can be used to navigate the mesh.
+        // Call adj_expand() to go back to the mutable layout before using any
+        // editing operator (e.g. poly_add, poly_remove, edge_split,...)
+        //
+                void       adj_compact();
+                void       adj_expand();
+                bool       adj_is_compact() const { return compact; }
+                Span<uint> adj_v2v_span(const uint vid) const { return compact ? csr_v2v.row(vid) : Span<uint>(v2v.at(vid)); }
+                Span<uint> adj_v2e_span(const uint vid) const { return compact ? csr_v2e.row(vid) : Span<uint>(v2e.at(vid)); }
+                Span<uint> adj_v2p_span(const uint vid) const { return compact ? csr_v2p.row(vid) : Span<uint>(v2p.at(vid)); }
+                Span<uint> adj_e2p_span(const uint eid) const { return compact ? csr_e2p.row(eid) : Span<uint>(e2p.at(eid)); }
+                Span<uint> adj_p2e_span(const uint pid) const { return compact ? csr_p2e.row(pid) : Span<uint>(p2e.at(pid)); }
+                Span<uint> adj_p2p_span(const uint pid) const { return compact ? csr_p2p.row(pid) : Span<uint>(p2p.at(pid)); }
+        virtual Span<uint> adj_p2v_span(const uint pid) const { return adj_p2v(pid); }
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        // Deferred removal: by default, removing an element moves the last element of
+        // the same kind into its slot, so that ids stay dense. Each removal therefore
+        // renames another element, rewriting all the adjacency lists that refer to it,
+        // which makes bulk edits (e.g. polys_remove, decimation, cuts) quadratic. When
+        // removal is deferred, removed elements are just disconnected from the rest of
+        // the mesh and flagged as deleted (tombstones): the ids of all other elements
+        // do not change, and num_verts(), num_edges(),... keep counting the deleted
+        // elements too (loops over ids should skip them, see *_is_deleted()).
+        // collect_garbage() removes all the tombstones in a single O(n) pass, renaming
+        // the surviving elements (their relative order is preserved) and returning the
+        // old to new id maps. Switching deferred removal off collects the garbage.
+        // Collect garbage before saving, rendering or compacting the mesh
+        //
+                void       set_deferred_removal(const bool b);
+                bool       deferred_removal() const { return defer_removal; }
+                bool       vert_is_deleted(const uint vid) const { return vid < v_deleted.size() && v_deleted[vid]; }
+                bool       edge_is_deleted(const uint eid) const { return eid < e_deleted.size() && e_deleted[eid]; }
+                bool       poly_is_deleted(const uint pid) const { return pid < p_deleted.size() && p_deleted[pid]; }
+                uint       num_deleted_verts() const;
+                uint       num_deleted_edges() const;
+                uint       num_deleted_polys() const;
+        virtual MeshIdMaps collect_garbage() = 0;
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        // memory used and reserved by each container of the mesh (see mesh_memory.h).
+        // shrink_to_fit() releases the reserved but unused memory, e.g. the slack
+        // left by reserve() guesses or by repeated edits. It does not alter the
+        // layout of the mesh (use adj_compact() to switch to the CSR tables)
+        //
+        virtual MeshMemoryUsage memory_usage() const;
+        virtual void            shrink_to_fit();
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
         const M & mesh_data()               const { return m_data;         }
               M & mesh_data()                     { return m_data;         }
         const V & vert_data(const uint vid) const { return v_data.at(vid); }
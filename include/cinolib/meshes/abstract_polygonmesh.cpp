@@ -41,6 +41,8 @@
 #include <cinolib/geometry/polygon_utils.h>
 #include <cinolib/vector_serialization.h>
 #include <cinolib/how_many_seconds.h>
+#include <cinolib/thread_pool.h>
+#include <cinolib/trace_profiler.h>
 #include <cinolib/deg_rad.h>
 #include <unordered_set>
 #include <queue>
@@ -68,7 +70,13 @@ void AbstractPolygonMesh<M,V,E,P>::load(const char * filename)
     std::string str(filename);
     std::string filetype = str.substr(str.size()-4,4);
 
-    if (filetype.compare(".off") == 0 ||
+    if (str.size()>5 && (str.compare(str.size()-5,5,".cino") == 0 ||
+                         str.compare(str.size()-5,5,".CINO") == 0))
+    {
+        this->load_binary(filename);
+        return;
+    }
+    else if (filetype.compare(".off") == 0 ||
         filetype.compare(".OFF") == 0)
     {
         read_OFF(filename, pos, poly_pos, poly_col);
@@ -100,11 +108,18 @@ template<class M, class V, class E, class P>
 CINO_INLINE
 void AbstractPolygonMesh<M,V,E,P>::save(const char * filename) const
 {
-    std::vector<double> coords = serialized_xyz_from_vec3d(this->verts);
-
     std::string str(filename);
     std::string filetype = str.substr(str.size()-3,3);
 
+    if (str.size()>5 && (str.compare(str.size()-5,5,".cino") == 0 ||
+                         str.compare(str.size()-5,5,".CINO") == 0))
+    {
+        this->save_binary(filename);
+        return;
+    }
+
+    std::vector<double> coords = serialized_xyz_from_vec3d(this->verts);
+
     if (filetype.compare("off") == 0 ||
         filetype.compare("OFF") == 0)
     {
@@ -141,6 +156,60 @@ void AbstractPolygonMesh<M,V,E,P>::save(const char * filename) const
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
+template<class M, class V, class E, class P>
+CINO_INLINE
+void AbstractPolygonMesh<M,V,E,P>::binary_export(BinaryMeshWriter & out, const bool adjacency) const
+{
+    this->binary_export_connectivity(out, adjacency);
+    if(adjacency) out.add(BIN_POLY_TRIS, poly_triangles);
+    this->binary_export_attributes(out);
+    out.add_attribute(BIN_POLY_NORMAL, this->p_data, &P::normal);
+    out.add_attribute(BIN_POLY_AO,     this->p_data, &P::AO);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class M, class V, class E, class P>
+CINO_INLINE
+bool AbstractPolygonMesh<M,V,E,P>::binary_import(const BinaryMeshReader & in)
+{
+    bool same_edges = true;
+    if(in.has(BIN_V2V))
+    {
+        if(!this->binary_import_connectivity(in) || !BinaryMeshReader::ids_below(this->csr_polys.entries, this->num_verts())) return false;
+        if(!in.read(BIN_POLY_TRIS, poly_triangles, this->num_verts()) || poly_triangles.size()!=this->num_polys())
+        {
+            this->adj_expand();
+            poly_triangles.clear();
+            poly_triangles.resize(this->num_polys());
+            update_p_tessellations();
+        }
+    }
+    else // adjacency was not saved: rebuild it
+    {
+        std::vector<vec3d>             tmp_verts;
+        std::vector<uint>              tmp_edges;
+        std::vector<std::vector<uint>> tmp_polys;
+        if(!in.read(BIN_VERTS, tmp_verts) || !in.read(BIN_POLYS, tmp_polys, tmp_verts.size())) return false;
+        in.read(BIN_EDGES, tmp_edges);
+        init(tmp_verts, tmp_polys);
+        // edge ids are reproduced only if the mesh was not edited after its initialization
+        same_edges = (tmp_edges == this->edges);
+    }
+
+    this->binary_import_attributes(in, same_edges);
+    in.read_attribute(BIN_POLY_AO, this->p_data, &P::AO);
+    if(!in.read_attribute(BIN_POLY_NORMAL, this->p_data, &P::normal))
+    {
+        this->adj_expand();
+        update_p_normals();
+        update_v_normals();
+    }
+    return true;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
 template<class M, class V, class E, class P>
 CINO_INLINE
 void AbstractPolygonMesh<M,V,E,P>::clear()
@@ -151,49 +220,249 @@ void AbstractPolygonMesh<M,V,E,P>::clear()
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
+template<class M, class V, class E, class P>
+CINO_INLINE
+MeshMemoryUsage AbstractPolygonMesh<M,V,E,P>::memory_usage() const
+{
+    MeshMemoryUsage mu = AbstractMesh<M,V,E,P>::memory_usage();
+    memory_usage_add(mu, "poly_triangles", poly_triangles);
+    return mu;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class M, class V, class E, class P>
+CINO_INLINE
+void AbstractPolygonMesh<M,V,E,P>::shrink_to_fit()
+{
+    AbstractMesh<M,V,E,P>::shrink_to_fit();
+    cinolib::shrink_to_fit(poly_triangles);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class M, class V, class E, class P>
+CINO_INLINE
+MeshIdMaps AbstractPolygonMesh<M,V,E,P>::collect_garbage()
+{
+    assert(!this->adj_is_compact() && "call adj_expand() before editing the mesh");
+
+    uint nv, ne, np;
+    MeshIdMaps maps;
+    maps.vmap = this->garbage_id_map(this->v_deleted, this->num_verts(), nv);
+    maps.emap = this->garbage_id_map(this->e_deleted, this->num_edges(), ne);
+    maps.pmap = this->garbage_id_map(this->p_deleted, this->num_polys(), np);
+    this->v_deleted.clear();
+    this->e_deleted.clear();
+    this->p_deleted.clear();
+    if(nv==this->num_verts() && ne==this->num_edges() && np==this->num_polys()) return maps;
+
+    // move surviving elements to their new slots...
+    this->garbage_compact(this->verts,  maps.vmap, nv);
+    this->garbage_compact(this->v_data, maps.vmap, nv);
+    this->garbage_compact(this->v2v,    maps.vmap, nv);
+    this->garbage_compact(this->v2e,    maps.vmap, nv);
+    this->garbage_compact(this->v2p,    maps.vmap, nv);
+    for(uint eid=0; eid<maps.emap.size(); ++eid)
+    {
+        if(maps.emap[eid]<0) continue;
+        this->edges[2*maps.emap[eid]  ] = this->edges[2*eid  ];
+        this->edges[2*maps.emap[eid]+1] = this->edges[2*eid+1];
+    }
+    this->edges.resize(2*ne);
+    this->garbage_compact(this->e_data,   maps.emap, ne);
+    this->garbage_compact(this->e2p,      maps.emap, ne);
+    this->garbage_compact(this->polys,    maps.pmap, np);
+    this->garbage_compact(this->p_data,   maps.pmap, np);
+    this->garbage_compact(this->p2e,      maps.pmap, np);
+    this->garbage_compact(this->p2p,      maps.pmap, np);
+    this->garbage_compact(poly_triangles, maps.pmap, np);
+
+    // ...and rename all references to them
+    for(uint vid=0; vid<nv; ++vid)
+    {
+        this->garbage_rename(this->v2v.at(vid), maps.vmap);
+        this->garbage_rename(this->v2e.at(vid), maps.emap);
+        this->garbage_rename(this->v2p.at(vid), maps.pmap);
+    }
+    this->garbage_rename(this->edges, maps.vmap);
+    for(uint eid=0; eid<ne; ++eid)
+    {
+        this->garbage_rename(this->e2p.at(eid), maps.pmap);
+    }
+    for(uint pid=0; pid<np; ++pid)
+    {
+        this->garbage_rename(this->polys.at(pid),    maps.vmap);
+        this->garbage_rename(this->p2e.at(pid),      maps.emap);
+        this->garbage_rename(this->p2p.at(pid),      maps.pmap);
+        this->garbage_rename(poly_triangles.at(pid), maps.vmap);
+    }
+    return maps;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
 template<class M, class V, class E, class P>
 CINO_INLINE
 void AbstractPolygonMesh<M,V,E,P>::init(const std::vector<vec3d>             & verts,
                                         const std::vector<std::vector<uint>> & polys)
 {
+    CINO_PROFILE_ZONE("AbstractPolygonMesh::init");
+    // Batch construction of the mesh connectivity. The result is exactly the
+    // same mesh one would obtain adding one poly at a time with poly_add()
+    // (same element ids and same ordering of all the adjacency lists), but
+    // edges are extracted with a single sort, adjacency tables are filled in
+    // one pass, and normals/tessellations are computed only once at the end
+
+    assert(!this->adj_is_compact());
     std::chrono::high_resolution_clock::time_point t0 = std::chrono::high_resolution_clock::now();
 
-    // pre-allocate memory
+    MeshInitStats & stats = this->init_info;
+    stats = MeshInitStats();
+
+    // detect duplicated polys (i.e. polys defined by the same set of verts)
+    AdjacencyCSR sorted_polys(polys);
+    sort_rows(sorted_polys);
+    std::vector<uint> unique_pid;
+    uint np = ids_by_first_occurrence(sorted_polys, unique_pid);
+    sorted_polys.clear();
+    stats.num_dup_polys = polys.size() - np;
+    if(stats.num_dup_polys>0)
+    {
+        std::cout << ANSI_fg_color_red << "WARNING: " << stats.num_dup_polys << " duplicated polys skipped!" << ANSI_fg_color_default << std::endl;
+    }
+
+    // verts
     uint nv = verts.size();
-    uint np = polys.size();
-    uint ne = 1.5*np;
-    this->verts.reserve(nv);
-    this->edges.reserve(ne*2);
+    this->verts = verts;
+    this->v_data.resize(nv);
+    if(nv>0) this->bb.update(this->verts);
+
+    // polys (and half edges)
     this->polys.reserve(np);
-    this->poly_triangles.reserve(np);
-    this->v2v.reserve(nv);
-    this->v2e.reserve(nv);
-    this->v2p.reserve(nv);
-    this->e2p.reserve(ne);
-    this->p2e.reserve(np);
-    this->p2p.reserve(np);
-    this->v_data.reserve(nv);
-    this->e_data.reserve(ne);
-    this->p_data.reserve(np);
-
-    // initialize mesh connectivity (and normals)
-    for(auto v : verts) this->vert_add(v);
-    for(auto p : polys) this->poly_add(p);
+    std::vector<uint64_t> he_keys;
+    he_keys.reserve(3*np);
+    for(uint i=0; i<polys.size(); ++i)
+    {
+        if(unique_pid.at(i) != this->polys.size()) continue; // duplicated poly
+        const std::vector<uint> & p = polys.at(i);
+#ifndef NDEBUG
+        for(uint vid : p) assert(vid < nv);
+#endif
+        this->polys.push_back(p);
+        for(uint j=0; j<p.size(); ++j)
+        {
+            uint64_t v0 = p.at(j);
+            uint64_t v1 = p.at((j+1)%p.size());
+            assert(v0!=v1);
+            he_keys.push_back((std::min(v0,v1) << 32) | std::max(v0,v1));
+        }
+    }
+    this->p_data.resize(np);
+
+    // edges: ids follow the order in which they are first encountered in the polys
+    std::vector<uint> he2e;
+    uint ne = ids_by_first_occurrence(he_keys, he2e);
+    he_keys.clear();
+    he_keys.shrink_to_fit();
+    this->edges.resize(2*ne);
+    this->e_data.resize(ne);
+    std::vector<uint> he_offset(np+1,0);
+    uint next_eid = 0;
+    for(uint pid=0; pid<np; ++pid)
+    {
+        const std::vector<uint> & p = this->polys.at(pid);
+        he_offset.at(pid+1) = he_offset.at(pid) + p.size();
+        for(uint j=0; j<p.size(); ++j)
+        {
+            // edges take the orientation of their first occurrence
+            if(he2e.at(he_offset.at(pid)+j) != next_eid) continue;
+            this->edges.at(2*next_eid  ) = p.at(j);
+            this->edges.at(2*next_eid+1) = p.at((j+1)%p.size());
+            ++next_eid;
+        }
+    }
+    assert(next_eid==ne);
+
+    // vert to edge/vert adjacency (exact allocation, then one pass fill)
+    std::vector<uint> v_deg(nv,0), p_deg(nv,0);
+    for(uint vid : this->edges) ++v_deg.at(vid);
+    for(const auto & p : this->polys) for(uint vid : p) ++p_deg.at(vid);
+    this->v2v.resize(nv);
+    this->v2e.resize(nv);
+    this->v2p.resize(nv);
+    for(uint vid=0; vid<nv; ++vid)
+    {
+        this->v2v.at(vid).reserve(v_deg.at(vid));
+        this->v2e.at(vid).reserve(v_deg.at(vid));
+        this->v2p.at(vid).reserve(p_deg.at(vid));
+    }
+    for(uint eid=0; eid<ne; ++eid)
+    {
+        uint vid0 = this->edges.at(2*eid  );
+        uint vid1 = this->edges.at(2*eid+1);
+        this->v2v.at(vid1).push_back(vid0);
+        this->v2v.at(vid0).push_back(vid1);
+        this->v2e.at(vid0).push_back(eid);
+        this->v2e.at(vid1).push_back(eid);
+    }
+
+    // poly based adjacency
+    std::vector<uint> e_deg(ne,0);
+    for(uint eid : he2e) ++e_deg.at(eid);
+    this->e2p.resize(ne);
+    for(uint eid=0; eid<ne; ++eid) this->e2p.at(eid).reserve(e_deg.at(eid));
+    this->p2e.resize(np);
+    this->p2p.resize(np);
+    for(uint pid=0; pid<np; ++pid)
+    {
+        const std::vector<uint> & p = this->polys.at(pid);
+        for(uint vid : p) this->v2p.at(vid).push_back(pid);
+        this->p2e.at(pid).reserve(p.size());
+        for(uint j=0; j<p.size(); ++j)
+        {
+            uint eid = he2e.at(he_offset.at(pid)+j);
+            for(uint nbr : this->e2p.at(eid))
+            {
+                assert(nbr!=pid);
+                if(CONTAINS_VEC(this->p2p.at(pid),nbr)) continue;
+                this->p2p.at(nbr).push_back(pid);
+                this->p2p.at(pid).push_back(nbr);
+            }
+            this->e2p.at(eid).push_back(pid);
+            this->p2e.at(pid).push_back(eid);
+        }
+    }
+
+    std::chrono::high_resolution_clock::time_point t1 = std::chrono::high_resolution_clock::now();
+
+    // geometry
+    this->update_p_normals();
+    this->update_v_normals();
+    this->poly_triangles.clear();
+    this->poly_triangles.resize(np);
+    this->update_p_tessellations();
 
     this->copy_xyz_to_uvw(UVW_param);
 
-    for(uint eid=0; eid<this->num_edges(); ++eid)
+    parallel_for(0, this->num_edges(), [this](const uint eid)
     {
         this->edge_data(eid).flags[MARKED] = (this->edge_is_boundary(eid) || !this->edge_is_manifold(eid));
-    }
+    });
 
-    std::chrono::high_resolution_clock::time_point t1 = std::chrono::high_resolution_clock::now();
+    std::chrono::high_resolution_clock::time_point t2 = std::chrono::high_resolution_clock::now();
 
-    std::cout << "load mesh\t"     <<
-                 this->num_verts() << "V / " <<
-                 this->num_edges() << "E / " <<
-                 this->num_polys() << "P  [" <<
-                 how_many_seconds(t0,t1) << "s]" << std::endl;
+    stats.num_verts          = this->num_verts();
+    stats.num_edges          = this->num_edges();
+    stats.num_polys          = this->num_polys();
+    stats.secs_connectivity  = how_many_seconds(t0,t1);
+    stats.secs_geometry      = how_many_seconds(t1,t2);
+    stats.secs_total         = how_many_seconds(t0,t2);
+    stats.bytes_connectivity = bytes_allocated(this->verts) + bytes_allocated(this->edges) +
+                               bytes_allocated(this->polys) + bytes_allocated(this->poly_triangles) +
+                               bytes_allocated(this->v2v)   + bytes_allocated(this->v2e) +
+                               bytes_allocated(this->v2p)   + bytes_allocated(this->e2p) +
+                               bytes_allocated(this->p2e)   + bytes_allocated(this->p2p);
 }
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
@@ -356,10 +625,10 @@ template<class M, class V, class E, class P>
 CINO_INLINE
 void AbstractPolygonMesh<M,V,E,P>::update_p_normals()
 {
-    for(uint pid=0; pid<this->num_polys(); ++pid)
+    parallel_for(0, this->num_polys(), [this](const uint pid)
     {
         update_p_normal(pid);
-    }
+    });
 }
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
@@ -368,10 +637,10 @@ template<class M, class V, class E, class P>
 CINO_INLINE
 void AbstractPolygonMesh<M,V,E,P>::update_p_tessellations()
 {
-    for(uint pid=0; pid<this->num_polys(); ++pid)
+    parallel_for(0, this->num_polys(), [this](const uint pid)
     {
         update_p_tessellation(pid);
-    }
+    });
 }
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
@@ -380,10 +649,10 @@ template<class M, class V, class E, class P>
 CINO_INLINE
 void AbstractPolygonMesh<M,V,E,P>::update_v_normals()
 {
-    for(uint vid=0; vid<this->num_verts(); ++vid)
+    parallel_for(0, this->num_verts(), [this](const uint vid)
     {
         update_v_normal(vid);
-    }
+    });
 }
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
@@ -402,9 +671,9 @@ template<class M, class V, class E, class P>
 CINO_INLINE
 int AbstractPolygonMesh<M,V,E,P>::Euler_characteristic() const
 {
-    uint nv = this->num_verts();
-    uint ne = this->num_edges();
-    uint np = this->num_polys();
+    uint nv = this->num_verts() - this->num_deleted_verts();
+    uint ne = this->num_edges() - this->num_deleted_edges();
+    uint np = this->num_polys() - this->num_deleted_polys();
     return nv - ne + np;
 }
 
@@ -846,6 +1115,7 @@ template<class M, class V, class E, class P>
 CINO_INLINE
 uint AbstractPolygonMesh<M,V,E,P>::vert_add(const vec3d & pos)
 {
+    assert(!this->adj_is_compact() && "call adj_expand() before editing the mesh");
     uint vid = this->num_verts();
     //
     this->verts.push_back(pos);
@@ -967,6 +1237,11 @@ void AbstractPolygonMesh<M,V,E,P>::vert_remove_unreferenced(const uint vid)
     this->v2v.at(vid).clear();
     this->v2e.at(vid).clear();
     this->v2p.at(vid).clear();
+    if(this->defer_removal)
+    {
+        this->mark_deleted(this->v_deleted, vid, this->num_verts());
+        return;
+    }
     vert_switch_id(vid, this->num_verts()-1);
     this->verts.pop_back();
     this->v_data.pop_back();
@@ -1060,6 +1335,7 @@ template<class M, class V, class E, class P>
 CINO_INLINE
 uint AbstractPolygonMesh<M,V,E,P>::edge_add(const uint vid0, const uint vid1)
 {
+    assert(!this->adj_is_compact() && "call adj_expand() before editing the mesh");
     assert(this->edge_id(vid0, vid1)==-1); // make sure it doesn't exist already
     assert(vid0 < this->num_verts());
     assert(vid1 < this->num_verts());
@@ -1146,6 +1422,11 @@ CINO_INLINE
 void AbstractPolygonMesh<M,V,E,P>::edge_remove_unreferenced(const uint eid)
 {
     this->e2p.at(eid).clear();
+    if(this->defer_removal)
+    {
+        this->mark_deleted(this->e_deleted, eid, this->num_edges());
+        return;
+    }
     edge_switch_id(eid, this->num_edges()-1);
     this->edges.resize(this->edges.size()-2);
     this->e_data.pop_back();
@@ -1415,6 +1696,7 @@ template<class M, class V, class E, class P>
 CINO_INLINE
 uint AbstractPolygonMesh<M,V,E,P>::poly_add(const std::vector<uint> & vlist)
 {
+    assert(!this->adj_is_compact() && "call adj_expand() before editing the mesh");
     if(poly_id(vlist)!=-1)
     {
         std::cout << ANSI_fg_color_red << "WARNING: adding duplicated poly!" << ANSI_fg_color_default << std::endl;
@@ -1498,6 +1780,7 @@ template<class M, class V, class E, class P>
 CINO_INLINE
 void AbstractPolygonMesh<M,V,E,P>::poly_remove(const uint pid)
 {
+    assert(!this->adj_is_compact() && "call adj_expand() before editing the mesh");
     // [28 Aug 2017] Tested on progressive random removal until almost no polys are left: PASSED
 
     std::set<uint,std::greater<uint>> dangling_verts; // higher ids first
@@ -1553,6 +1836,12 @@ void AbstractPolygonMesh<M,V,E,P>::poly_remove_unreferenced(const uint pid)
     this->polys.at(pid).clear();
     this->p2e.at(pid).clear();
     this->p2p.at(pid).clear();
+    if(this->defer_removal)
+    {
+        this->poly_triangles.at(pid).clear();
+        this->mark_deleted(this->p_deleted, pid, this->num_polys());
+        return;
+    }
     poly_switch_id(pid, this->num_polys()-1);
     this->polys.pop_back();
     this->p_data.pop_back();
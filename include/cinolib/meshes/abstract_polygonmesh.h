@@ -55,6 +55,9 @@ class AbstractPolygonMesh : public AbstractMesh<M,V,E,P>
         std::vector<std::vector<uint>> poly_triangles; // triangles covering each quad. Useful for
                                                        // robust normal estimation and rendering
 
+        void binary_export(BinaryMeshWriter & out, const bool adjacency) const override;
+        bool binary_import(const BinaryMeshReader & in) override;
+
     public:
 
         explicit AbstractPolygonMesh() : AbstractMesh<M,V,E,P>() {}
@@ -68,6 +71,14 @@ class AbstractPolygonMesh : public AbstractMesh<M,V,E,P>
         //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
         void clear() override;
+
+        MeshMemoryUsage memory_usage() const override;
+        void            shrink_to_fit() override;
+
+        MeshIdMaps collect_garbage() override;
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
         void init(const std::vector<vec3d>             & verts,
                   const std::vector<std::vector<uint>> & polys);
         void init(      std::vector<vec3d>             & pos,       // vertex xyz positions
@@ -95,12 +106,13 @@ class AbstractPolygonMesh : public AbstractMesh<M,V,E,P>
 
         //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
-        uint verts_per_poly(const uint pid) const override { return this->polys.at(pid).size(); }
+        uint verts_per_poly(const uint pid) const override { return this->polys_span(pid).size(); }
 
         //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
         const std::vector<uint> & adj_p2v(const uint pid) const override { return this->polys.at(pid); }
               std::vector<uint> & adj_p2v(const uint pid)       override { return this->polys.at(pid); }
+        Span<uint>                adj_p2v_span(const uint pid) const override { return this->polys_span(pid); }
 
         //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
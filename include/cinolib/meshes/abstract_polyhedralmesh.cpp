@@ -37,9 +37,12 @@
 #include <cinolib/geometry/triangle.h>
 #include <cinolib/geometry/polygon_utils.h>
 #include <cinolib/how_many_seconds.h>
+#include <cinolib/thread_pool.h>
+#include <cinolib/trace_profiler.h>
 #include <unordered_set>
 #include <unordered_map>
 #include <queue>
+#include <algorithm>
 
 namespace cinolib
 {
@@ -62,6 +65,240 @@ void AbstractPolyhedralMesh<M,V,E,F,P>::clear()
     f2f.clear();
     f2p.clear();
     p2v.clear();
+    //
+    f_deleted.clear();
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class M, class V, class E, class F, class P>
+CINO_INLINE
+MeshMemoryUsage AbstractPolyhedralMesh<M,V,E,F,P>::memory_usage() const
+{
+    MeshMemoryUsage mu = AbstractMesh<M,V,E,P>::memory_usage();
+    memory_usage_add(mu, "faces",              faces);
+    memory_usage_add(mu, "face_triangles",     face_triangles);
+    memory_usage_add(mu, "polys_face_winding", polys_face_winding);
+    memory_usage_add(mu, "f_data",             f_data);
+    memory_usage_add(mu, "v2f",                v2f);
+    memory_usage_add(mu, "e2f",                e2f);
+    memory_usage_add(mu, "f2e",                f2e);
+    memory_usage_add(mu, "f2f",                f2f);
+    memory_usage_add(mu, "f2p",                f2p);
+    memory_usage_add(mu, "p2v",                p2v);
+    if(!f_deleted.empty()) memory_usage_add(mu, "f_deleted", f_deleted);
+    return mu;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class M, class V, class E, class F, class P>
+CINO_INLINE
+void AbstractPolyhedralMesh<M,V,E,F,P>::shrink_to_fit()
+{
+    AbstractMesh<M,V,E,P>::shrink_to_fit();
+    cinolib::shrink_to_fit(faces);
+    cinolib::shrink_to_fit(face_triangles);
+    cinolib::shrink_to_fit(polys_face_winding);
+    cinolib::shrink_to_fit(f_data);
+    cinolib::shrink_to_fit(v2f);
+    cinolib::shrink_to_fit(e2f);
+    cinolib::shrink_to_fit(f2e);
+    cinolib::shrink_to_fit(f2f);
+    cinolib::shrink_to_fit(f2p);
+    cinolib::shrink_to_fit(p2v);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class M, class V, class E, class F, class P>
+CINO_INLINE
+MeshIdMaps AbstractPolyhedralMesh<M,V,E,F,P>::collect_garbage()
+{
+    assert(!this->adj_is_compact() && "call adj_expand() before editing the mesh");
+
+    uint nv, ne, nf, np;
+    MeshIdMaps maps;
+    maps.vmap = this->garbage_id_map(this->v_deleted, this->num_verts(), nv);
+    maps.emap = this->garbage_id_map(this->e_deleted, this->num_edges(), ne);
+    maps.fmap = this->garbage_id_map(this->f_deleted, this->num_faces(), nf);
+    maps.pmap = this->garbage_id_map(this->p_deleted, this->num_polys(), np);
+    this->v_deleted.clear();
+    this->e_deleted.clear();
+    this->f_deleted.clear();
+    this->p_deleted.clear();
+    if(nv==this->num_verts() && ne==this->num_edges() && nf==this->num_faces() && np==this->num_polys()) return maps;
+
+    // move surviving elements to their new slots...
+    this->garbage_compact(this->verts,  maps.vmap, nv);
+    this->garbage_compact(this->v_data, maps.vmap, nv);
+    this->garbage_compact(this->v2v,    maps.vmap, nv);
+    this->garbage_compact(this->v2e,    maps.vmap, nv);
+    this->garbage_compact(this->v2f,    maps.vmap, nv);
+    this->garbage_compact(this->v2p,    maps.vmap, nv);
+    for(uint eid=0; eid<maps.emap.size(); ++eid)
+    {
+        if(maps.emap[eid]<0) continue;
+        this->edges[2*maps.emap[eid]  ] = this->edges[2*eid  ];
+        this->edges[2*maps.emap[eid]+1] = this->edges[2*eid+1];
+    }
+    this->edges.resize(2*ne);
+    this->garbage_compact(this->e_data,             maps.emap, ne);
+    this->garbage_compact(this->e2f,                maps.emap, ne);
+    this->garbage_compact(this->e2p,                maps.emap, ne);
+    this->garbage_compact(this->faces,              maps.fmap, nf);
+    this->garbage_compact(this->f_data,             maps.fmap, nf);
+    this->garbage_compact(this->f2e,                maps.fmap, nf);
+    this->garbage_compact(this->f2f,                maps.fmap, nf);
+    this->garbage_compact(this->f2p,                maps.fmap, nf);
+    this->garbage_compact(this->face_triangles,     maps.fmap, nf);
+    this->garbage_compact(this->polys,              maps.pmap, np);
+    this->garbage_compact(this->polys_face_winding, maps.pmap, np);
+    this->garbage_compact(this->p_data,             maps.pmap, np);
+    this->garbage_compact(this->p2v,                maps.pmap, np);
+    this->garbage_compact(this->p2e,                maps.pmap, np);
+    this->garbage_compact(this->p2p,                maps.pmap, np);
+
+    // ...and rename all references to them
+    for(uint vid=0; vid<nv; ++vid)
+    {
+        this->garbage_rename(this->v2v.at(vid), maps.vmap);
+        this->garbage_rename(this->v2e.at(vid), maps.emap);
+        this->garbage_rename(this->v2f.at(vid), maps.fmap);
+        this->garbage_rename(this->v2p.at(vid), maps.pmap);
+    }
+    this->garbage_rename(this->edges, maps.vmap);
+    for(uint eid=0; eid<ne; ++eid)
+    {
+        this->garbage_rename(this->e2f.at(eid), maps.fmap);
+        this->garbage_rename(this->e2p.at(eid), maps.pmap);
+    }
+    for(uint fid=0; fid<nf; ++fid)
+    {
+        this->garbage_rename(this->faces.at(fid),          maps.vmap);
+        this->garbage_rename(this->f2e.at(fid),            maps.emap);
+        this->garbage_rename(this->f2f.at(fid),            maps.fmap);
+        this->garbage_rename(this->f2p.at(fid),            maps.pmap);
+        this->garbage_rename(this->face_triangles.at(fid), maps.vmap);
+    }
+    for(uint pid=0; pid<np; ++pid)
+    {
+        this->garbage_rename(this->polys.at(pid), maps.fmap);
+        this->garbage_rename(this->p2v.at(pid),   maps.vmap);
+        this->garbage_rename(this->p2e.at(pid),   maps.emap);
+        this->garbage_rename(this->p2p.at(pid),   maps.pmap);
+    }
+    return maps;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class M, class V, class E, class F, class P>
+CINO_INLINE
+uint AbstractPolyhedralMesh<M,V,E,F,P>::num_deleted_faces() const
+{
+    return std::count(f_deleted.begin(), f_deleted.end(), true);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class M, class V, class E, class F, class P>
+CINO_INLINE
+void AbstractPolyhedralMesh<M,V,E,F,P>::binary_export(BinaryMeshWriter & out, const bool adjacency) const
+{
+    this->binary_export_connectivity(out, adjacency);
+    out.add(BIN_FACES,   faces);
+    out.add(BIN_WINDING, polys_face_winding);
+    if(adjacency)
+    {
+        out.add(BIN_V2F, v2f);
+        out.add(BIN_E2F, e2f);
+        out.add(BIN_F2E, f2e);
+        out.add(BIN_F2F, f2f);
+        out.add(BIN_F2P, f2p);
+        out.add(BIN_P2V, p2v);
+        out.add(BIN_FACE_TRIS, face_triangles);
+    }
+    this->binary_export_attributes(out);
+    out.add_attribute(BIN_FACE_NORMAL,  f_data, &F::normal);
+    out.add_attribute(BIN_FACE_COLOR,   f_data, &F::color);
+    out.add_attribute(BIN_FACE_LABEL,   f_data, &F::label);
+    out.add_attribute(BIN_FACE_QUALITY, f_data, &F::quality);
+    out.add_attribute(BIN_FACE_AO,      f_data, &F::AO);
+    out.add_attribute(BIN_FACE_FLAGS,   f_data, &F::flags);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class M, class V, class E, class F, class P>
+CINO_INLINE
+bool AbstractPolyhedralMesh<M,V,E,F,P>::binary_import(const BinaryMeshReader & in)
+{
+    bool same_edges = true;
+    if(in.has(BIN_V2V))
+    {
+        if(!this->binary_import_connectivity(in)) return false;
+        uint nv = this->num_verts();
+        uint ne = this->num_edges();
+        uint np = this->num_polys();
+        if(!in.read(BIN_FACES, faces, nv)) return false;
+        uint nf = faces.size();
+        if(!BinaryMeshReader::ids_below(this->csr_polys.entries, nf) ||
+           !in.read(BIN_WINDING, this->csr_polys, polys_face_winding) ||
+           !in.read(BIN_V2F, v2f, nf) || v2f.size()!=nv ||
+           !in.read(BIN_E2F, e2f, nf) || e2f.size()!=ne ||
+           !in.read(BIN_F2E, f2e, ne) || f2e.size()!=nf ||
+           !in.read(BIN_F2F, f2f, nf) || f2f.size()!=nf ||
+           !in.read(BIN_F2P, f2p, np) || f2p.size()!=nf ||
+           !in.read(BIN_P2V, p2v, nv) || p2v.size()!=np)
+        {
+            return false;
+        }
+        f_data.resize(nf);
+        if(!in.read(BIN_FACE_TRIS, face_triangles, nv) || face_triangles.size()!=nf)
+        {
+            face_triangles.clear();
+            update_f_tessellation();
+        }
+    }
+    else // adjacency was not saved: rebuild it
+    {
+        std::vector<vec3d>             tmp_verts;
+        std::vector<uint>              tmp_edges;
+        std::vector<std::vector<uint>> tmp_faces;
+        AdjacencyCSR                   tmp_polys;
+        std::vector<std::vector<bool>> tmp_winding;
+        if(!in.read(BIN_VERTS, tmp_verts) ||
+           !in.read(BIN_FACES, tmp_faces, tmp_verts.size()) ||
+           !in.read(BIN_POLYS, tmp_polys, tmp_faces.size()) ||
+           !in.read(BIN_WINDING, tmp_polys, tmp_winding))
+        {
+            return false;
+        }
+        in.read(BIN_EDGES, tmp_edges);
+        std::vector<std::vector<uint>> polys;
+        tmp_polys.unpack(polys);
+        tmp_polys.clear();
+        init(tmp_verts, tmp_faces, polys, tmp_winding);
+        parallel_for(0, this->num_polys(), [this](const uint pid){ this->poly_finalize(pid); });
+        // edge ids are reproduced only if the mesh was not edited after its initialization
+        same_edges = (tmp_edges == this->edges);
+    }
+
+    this->binary_import_attributes(in, same_edges);
+    in.read_attribute(BIN_FACE_COLOR,   f_data, &F::color);
+    in.read_attribute(BIN_FACE_LABEL,   f_data, &F::label);
+    in.read_attribute(BIN_FACE_QUALITY, f_data, &F::quality);
+    in.read_attribute(BIN_FACE_AO,      f_data, &F::AO);
+    in.read_attribute(BIN_FACE_FLAGS,   f_data, &F::flags);
+    if(!in.read_attribute(BIN_FACE_NORMAL, f_data, &F::normal))
+    {
+        this->adj_expand();
+        update_f_normals();
+        update_v_normals();
+    }
+    this->init_info.num_faces = faces.size();
+    return true;
 }
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
@@ -73,50 +310,221 @@ void AbstractPolyhedralMesh<M,V,E,F,P>::init(const std::vector<vec3d>
                                              const std::vector<std::vector<uint>> & polys,
                                              const std::vector<std::vector<bool>> & polys_face_winding)
 {
+    CINO_PROFILE_ZONE("AbstractPolyhedralMesh::init");
+    // Batch construction of the mesh connectivity. The result is the same mesh
+    // one would obtain calling face_add() and poly_add() for each element (same
+    // element ids and same ordering of all the adjacency lists), but faces and
+    // edges are extracted with a single sort, adjacency tables are filled in one
+    // pass, and normals/tessellations are computed only once at the end
+
+    assert(!this->adj_is_compact());
+    assert(polys.size() == polys_face_winding.size());
     std::chrono::high_resolution_clock::time_point t0 = std::chrono::high_resolution_clock::now();
 
-    // pre-allocate memory
+    MeshInitStats & stats = this->init_info;
+    stats = MeshInitStats();
+
+    // verts
     uint nv = verts.size();
-    uint nf = faces.size();
-    uint np = polys.size();
-    uint ne = 1.5*nf;
-    this->verts.reserve(nv);
-    this->edges.reserve(ne*2);
+    this->verts = verts;
+    this->v_data.resize(nv);
+    if(nv>0) this->bb.update(this->verts);
+
+    // faces (duplicated faces are those defined by the same set of verts)
+    AdjacencyCSR keys(faces);
+    sort_rows(keys);
+    std::vector<uint> unique_fid;
+    uint nf = ids_by_first_occurrence(keys, unique_fid);
+    stats.num_dup_faces = faces.size() - nf;
     this->faces.reserve(nf);
+    std::vector<uint64_t> he_keys;
+    for(uint i=0; i<faces.size(); ++i)
+    {
+        if(unique_fid.at(i) != this->faces.size()) continue; // duplicated face
+        const std::vector<uint> & f = faces.at(i);
+#ifndef NDEBUG
+        for(uint vid : f) assert(vid < nv);
+#endif
+        this->faces.push_back(f);
+        for(uint j=0; j<f.size(); ++j)
+        {
+            uint64_t v0 = f.at(j);
+            uint64_t v1 = f.at((j+1)%f.size());
+            assert(v0!=v1);
+            he_keys.push_back((std::min(v0,v1) << 32) | std::max(v0,v1));
+        }
+    }
+    this->f_data.resize(nf);
+
+    // polys (duplicated polys are those defined by the same set of faces)
+    std::vector<std::vector<uint>> flists(polys.size());
+    for(uint i=0; i<polys.size(); ++i)
+    {
+        flists.at(i).reserve(polys.at(i).size());
+        for(uint fid : polys.at(i)) flists.at(i).push_back(unique_fid.at(fid));
+    }
+    keys.build(flists);
+    sort_rows(keys);
+    std::vector<uint> unique_pid;
+    uint np = ids_by_first_occurrence(keys, unique_pid);
+    keys.clear();
+    stats.num_dup_polys = polys.size() - np;
     this->polys.reserve(np);
-    this->v2v.reserve(nv);
-    this->v2e.reserve(nv);
-    this->v2f.reserve(nv);
-    this->v2p.reserve(nv);
-    this->e2f.reserve(ne);
-    this->e2p.reserve(ne);
-    this->f2e.reserve(nf);
-    this->f2f.reserve(nf);
-    this->f2p.reserve(nf);
-    this->p2v.reserve(np);
-    this->p2e.reserve(np);
-    this->p2p.reserve(np);
-    this->v_data.reserve(nv);
-    this->e_data.reserve(ne);
-    this->f_data.reserve(nf);
-    this->p_data.reserve(np);
-    this->face_triangles.reserve(nf);
     this->polys_face_winding.reserve(np);
+    for(uint i=0; i<polys.size(); ++i)
+    {
+        if(unique_pid.at(i) != this->polys.size()) continue; // duplicated poly
+        this->polys.push_back(flists.at(i));
+        this->polys_face_winding.push_back(polys_face_winding.at(i));
+    }
+    flists.clear();
+    this->p_data.resize(np);
 
-    for(auto v : verts) vert_add(v);
-    for(auto f : faces) face_add(f);
-    for(uint pid=0; pid<polys.size(); ++pid) this->poly_add(polys.at(pid), polys_face_winding.at(pid));
+    if(stats.num_dup_faces>0 || stats.num_dup_polys>0)
+    {
+        std::cout << ANSI_fg_color_red << "WARNING: " << stats.num_dup_faces << " duplicated faces and "
+                  << stats.num_dup_polys << " duplicated polys skipped!" << ANSI_fg_color_default << std::endl;
+    }
 
-    this->copy_xyz_to_uvw(UVW_param);
+    // edges: ids follow the order in which they are first encountered in the faces
+    std::vector<uint> he2e;
+    uint ne = ids_by_first_occurrence(he_keys, he2e);
+    he_keys.clear();
+    he_keys.shrink_to_fit();
+    this->edges.resize(2*ne);
+    this->e_data.resize(ne);
+    std::vector<uint> he_offset(nf+1,0);
+    uint next_eid = 0;
+    for(uint fid=0; fid<nf; ++fid)
+    {
+        const std::vector<uint> & f = this->faces.at(fid);
+        he_offset.at(fid+1) = he_offset.at(fid) + f.size();
+        for(uint j=0; j<f.size(); ++j)
+        {
+            // edges take the orientation of their first occurrence
+            if(he2e.at(he_offset.at(fid)+j) != next_eid) continue;
+            this->edges.at(2*next_eid  ) = f.at(j);
+            this->edges.at(2*next_eid+1) = f.at((j+1)%f.size());
+            ++next_eid;
+        }
+    }
+    assert(next_eid==ne);
+
+    // vert to edge/vert adjacency
+    std::vector<uint> v_deg(nv,0), v_fdeg(nv,0), e_fdeg(ne,0);
+    for(uint vid : this->edges) ++v_deg.at(vid);
+    for(uint fid=0; fid<nf; ++fid) for(uint vid : this->faces.at(fid)) ++v_fdeg.at(vid);
+    for(uint eid : he2e) ++e_fdeg.at(eid);
+    this->v2v.resize(nv);
+    this->v2e.resize(nv);
+    this->v2f.resize(nv);
+    this->v2p.resize(nv);
+    for(uint vid=0; vid<nv; ++vid)
+    {
+        this->v2v.at(vid).reserve(v_deg.at(vid));
+        this->v2e.at(vid).reserve(v_deg.at(vid));
+        this->v2f.at(vid).reserve(v_fdeg.at(vid));
+    }
+    for(uint eid=0; eid<ne; ++eid)
+    {
+        uint vid0 = this->edges.at(2*eid  );
+        uint vid1 = this->edges.at(2*eid+1);
+        this->v2v.at(vid1).push_back(vid0);
+        this->v2v.at(vid0).push_back(vid1);
+        this->v2e.at(vid0).push_back(eid);
+        this->v2e.at(vid1).push_back(eid);
+    }
+
+    // face based adjacency
+    this->e2f.resize(ne);
+    this->e2p.resize(ne);
+    this->f2e.resize(nf);
+    this->f2f.resize(nf);
+    this->f2p.resize(nf);
+    for(uint eid=0; eid<ne; ++eid) this->e2f.at(eid).reserve(e_fdeg.at(eid));
+    for(uint fid=0; fid<nf; ++fid)
+    {
+        const std::vector<uint> & f = this->faces.at(fid);
+        for(uint vid : f) this->v2f.at(vid).push_back(fid);
+        this->f2e.at(fid).reserve(f.size());
+        for(uint j=0; j<f.size(); ++j)
+        {
+            uint eid = he2e.at(he_offset.at(fid)+j);
+            for(uint nbr : this->e2f.at(eid))
+            {
+                assert(nbr!=fid);
+                if(CONTAINS_VEC(this->f2f.at(fid),nbr)) continue;
+                this->f2f.at(nbr).push_back(fid);
+                this->f2f.at(fid).push_back(nbr);
+            }
+            this->e2f.at(eid).push_back(fid);
+            this->f2e.at(fid).push_back(eid);
+        }
+    }
+
+    // poly based adjacency
+    this->p2v.resize(np);
+    this->p2e.resize(np);
+    this->p2p.resize(np);
+    for(uint pid=0; pid<np; ++pid)
+    {
+        for(uint fid : this->polys.at(pid))
+        {
+            const std::vector<uint> & f = this->faces.at(fid);
+            for(uint j=0; j<f.size(); ++j)
+            {
+                uint eid = this->f2e.at(fid).at(j);
+                if(DOES_NOT_CONTAIN_VEC(this->p2e.at(pid),eid))
+                {
+                    this->e2p.at(eid).push_back(pid);
+                    this->p2e.at(pid).push_back(eid);
+                }
+                if(DOES_NOT_CONTAIN_VEC(this->p2v.at(pid),f.at(j)))
+                {
+                    this->p2v.at(pid).push_back(f.at(j));
+                    this->v2p.at(f.at(j)).push_back(pid);
+                }
+            }
+            for(uint nbr : this->f2p.at(fid))
+            {
+                if(pid!=nbr && DOES_NOT_CONTAIN_VEC(this->p2p.at(pid),nbr))
+                {
+                    this->p2p.at(pid).push_back(nbr);
+                    this->p2p.at(nbr).push_back(pid);
+                }
+            }
+            this->f2p.at(fid).push_back(pid);
+        }
+    }
 
     std::chrono::high_resolution_clock::time_point t1 = std::chrono::high_resolution_clock::now();
 
-    std::cout << "load mesh\t"     <<
-                 this->num_verts() << "V / " <<
-                 this->num_edges() << "E / " <<
-                 this->num_faces() << "F / " <<
-                 this->num_polys() << "P  [" <<
-                 how_many_seconds(t0,t1) << "s]" << std::endl;
+    // geometry
+    this->update_f_normals();
+    this->update_v_normals();
+    this->face_triangles.clear();
+    this->update_f_tessellation();
+
+    this->copy_xyz_to_uvw(UVW_param);
+
+    std::chrono::high_resolution_clock::time_point t2 = std::chrono::high_resolution_clock::now();
+
+    stats.num_verts          = this->num_verts();
+    stats.num_edges          = this->num_edges();
+    stats.num_faces          = this->num_faces();
+    stats.num_polys          = this->num_polys();
+    stats.secs_connectivity  = how_many_seconds(t0,t1);
+    stats.secs_geometry      = how_many_seconds(t1,t2);
+    stats.secs_total         = how_many_seconds(t0,t2);
+    stats.bytes_connectivity = bytes_allocated(this->verts) + bytes_allocated(this->edges) +
+                               bytes_allocated(this->faces) + bytes_allocated(this->polys) +
+                               bytes_allocated(this->polys_face_winding) + bytes_allocated(this->face_triangles) +
+                               bytes_allocated(this->v2v)   + bytes_allocated(this->v2e) +
+                               bytes_allocated(this->v2f)   + bytes_allocated(this->v2p) +
+                               bytes_allocated(this->e2f)   + bytes_allocated(this->e2p) +
+                               bytes_allocated(this->f2e)   + bytes_allocated(this->f2f) +
+                               bytes_allocated(this->f2p)   + bytes_allocated(this->p2v) +
+                               bytes_allocated(this->p2e)   + bytes_allocated(this->p2p);
 }
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
@@ -126,37 +534,72 @@ CINO_INLINE
 void AbstractPolyhedralMesh<M,V,E,F,P>::init(const std::vector<vec3d>             & verts,
                                              const std::vector<std::vector<uint>> & polys)
 {
+    // Split tets and hexes into faces, assigning CCW winding to a face the first
+    // time it is encountered, and CW winding to all the subsequent occurrences
+    // (as poly_add(vlist) would do). Then proceed with the face based batch init
+
     std::chrono::high_resolution_clock::time_point t0 = std::chrono::high_resolution_clock::now();
 
-    // pre-allocate memory
-    uint nv = verts.size();
-    uint np = polys.size();
-    this->verts.reserve(nv);
-    this->polys.reserve(np);
-    this->v2v.reserve(nv);
-    this->v2e.reserve(nv);
-    this->v2f.reserve(nv);
-    this->v2p.reserve(nv);
-    this->p2v.reserve(np);
-    this->p2e.reserve(np);
-    this->p2p.reserve(np);
-    this->v_data.reserve(nv);
-    this->p_data.reserve(np);
-    this->polys_face_winding.reserve(np);
+    AdjacencyCSR local_faces;
+    local_faces.offsets.push_back(0);
+    std::vector<std::vector<bool>> local_winding(polys.size());
+    std::vector<std::vector<uint>> local_polys(polys.size());
+    for(uint pid=0; pid<polys.size(); ++pid)
+    {
+        const std::vector<uint> & vlist = polys.at(pid);
+        switch(vlist.size())
+        {
+            case 4: // tetrahedron
+                for(uint i=0; i<4; ++i)
+                {
+                    local_polys.at(pid).push_back(local_faces.num_rows());
+                    for(uint j=0; j<3; ++j) local_faces.entries.push_back(vlist.at(TET_FACES[i][j]));
+                    local_faces.offsets.push_back(local_faces.entries.size());
+                }
+                break;
+            case 8: // hexahedron
+                for(uint i=0; i<6; ++i)
+                {
+                    local_polys.at(pid).push_back(local_faces.num_rows());
+                    for(uint j=0; j<4; ++j) local_faces.entries.push_back(vlist.at(HEXA_FACES[i][j]));
+                    local_faces.offsets.push_back(local_faces.entries.size());
+                }
+                break;
+            default: assert(false && "Unknown polyhedral element!");
+        }
+    }
 
-    for(auto v : verts) vert_add(v);
-    for(auto p : polys) poly_add(p);
+    AdjacencyCSR keys = local_faces;
+    sort_rows(keys);
+    std::vector<uint> unique_fid;
+    uint nf = ids_by_first_occurrence(keys, unique_fid);
+    keys.clear();
 
-    this->copy_xyz_to_uvw(UVW_param);
+    std::vector<std::vector<uint>> faces;
+    faces.reserve(nf);
+    for(uint pid=0; pid<polys.size(); ++pid)
+    {
+        for(uint & fid : local_polys.at(pid))
+        {
+            bool first_occurrence = (unique_fid.at(fid) == faces.size());
+            if(first_occurrence) faces.push_back(local_faces.row(fid).to_vector());
+            local_winding.at(pid).push_back(first_occurrence);
+            fid = unique_fid.at(fid);
+        }
+    }
+    local_faces.clear();
 
     std::chrono::high_resolution_clock::time_point t1 = std::chrono::high_resolution_clock::now();
 
-    std::cout << "load mesh\t"     <<
-                 this->num_verts() << "V / " <<
-                 this->num_edges() << "E / " <<
-                 this->num_faces() << "F / " <<
-                 this->num_polys() << "P  [" <<
-                 how_many_seconds(t0,t1) << "s]" << std::endl;
+    init(verts, faces, local_polys, local_winding);
+
+    // mesh specific per element updates (e.g. canonical p2v ordering of tets and hexes)
+    parallel_for(0, this->num_polys(), [this](const uint pid){ this->poly_finalize(pid); });
+
+    std::chrono::high_resolution_clock::time_point t2 = std::chrono::high_resolution_clock::now();
+
+    this->init_info.secs_connectivity += how_many_seconds(t0,t1);
+    this->init_info.secs_total         = how_many_seconds(t0,t2);
 }
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
@@ -286,10 +729,10 @@ template<class M, class V, class E, class F, class P>
 CINO_INLINE
 void AbstractPolyhedralMesh<M,V,E,F,P>::update_f_normals()
 {
-    for(uint fid=0; fid<num_faces(); ++fid)
+    parallel_for(0, num_faces(), [this](const uint fid)
     {
         update_f_normal(fid);
-    }
+    });
 }
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
@@ -299,10 +742,10 @@ CINO_INLINE
 void AbstractPolyhedralMesh<M,V,E,F,P>::update_f_tessellation()
 {
     this->face_triangles.resize(this->num_faces());
-    for(uint fid=0; fid<this->num_faces(); ++fid)
+    parallel_for(0, this->num_faces(), [this](const uint fid)
     {
         update_f_tessellation(fid);
-    }
+    });
 }
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
@@ -358,10 +801,10 @@ template<class M, class V, class E, class F, class P>
 CINO_INLINE
 void AbstractPolyhedralMesh<M,V,E,F,P>::update_v_normals()
 {
-    for(uint vid=0; vid<this->num_verts(); ++vid)
+    parallel_for(0, this->num_verts(), [this](const uint vid)
     {
         if(vert_is_on_srf(vid)) update_v_normal(vid);
-    }
+    });
 }
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
@@ -386,10 +829,10 @@ CINO_INLINE
 int AbstractPolyhedralMesh<M,V,E,F,P>::Euler_characteristic() const
 {
     // https://math.stackexchange.com/questions/1680607/eulers-formula-for-tetrahedral-mesh
-    uint nv = this->num_verts();
-    uint ne = this->num_edges();
-    uint nf = this->num_faces();
-    uint np = this->num_polys();
+    uint nv = this->num_verts() - this->num_deleted_verts();
+    uint ne = this->num_edges() - this->num_deleted_edges();
+    uint nf = this->num_faces() - this->num_deleted_faces();
+    uint np = this->num_polys() - this->num_deleted_polys();
     return nv - ne + nf - np;
 }
 
@@ -1958,6 +2401,11 @@ void AbstractPolyhedralMesh<M,V,E,F,P>::vert_remove_unreferenced(const uint vid)
     this->v2e.at(vid).clear();
     this->v2f.at(vid).clear();
     this->v2p.at(vid).clear();
+    if(this->defer_removal)
+    {
+        this->mark_deleted(this->v_deleted, vid, this->num_verts());
+        return;
+    }
     vert_switch_id(vid, this->num_verts()-1);
     this->verts.pop_back();
     this->v_data.pop_back();
@@ -1973,6 +2421,7 @@ template<class M, class V, class E, class F, class P>
 CINO_INLINE
 uint AbstractPolyhedralMesh<M,V,E,F,P>::vert_add(const vec3d & pos)
 {
+    assert(!this->adj_is_compact() && "call adj_expand() before editing the mesh");
     uint vid = this->num_verts();
     //
     this->verts.push_back(pos);
@@ -2053,6 +2502,7 @@ template<class M, class V, class E, class F, class P>
 CINO_INLINE
 uint AbstractPolyhedralMesh<M,V,E,F,P>::edge_add(const uint vid0, const uint vid1)
 {
+    assert(!this->adj_is_compact() && "call adj_expand() before editing the mesh");
     assert(this->edge_id(vid0, vid1)==-1); // make sure it doesn't exist already
     assert(vid0 < this->num_verts());
     assert(vid1 < this->num_verts());
@@ -2098,6 +2548,11 @@ void AbstractPolyhedralMesh<M,V,E,F,P>::edge_remove_unreferenced(const uint eid)
 {
     this->e2f.at(eid).clear();
     this->e2p.at(eid).clear();
+    if(this->defer_removal)
+    {
+        this->mark_deleted(this->e_deleted, eid, this->num_edges());
+        return;
+    }
     edge_switch_id(eid, this->num_edges()-1);
     this->edges.resize(this->edges.size()-2);
     this->e_data.pop_back();
@@ -2190,6 +2645,7 @@ template<class M, class V, class E, class F, class P>
 CINO_INLINE
 uint AbstractPolyhedralMesh<M,V,E,F,P>::face_add(const std::vector<uint> & f)
 {
+    assert(!this->adj_is_compact() && "call adj_expand() before editing the mesh");
     if(face_id(f)!=-1)
     {
         std::cout << ANSI_fg_color_red << "WARNING: adding duplicated face!" << ANSI_fg_color_default << std::endl;
@@ -2273,6 +2729,11 @@ void AbstractPolyhedralMesh<M,V,E,F,P>::face_remove_unreferenced(const uint fid)
     this->f2f.at(fid).clear();
     this->f2p.at(fid).clear();
     this->face_triangles.at(fid).clear();
+    if(this->defer_removal)
+    {
+        this->mark_deleted(this->f_deleted, fid, this->num_faces());
+        return;
+    }
     face_switch_id(fid, this->num_faces()-1);
     this->faces.pop_back();
     this->f_data.pop_back();
@@ -2357,6 +2818,7 @@ CINO_INLINE
 uint AbstractPolyhedralMesh<M,V,E,F,P>::poly_add(const std::vector<uint> & flist,
                                                  const std::vector<bool> & fwinding)
 {
+    assert(!this->adj_is_compact() && "call adj_expand() before editing the mesh");
     if(poly_id(flist)!=-1)
     {
         std::cout << ANSI_fg_color_red << "WARNING: adding duplicated poly!" << ANSI_fg_color_default << std::endl;
@@ -2502,6 +2964,11 @@ void AbstractPolyhedralMesh<M,V,E,F,P>::poly_remove_unreferenced(const uint pid)
     this->p2e.at(pid).clear();
     this->p2p.at(pid).clear();
     this->polys_face_winding.at(pid).clear();
+    if(this->defer_removal)
+    {
+        this->mark_deleted(this->p_deleted, pid, this->num_polys());
+        return;
+    }
     poly_switch_id(pid, this->num_polys()-1);
     this->polys.pop_back();
     this->p_data.pop_back();
@@ -2517,6 +2984,7 @@ template<class M, class V, class E, class F, class P>
 CINO_INLINE
 void AbstractPolyhedralMesh<M,V,E,F,P>::poly_remove(const uint pid)
 {
+    assert(!this->adj_is_compact() && "call adj_expand() before editing the mesh");
     std::set<uint,std::greater<uint>> dangling_verts; // higher ids first
     std::set<uint,std::greater<uint>> dangling_edges; // higher ids first
     std::set<uint,std::greater<uint>> dangling_faces; // higher ids first
@@ -66,6 +66,11 @@ class AbstractPolyhedralMesh : public AbstractMesh<M,V,E,P>
 
         std::vector<std::vector<uint>> face_triangles; // per face serialized triangulation (e.g., for rendering)
 
+        std::vector<bool> f_deleted; // tombstones for deferred removal (see AbstractMesh::set_deferred_removal())
+
+        void binary_export(BinaryMeshWriter & out, const bool adjacency) const override;
+        bool binary_import(const BinaryMeshReader & in) override;
+
     public:
 
         typedef F F_type;
@@ -77,6 +82,15 @@ class AbstractPolyhedralMesh : public AbstractMesh<M,V,E,P>
 
         void clear() override;
 
+        MeshMemoryUsage memory_usage() const override;
+        void            shrink_to_fit() override;
+
+        MeshIdMaps collect_garbage() override;
+        bool       face_is_deleted(const uint fid) const { return fid < f_deleted.size() && f_deleted[fid]; }
+        uint       num_deleted_faces() const;
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
         void init(const std::vector<vec3d>             & verts,
                   const std::vector<std::vector<uint>> & faces,
                   const std::vector<std::vector<uint>> & polys,
@@ -112,7 +126,7 @@ class AbstractPolyhedralMesh : public AbstractMesh<M,V,E,P>
         //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
         virtual uint verts_per_poly(const uint pid) const override { return this->p2v.at(pid).size();   }
-        virtual uint faces_per_poly(const uint pid) const          { return this->polys.at(pid).size(); }
+        virtual uint faces_per_poly(const uint pid) const          { return this->polys_span(pid).size(); }
         virtual uint verts_per_face(const uint fid) const          { return this->faces.at(fid).size(); }
         virtual uint edges_per_face(const uint fid) const          { return this->faces.at(fid).size(); }
 
@@ -146,6 +160,7 @@ class AbstractPolyhedralMesh : public AbstractMesh<M,V,E,P>
               std::vector<uint> & adj_p2f(const uint pid)                { return this->polys.at(pid); }
         const std::vector<uint> & adj_p2v(const uint pid) const override { return p2v.at(pid);         }
               std::vector<uint> & adj_p2v(const uint pid)       override { return p2v.at(pid);         }
+        Span<uint>                adj_p2f_span(const uint pid) const { return this->polys_span(pid); }
 
         //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
@@ -273,6 +288,7 @@ class AbstractPolyhedralMesh : public AbstractMesh<M,V,E,P>
                 void               poly_switch_id              (const uint pid0, const uint pid1);
                 uint               poly_add                    (const std::vector<uint> & flist, const std::vector<bool> & fwinding);
         virtual uint               poly_add                    (const std::vector<uint> & vlist);
+        virtual void               poly_finalize               (const uint) {} // mesh specific updates to polys added from a vertex list (see Tetmesh and Hexmesh)
                 void               poly_remove_unreferenced    (const uint pid);
                 void               poly_remove                 (const uint pid);
                 void               polys_remove                (const std::vector<uint> & pids);
@@ -0,0 +1,104 @@
+/********************************************************************************
+*  This file is part of CinoLib                                                 *
+*  Copyright(C) 2016: Marco Livesu                                              *
+*                                                                               *
+*  The MIT License                                                              *
+*                                                                               *
+*  Permission is hereby granted, free of charge, to any person obtaining a      *
+*  copy of this software and associated documentation files (the "Software"),   *
+*  to deal in the Software without restriction, including without limitation    *
+*  the rights to use, copy, modify, merge, publish, distribute, sublicense,     *
+*  and/or sell copies of the Software, and to permit persons to whom the        *
+*  Software is furnished to do so, subject to the following conditions:         *
+*                                                                               *
+*  The above copyright notice and this permission notice shall be included in   *
+*  all copies or substantial portions of the Software.                          *
+*                                                                               *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR   *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,     *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. IN NO EVENT SHALL THE *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER       *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      *
+*  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS *
+*  IN THE SOFTWARE.                                                             *
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Marco Livesu (marco.livesu@gmail.com)                                     *
+*     http://pers.ge.imati.cnr.it/livesu/                                       *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*********************************************************************************/
+#include <cinolib/meshes/adjacency_csr.h>
+#include <algorithm>
+
+namespace cinolib
+{
+
+CINO_INLINE
+AdjacencyCSR::AdjacencyCSR(const std::vector<std::vector<uint>> & rows)
+{
+    build(rows);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void AdjacencyCSR::clear()
+{
+    // release memory (clear() alone would keep the capacity)
+    std::vector<uint>().swap(offsets);
+    std::vector<uint>().swap(entries);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void AdjacencyCSR::build(const std::vector<std::vector<uint>> & rows)
+{
+    clear();
+
+    offsets.resize(rows.size()+1);
+    offsets.front() = 0;
+    for(uint i=0; i<rows.size(); ++i)
+    {
+        offsets.at(i+1) = offsets.at(i) + rows.at(i).size();
+    }
+
+    entries.resize(offsets.back());
+    for(uint i=0; i<rows.size(); ++i)
+    {
+        std::copy(rows.at(i).begin(), rows.at(i).end(), entries.begin() + offsets.at(i));
+    }
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void AdjacencyCSR::unpack(std::vector<std::vector<uint>> & rows) const
+{
+    rows.clear();
+    rows.resize(num_rows());
+    for(uint i=0; i<num_rows(); ++i)
+    {
+        rows.at(i).assign(entries.begin() + offsets.at(i),
+                          entries.begin() + offsets.at(i+1));
+    }
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+Span<uint> AdjacencyCSR::row(const uint i) const
+{
+    // offsets.at() throws for invalid rows, as the std::vector::at() of the mutable layout does
+    const uint * base = entries.data();
+    uint         end  = offsets.at(i+1);
+    return Span<uint>(base + offsets[i], base + end);
+}
+
+}
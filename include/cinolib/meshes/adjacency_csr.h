@@ -0,0 +1,89 @@
+/********************************************************************************
+*  This file is part of CinoLib                                                 *
+*  Copyright(C) 2016: Marco Livesu                                              *
+*                                                                               *
+*  The MIT License                                                              *
+*                                                                               *
+*  Permission is hereby granted, free of charge, to any person obtaining a      *
+*  copy of this software and associated documentation files (the "Software"),   *
+*  to deal in the Software without restriction, including without limitation    *
+*  the rights to use, copy, modify, merge, publish, distribute, sublicense,     *
+*  and/or sell copies of the Software, and to permit persons to whom the        *
+*  Software is furnished to do so, subject to the following conditions:         *
+*                                                                               *
+*  The above copyright notice and this permission notice shall be included in   *
+*  all copies or substantial portions of the Software.                          *
+*                                                                               *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR   *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,     *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. IN NO EVENT SHALL THE *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER       *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      *
+*  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS *
+*  IN THE SOFTWARE.                                                             *
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Marco Livesu (marco.livesu@gmail.com)                                     *
+*     http://pers.ge.imati.cnr.it/livesu/                                       *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*********************************************************************************/
+#ifndef CINO_ADJACENCY_CSR_H
+#define CINO_ADJACENCY_CSR_H
+
+#include <cinolib/cino_inline.h>
+#include <cinolib/span.h>
+#include <vector>
+
+namespace cinolib
+{
+
+/* Compressed Sparse Row (CSR) storage for a mesh adjacency relation.
+ * All rows are stored one after the other in a single flat array, and
+ * row i spans the entries in the range [offsets[i], offsets[i+1]).
+ * With respect to a std::vector<std::vector<uint>> this costs a single
+ * heap allocation per relation and keeps the rows contiguous in memory,
+ * which both saves memory and speeds up one-ring traversals on big meshes.
+ *
+ * The table is read-only: rows can be accessed but not edited. Use unpack()
+ * to go back to the mutable (vector of vectors) representation.
+*/
+
+class AdjacencyCSR
+{
+    public:
+
+        explicit AdjacencyCSR() {}
+        explicit AdjacencyCSR(const std::vector<std::vector<uint>> & rows);
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        void clear();
+        void build (const std::vector<std::vector<uint>> & rows);
+        void unpack(std::vector<std::vector<uint>> & rows) const;
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        uint       num_rows()             const { return offsets.empty() ? 0 : offsets.size()-1; }
+        uint       num_entries()          const { return entries.size(); }
+        uint       row_size(const uint i) const { return offsets.at(i+1) - offsets.at(i); }
+        Span<uint> row     (const uint i) const;
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        std::vector<uint> offsets; // num_rows+1 entries. Row i spans [offsets[i], offsets[i+1])
+        std::vector<uint> entries; // all rows, serialized
+};
+
+}
+
+#ifndef  CINO_STATIC_LIB
+#include "adjacency_csr.cpp"
+#endif
+
+#endif // CINO_ADJACENCY_CSR_H
@@ -0,0 +1,145 @@
+/********************************************************************************
+*  This file is part of CinoLib                                                 *
+*  Copyright(C) 2016: Marco Livesu                                              *
+*                                                                               *
+*  The MIT License                                                              *
+*                                                                               *
+*  Permission is hereby granted, free of charge, to any person obtaining a      *
+*  copy of this software and associated documentation files (the "Software"),   *
+*  to deal in the Software without restriction, including without limitation    *
+*  the rights to use, copy, modify, merge, publish, distribute, sublicense,     *
+*  and/or sell copies of the Software, and to permit persons to whom the        *
+*  Software is furnished to do so, subject to the following conditions:         *
+*                                                                               *
+*  The above copyright notice and this permission notice shall be included in   *
+*  all copies or substantial portions of the Software.                          *
+*                                                                               *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR   *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,     *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. IN NO EVENT SHALL THE *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER       *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      *
+*  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS *
+*  IN THE SOFTWARE.                                                             *
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Marco Livesu (marco.livesu@gmail.com)                                     *
+*     http://pers.ge.imati.cnr.it/livesu/                                       *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*********************************************************************************/
+#include <cinolib/meshes/batch_init.h>
+#include <cinolib/thread_pool.h>
+#include <algorithm>
+#include <numeric>
+
+namespace cinolib
+{
+
+CINO_INLINE
+std::ostream & operator<<(std::ostream & in, const MeshInitStats & stats)
+{
+    in << "load mesh\t" << stats.num_verts << "V / " << stats.num_edges << "E / ";
+    if(stats.num_faces>0) in << stats.num_faces << "F / ";
+    in << stats.num_polys                         << "P  ["    <<
+          stats.secs_total                        << "s] ("    <<
+          stats.secs_connectivity                 << "s connectivity, " <<
+          stats.secs_geometry                     << "s geometry, "     <<
+          stats.bytes_connectivity/(1024.0*1024.0)<< "MB)";
+    if(stats.num_dup_faces>0) in << " " << stats.num_dup_faces << " duplicated faces skipped";
+    if(stats.num_dup_polys>0) in << " " << stats.num_dup_polys << " duplicated polys skipped";
+    return in;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+uint ids_by_first_occurrence(const std::vector<uint64_t> & keys,
+                                   std::vector<uint>     & ids)
+{
+    // sort (key,position) pairs, so that equal keys become consecutive
+    // and the first element of each group is its first occurrence
+    std::vector<std::pair<uint64_t,uint>> sorted(keys.size());
+    parallel_for(0, keys.size(), [&](const uint i){ sorted[i] = std::make_pair(keys[i],i); });
+    parallel_sort(sorted.begin(), sorted.end());
+
+    // link each key to its first occurrence
+    std::vector<uint> first(keys.size());
+    for(uint i=0; i<sorted.size(); ++i)
+    {
+        bool new_group = (i==0 || sorted[i].first!=sorted[i-1].first);
+        first[sorted[i].second] = new_group ? sorted[i].second : first[sorted[i-1].second];
+    }
+
+    // assign ids scanning the input in order
+    uint count = 0;
+    ids.resize(keys.size());
+    for(uint i=0; i<keys.size(); ++i)
+    {
+        ids[i] = (first[i]==i) ? count++ : ids[first[i]];
+    }
+    return count;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+uint ids_by_first_occurrence(const AdjacencyCSR      & keys,
+                                   std::vector<uint> & ids)
+{
+    uint n = keys.num_rows();
+
+    auto row_less = [&](const uint i, const uint j) -> bool
+    {
+        Span<uint> a = keys.row(i);
+        Span<uint> b = keys.row(j);
+        if(a.size()!=b.size()) return a.size()<b.size();
+        for(uint k=0; k<a.size(); ++k) if(a[k]!=b[k]) return a[k]<b[k];
+        return i<j;
+    };
+
+    auto row_equal = [&](const uint i, const uint j) -> bool
+    {
+        Span<uint> a = keys.row(i);
+        Span<uint> b = keys.row(j);
+        return a.size()==b.size() && std::equal(a.begin(), a.end(), b.begin());
+    };
+
+    std::vector<uint> sorted(n);
+    std::iota(sorted.begin(), sorted.end(), 0);
+    parallel_sort(sorted.begin(), sorted.end(), row_less);
+
+    std::vector<uint> first(n);
+    for(uint i=0; i<n; ++i)
+    {
+        bool new_group = (i==0 || !row_equal(sorted[i],sorted[i-1]));
+        first[sorted[i]] = new_group ? sorted[i] : first[sorted[i-1]];
+    }
+
+    uint count = 0;
+    ids.resize(n);
+    for(uint i=0; i<n; ++i)
+    {
+        ids[i] = (first[i]==i) ? count++ : ids[first[i]];
+    }
+    return count;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void sort_rows(AdjacencyCSR & table)
+{
+    parallel_for(0, table.num_rows(), [&table](const uint i)
+    {
+        std::sort(table.entries.begin() + table.offsets[i],
+                  table.entries.begin() + table.offsets[i+1]);
+    });
+}
+
+}
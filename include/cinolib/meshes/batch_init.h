@@ -0,0 +1,101 @@
+/********************************************************************************
+*  This file is part of CinoLib                                                 *
+*  Copyright(C) 2016: Marco Livesu                                              *
+*                                                                               *
+*  The MIT License                                                              *
+*                                                                               *
+*  Permission is hereby granted, free of charge, to any person obtaining a      *
+*  copy of this software and associated documentation files (the "Software"),   *
+*  to deal in the Software without restriction, including without limitation    *
+*  the rights to use, copy, modify, merge, publish, distribute, sublicense,     *
+*  and/or sell copies of the Software, and to permit persons to whom the        *
+*  Software is furnished to do so, subject to the following conditions:         *
+*                                                                               *
+*  The above copyright notice and this permission notice shall be included in   *
+*  all copies or substantial portions of the Software.                          *
+*                                                                               *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR   *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,     *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. IN NO EVENT SHALL THE *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER       *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      *
+*  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS *
+*  IN THE SOFTWARE.                                                             *
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Marco Livesu (marco.livesu@gmail.com)                                     *
+*     http://pers.ge.imati.cnr.it/livesu/                                       *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*********************************************************************************/
+#ifndef CINO_BATCH_INIT_H
+#define CINO_BATCH_INIT_H
+
+#include <cinolib/cino_inline.h>
+#include <cinolib/meshes/adjacency_csr.h>
+#include <cinolib/meshes/mesh_memory.h>
+#include <iostream>
+#include <vector>
+#include <stdint.h>
+
+namespace cinolib
+{
+
+/* Statistics about the (batch) construction of a mesh. They are filled by the
+ * init() methods of all the mesh classes and can be retrieved with init_stats()
+*/
+
+typedef struct
+{
+    uint   num_verts          = 0;
+    uint   num_edges          = 0;
+    uint   num_faces          = 0; // volume meshes only
+    uint   num_polys          = 0;
+    uint   num_dup_faces      = 0; // duplicated faces found (and skipped) in the input
+    uint   num_dup_polys      = 0; // duplicated polys found (and skipped) in the input
+    double secs_connectivity  = 0; // time spent to build the adjacency tables
+    double secs_geometry      = 0; // time spent to compute normals and tessellations
+    double secs_total         = 0; // overall time spent into init()
+    size_t bytes_connectivity = 0; // memory allocated for elements and adjacency tables
+}
+MeshInitStats;
+
+CINO_INLINE
+std::ostream & operator<<(std::ostream & in, const MeshInitStats & stats);
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// Assigns a dense id to each key, such that equal keys receive the same id,
+// and ids follow the order in which keys appear for the first time in the input.
+// This is what the incremental insertion of mesh elements (e.g. edges or faces
+// with duplicate check) would produce, but it is computed in O(n log n) with a
+// single sort instead of n local searches. Returns the number of unique keys
+
+CINO_INLINE
+uint ids_by_first_occurrence(const std::vector<uint64_t> & keys,
+                                   std::vector<uint>     & ids);
+
+// same as above, for keys of variable length (each row of the CSR table is a key)
+
+CINO_INLINE
+uint ids_by_first_occurrence(const AdjacencyCSR      & keys,
+                                   std::vector<uint> & ids);
+
+// sorts the entries of each row of the table (e.g. to obtain keys that do
+// not depend on the order in which the verts of an element are listed)
+
+CINO_INLINE
+void sort_rows(AdjacencyCSR & table);
+
+}
+
+#ifndef  CINO_STATIC_LIB
+#include "batch_init.cpp"
+#endif
+
+#endif // CINO_BATCH_INIT_H
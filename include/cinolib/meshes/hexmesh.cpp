@@ -41,6 +41,7 @@
 #include <cinolib/standard_elements_tables.h>
 #include <cinolib/vector_serialization.h>
 #include <cinolib/io/io_utilities.h>
+#include <cinolib/thread_pool.h>
 
 #include <queue>
 #include <float.h>
@@ -106,8 +107,14 @@ void Hexmesh<M,V,E,F,P>::load(const char * filename)
     std::string str(filename);
     std::string filetype = "." + get_file_extension(str);
 
-    if (filetype.compare(".mesh") == 0 ||
-        filetype.compare(".MESH") == 0)
+    if (filetype.compare(".cino") == 0 ||
+        filetype.compare(".CINO") == 0)
+    {
+        this->load_binary(filename);
+        return;
+    }
+    else if (filetype.compare(".mesh") == 0 ||
+             filetype.compare(".MESH") == 0)
     {
         read_MESH(filename, tmp_verts, tmp_polys, vert_labels, poly_labels);
     }
@@ -138,8 +145,13 @@ void Hexmesh<M,V,E,F,P>::save(const char * filename) const
     std::string str(filename);
     std::string filetype = "." + get_file_extension(str);
 
-    if (filetype.compare(".mesh") == 0 ||
-        filetype.compare(".MESH") == 0)
+    if (filetype.compare(".cino") == 0 ||
+        filetype.compare(".CINO") == 0)
+    {
+        this->save_binary(filename);
+    }
+    else if (filetype.compare(".mesh") == 0 ||
+             filetype.compare(".MESH") == 0)
     {
         if(this->polys_are_labeled())
         {
@@ -367,10 +379,10 @@ template<class M, class V, class E, class F, class P>
 CINO_INLINE
 void Hexmesh<M,V,E,F,P>::update_hex_quality()
 {
-    for(uint pid=0; pid<this->num_polys(); ++pid)
+    parallel_for(0, this->num_polys(), [this](const uint pid)
     {
         update_hex_quality(pid);
-    }
+    });
 }
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
@@ -451,9 +463,19 @@ uint Hexmesh<M,V,E,F,P>::poly_add(const std::vector<uint> & vlist) // vertex lis
 {
     assert(vlist.size()==8);
     uint pid = AbstractPolyhedralMesh<M,V,E,F,P>::poly_add(vlist);
+    poly_finalize(pid);
+    return pid;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class M, class V, class E, class F, class P>
+CINO_INLINE
+void Hexmesh<M,V,E,F,P>::poly_finalize(const uint pid)
+{
+    assert(this->adj_p2v(pid).size()==8);
     reorder_p2v(pid); // make sure p2v stores hex vertices in the standard way
     update_hex_quality(pid);
-    return pid;
 }
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
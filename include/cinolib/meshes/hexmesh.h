@@ -119,6 +119,7 @@ class Hexmesh : public AbstractPolyhedralMesh<M,V,E,F,P>
         double poly_volume          (const uint pid) const override;
         bool   poly_fix_orientation ();
         uint   poly_add             (const std::vector<uint> & vlist) override; // vertex list
+        void   poly_finalize        (const uint pid) override; // reorder p2v + update quality
 
         using  AbstractPolyhedralMesh<M,V,E,F,P>::poly_add; // avoid hiding poly_add(flist,fwinding);
 
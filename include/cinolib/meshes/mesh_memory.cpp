@@ -0,0 +1,117 @@
+/********************************************************************************
+*  This file is part of CinoLib                                                 *
+*  Copyright(C) 2016: Marco Livesu                                              *
+*                                                                               *
+*  The MIT License                                                              *
+*                                                                               *
+*  Permission is hereby granted, free of charge, to any person obtaining a      *
+*  copy of this software and associated documentation files (the "Software"),   *
+*  to deal in the Software without restriction, including without limitation    *
+*  the rights to use, copy, modify, merge, publish, distribute, sublicense,     *
+*  and/or sell copies of the Software, and to permit persons to whom the        *
+*  Software is furnished to do so, subject to the following conditions:         *
+*                                                                               *
+*  The above copyright notice and this permission notice shall be included in   *
+*  all copies or substantial portions of the Software.                          *
+*                                                                               *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR   *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,     *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. IN NO EVENT SHALL THE *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER       *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      *
+*  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS *
+*  IN THE SOFTWARE.                                                             *
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Marco Livesu (marco.livesu@gmail.com)                                     *
+*     http://pers.ge.imati.cnr.it/livesu/                                       *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*********************************************************************************/
+#include <cinolib/meshes/mesh_memory.h>
+#include <iomanip>
+
+namespace cinolib
+{
+
+CINO_INLINE
+std::ostream & operator<<(std::ostream & in, const MeshMemoryUsage & mu)
+{
+    auto MB = [](const size_t bytes) { return bytes/(1024.0*1024.0); };
+
+    in << std::fixed << std::setprecision(3);
+    for(const MemoryBlock & b : mu.blocks)
+    {
+        in << std::left << std::setw(24) << b.name << std::right
+           << std::setw(12) << MB(b.bytes_used)     << "MB used "
+           << std::setw(12) << MB(b.bytes_reserved) << "MB reserved\n";
+    }
+    in << std::left << std::setw(24) << "TOTAL" << std::right
+       << std::setw(12) << MB(mu.bytes_used)     << "MB used "
+       << std::setw(12) << MB(mu.bytes_reserved) << "MB reserved";
+    in << std::defaultfloat << std::setprecision(6);
+    return in;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void memory_usage_add(MeshMemoryUsage & mu, const std::string & name, const size_t used, const size_t reserved)
+{
+    MemoryBlock b;
+    b.name           = name;
+    b.bytes_used     = used;
+    b.bytes_reserved = reserved;
+    mu.blocks.push_back(b);
+    mu.bytes_used     += used;
+    mu.bytes_reserved += reserved;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+size_t bytes_used(const std::vector<bool> & v)
+{
+    // bits are packed into 64 bit words
+    return sizeof(v) + ((v.size()+63)/64)*8;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+size_t bytes_used(const AdjacencyCSR & t)
+{
+    return bytes_used(t.offsets) + bytes_used(t.entries);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+size_t bytes_allocated(const std::vector<bool> & v)
+{
+    return sizeof(v) + (v.capacity()+7)/8;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+size_t bytes_allocated(const AdjacencyCSR & t)
+{
+    return bytes_allocated(t.offsets) + bytes_allocated(t.entries);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void shrink_to_fit(AdjacencyCSR & t)
+{
+    t.offsets.shrink_to_fit();
+    t.entries.shrink_to_fit();
+}
+
+}
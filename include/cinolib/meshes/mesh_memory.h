@@ -0,0 +1,164 @@
+/********************************************************************************
+*  This file is part of CinoLib                                                 *
+*  Copyright(C) 2016: Marco Livesu                                              *
+*                                                                               *
+*  The MIT License                                                              *
+*                                                                               *
+*  Permission is hereby granted, free of charge, to any person obtaining a      *
+*  copy of this software and associated documentation files (the "Software"),   *
+*  to deal in the Software without restriction, including without limitation    *
+*  the rights to use, copy, modify, merge, publish, distribute, sublicense,     *
+*  and/or sell copies of the Software, and to permit persons to whom the        *
+*  Software is furnished to do so, subject to the following conditions:         *
+*                                                                               *
+*  The above copyright notice and this permission notice shall be included in   *
+*  all copies or substantial portions of the Software.                          *
+*                                                                               *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR   *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,     *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. IN NO EVENT SHALL THE *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER       *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      *
+*  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS *
+*  IN THE SOFTWARE.                                                             *
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Marco Livesu (marco.livesu@gmail.com)                                     *
+*     http://pers.ge.imati.cnr.it/livesu/                                       *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*********************************************************************************/
+#ifndef CINO_MESH_MEMORY_H
+#define CINO_MESH_MEMORY_H
+
+#include <cinolib/cino_inline.h>
+#include <cinolib/meshes/adjacency_csr.h>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace cinolib
+{
+
+/* Memory accounting for the containers of a mesh (see the memory_usage()
+ * method of the mesh classes). For each container two figures are reported:
+ * the bytes occupied by the elements it stores (used) and the bytes it has
+ * allocated (reserved), which also include the slack left behind by reserve()
+ * and by removed elements. The difference between the two is what a call to
+ * shrink_to_fit() gives back to the system. Allocator overheads and memory
+ * owned by the attributes (e.g. a std::vector inside a custom vert attribute)
+ * are not accounted for.
+*/
+
+typedef struct
+{
+    std::string name;
+    size_t      bytes_used     = 0;
+    size_t      bytes_reserved = 0;
+}
+MemoryBlock;
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+typedef struct
+{
+    std::vector<MemoryBlock> blocks;             // one per container, in the order they were added
+    size_t                   bytes_used     = 0; // sum over all blocks
+    size_t                   bytes_reserved = 0; // sum over all blocks
+}
+MeshMemoryUsage;
+
+CINO_INLINE
+std::ostream & operator<<(std::ostream & in, const MeshMemoryUsage & mu);
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// bytes occupied by the elements of a container (size is counted, not capacity)
+
+CINO_INLINE size_t bytes_used(const std::vector<bool> & v);
+CINO_INLINE size_t bytes_used(const AdjacencyCSR      & t);
+
+template<typename T>
+CINO_INLINE
+size_t bytes_used(const std::vector<T> & v)
+{
+    return sizeof(v) + v.size()*sizeof(T);
+}
+
+template<typename T>
+CINO_INLINE
+size_t bytes_used(const std::vector<std::vector<T>> & v)
+{
+    size_t bytes = sizeof(v);
+    for(const auto & row : v) bytes += bytes_used(row);
+    return bytes;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// bytes allocated by a container (capacity is counted, not size)
+
+CINO_INLINE size_t bytes_allocated(const std::vector<bool> & v);
+CINO_INLINE size_t bytes_allocated(const AdjacencyCSR      & t);
+
+template<typename T>
+CINO_INLINE
+size_t bytes_allocated(const std::vector<T> & v)
+{
+    return sizeof(v) + v.capacity()*sizeof(T);
+}
+
+template<typename T>
+CINO_INLINE
+size_t bytes_allocated(const std::vector<std::vector<T>> & v)
+{
+    size_t bytes = sizeof(v) + (v.capacity()-v.size())*sizeof(std::vector<T>);
+    for(const auto & row : v) bytes += bytes_allocated(row);
+    return bytes;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void memory_usage_add(MeshMemoryUsage & mu, const std::string & name, const size_t used, const size_t reserved);
+
+template<class C>
+CINO_INLINE
+void memory_usage_add(MeshMemoryUsage & mu, const std::string & name, const C & container)
+{
+    memory_usage_add(mu, name, bytes_used(container), bytes_allocated(container));
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// releases the memory reserved but not used by a container
+
+CINO_INLINE void shrink_to_fit(AdjacencyCSR & t);
+
+template<typename T>
+CINO_INLINE
+void shrink_to_fit(std::vector<T> & v)
+{
+    v.shrink_to_fit();
+}
+
+template<typename T>
+CINO_INLINE
+void shrink_to_fit(std::vector<std::vector<T>> & v)
+{
+    for(auto & row : v) row.shrink_to_fit();
+    v.shrink_to_fit();
+}
+
+}
+
+#ifndef  CINO_STATIC_LIB
+#include "mesh_memory.cpp"
+#endif
+
+#endif // CINO_MESH_MEMORY_H
@@ -88,8 +88,14 @@ void Polyhedralmesh<M,V,E,F,P>::load(const char * filename)
     std::string str(filename);
     std::string filetype = "." + get_file_extension(str);
 
-    if (filetype.compare(".hybrid") == 0 ||
-        filetype.compare(".HYBRID") == 0)
+    if (filetype.compare(".cino") == 0 ||
+        filetype.compare(".CINO") == 0)
+    {
+        this->load_binary(filename);
+        return;
+    }
+    else if (filetype.compare(".hybrid") == 0 ||
+             filetype.compare(".HYBRID") == 0)
     {
         read_HYBDRID(filename, tmp_verts, tmp_faces, tmp_polys, tmp_polys_face_winding);
         this->init(tmp_verts, tmp_faces, tmp_polys, tmp_polys_face_winding);
@@ -133,8 +139,13 @@ void Polyhedralmesh<M,V,E,F,P>::save(const char * filename) const
     std::string str(filename);
     std::string filetype = str.substr(str.size()-6,6);
 
-    if (filetype.compare(".hedra") == 0 ||
-        filetype.compare(".HEDRA") == 0)
+    if (get_file_extension(str).compare("cino") == 0 ||
+        get_file_extension(str).compare("CINO") == 0)
+    {
+        this->save_binary(filename);
+    }
+    else if (filetype.compare(".hedra") == 0 ||
+             filetype.compare(".HEDRA") == 0)
     {
         write_HEDRA(filename, this->verts, this->faces, this->polys, this->polys_face_winding);
     }
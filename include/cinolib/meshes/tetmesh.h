@@ -135,6 +135,7 @@ class Tetmesh : public AbstractPolyhedralMesh<M,V,E,F,P>
         uint              poly_split            (const uint pid, const std::vector<double> & bc = { 0.25, 0.25, 0.25, 0.25 });
         void              polys_split           (const std::vector<uint> & pids);
         uint              poly_add              (const std::vector<uint> & vlist) override; // vertex list
+        void              poly_finalize         (const uint pid) override; // reorder p2v + update quality
 
         using  AbstractPolyhedralMesh<M,V,E,F,P>::poly_add; // avoid hiding poly_add(flist,fwinding);
 
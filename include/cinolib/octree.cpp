@@ -35,11 +35,30 @@
 *********************************************************************************/
 #include <cinolib/octree.h>
 #include <cinolib/how_many_seconds.h>
+#include <cinolib/thread_pool.h>
+#include <cinolib/trace_profiler.h>
+#include <algorithm>
+#include <numeric>
 #include <stack>
 
 namespace cinolib
 {
 
+CINO_INLINE
+std::ostream & operator<<(std::ostream & in, const OctreeBuildStats & stats)
+{
+    in << ":::::::::::::::::::::::::::::::::::::::::::::::::::" << "\n";
+    in << "Octree created (" << stats.secs << "s, " << stats.num_threads << " threads)\n";
+    in << "#Items                   : " << stats.num_items          << "\n";
+    in << "#Leaves                  : " << stats.num_leaves         << "\n";
+    in << "Depth                    : " << stats.depth              << "\n";
+    in << "Max items per leaf       : " << stats.max_items_per_leaf << "\n";
+    in << ":::::::::::::::::::::::::::::::::::::::::::::::::::";
+    return in;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
 CINO_INLINE
 OctreeNode::~OctreeNode()
 {
@@ -77,41 +96,162 @@ Octree::~Octree()
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
 CINO_INLINE
-void Octree::build()
+OctreeBuildStats Octree::build()
 {
+    CINO_PROFILE_ZONE("Octree::build");
     typedef std::chrono::high_resolution_clock Time;
     Time::time_point t0 = Time::now();
 
+    OctreeBuildStats stats;
+    stats.num_items   = items.size();
+    stats.num_threads = get_num_threads();
+
     if(!items.empty())
     {
         // make AABBs for each item
-        aabbs.reserve(items.size());
-        for(const auto item : items) aabbs.push_back(item->aabb());
-        assert(items.size() == aabbs.size());
+        aabbs.resize(items.size());
+        parallel_for(0, items.size(), [this](const uint id)
+        {
+            aabbs[id] = items[id]->aabb();
+        });
 
         // build the tree root
         assert(root==nullptr);
         root = new OctreeNode(nullptr, AABB(aabbs, 1.5)); // enlarge it a bit to make sure queries don't fall outside
+        root->item_indices.resize(items.size());
+        std::iota(root->item_indices.begin(), root->item_indices.end(), 0);
 
-        tree_depth = 1;
-        num_leaves = 1;
+        num_leaves = 0;
+        tree_depth = 0;
+
+        // expand the top levels of the tree breadth first, until
+        // there are enough independent subtrees to feed all threads
+        std::vector<std::pair<OctreeNode*,uint>> frontier = { std::make_pair(root,0u) };
+        while(stats.num_threads>1 && !frontier.empty() && frontier.size()<4*stats.num_threads)
+        {
+            std::vector<std::pair<OctreeNode*,uint>> next;
+            for(const auto & obj : frontier)
+            {
+                OctreeNode *node  = obj.first;
+                uint        depth = obj.second;
+                if(needs_split(node, depth))
+                {
+                    split_node(node);
+                    for(int i=0; i<8; ++i) next.push_back(std::make_pair(node->children[i], depth+1));
+                }
+                else
+                {
+                    ++num_leaves;
+                    tree_depth = std::max(tree_depth, depth);
+                }
+            }
+            frontier.swap(next);
+        }
 
-        // populate the tree
-        for(uint id=0; id<items.size(); ++id) build_item(id, root, 0);
+        // build each subtree in a separate task
+        std::vector<uint> leaves(frontier.size(),0), depths(frontier.size(),0);
+        parallel_for(0, frontier.size(), [&](const uint i)
+        {
+            build_subtree(frontier[i].first, frontier[i].second, leaves[i], depths[i]);
+        }, 1);
+        for(uint l : leaves) num_leaves += l;
+        for(uint d : depths) tree_depth  = std::max(tree_depth, d);
     }
 
-    Time::time_point t1 = Time::now();
-    double t = how_many_seconds(t0,t1);
-
-    std::cout << ":::::::::::::::::::::::::::::::::::::::::::::::::::" << std::endl;
-    std::cout << "Octree created (" << t << "s)                      " << std::endl;
-    std::cout << "#Items                   : " << items.size()         << std::endl;
-    std::cout << "#Leaves                  : " << num_leaves           << std::endl;
-    std::cout << "Max depth                : " << max_depth            << std::endl;
-    std::cout << "Depth                    : " << tree_depth           << std::endl;
-    std::cout << "Prescribed items per leaf: " << items_per_leaf       << std::endl;
-    std::cout << "Max items per leaf       : " << max_items_per_leaf() << std::endl;
-    std::cout << ":::::::::::::::::::::::::::::::::::::::::::::::::::" << std::endl;
+    stats.num_leaves         = num_leaves;
+    stats.depth              = tree_depth;
+    stats.max_items_per_leaf = max_items_per_leaf();
+    stats.secs               = how_many_seconds(t0, Time::now());
+
+    std::cout << stats << std::endl;
+    return stats;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+bool Octree::needs_split(const OctreeNode * node, const uint depth) const
+{
+    // BUGFIX Jan 19, 2020: always split the root node (queries assume so)
+    return node==root || (node->item_indices.size()>items_per_leaf && depth<max_depth);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void Octree::create_children(OctreeNode * node)
+{
+    vec3d min = node->bbox.min;
+    vec3d max = node->bbox.max;
+    vec3d avg = node->bbox.center();
+    node->children[0] = new OctreeNode(node, AABB(vec3d(min[0], min[1], min[2]), vec3d(avg[0], avg[1], avg[2])));
+    node->children[1] = new OctreeNode(node, AABB(vec3d(avg[0], min[1], min[2]), vec3d(max[0], avg[1], avg[2])));
+    node->children[2] = new OctreeNode(node, AABB(vec3d(avg[0], avg[1], min[2]), vec3d(max[0], max[1], avg[2])));
+    node->children[3] = new OctreeNode(node, AABB(vec3d(min[0], avg[1], min[2]), vec3d(avg[0], max[1], avg[2])));
+    node->children[4] = new OctreeNode(node, AABB(vec3d(min[0], min[1], avg[2]), vec3d(avg[0], avg[1], max[2])));
+    node->children[5] = new OctreeNode(node, AABB(vec3d(avg[0], min[1], avg[2]), vec3d(max[0], avg[1], max[2])));
+    node->children[6] = new OctreeNode(node, AABB(vec3d(avg[0], avg[1], avg[2]), vec3d(max[0], max[1], max[2])));
+    node->children[7] = new OctreeNode(node, AABB(vec3d(min[0], avg[1], avg[2]), vec3d(avg[0], max[1], max[2])));
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void Octree::split_node(OctreeNode * node)
+{
+    assert(!node->is_inner);
+    node->is_inner = true;
+    create_children(node);
+
+    // move items downwards in the tree, preserving their order.
+    // NOTE: items that span across multiple octants will be added to each node they intersect.
+    // Big nodes (i.e. the top levels of the tree) are processed in chunks, in parallel
+    const std::vector<uint> & ids = node->item_indices;
+    uint n_chunks = (get_num_threads()>1) ? std::min(4*get_num_threads(), (uint)(ids.size()/4096)+1) : 1;
+    std::vector<std::vector<uint>> chunk_ids(8*n_chunks);
+    global_thread_pool().run(n_chunks, [&](const uint chunk, const uint)
+    {
+        uint beg = uint(uint64_t(ids.size())* chunk   /n_chunks);
+        uint end = uint(uint64_t(ids.size())*(chunk+1)/n_chunks);
+        for(uint j=beg; j<end; ++j)
+        {
+            bool found_octant = false;
+            for(int i=0; i<8; ++i)
+            {
+                if(node->children[i]->bbox.intersects_box(aabbs.at(ids[j])))
+                {
+                    chunk_ids[8*chunk+i].push_back(ids[j]);
+                    found_octant = true;
+                }
+            }
+            assert(found_octant);
+            (void)found_octant; // unused if NDEBUG is defined
+        }
+    });
+    for(int i=0; i<8; ++i)
+    {
+        std::vector<uint> & child_ids = node->children[i]->item_indices;
+        for(uint chunk=0; chunk<n_chunks; ++chunk)
+        {
+            child_ids.insert(child_ids.end(), chunk_ids[8*chunk+i].begin(), chunk_ids[8*chunk+i].end());
+        }
+    }
+    std::vector<uint>().swap(node->item_indices);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void Octree::build_subtree(OctreeNode * node, const uint depth, uint & leaves, uint & deepest_leaf)
+{
+    if(!needs_split(node, depth))
+    {
+        ++leaves;
+        deepest_leaf = std::max(deepest_leaf, depth);
+        return;
+    }
+    split_node(node);
+    for(int i=0; i<8; ++i) build_subtree(node->children[i], depth+1, leaves, deepest_leaf);
 }
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
@@ -143,7 +283,7 @@ void Octree::build_item(const uint id, OctreeNode * node, const uint depth)
         //
         // BUGFIX Jan 19, 2020: always split the root node (queries assume so)
         //
-        if(node==root || (node->item_indices.size()>items_per_leaf && depth<max_depth))
+        if(needs_split(node, depth))
         {
             node->is_inner = true;
 
@@ -151,17 +291,7 @@ void Octree::build_item(const uint id, OctreeNode * node, const uint depth)
             node->item_indices.clear();
 
             // create children octants
-            vec3d min = node->bbox.min;
-            vec3d max = node->bbox.max;
-            vec3d avg = node->bbox.center();
-            node->children[0] = new OctreeNode(node, AABB(vec3d(min[0], min[1], min[2]), vec3d(avg[0], avg[1], avg[2])));
-            node->children[1] = new OctreeNode(node, AABB(vec3d(avg[0], min[1], min[2]), vec3d(max[0], avg[1], avg[2])));
-            node->children[2] = new OctreeNode(node, AABB(vec3d(avg[0], avg[1], min[2]), vec3d(max[0], max[1], avg[2])));
-            node->children[3] = new OctreeNode(node, AABB(vec3d(min[0], avg[1], min[2]), vec3d(avg[0], max[1], avg[2])));
-            node->children[4] = new OctreeNode(node, AABB(vec3d(min[0], min[1], avg[2]), vec3d(avg[0], avg[1], max[2])));
-            node->children[5] = new OctreeNode(node, AABB(vec3d(avg[0], min[1], avg[2]), vec3d(max[0], avg[1], max[2])));
-            node->children[6] = new OctreeNode(node, AABB(vec3d(avg[0], avg[1], avg[2]), vec3d(max[0], max[1], max[2])));
-            node->children[7] = new OctreeNode(node, AABB(vec3d(min[0], avg[1], avg[2]), vec3d(avg[0], max[1], max[2])));
+            create_children(node);
 
             // mode items downwards in the tree
             // NOTE: items that span across multiple octants will be added to each node they intersect)
@@ -181,9 +311,9 @@ void Octree::build_item(const uint id, OctreeNode * node, const uint depth)
                 assert(found_octant);
             }
 
-            // remove items from current node            
+            // remove items from current node
             num_leaves += 7; // 8 children minus the current node
-            tree_depth = std::max(depth, d_plus_one);
+            tree_depth = std::max(tree_depth, d_plus_one);
         }
     }
 }
@@ -285,63 +415,89 @@ void Octree::closest_point(const vec3d  & p,          // query point
                                  vec3d  & pos,        // point in T closest to p
                                  double & dist) const // distance between pos and p
 {
-    assert(root != nullptr);
-
     typedef std::chrono::high_resolution_clock Time;
     Time::time_point t0 = Time::now();
 
+    QueryScratch scratch;
+    closest_point(p, scratch, id, pos, dist);
+
+    if(print_debug_info)
+    {
+        Time::time_point t1 = Time::now();
+        print_query_info("Closest point query", how_many_seconds(t0,t1), scratch.aabb_queries, scratch.item_queries);
+    }
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void Octree::closest_point(const vec3d        & p,
+                                 QueryScratch & scratch,
+                                 uint         & id,
+                                 vec3d        & pos,
+                                 double       & dist) const
+{
+    CINO_PROFILE_ZONE("Octree::closest_point");
+    assert(root != nullptr);
+
+    // the queue contains both nodes (index = -1) and items. Nodes are expanded
+    // until the closest element is an item, which is then the closest overall
+    std::vector<Obj> & q = scratch.queue;
+    q.clear();
+
     Obj obj;
     obj.node = root;
     obj.dist = root->bbox.dist_sqrd(p);
+    q.push_back(obj);
+    ++scratch.aabb_queries;
 
-    PrioQueue q;
-    q.push(obj);
-
-    uint aabb_queries = 1;
-    uint item_queries = 0;
+    auto push_items = [&](OctreeNode *leaf)
+    {
+        for(uint index : leaf->item_indices)
+        {
+            Obj obj;
+            obj.node  = leaf;
+            obj.index = index;
+            obj.pos   = items.at(index)->point_closest_to(p);
+            obj.dist  = obj.pos.dist_squared(p);
+            q.push_back(obj);
+            std::push_heap(q.begin(), q.end(), Greater());
+        }
+        scratch.item_queries += leaf->item_indices.size();
+    };
 
-    while(q.top().node->is_inner)
+    while(!q.empty() && q.front().index<0)
     {
-        Obj obj = q.top();
-        q.pop();
+        std::pop_heap(q.begin(), q.end(), Greater());
+        OctreeNode *node = q.back().node;
+        q.pop_back();
+
+        if(!node->is_inner)
+        {
+            push_items(node); // happens only if the root is a leaf
+            continue;
+        }
 
         for(int i=0; i<8; ++i)
         {
-            OctreeNode *child = obj.node->children[i];
+            OctreeNode *child = node->children[i];
             if(child->is_inner)
             {
                 Obj obj;
                 obj.node = child;
                 obj.dist = child->bbox.dist_sqrd(p);
-                q.push(obj);
-                if(print_debug_info) ++aabb_queries;
-            }
-            else
-            {
-                for(uint index : child->item_indices)
-                {
-                    Obj obj;
-                    obj.node  = child;
-                    obj.index = index;
-                    obj.pos   = items.at(index)->point_closest_to(p);
-                    obj.dist  = obj.pos.dist_squared(p);
-                    q.push(obj);
-                }
-                if(print_debug_info) item_queries+=child->item_indices.size();
+                q.push_back(obj);
+                std::push_heap(q.begin(), q.end(), Greater());
+                ++scratch.aabb_queries;
             }
+            else push_items(child);
         }
     }
 
-    if(print_debug_info)
-    {
-        Time::time_point t1 = Time::now();
-        print_query_info("Closest point query", how_many_seconds(t0,t1), aabb_queries, item_queries);
-    }
-
-    assert(q.top().index>=0);
-    id   = items.at(q.top().index)->id;
-    pos  = q.top().pos;
-    dist = q.top().dist;
+    assert(!q.empty() && q.front().index>=0);
+    id   = items.at(q.front().index)->id;
+    pos  = q.front().pos;
+    dist = q.front().dist;
 }
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
@@ -353,39 +509,53 @@ bool Octree::contains(const vec3d & p, const bool strict, uint & id) const
     typedef std::chrono::high_resolution_clock Time;
     Time::time_point t0 = Time::now();
 
-    uint aabb_queries = 0;
-    uint item_queries = 0;
+    QueryScratch scratch;
+    bool found = contains(p, strict, scratch, id);
 
-    std::stack<OctreeNode*> lifo;
-    lifo.push(root);
+    if(found && print_debug_info)
+    {
+        Time::time_point t1 = Time::now();
+        print_query_info("Contains query (first item)", how_many_seconds(t0,t1), scratch.aabb_queries, scratch.item_queries);
+    }
+    return found;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// this query becomes exact if CINOLIB_USES_EXACT_PREDICATES is defined
+CINO_INLINE
+bool Octree::contains(const vec3d & p, const bool strict, QueryScratch & scratch, uint & id) const
+{
+    CINO_PROFILE_ZONE("Octree::contains");
+    ++scratch.aabb_queries;
+    if(!root->bbox.contains(p,strict)) return false;
+
+    std::vector<const OctreeNode*> & lifo = scratch.stack;
+    lifo.clear();
+    lifo.push_back(root);
 
     while(!lifo.empty())
     {
-        OctreeNode *node = lifo.top();
-        lifo.pop();
+        const OctreeNode *node = lifo.back();
+        lifo.pop_back();
         assert(node->bbox.contains(p, strict));
 
         if(node->is_inner)
         {
             for(int i=0; i<8; ++i)
             {
-                if(node->children[i]->bbox.contains(p,strict)) lifo.push(node->children[i]);
+                if(node->children[i]->bbox.contains(p,strict)) lifo.push_back(node->children[i]);
             }
-            if(print_debug_info) aabb_queries+=8;
+            scratch.aabb_queries+=8;
         }
         else
         {
             for(uint i : node->item_indices)
             {
-                if(print_debug_info) ++item_queries;
+                ++scratch.item_queries;
                 if(items.at(i)->contains(p,strict))
                 {
                     id = items.at(i)->id;
-                    if(print_debug_info)
-                    {
-                        Time::time_point t1 = Time::now();
-                        print_query_info("Contains query (first item)", how_many_seconds(t0,t1), aabb_queries, item_queries);
-                    }
                     return true;
                 }
             }
@@ -456,27 +626,73 @@ bool Octree::intersects_ray(const vec3d & p, const vec3d & dir, double & min_t,
     typedef std::chrono::high_resolution_clock Time;
     Time::time_point t0 = Time::now();
 
+    QueryScratch scratch;
+    bool hit = intersects_ray(p, dir, scratch, min_t, id);
+
+    if(print_debug_info)
+    {
+        Time::time_point t1 = Time::now();
+        print_query_info("Intersects ray query", how_many_seconds(t0,t1), scratch.aabb_queries, scratch.item_queries);
+    }
+    return hit;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+bool Octree::intersects_ray(const vec3d        & p,
+                            const vec3d        & dir,
+                                  QueryScratch & scratch,
+                                  double       & min_t,
+                                  uint         & id) const
+{
+    CINO_PROFILE_ZONE("Octree::intersects_ray");
     vec3d  pos;
     double t;
     if(!root->bbox.intersects_ray(p, dir, t, pos)) return false;
+
+    // as in closest_point, nodes (index = -1) and items share the same queue
+    std::vector<Obj> & q = scratch.queue;
+    q.clear();
+
     Obj obj;
     obj.node = root;
     obj.dist = t;
+    q.push_back(obj);
+    ++scratch.aabb_queries;
 
-    PrioQueue q;
-    q.push(obj);
-
-    uint aabb_queries = 1;
-    uint item_queries = 0;
+    auto push_items = [&](OctreeNode *leaf)
+    {
+        for(uint i : leaf->item_indices)
+        {
+            if(items.at(i)->intersects_ray(p, dir, t, pos))
+            {
+                Obj obj;
+                obj.node  = leaf;
+                obj.index = i;
+                obj.dist  = t;
+                q.push_back(obj);
+                std::push_heap(q.begin(), q.end(), Greater());
+            }
+        }
+        scratch.item_queries += leaf->item_indices.size();
+    };
 
-    while(!q.empty() && q.top().node->is_inner)
+    while(!q.empty() && q.front().index<0)
     {
-        Obj obj = q.top();
-        q.pop();
+        std::pop_heap(q.begin(), q.end(), Greater());
+        OctreeNode *node = q.back().node;
+        q.pop_back();
+
+        if(!node->is_inner)
+        {
+            push_items(node); // happens only if the root is a leaf
+            continue;
+        }
 
         for(int i=0; i<8; ++i)
         {
-            OctreeNode *child = obj.node->children[i];
+            OctreeNode *child = node->children[i];
             if(child->bbox.intersects_ray(p, dir, t, pos))
             {
                 if(child->is_inner)
@@ -484,38 +700,18 @@ bool Octree::intersects_ray(const vec3d & p, const vec3d & dir, double & min_t,
                     Obj obj;
                     obj.node = child;
                     obj.dist = t;
-                    q.push(obj);
+                    q.push_back(obj);
+                    std::push_heap(q.begin(), q.end(), Greater());
                 }
-                else
-                {
-                    for(uint i : child->item_indices)
-                    {
-                        if(items.at(i)->intersects_ray(p, dir, t, pos))
-                        {
-                            Obj obj;
-                            obj.node  = child;
-                            obj.index = items.at(i)->id;
-                            obj.dist  = t;
-                            q.push(obj);
-                        }
-                        if(print_debug_info) ++item_queries;
-                    }
-                }
-                if(print_debug_info) ++aabb_queries;
+                else push_items(child);
+                ++scratch.aabb_queries;
             }
         }
     }
 
-    if(print_debug_info)
-    {
-        Time::time_point t1 = Time::now();
-        print_query_info("Intersects ray query", how_many_seconds(t0,t1), aabb_queries, item_queries);
-    }
-
     if(q.empty()) return false;
-    assert(q.top().index>=0);
-    id    = items.at(q.top().index)->id;
-    min_t = q.top().dist;
+    id    = items.at(q.front().index)->id;
+    min_t = q.front().dist;
     return true;
 }
 
@@ -658,7 +854,7 @@ bool Octree::intersects_segment(const vec3d s[], const bool ignore_if_valid_comp
 
     ids.clear();
 
-    AABB s_box({s[0], s[1]});
+    AABB s_box(std::vector<vec3d>{s[0], s[1]});
 
     std::stack<OctreeNode*> lifo;
     lifo.push(root);
@@ -704,4 +900,130 @@ bool Octree::intersects_segment(const vec3d s[], const bool ignore_if_valid_comp
     return !ids.empty();
 }
 
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void Octree::closest_point(const Span<vec3d>         & points,
+                                 std::vector<uint>   & ids,
+                                 std::vector<vec3d>  & pos,
+                                 std::vector<double> & dist) const
+{
+    CINO_PROFILE_ZONE("Octree::closest_point (batch)");
+    typedef std::chrono::high_resolution_clock Time;
+    Time::time_point t0 = Time::now();
+
+    ids.resize(points.size());
+    pos.resize(points.size());
+    dist.resize(points.size());
+
+    std::vector<QueryScratch> scratch(get_num_threads());
+    parallel_for_ranges(0, points.size(), [&](const uint beg, const uint end, const uint thread_id)
+    {
+        for(uint i=beg; i<end; ++i)
+        {
+            closest_point(points[i], scratch.at(thread_id), ids[i], pos[i], dist[i]);
+        }
+    }, 64);
+
+    if(print_debug_info)
+    {
+        Time::time_point t1 = Time::now();
+        uint aabb_queries = 0;
+        uint item_queries = 0;
+        for(const QueryScratch & s : scratch)
+        {
+            aabb_queries += s.aabb_queries;
+            item_queries += s.item_queries;
+        }
+        print_query_info("Closest point query (" + std::to_string(points.size()) + " points)",
+                         how_many_seconds(t0,t1), aabb_queries, item_queries);
+    }
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// this query becomes exact if CINOLIB_USES_EXACT_PREDICATES is defined
+CINO_INLINE
+void Octree::contains(const Span<vec3d>      & points,
+                      const bool               strict,
+                            std::vector<int> & ids) const
+{
+    CINO_PROFILE_ZONE("Octree::contains (batch)");
+    typedef std::chrono::high_resolution_clock Time;
+    Time::time_point t0 = Time::now();
+
+    ids.resize(points.size());
+
+    std::vector<QueryScratch> scratch(get_num_threads());
+    parallel_for_ranges(0, points.size(), [&](const uint beg, const uint end, const uint thread_id)
+    {
+        for(uint i=beg; i<end; ++i)
+        {
+            uint id;
+            ids[i] = contains(points[i], strict, scratch.at(thread_id), id) ? int(id) : -1;
+        }
+    }, 64);
+
+    if(print_debug_info)
+    {
+        Time::time_point t1 = Time::now();
+        uint aabb_queries = 0;
+        uint item_queries = 0;
+        for(const QueryScratch & s : scratch)
+        {
+            aabb_queries += s.aabb_queries;
+            item_queries += s.item_queries;
+        }
+        print_query_info("Contains query (" + std::to_string(points.size()) + " points)",
+                         how_many_seconds(t0,t1), aabb_queries, item_queries);
+    }
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void Octree::intersects_ray(const Span<vec3d>         & origins,
+                            const Span<vec3d>         & dirs,
+                                  std::vector<double> & min_t,
+                                  std::vector<int>    & ids) const
+{
+    CINO_PROFILE_ZONE("Octree::intersects_ray (batch)");
+    assert(origins.size()==dirs.size());
+
+    typedef std::chrono::high_resolution_clock Time;
+    Time::time_point t0 = Time::now();
+
+    min_t.resize(origins.size());
+    ids.resize(origins.size());
+
+    std::vector<QueryScratch> scratch(get_num_threads());
+    parallel_for_ranges(0, origins.size(), [&](const uint beg, const uint end, const uint thread_id)
+    {
+        for(uint i=beg; i<end; ++i)
+        {
+            uint id;
+            if(intersects_ray(origins[i], dirs[i], scratch.at(thread_id), min_t[i], id)) ids[i] = int(id);
+            else
+            {
+                ids[i]   = -1;
+                min_t[i] = inf_double;
+            }
+        }
+    }, 64);
+
+    if(print_debug_info)
+    {
+        Time::time_point t1 = Time::now();
+        uint aabb_queries = 0;
+        uint item_queries = 0;
+        for(const QueryScratch & s : scratch)
+        {
+            aabb_queries += s.aabb_queries;
+            item_queries += s.item_queries;
+        }
+        print_query_info("Intersects ray query (" + std::to_string(origins.size()) + " rays)",
+                         how_many_seconds(t0,t1), aabb_queries, item_queries);
+    }
+}
+
 }
@@ -38,6 +38,7 @@
 
 #include <cinolib/geometry/spatial_data_structure_item.h>
 #include <cinolib/meshes/meshes.h>
+#include <cinolib/span.h>
 #include <queue>
 
 namespace cinolib
@@ -57,11 +58,40 @@ class OctreeNode
 
 //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
+typedef struct
+{
+    uint   num_items          = 0;
+    uint   num_leaves         = 0;
+    uint   depth              = 0; // depth of the deepest leaf (the root has depth zero)
+    uint   max_items_per_leaf = 0;
+    uint   num_threads        = 1; // threads used for the construction
+    double secs               = 0; // construction time
+}
+OctreeBuildStats;
+
+CINO_INLINE
+std::ostream & operator<<(std::ostream & in, const OctreeBuildStats & stats);
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
 /* Usage:
  *
  *  i)   Create an empty octree
  *  ii)  Use the add_segment/triangle/tetrahedron facilities to populate it
  *  iii) Call build to make the tree
+ *
+ * The tree is built top-down: a node is split if it is the root, or if it
+ * intersects more than items_per_leaf items and is shallower than max_depth.
+ * The result is the same tree one would obtain inserting items one by one
+ * with build_item(). If the global thread pool has more than one thread
+ * (see set_num_threads() in thread_pool.h), the top levels of the tree are
+ * expanded in parallel, and then each subtree is built by a separate task
+ *
+ * Thread safety: once the tree is built, all const queries can be safely
+ * issued concurrently from multiple threads, as long as nobody modifies the
+ * tree (add_*, build*, debug_mode) at the same time. Batched queries split
+ * their input across the threads of the global pool, and each thread reuses
+ * the same scratch memory (priority queue, stack) for all its queries
 */
 
 class Octree
@@ -82,13 +112,13 @@ class Octree
 
         //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
-        void build();
-        void build_item(const uint id, OctreeNode *node, const uint depth);
+        OctreeBuildStats build();
+        void             build_item(const uint id, OctreeNode *node, const uint depth);
 
         //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
         template<class M, class V, class E, class P>
-        void build_from_mesh_polys(const AbstractPolygonMesh<M,V,E,P> & m)
+        OctreeBuildStats build_from_mesh_polys(const AbstractPolygonMesh<M,V,E,P> & m)
         {
             assert(items.empty());
             items.reserve(m.num_polys());
@@ -102,13 +132,13 @@ class Octree
                     add_triangle(pid, {v0,v1,v2});
                 }
             }
-            build();
+            return build();
         }
 
         //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
         template<class M, class V, class E, class P>
-        void build_from_mesh_polys(const AbstractPolyhedralMesh<M,V,E,P> & m)
+        OctreeBuildStats build_from_mesh_polys(const AbstractPolyhedralMesh<M,V,E,P> & m)
         {
             assert(items.empty());
             items.reserve(m.num_polys());
@@ -120,13 +150,13 @@ class Octree
                     default: assert(false && "Unsupported element");
                 }
             }
-            build();
+            return build();
         }
 
         //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
         template<class M, class V, class E, class P>
-        void build_from_mesh_edges(const AbstractMesh<M,V,E,P> & m)
+        OctreeBuildStats build_from_mesh_edges(const AbstractMesh<M,V,E,P> & m)
         {
             assert(items.empty());
             items.reserve(m.num_edges());
@@ -134,7 +164,7 @@ class Octree
             {
                 add_segment(eid, m.edge_verts(eid));
             }
-            build();
+            return build();
         }
 
         //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
@@ -173,6 +203,15 @@ class Octree
         bool intersects_segment (const vec3d s[], const bool ignore_if_valid_complex, std::unordered_set<uint> & ids) const;
         bool intersects_triangle(const vec3d t[], const bool ignore_if_valid_complex, std::unordered_set<uint> & ids) const;
 
+        // BATCHED QUERIES :::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        // same as the queries above, for a whole set of points (or rays). Results are
+        // stored in flat arrays, having one entry per query. Points not contained in any
+        // item and rays that do not hit any item get id -1 (and t = inf for rays)
+        void closest_point (const Span<vec3d> & points, std::vector<uint> & ids, std::vector<vec3d> & pos, std::vector<double> & dist) const;
+        void contains      (const Span<vec3d> & points, const bool strict, std::vector<int> & ids) const;
+        void intersects_ray(const Span<vec3d> & origins, const Span<vec3d> & dirs, std::vector<double> & min_t, std::vector<int> & ids) const;
+
         //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
     protected:
@@ -184,6 +223,13 @@ class Octree
 
         //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
+        bool needs_split    (const OctreeNode *node, const uint depth) const;
+        void create_children(OctreeNode *node);
+        void split_node     (OctreeNode *node);
+        void build_subtree  (OctreeNode *node, const uint depth, uint & leaves, uint & deepest_leaf);
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
         uint max_depth;      // maximum allowed depth of the tree
         uint items_per_leaf; // prescribed number of items per leaf (can't go deeper than max_depth anyways)
         uint tree_depth = 0; // actual depth of the tree
@@ -196,7 +242,7 @@ class Octree
         {
             double      dist  = inf_double;
             OctreeNode *node  = nullptr;
-            int         index = -1; // note: this is the item ID, NOT necessarily the index of vector items!!
+            int         index = -1; // index of vector items
             vec3d       pos;        // closest point
         };
         struct Greater
@@ -207,6 +253,19 @@ class Octree
             }
         };
         typedef std::priority_queue<Obj,std::vector<Obj>,Greater> PrioQueue;
+
+        // memory used by a query. Batched queries keep one per thread, and reuse it
+        struct QueryScratch
+        {
+            std::vector<Obj>                queue; // binary heap (std::push_heap/pop_heap with Greater)
+            std::vector<const OctreeNode *> stack;
+            uint aabb_queries = 0;
+            uint item_queries = 0;
+        };
+
+        void closest_point (const vec3d & p, QueryScratch & scratch, uint & id, vec3d & pos, double & dist) const;
+        bool contains      (const vec3d & p, const bool strict, QueryScratch & scratch, uint & id) const;
+        bool intersects_ray(const vec3d & p, const vec3d & dir, QueryScratch & scratch, double & min_t, uint & id) const;
 };
 
 }
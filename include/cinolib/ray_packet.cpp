@@ -0,0 +1,244 @@
+/********************************************************************************
+*  This file is part of CinoLib                                                 *
+*  Copyright(C) 2016: Marco Livesu                                              *
+*                                                                               *
+*  The MIT License                                                              *
+*                                                                               *
+*  Permission is hereby granted, free of charge, to any person obtaining a      *
+*  copy of this software and associated documentation files (the "Software"),   *
+*  to deal in the Software without restriction, including without limitation    *
+*  the rights to use, copy, modify, merge, publish, distribute, sublicense,     *
+*  and/or sell copies of the Software, and to permit persons to whom the        *
+*  Software is furnished to do so, subject to the following conditions:         *
+*                                                                               *
+*  The above copyright notice and this permission notice shall be included in   *
+*  all copies or substantial portions of the Software.                          *
+*                                                                               *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR   *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,     *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. IN NO EVENT SHALL THE *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER       *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      *
+*  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS *
+*  IN THE SOFTWARE.                                                             *
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Marco Livesu (marco.livesu@gmail.com)                                     *
+*     http://pers.ge.imati.cnr.it/livesu/                                       *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*********************************************************************************/
+#include <cinolib/ray_packet.h>
+#include <cfloat>
+#include <cmath>
+
+namespace cinolib
+{
+
+#if defined(CINO_RAY_PACKET_AVX)
+
+CINO_INLINE FloatLanes lanes_set  (const float f)                      { return { _mm256_set1_ps(f) }; }
+CINO_INLINE FloatLanes lanes_load (const float * f)                    { return { _mm256_loadu_ps(f) }; }
+CINO_INLINE void       lanes_store(const FloatLanes & a, float * f)    { _mm256_storeu_ps(f, a.v); }
+
+CINO_INLINE FloatLanes operator+(const FloatLanes & a, const FloatLanes & b) { return { _mm256_add_ps(a.v, b.v) }; }
+CINO_INLINE FloatLanes operator-(const FloatLanes & a, const FloatLanes & b) { return { _mm256_sub_ps(a.v, b.v) }; }
+CINO_INLINE FloatLanes operator*(const FloatLanes & a, const FloatLanes & b) { return { _mm256_mul_ps(a.v, b.v) }; }
+CINO_INLINE FloatLanes operator/(const FloatLanes & a, const FloatLanes & b) { return { _mm256_div_ps(a.v, b.v) }; }
+
+CINO_INLINE FloatLanes lanes_min       (const FloatLanes & a, const FloatLanes & b) { return { _mm256_min_ps(a.v, b.v) }; }
+CINO_INLINE FloatLanes lanes_max       (const FloatLanes & a, const FloatLanes & b) { return { _mm256_max_ps(a.v, b.v) }; }
+CINO_INLINE FloatLanes lanes_abs       (const FloatLanes & a)                       { return { _mm256_andnot_ps(_mm256_set1_ps(-0.f), a.v) }; }
+CINO_INLINE FloatLanes lanes_less      (const FloatLanes & a, const FloatLanes & b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ) }; }
+CINO_INLINE FloatLanes lanes_less_equal(const FloatLanes & a, const FloatLanes & b) { return { _mm256_cmp_ps(a.v, b.v, _CMP_LE_OQ) }; }
+CINO_INLINE FloatLanes lanes_and       (const FloatLanes & m0, const FloatLanes & m1) { return { _mm256_and_ps(m0.v, m1.v) }; }
+CINO_INLINE FloatLanes lanes_select    (const FloatLanes & m, const FloatLanes & a, const FloatLanes & b) { return { _mm256_blendv_ps(b.v, a.v, m.v) }; }
+CINO_INLINE uint       lanes_bits      (const FloatLanes & m) { return uint(_mm256_movemask_ps(m.v)); }
+
+#elif defined(CINO_RAY_PACKET_SSE)
+
+CINO_INLINE FloatLanes lanes_set  (const float f)                      { return { _mm_set1_ps(f) }; }
+CINO_INLINE FloatLanes lanes_load (const float * f)                    { return { _mm_loadu_ps(f) }; }
+CINO_INLINE void       lanes_store(const FloatLanes & a, float * f)    { _mm_storeu_ps(f, a.v); }
+
+CINO_INLINE FloatLanes operator+(const FloatLanes & a, const FloatLanes & b) { return { _mm_add_ps(a.v, b.v) }; }
+CINO_INLINE FloatLanes operator-(const FloatLanes & a, const FloatLanes & b) { return { _mm_sub_ps(a.v, b.v) }; }
+CINO_INLINE FloatLanes operator*(const FloatLanes & a, const FloatLanes & b) { return { _mm_mul_ps(a.v, b.v) }; }
+CINO_INLINE FloatLanes operator/(const FloatLanes & a, const FloatLanes & b) { return { _mm_div_ps(a.v, b.v) }; }
+
+CINO_INLINE FloatLanes lanes_min       (const FloatLanes & a, const FloatLanes & b) { return { _mm_min_ps(a.v, b.v) }; }
+CINO_INLINE FloatLanes lanes_max       (const FloatLanes & a, const FloatLanes & b) { return { _mm_max_ps(a.v, b.v) }; }
+CINO_INLINE FloatLanes lanes_abs       (const FloatLanes & a)                       { return { _mm_andnot_ps(_mm_set1_ps(-0.f), a.v) }; }
+CINO_INLINE FloatLanes lanes_less      (const FloatLanes & a, const FloatLanes & b) { return { _mm_cmplt_ps(a.v, b.v) }; }
+CINO_INLINE FloatLanes lanes_less_equal(const FloatLanes & a, const FloatLanes & b) { return { _mm_cmple_ps(a.v, b.v) }; }
+CINO_INLINE FloatLanes lanes_and       (const FloatLanes & m0, const FloatLanes & m1) { return { _mm_and_ps(m0.v, m1.v) }; }
+CINO_INLINE FloatLanes lanes_select    (const FloatLanes & m, const FloatLanes & a, const FloatLanes & b) { return { _mm_or_ps(_mm_and_ps(m.v, a.v), _mm_andnot_ps(m.v, b.v)) }; }
+CINO_INLINE uint       lanes_bits      (const FloatLanes & m) { return uint(_mm_movemask_ps(m.v)); }
+
+#else
+
+// scalar fallback: masks are stored as 1 (set) or 0 (unset)
+
+CINO_INLINE
+FloatLanes lanes_set(const float f)
+{
+    FloatLanes r;
+    for(uint i=0; i<RAY_PACKET_WIDTH; ++i) r.v[i] = f;
+    return r;
+}
+
+CINO_INLINE
+FloatLanes lanes_load(const float * f)
+{
+    FloatLanes r;
+    for(uint i=0; i<RAY_PACKET_WIDTH; ++i) r.v[i] = f[i];
+    return r;
+}
+
+CINO_INLINE
+void lanes_store(const FloatLanes & a, float * f)
+{
+    for(uint i=0; i<RAY_PACKET_WIDTH; ++i) f[i] = a.v[i];
+}
+
+#define CINO_LANES_BINARY_OP(expr) \
+    FloatLanes r; \
+    for(uint i=0; i<RAY_PACKET_WIDTH; ++i) r.v[i] = (expr); \
+    return r;
+
+CINO_INLINE FloatLanes operator+(const FloatLanes & a, const FloatLanes & b) { CINO_LANES_BINARY_OP(a.v[i] + b.v[i]) }
+CINO_INLINE FloatLanes operator-(const FloatLanes & a, const FloatLanes & b) { CINO_LANES_BINARY_OP(a.v[i] - b.v[i]) }
+CINO_INLINE FloatLanes operator*(const FloatLanes & a, const FloatLanes & b) { CINO_LANES_BINARY_OP(a.v[i] * b.v[i]) }
+CINO_INLINE FloatLanes operator/(const FloatLanes & a, const FloatLanes & b) { CINO_LANES_BINARY_OP(a.v[i] / b.v[i]) }
+
+CINO_INLINE FloatLanes lanes_min       (const FloatLanes & a, const FloatLanes & b) { CINO_LANES_BINARY_OP(a.v[i]<b.v[i] ? a.v[i] : b.v[i]) }
+CINO_INLINE FloatLanes lanes_max       (const FloatLanes & a, const FloatLanes & b) { CINO_LANES_BINARY_OP(a.v[i]>b.v[i] ? a.v[i] : b.v[i]) }
+CINO_INLINE FloatLanes lanes_abs       (const FloatLanes & a)                       { CINO_LANES_BINARY_OP(std::fabs(a.v[i])) }
+CINO_INLINE FloatLanes lanes_less      (const FloatLanes & a, const FloatLanes & b) { CINO_LANES_BINARY_OP(a.v[i] <  b.v[i] ? 1.f : 0.f) }
+CINO_INLINE FloatLanes lanes_less_equal(const FloatLanes & a, const FloatLanes & b) { CINO_LANES_BINARY_OP(a.v[i] <= b.v[i] ? 1.f : 0.f) }
+CINO_INLINE FloatLanes lanes_and       (const FloatLanes & a, const FloatLanes & b) { CINO_LANES_BINARY_OP(a.v[i]!=0 && b.v[i]!=0 ? 1.f : 0.f) }
+CINO_INLINE FloatLanes lanes_select    (const FloatLanes & m, const FloatLanes & a, const FloatLanes & b) { CINO_LANES_BINARY_OP(m.v[i]!=0 ? a.v[i] : b.v[i]) }
+
+#undef CINO_LANES_BINARY_OP
+
+CINO_INLINE
+uint lanes_bits(const FloatLanes & m)
+{
+    uint bits = 0;
+    for(uint i=0; i<RAY_PACKET_WIDTH; ++i) if(m.v[i]!=0) bits |= (1u<<i);
+    return bits;
+}
+
+#endif
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void ray_packet_init(RayPacket   & rp,
+                     const vec3d * orig,
+                     const vec3d * dir,
+                     const uint    n)
+{
+    assert(n<=RAY_PACKET_WIDTH);
+
+    // unused lanes replicate the first ray, but never hit anything (t_max<0)
+    float o[3][RAY_PACKET_WIDTH], d[3][RAY_PACKET_WIDTH], inv[3][RAY_PACKET_WIDTH], t[RAY_PACKET_WIDTH];
+    for(uint i=0; i<RAY_PACKET_WIDTH; ++i)
+    {
+        uint ray = (i<n) ? i : 0;
+        for(int j=0; j<3; ++j)
+        {
+            o[j][i] = float(orig[ray][j]);
+            d[j][i] = float(dir[ray][j]);
+            // axis aligned rays get a huge (but finite) inverse, so that slab
+            // tests never multiply zero by infinity
+            inv[j][i] = (std::fabs(dir[ray][j])<1e-15) ? FLT_MAX : float(1.0/dir[ray][j]);
+        }
+        t[i] = (i<n) ? FLT_MAX : -1.f;
+    }
+    for(int j=0; j<3; ++j)
+    {
+        rp.org[j]     = lanes_load(o[j]);
+        rp.dir[j]     = lanes_load(d[j]);
+        rp.inv_dir[j] = lanes_load(inv[j]);
+    }
+    rp.t_max = lanes_load(t);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+uint ray_packet_intersects_box(const RayPacket  & rp,
+                               const float        bbox_min[3],
+                               const float        bbox_max[3],
+                                     FloatLanes & t_near)
+{
+    FloatLanes t0 = lanes_set(0.f);
+    FloatLanes t1 = rp.t_max;
+    for(int j=0; j<3; ++j)
+    {
+        FloatLanes ta = (lanes_set(bbox_min[j]) - rp.org[j]) * rp.inv_dir[j];
+        FloatLanes tb = (lanes_set(bbox_max[j]) - rp.org[j]) * rp.inv_dir[j];
+        t0 = lanes_max(t0, lanes_min(ta,tb));
+        t1 = lanes_min(t1, lanes_max(ta,tb));
+    }
+    t_near = t0;
+    return lanes_bits(lanes_less_equal(t0,t1));
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// see Moller_Trumbore_intersection.cpp for the scalar (double precision) version
+CINO_INLINE
+uint ray_packet_clip_triangle(RayPacket & rp, const float tri[9])
+{
+    FloatLanes v0[3], e0[3], e1[3];
+    for(int j=0; j<3; ++j)
+    {
+        v0[j] = lanes_set(tri[j]);
+        e0[j] = lanes_set(tri[3+j]);
+        e1[j] = lanes_set(tri[6+j]);
+    }
+
+    // pvec = dir x e1
+    FloatLanes pvec[3] =
+    {
+        rp.dir[1]*e1[2] - rp.dir[2]*e1[1],
+        rp.dir[2]*e1[0] - rp.dir[0]*e1[2],
+        rp.dir[0]*e1[1] - rp.dir[1]*e1[0]
+    };
+    FloatLanes det     = e0[0]*pvec[0] + e0[1]*pvec[1] + e0[2]*pvec[2];
+    FloatLanes inv_det = lanes_set(1.f) / det;
+
+    FloatLanes tvec[3] = { rp.org[0]-v0[0], rp.org[1]-v0[1], rp.org[2]-v0[2] };
+    FloatLanes u       = (tvec[0]*pvec[0] + tvec[1]*pvec[1] + tvec[2]*pvec[2]) * inv_det;
+
+    // qvec = tvec x e0
+    FloatLanes qvec[3] =
+    {
+        tvec[1]*e0[2] - tvec[2]*e0[1],
+        tvec[2]*e0[0] - tvec[0]*e0[2],
+        tvec[0]*e0[1] - tvec[1]*e0[0]
+    };
+    FloatLanes v = (rp.dir[0]*qvec[0] + rp.dir[1]*qvec[1] + rp.dir[2]*qvec[2]) * inv_det;
+    FloatLanes t = (e1[0]*qvec[0] + e1[1]*qvec[1] + e1[2]*qvec[2]) * inv_det;
+
+    FloatLanes zero = lanes_set(0.f);
+    FloatLanes one  = lanes_set(1.f);
+    FloatLanes hit  = lanes_less_equal(lanes_set(0.0000001f), lanes_abs(det)); // not coplanar
+    hit = lanes_and(hit, lanes_less_equal(zero, u));
+    hit = lanes_and(hit, lanes_less_equal(zero, v));
+    hit = lanes_and(hit, lanes_less_equal(u+v, one));
+    hit = lanes_and(hit, lanes_less_equal(zero, t));
+    hit = lanes_and(hit, lanes_less(t, rp.t_max));
+
+    rp.t_max = lanes_select(hit, t, rp.t_max);
+    return lanes_bits(hit);
+}
+
+}
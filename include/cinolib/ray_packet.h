@@ -0,0 +1,134 @@
+/********************************************************************************
+*  This file is part of CinoLib                                                 *
+*  Copyright(C) 2016: Marco Livesu                                              *
+*                                                                               *
+*  The MIT License                                                              *
+*                                                                               *
+*  Permission is hereby granted, free of charge, to any person obtaining a      *
+*  copy of this software and associated documentation files (the "Software"),   *
+*  to deal in the Software without restriction, including without limitation    *
+*  the rights to use, copy, modify, merge, publish, distribute, sublicense,     *
+*  and/or sell copies of the Software, and to permit persons to whom the        *
+*  Software is furnished to do so, subject to the following conditions:         *
+*                                                                               *
+*  The above copyright notice and this permission notice shall be included in   *
+*  all copies or substantial portions of the Software.                          *
+*                                                                               *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR   *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,     *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. IN NO EVENT SHALL THE *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER       *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      *
+*  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS *
+*  IN THE SOFTWARE.                                                             *
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Marco Livesu (marco.livesu@gmail.com)                                     *
+*     http://pers.ge.imati.cnr.it/livesu/                                       *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*********************************************************************************/
+#ifndef CINO_RAY_PACKET_H
+#define CINO_RAY_PACKET_H
+
+#include <cinolib/geometry/vec3.h>
+
+#if !defined(CINOLIB_NO_SIMD) && defined(__AVX__)
+#define CINO_RAY_PACKET_AVX
+#include <immintrin.h>
+#elif !defined(CINOLIB_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64))
+#define CINO_RAY_PACKET_SSE
+#include <emmintrin.h>
+#endif
+
+namespace cinolib
+{
+
+/* Lanes of single precision floats processed with a single instruction. The
+ * width of a packet depends on the instruction sets enabled at compile time:
+ * 8 lanes with AVX (e.g. -mavx or -march=native), 4 lanes with SSE2 (enabled
+ * by default on any x86-64 compiler). On other architectures, or if the macro
+ * CINOLIB_NO_SIMD is defined, a portable scalar fallback with 4 lanes is used.
+ *
+ * Comparisons return masks, which can only be consumed by lanes_and,
+ * lanes_select and lanes_bits
+*/
+
+#if defined(CINO_RAY_PACKET_AVX)
+const uint RAY_PACKET_WIDTH = 8;
+typedef struct { __m256 v; } FloatLanes;
+#elif defined(CINO_RAY_PACKET_SSE)
+const uint RAY_PACKET_WIDTH = 4;
+typedef struct { __m128 v; } FloatLanes;
+#else
+const uint RAY_PACKET_WIDTH = 4;
+typedef struct { float v[RAY_PACKET_WIDTH]; } FloatLanes;
+#endif
+
+CINO_INLINE FloatLanes lanes_set  (const float f);
+CINO_INLINE FloatLanes lanes_load (const float * f);
+CINO_INLINE void       lanes_store(const FloatLanes & a, float * f);
+
+CINO_INLINE FloatLanes operator+(const FloatLanes & a, const FloatLanes & b);
+CINO_INLINE FloatLanes operator-(const FloatLanes & a, const FloatLanes & b);
+CINO_INLINE FloatLanes operator*(const FloatLanes & a, const FloatLanes & b);
+CINO_INLINE FloatLanes operator/(const FloatLanes & a, const FloatLanes & b);
+
+CINO_INLINE FloatLanes lanes_min       (const FloatLanes & a, const FloatLanes & b);
+CINO_INLINE FloatLanes lanes_max       (const FloatLanes & a, const FloatLanes & b);
+CINO_INLINE FloatLanes lanes_abs       (const FloatLanes & a);
+CINO_INLINE FloatLanes lanes_less      (const FloatLanes & a, const FloatLanes & b); // mask a <  b
+CINO_INLINE FloatLanes lanes_less_equal(const FloatLanes & a, const FloatLanes & b); // mask a <= b
+CINO_INLINE FloatLanes lanes_and       (const FloatLanes & m0, const FloatLanes & m1);
+CINO_INLINE FloatLanes lanes_select    (const FloatLanes & m, const FloatLanes & a, const FloatLanes & b); // m ? a : b
+CINO_INLINE uint       lanes_bits      (const FloatLanes & m); // i-th bit set if the i-th lane of m is set
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+/* A packet of RAY_PACKET_WIDTH rays R(t) := org + t * dir, traversed together
+ * through a spatial data structure. Unused lanes have a negative t_max, so
+ * they never hit anything
+*/
+
+typedef struct
+{
+    FloatLanes org[3];
+    FloatLanes dir[3];
+    FloatLanes inv_dir[3];
+    FloatLanes t_max; // rays are clipped at t_max (i.e. the closest hit found so far)
+}
+RayPacket;
+
+// fills the first n lanes of the packet with the given rays (n <= RAY_PACKET_WIDTH)
+CINO_INLINE
+void ray_packet_init(RayPacket   & rp,
+                     const vec3d * orig,
+                     const vec3d * dir,
+                     const uint    n);
+
+// returns the lanes (bitmask) of the rays that hit the box within [0,t_max],
+// and the t at which they enter it
+CINO_INLINE
+uint ray_packet_intersects_box(const RayPacket & rp,
+                               const float       bbox_min[3],
+                               const float       bbox_max[3],
+                                     FloatLanes & t_near);
+
+// tests the packet against a triangle, given as its first vertex and the two
+// edges leaving it (9 floats), with the Moller-Trumbore algorithm. Rays that
+// hit it within [0,t_max) are clipped at the hit, and their lanes are returned
+CINO_INLINE
+uint ray_packet_clip_triangle(RayPacket & rp, const float tri[9]);
+
+}
+
+#ifndef  CINO_STATIC_LIB
+#include "ray_packet.cpp"
+#endif
+
+#endif // CINO_RAY_PACKET_H
@@ -35,6 +35,7 @@
 *********************************************************************************/
 #include <cinolib/remesh_BotschKobbelt2004.h>
 #include <cinolib/tangential_smoothing.h>
+#include <cinolib/trace_profiler.h>
 
 namespace cinolib
 {
@@ -53,6 +54,7 @@ void remesh_Botsch_Kobbelt_2004(DrawableTrimesh<M,V,E,P> & m,
                                 const double               target_edge_length,
                                 const bool                 preserve_marked_features)
 {
+    CINO_PROFILE_ZONE("remesh_Botsch_Kobbelt_2004");
     double l = (target_edge_length>0) ? target_edge_length : m.edge_avg_length();
 
     // 1) split too long edges
@@ -0,0 +1,865 @@
+/********************************************************************************
+*  This file is part of CinoLib                                                 *
+*  Copyright(C) 2016: Marco Livesu                                              *
+*                                                                               *
+*  The MIT License                                                              *
+*                                                                               *
+*  Permission is hereby granted, free of charge, to any person obtaining a      *
+*  copy of this software and associated documentation files (the "Software"),   *
+*  to deal in the Software without restriction, including without limitation    *
+*  the rights to use, copy, modify, merge, publish, distribute, sublicense,     *
+*  and/or sell copies of the Software, and to permit persons to whom the        *
+*  Software is furnished to do so, subject to the following conditions:         *
+*                                                                               *
+*  The above copyright notice and this permission notice shall be included in   *
+*  all copies or substantial portions of the Software.                          *
+*                                                                               *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR   *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,     *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. IN NO EVENT SHALL THE *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER       *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      *
+*  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS *
+*  IN THE SOFTWARE.                                                             *
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Marco Livesu (marco.livesu@gmail.com)                                     *
+*     http://pers.ge.imati.cnr.it/livesu/                                       *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*********************************************************************************/
+#include <cinolib/remesh_isotropic.h>
+#include <cinolib/thread_pool.h>
+#include <cinolib/trace_profiler.h>
+#include <cinolib/how_many_seconds.h>
+#include <cinolib/vector_serialization.h>
+#include <cinolib/min_max_inf.h>
+#include <algorithm>
+#include <queue>
+#include <climits>
+
+namespace cinolib
+{
+
+CINO_INLINE
+std::ostream & operator<<(std::ostream & in, const RemeshIterationStats & stats)
+{
+    in << stats.num_splits    << " splits, "
+       << stats.num_collapses << " collapses, "
+       << stats.num_flips     << " flips  ["
+       << stats.secs          << "s]  "
+       << stats.num_verts     << "V / "
+       << stats.num_edges     << "E / "
+       << stats.num_polys     << "P  edge length min/avg/max: "
+       << stats.edge_len_min  << " / "
+       << stats.edge_len_avg  << " / "
+       << stats.edge_len_max  << " ("
+       << 100.0*stats.in_range_ratio << "% in range)";
+    return in;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void IsotropicRemesher::init(const std::vector<vec3d> & verts,
+                             const std::vector<uint>  & tris,
+                             const std::vector<ipair> & feature_edges,
+                             const std::vector<int>   & tri_labels)
+{
+    assert(tris.size()%3==0);
+    uint nv = verts.size();
+    uint nt = tris.size()/3;
+
+    this->pos  = verts;
+    this->tris = tris;
+    labels     = tri_labels;
+    if(labels.empty()) labels.assign(nt,-1);
+    assert(labels.size()==nt);
+
+    v2t.assign(nv, std::vector<uint>());
+    for(uint tid=0; tid<nt; ++tid)
+    for(uint i=0; i<3; ++i)
+    {
+        v2t.at(tris.at(3*tid+i)).push_back(tid);
+    }
+
+    vert_dead.assign(nv, 0);
+    tri_dead.assign(nt, 0);
+    nv_alive = nv;
+    nt_alive = nt;
+
+    boundary.assign(nv, 0);
+    for(uint tid=0; tid<nt; ++tid)
+    for(uint i=0; i<3; ++i)
+    {
+        uint vid0 = tris.at(3*tid+i);
+        uint vid1 = tris.at(3*tid+(i+1)%3);
+        uint t[2];
+        if(edge_tris(vid0,vid1,t)==1) boundary.at(vid0) = boundary.at(vid1) = 1;
+    }
+
+    anchored = boundary;
+    features.clear();
+    for(const ipair & e : feature_edges)
+    {
+        features.insert(edge_key(e.first, e.second));
+        anchored.at(e.first)  = 1;
+        anchored.at(e.second) = 1;
+    }
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+std::vector<RemeshIterationStats> IsotropicRemesher::remesh(const RemeshOptions & opt)
+{
+    CINO_PROFILE_ZONE("IsotropicRemesher::remesh");
+
+    if(!opt.preserve_marked_features)
+    {
+        features.clear();
+        anchored = boundary;
+    }
+
+    double l = (opt.target_edge_length>0) ? opt.target_edge_length : edge_avg_length();
+
+    std::vector<RemeshIterationStats> stats;
+    for(uint i=0; i<opt.max_iterations; ++i)
+    {
+        stats.push_back(iterate(l, opt.smoothing_steps));
+        const RemeshIterationStats & s = stats.back();
+        uint edits = s.num_splits + s.num_collapses + s.num_flips;
+        if(edits <= opt.convergence_threshold * s.num_edges) break;
+    }
+    compact();
+    return stats;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+RemeshIterationStats IsotropicRemesher::iterate(const double target_edge_length, const uint smoothing_steps)
+{
+    CINO_PROFILE_ZONE("IsotropicRemesher::iterate");
+    typedef std::chrono::high_resolution_clock Time;
+    Time::time_point t0 = Time::now();
+
+    double max_len = 4./3. * target_edge_length;
+    double min_len = 4./5. * target_edge_length;
+
+    RemeshIterationStats stats;
+    stats.num_splits    = split_long_edges(max_len);
+    stats.num_collapses = collapse_short_edges(min_len, max_len);
+    stats.num_flips     = flip_edges();
+    for(uint i=0; i<smoothing_steps; ++i) smooth();
+
+    edge_stats(target_edge_length, stats);
+    stats.num_verts = nv_alive;
+    stats.num_polys = nt_alive;
+    stats.secs      = how_many_seconds(t0, Time::now());
+    return stats;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void IsotropicRemesher::compact()
+{
+    uint nv = 0;
+    std::vector<uint> vmap(pos.size(), UINT_MAX);
+    for(uint vid=0; vid<pos.size(); ++vid)
+    {
+        if(vert_dead.at(vid)) continue;
+        vmap.at(vid)     = nv;
+        pos.at(nv)       = pos.at(vid);
+        boundary.at(nv)  = boundary.at(vid);
+        anchored.at(nv)  = anchored.at(vid);
+        ++nv;
+    }
+    pos.resize(nv);
+    boundary.resize(nv);
+    anchored.resize(nv);
+
+    uint nt = 0;
+    for(uint tid=0; tid<tri_dead.size(); ++tid)
+    {
+        if(tri_dead.at(tid)) continue;
+        for(uint i=0; i<3; ++i) tris.at(3*nt+i) = vmap.at(tris.at(3*tid+i));
+        labels.at(nt) = labels.at(tid);
+        ++nt;
+    }
+    tris.resize(3*nt);
+    labels.resize(nt);
+
+    std::unordered_set<uint64_t> tmp;
+    for(uint64_t key : features)
+    {
+        uint vid0 = vmap.at(key >> 32);
+        uint vid1 = vmap.at(key & 0xFFFFFFFF);
+        if(vid0!=UINT_MAX && vid1!=UINT_MAX) tmp.insert(edge_key(vid0,vid1));
+    }
+    features.swap(tmp);
+
+    v2t.assign(nv, std::vector<uint>());
+    for(uint tid=0; tid<nt; ++tid)
+    for(uint i=0; i<3; ++i)
+    {
+        v2t.at(tris.at(3*tid+i)).push_back(tid);
+    }
+
+    vert_dead.assign(nv, 0);
+    tri_dead.assign(nt, 0);
+    assert(nv==nv_alive && nt==nt_alive);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void IsotropicRemesher::export_mesh(std::vector<vec3d> & verts,
+                                    std::vector<uint>  & tris,
+                                    std::vector<ipair> & feature_edges,
+                                    std::vector<int>   & tri_labels)
+{
+    compact();
+    verts      = pos;
+    tris       = this->tris;
+    tri_labels = labels;
+    feature_edges.clear();
+    for(uint64_t key : features)
+    {
+        feature_edges.push_back(std::make_pair(uint(key >> 32), uint(key & 0xFFFFFFFF)));
+    }
+    std::sort(feature_edges.begin(), feature_edges.end());
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+double IsotropicRemesher::edge_avg_length() const
+{
+    std::vector<ipair> e;
+    edges(e);
+    double sum = 0;
+    for(const ipair & p : e) sum += pos.at(p.first).dist(pos.at(p.second));
+    return e.empty() ? 0 : sum/e.size();
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+uint IsotropicRemesher::split_long_edges(const double max_len)
+{
+    CINO_PROFILE_ZONE("IsotropicRemesher::split_long_edges");
+
+    // longest edges first. Positions do not change while splitting, hence
+    // an entry is outdated only if its edge does not exist anymore
+    typedef std::pair<double,ipair> Entry;
+    std::priority_queue<Entry> q;
+
+    std::vector<ipair> e;
+    edges(e);
+    for(const ipair & p : e)
+    {
+        double len = pos.at(p.first).dist(pos.at(p.second));
+        if(len > max_len) q.push(std::make_pair(len,p));
+    }
+
+    uint count = 0;
+    while(!q.empty())
+    {
+        uint vid0 = q.top().second.first;
+        uint vid1 = q.top().second.second;
+        q.pop();
+
+        uint t[2];
+        uint n = edge_tris(vid0, vid1, t);
+        if(n==0 || n>2) continue; // gone (or non manifold)
+
+        uint opp[2];
+        for(uint i=0; i<n; ++i) opp[i] = tri_opposite_vert(t[i], vid0, vid1);
+
+        edge_split(vid0, vid1);
+        ++count;
+
+        uint vid = pos.size()-1;
+        auto push = [&](const uint v0, const uint v1)
+        {
+            double len = pos.at(v0).dist(pos.at(v1));
+            if(len > max_len) q.push(std::make_pair(len, std::make_pair(v0,v1)));
+        };
+        push(vid0, vid);
+        push(vid,  vid1);
+        for(uint i=0; i<n; ++i) push(vid, opp[i]);
+    }
+    return count;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+uint IsotropicRemesher::collapse_short_edges(const double min_len, const double max_len)
+{
+    CINO_PROFILE_ZONE("IsotropicRemesher::collapse_short_edges");
+
+    // shortest edges first. Collapses move vertices, hence lengths
+    // are re-evaluated (and outdated entries skipped) when popped
+    typedef std::pair<double,ipair> Entry;
+    std::priority_queue<Entry,std::vector<Entry>,std::greater<Entry>> q;
+
+    std::vector<ipair> e;
+    edges(e);
+    for(const ipair & p : e)
+    {
+        if(anchored.at(p.first) || anchored.at(p.second)) continue;
+        double len = pos.at(p.first).dist(pos.at(p.second));
+        if(len < min_len) q.push(std::make_pair(len,p));
+    }
+
+    uint count = 0;
+    std::vector<uint> nbrs;
+    while(!q.empty())
+    {
+        uint vid0 = q.top().second.first;
+        uint vid1 = q.top().second.second;
+        q.pop();
+
+        if(vert_dead.at(vid0) || vert_dead.at(vid1)) continue;
+        if(pos.at(vid0).dist(pos.at(vid1)) >= min_len) continue;
+        if(!edge_collapse(vid0, vid1, max_len)) continue;
+        ++count;
+
+        // vid1 survived and moved: its edges may have become too short
+        vert_neighbors(vid1, nbrs);
+        for(uint nbr : nbrs)
+        {
+            if(anchored.at(nbr)) continue;
+            double len = pos.at(vid1).dist(pos.at(nbr));
+            if(len < min_len) q.push(std::make_pair(len, std::make_pair(vid1,nbr)));
+        }
+    }
+    return count;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+uint IsotropicRemesher::flip_edges()
+{
+    CINO_PROFILE_ZONE("IsotropicRemesher::flip_edges");
+
+    // Flips are applied in rounds. At each round the edges whose flip improves
+    // vertex valences are greedily colored, so that edges with the same color do
+    // not share any vertex (neither of the edge, nor opposite to it). Flips with
+    // the same color touch disjoint sets of triangles and are done in parallel
+    typedef struct { uint v[4]; } Candidate; // edge verts, followed by opposite verts
+
+    uint count = 0;
+    for(uint round=0; round<10; ++round)
+    {
+        std::vector<ipair> e;
+        edges(e);
+        std::vector<uint8_t> improves(e.size());
+        parallel_for(0, e.size(), [&](const uint i)
+        {
+            improves[i] = edge_improves_valence(e[i].first, e[i].second);
+        });
+
+        std::vector<uint64_t>               used(pos.size(), 0); // colors used around each vertex
+        std::vector<std::vector<Candidate>> colors;
+        for(uint i=0; i<e.size(); ++i)
+        {
+            if(!improves[i]) continue;
+            uint t[2];
+            edge_tris(e[i].first, e[i].second, t);
+            Candidate c;
+            c.v[0] = e[i].first;
+            c.v[1] = e[i].second;
+            c.v[2] = tri_opposite_vert(t[0], c.v[0], c.v[1]);
+            c.v[3] = tri_opposite_vert(t[1], c.v[0], c.v[1]);
+            uint64_t mask = used[c.v[0]] | used[c.v[1]] | used[c.v[2]] | used[c.v[3]];
+            if(mask==~uint64_t(0)) continue; // no color left, try again next round
+            uint col = 0;
+            while(mask & (uint64_t(1) << col)) ++col;
+            for(uint vid : c.v) used[vid] |= (uint64_t(1) << col);
+            if(col>=colors.size()) colors.resize(col+1);
+            colors.at(col).push_back(c);
+        }
+        if(colors.empty()) break;
+
+        uint round_count = 0;
+        for(const std::vector<Candidate> & set : colors)
+        {
+            // flips done by previous colors may have changed the verts opposite to an
+            // edge. In that case the flip is skipped, as its set of verts is not locked
+            std::vector<uint8_t> flipped(set.size(), 0);
+            parallel_for(0, set.size(), [&](const uint i)
+            {
+                const Candidate & c = set[i];
+                uint t[2];
+                if(edge_tris(c.v[0], c.v[1], t)!=2) return;
+                uint opp0 = tri_opposite_vert(t[0], c.v[0], c.v[1]);
+                uint opp1 = tri_opposite_vert(t[1], c.v[0], c.v[1]);
+                if(std::min(opp0,opp1)!=std::min(c.v[2],c.v[3]) ||
+                   std::max(opp0,opp1)!=std::max(c.v[2],c.v[3])) return;
+                flipped[i] = edge_flip(c.v[0], c.v[1]);
+            });
+            for(uint8_t f : flipped) round_count += f;
+        }
+        count += round_count;
+        if(round_count==0) break;
+    }
+    return count;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void IsotropicRemesher::smooth()
+{
+    CINO_PROFILE_ZONE("IsotropicRemesher::smooth");
+
+    // greedy vertex coloring: verts with the same color are not adjacent,
+    // hence they can be relocated in parallel (each vertex reads only the
+    // positions of its neighbors)
+    uint nv = pos.size();
+    std::vector<int>               color(nv, -1);
+    std::vector<std::vector<uint>> colors;
+    std::vector<uint>              nbrs;
+    for(uint vid=0; vid<nv; ++vid)
+    {
+        if(vert_dead.at(vid) || anchored.at(vid) || v2t.at(vid).empty()) continue;
+        vert_neighbors(vid, nbrs);
+        uint64_t mask = 0;
+        for(uint nbr : nbrs) if(color.at(nbr)>=0) mask |= (uint64_t(1) << color.at(nbr));
+        if(mask==~uint64_t(0)) continue;
+        uint col = 0;
+        while(mask & (uint64_t(1) << col)) ++col;
+        color.at(vid) = col;
+        if(col>=colors.size()) colors.resize(col+1);
+        colors.at(col).push_back(vid);
+    }
+
+    // vertex areas are computed once, before any vertex moves
+    std::vector<double> area(nv, 0);
+    parallel_for(0, nv, [&](const uint vid)
+    {
+        double a = 0;
+        for(uint tid : v2t[vid]) a += tri_normal(tid).length();
+        area[vid] = a/6.0;
+    });
+
+    for(const std::vector<uint> & set : colors)
+    {
+        parallel_for_ranges(0, set.size(), [&](const uint beg, const uint end, const uint)
+        {
+            std::vector<uint> nbrs;
+            for(uint i=beg; i<end; ++i)
+            {
+                uint vid = set[i];
+
+                vec3d n(0,0,0);
+                for(uint tid : v2t[vid]) n += tri_normal(tid);
+                if(n.normalize()==0) continue;
+
+                vec3d  c(0,0,0);
+                double w = 0;
+                vert_neighbors(vid, nbrs);
+                for(uint nbr : nbrs)
+                {
+                    c += area[nbr] * pos[nbr];
+                    w += area[nbr];
+                }
+                if(w==0) continue;
+
+                vec3d d = c/w - pos[vid];
+                pos[vid] += d - n * d.dot(n);
+            }
+        }, 256);
+    }
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void IsotropicRemesher::edge_stats(const double l, RemeshIterationStats & stats) const
+{
+    std::vector<ipair> e;
+    edges(e);
+    stats.num_edges    = e.size();
+    stats.edge_len_min = inf_double;
+    stats.edge_len_max = 0;
+    stats.edge_len_avg = 0;
+    uint in_range = 0;
+    for(const ipair & p : e)
+    {
+        double len = pos.at(p.first).dist(pos.at(p.second));
+        stats.edge_len_min  = std::min(stats.edge_len_min, len);
+        stats.edge_len_max  = std::max(stats.edge_len_max, len);
+        stats.edge_len_avg += len;
+        if(len >= 4./5.*l && len <= 4./3.*l) ++in_range;
+    }
+    if(e.empty())
+    {
+        stats.edge_len_min = 0;
+        return;
+    }
+    stats.edge_len_avg  /= e.size();
+    stats.in_range_ratio = double(in_range)/e.size();
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void IsotropicRemesher::edge_split(const uint vid0, const uint vid1)
+{
+    uint t[2];
+    uint n = edge_tris(vid0, vid1, t);
+    assert(n==1 || n==2);
+
+    uint vid = pos.size();
+    pos.push_back(0.5*(pos.at(vid0) + pos.at(vid1)));
+    v2t.push_back(std::vector<uint>());
+    vert_dead.push_back(0);
+    boundary.push_back(n==1);
+    anchored.push_back(n==1);
+    ++nv_alive;
+
+    // each triangle (u,w,c) is replaced by (u,vid,c) and (vid,w,c)
+    for(uint i=0; i<n; ++i)
+    {
+        uint tid = t[i];
+        uint off = 0;
+        while(!((tris.at(3*tid+off)==vid0 && tris.at(3*tid+(off+1)%3)==vid1) ||
+                (tris.at(3*tid+off)==vid1 && tris.at(3*tid+(off+1)%3)==vid0))) ++off;
+        uint w = tris.at(3*tid+(off+1)%3);
+        uint c = tris.at(3*tid+(off+2)%3);
+        tris.at(3*tid+(off+1)%3) = vid;
+
+        uint new_tid = tri_dead.size();
+        int  label   = labels.at(tid);
+        tris.push_back(vid);
+        tris.push_back(w);
+        tris.push_back(c);
+        labels.push_back(label);
+        tri_dead.push_back(0);
+        ++nt_alive;
+
+        std::replace(v2t.at(w).begin(), v2t.at(w).end(), tid, new_tid);
+        v2t.at(c).push_back(new_tid);
+        v2t.at(vid).push_back(tid);
+        v2t.at(vid).push_back(new_tid);
+    }
+
+    if(features.erase(edge_key(vid0,vid1))>0)
+    {
+        features.insert(edge_key(vid0,vid));
+        features.insert(edge_key(vid,vid1));
+        anchored.at(vid) = 1;
+    }
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+bool IsotropicRemesher::edge_collapse(const uint vid0, const uint vid1, const double max_len)
+{
+    // vid0 is removed, vid1 is moved to the edge midpoint
+    if(anchored.at(vid0) || anchored.at(vid1)) return false;
+
+    uint t[2];
+    if(edge_tris(vid0, vid1, t)!=2) return false;
+    uint opp0 = tri_opposite_vert(t[0], vid0, vid1);
+    uint opp1 = tri_opposite_vert(t[1], vid0, vid1);
+    if(opp0==opp1) return false;
+    if(vert_valence(opp0)<=3 || vert_valence(opp1)<=3) return false;
+
+    // link condition: the only verts adjacent to both
+    // endpoints must be the ones opposite to the edge
+    std::vector<uint> nbrs0, nbrs1, shared;
+    vert_neighbors(vid0, nbrs0);
+    vert_neighbors(vid1, nbrs1);
+    std::set_intersection(nbrs0.begin(), nbrs0.end(), nbrs1.begin(), nbrs1.end(), std::back_inserter(shared));
+    if(shared.size()!=2) return false;
+    if(nbrs0.size()+nbrs1.size()-4 < 3) return false;
+
+    // the triangles that survive must neither flip nor get edges longer than max_len
+    vec3d p = 0.5*(pos.at(vid0) + pos.at(vid1));
+    for(uint vid : {vid0, vid1})
+    for(uint tid : v2t.at(vid))
+    {
+        if(tid==t[0] || tid==t[1]) continue;
+        vec3d v[3];
+        for(uint i=0; i<3; ++i)
+        {
+            uint id = tris.at(3*tid+i);
+            if(id==vid0 || id==vid1) v[i] = p;
+            else
+            {
+                v[i] = pos.at(id);
+                if(p.dist(v[i]) > max_len) return false;
+            }
+        }
+        vec3d n_old = tri_normal(tid);
+        vec3d n_new = (v[1]-v[0]).cross(v[2]-v[0]);
+        if(n_old.dot(n_new) <= 0.5 * n_old.length() * n_new.length()) return false;
+    }
+
+    for(uint i=0; i<2; ++i)
+    {
+        tri_dead.at(t[i]) = 1;
+        --nt_alive;
+        for(uint j=0; j<3; ++j) vert_remove_tri(tris.at(3*t[i]+j), t[i]);
+    }
+    for(uint tid : v2t.at(vid0))
+    {
+        std::replace(tris.begin()+3*tid, tris.begin()+3*tid+3, vid0, vid1);
+        v2t.at(vid1).push_back(tid);
+    }
+    v2t.at(vid0).clear();
+    vert_dead.at(vid0) = 1;
+    --nv_alive;
+    pos.at(vid1) = p;
+    return true;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+bool IsotropicRemesher::edge_improves_valence(const uint vid0, const uint vid1) const
+{
+    if(edge_is_feature(vid0, vid1)) return false;
+
+    uint t[2];
+    if(edge_tris(vid0, vid1, t)!=2) return false;
+    uint opp0 = tri_opposite_vert(t[0], vid0, vid1);
+    uint opp1 = tri_opposite_vert(t[1], vid0, vid1);
+    if(opp0==opp1) return false;
+
+    // squared deviation from the ideal valence (6 inside, 4 on the boundary)
+    auto dev = [&](const uint vid, const int delta) -> int
+    {
+        int d = int(vert_valence(vid)) + delta - (boundary[vid] ? 4 : 6);
+        return d*d;
+    };
+    int before = dev(vid0, 0) + dev(vid1, 0) + dev(opp0, 0) + dev(opp1, 0);
+    int after  = dev(vid0,-1) + dev(vid1,-1) + dev(opp0,+1) + dev(opp1,+1);
+    return after < before;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+bool IsotropicRemesher::edge_flip(const uint vid0, const uint vid1)
+{
+    // NOTE: reads and writes only data attached to the edge endpoints,
+    // to the verts opposite to it, and to its two triangles
+    if(!edge_improves_valence(vid0, vid1)) return false;
+    if(vert_valence(vid0)<=3 || vert_valence(vid1)<=3) return false;
+
+    // orient the edge so that t0 = (a,b,c) and t1 = (b,a,d)
+    uint t[2];
+    edge_tris(vid0, vid1, t);
+    uint a = vid0;
+    uint b = vid1;
+    for(uint i=0; i<3; ++i)
+    {
+        if(tris[3*t[0]+i]==b && tris[3*t[0]+(i+1)%3]==a) std::swap(a,b);
+    }
+    uint c = tri_opposite_vert(t[0], a, b);
+    uint d = tri_opposite_vert(t[1], a, b);
+
+    // the new edge must not exist already
+    for(uint tid : v2t[c])
+    {
+        if(tris[3*tid]==d || tris[3*tid+1]==d || tris[3*tid+2]==d) return false;
+    }
+
+    // the new triangles (a,d,c) and (d,b,c) must agree with the old ones
+    vec3d n_old = tri_normal(t[0]) + tri_normal(t[1]);
+    vec3d n0    = (pos[d]-pos[a]).cross(pos[c]-pos[a]);
+    vec3d n1    = (pos[b]-pos[d]).cross(pos[c]-pos[d]);
+    if(n0.dot(n1) <= 0 || n0.dot(n_old) <= 0 || n1.dot(n_old) <= 0) return false;
+
+    tris[3*t[0]  ] = a; tris[3*t[0]+1] = d; tris[3*t[0]+2] = c;
+    tris[3*t[1]  ] = d; tris[3*t[1]+1] = b; tris[3*t[1]+2] = c;
+    vert_remove_tri(a, t[1]);
+    vert_remove_tri(b, t[0]);
+    v2t[c].push_back(t[1]);
+    v2t[d].push_back(t[0]);
+    return true;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+uint64_t IsotropicRemesher::edge_key(const uint vid0, const uint vid1)
+{
+    return (uint64_t(std::min(vid0,vid1)) << 32) | std::max(vid0,vid1);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void IsotropicRemesher::edges(std::vector<ipair> & e) const
+{
+    // interior edges are listed by the triangle that traverses them from the
+    // smaller to the bigger vid. Boundary edges have only one triangle
+    e.clear();
+    e.reserve(nt_alive*3/2 + 1);
+    for(uint tid=0; tid<tri_dead.size(); ++tid)
+    {
+        if(tri_dead[tid]) continue;
+        for(uint i=0; i<3; ++i)
+        {
+            uint vid0 = tris[3*tid+i];
+            uint vid1 = tris[3*tid+(i+1)%3];
+            uint t[2];
+            if(vid0<vid1 || (boundary[vid0] && boundary[vid1] && edge_tris(vid0,vid1,t)==1))
+            {
+                e.push_back(std::make_pair(vid0,vid1));
+            }
+        }
+    }
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+uint IsotropicRemesher::edge_tris(const uint vid0, const uint vid1, uint t[2]) const
+{
+    uint count = 0;
+    for(uint tid : v2t[vid0])
+    {
+        if(tris[3*tid]==vid1 || tris[3*tid+1]==vid1 || tris[3*tid+2]==vid1)
+        {
+            if(count<2) t[count] = tid;
+            ++count;
+        }
+    }
+    return count;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+bool IsotropicRemesher::edge_is_feature(const uint vid0, const uint vid1) const
+{
+    return !features.empty() && features.count(edge_key(vid0,vid1))>0;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+uint IsotropicRemesher::tri_opposite_vert(const uint tid, const uint vid0, const uint vid1) const
+{
+    for(uint i=0; i<3; ++i)
+    {
+        uint vid = tris[3*tid+i];
+        if(vid!=vid0 && vid!=vid1) return vid;
+    }
+    assert(false);
+    return 0;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+vec3d IsotropicRemesher::tri_normal(const uint tid) const
+{
+    const vec3d & p0 = pos[tris[3*tid  ]];
+    const vec3d & p1 = pos[tris[3*tid+1]];
+    const vec3d & p2 = pos[tris[3*tid+2]];
+    return (p1-p0).cross(p2-p0);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+uint IsotropicRemesher::vert_valence(const uint vid) const
+{
+    // manifold verts have as many neighbors as incident triangles (plus one on the boundary)
+    return v2t[vid].size() + (boundary[vid] ? 1 : 0);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void IsotropicRemesher::vert_neighbors(const uint vid, std::vector<uint> & nbrs) const
+{
+    nbrs.clear();
+    for(uint tid : v2t[vid])
+    for(uint i=0; i<3; ++i)
+    {
+        uint nbr = tris[3*tid+i];
+        if(nbr!=vid) nbrs.push_back(nbr);
+    }
+    std::sort(nbrs.begin(), nbrs.end());
+    nbrs.erase(std::unique(nbrs.begin(), nbrs.end()), nbrs.end());
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void IsotropicRemesher::vert_remove_tri(const uint vid, const uint tid)
+{
+    std::vector<uint> & list = v2t[vid];
+    auto it = std::find(list.begin(), list.end(), tid);
+    assert(it!=list.end());
+    *it = list.back();
+    list.pop_back();
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class M, class V, class E, class P>
+CINO_INLINE
+std::vector<RemeshIterationStats> remesh_isotropic(Trimesh<M,V,E,P>    & m,
+                                                   const RemeshOptions & opt)
+{
+    CINO_PROFILE_ZONE("remesh_isotropic");
+
+    std::vector<uint> tris;
+    std::vector<int>  labels(m.num_polys());
+    tris.reserve(3*m.num_polys());
+    for(uint pid=0; pid<m.num_polys(); ++pid)
+    {
+        for(uint vid : m.adj_p2v_span(pid)) tris.push_back(vid);
+        labels.at(pid) = m.poly_data(pid).label;
+    }
+
+    std::vector<ipair> features;
+    for(uint eid=0; eid<m.num_edges(); ++eid)
+    {
+        if(m.edge_data(eid).flags[MARKED]) features.push_back(std::make_pair(m.edge_vert_id(eid,0), m.edge_vert_id(eid,1)));
+    }
+
+    IsotropicRemesher remesher;
+    remesher.init(m.vector_verts(), tris, features, labels);
+    std::vector<RemeshIterationStats> stats = remesher.remesh(opt);
+
+    std::vector<vec3d> verts;
+    remesher.export_mesh(verts, tris, features, labels);
+
+    M data = m.mesh_data();
+    m.clear();
+    m.init(verts, polys_from_serialized_vids(tris,3));
+    m.mesh_data() = data;
+
+    if(labels.size()==m.num_polys())
+    {
+        for(uint pid=0; pid<m.num_polys(); ++pid) m.poly_data(pid).label = labels.at(pid);
+    }
+    for(const ipair & e : features)
+    {
+        int eid = m.edge_id(e.first, e.second);
+        if(eid>=0) m.edge_data(eid).flags[MARKED] = true;
+    }
+    return stats;
+}
+
+}
@@ -0,0 +1,195 @@
+/********************************************************************************
+*  This file is part of CinoLib                                                 *
+*  Copyright(C) 2016: Marco Livesu                                              *
+*                                                                               *
+*  The MIT License                                                              *
+*                                                                               *
+*  Permission is hereby granted, free of charge, to any person obtaining a      *
+*  copy of this software and associated documentation files (the "Software"),   *
+*  to deal in the Software without restriction, including without limitation    *
+*  the rights to use, copy, modify, merge, publish, distribute, sublicense,     *
+*  and/or sell copies of the Software, and to permit persons to whom the        *
+*  Software is furnished to do so, subject to the following conditions:         *
+*                                                                               *
+*  The above copyright notice and this permission notice shall be included in   *
+*  all copies or substantial portions of the Software.                          *
+*                                                                               *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR   *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,     *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. IN NO EVENT SHALL THE *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER       *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      *
+*  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS *
+*  IN THE SOFTWARE.                                                             *
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Marco Livesu (marco.livesu@gmail.com)                                     *
+*     http://pers.ge.imati.cnr.it/livesu/                                       *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*********************************************************************************/
+#ifndef CINO_REMESH_ISOTROPIC_H
+#define CINO_REMESH_ISOTROPIC_H
+
+#include <cinolib/cino_inline.h>
+#include <cinolib/meshes/trimesh.h>
+#include <cinolib/ipair.h>
+#include <unordered_set>
+#include <iostream>
+#include <vector>
+#include <stdint.h>
+
+namespace cinolib
+{
+
+/* Headless isotropic remesher for triangle meshes, based on:
+ *
+ * A Remeshing Approach to Multiresolution Modeling
+ * M.Botsch, L.Kobbelt
+ * Symposium on Geomtry Processing, 2004
+ *
+ * Each iteration splits edges longer than 4/3 of the target length (longest
+ * first), collapses edges shorter than 4/5 of the target length (shortest
+ * first), flips edges to drive vertex valences towards 6 (4 on the boundary)
+ * and relocates vertices with area weighted tangential smoothing. Iterations
+ * continue until the mesh stops changing or a maximum number is reached.
+ *
+ * With respect to remesh_Botsch_Kobbelt_2004 (which performs a single
+ * iteration on a DrawableTrimesh), this engine works on its own lean copy
+ * of the mesh connectivity: removed elements are only flagged as deleted
+ * (no per operation id swaps) and the mesh is compacted once at the end.
+ * Edge flips and smoothing run in parallel on the global thread pool, one
+ * independent set at a time (edges that share no vertex, vertices that share
+ * no edge), using a greedy graph coloring. Boundary vertices, and vertices
+ * incident to marked edges if features are preserved, never move.
+ *
+ * NOTE: per element attributes other than poly labels and marked edges are
+ * not transferred to the output mesh
+*/
+
+typedef struct
+{
+    double target_edge_length       = -1;   // if <= 0, the average edge length of the input is used
+    uint   max_iterations           = 10;
+    double convergence_threshold    = 0.01; // stop as soon as an iteration edits less than this fraction of the edges
+    uint   smoothing_steps          = 1;    // tangential smoothing steps per iteration
+    bool   preserve_marked_features = true; // marked edges are never collapsed or flipped, and their verts never move
+}
+RemeshOptions;
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+typedef struct
+{
+    uint   num_splits     = 0;
+    uint   num_collapses  = 0;
+    uint   num_flips      = 0;
+    uint   num_verts      = 0;
+    uint   num_edges      = 0;
+    uint   num_polys      = 0;
+    double edge_len_min   = 0;
+    double edge_len_max   = 0;
+    double edge_len_avg   = 0;
+    double in_range_ratio = 0; // fraction of edges with length in [4/5,4/3] of the target length
+    double secs           = 0;
+}
+RemeshIterationStats;
+
+CINO_INLINE
+std::ostream & operator<<(std::ostream & in, const RemeshIterationStats & stats);
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+class IsotropicRemesher
+{
+    public:
+
+        explicit IsotropicRemesher() {}
+
+        void init(const std::vector<vec3d> & verts,
+                  const std::vector<uint>  & tris,
+                  const std::vector<ipair> & feature_edges = std::vector<ipair>(),  // treated as sharp creases
+                  const std::vector<int>   & tri_labels    = std::vector<int>());
+
+        std::vector<RemeshIterationStats> remesh (const RemeshOptions & opt);
+        RemeshIterationStats              iterate(const double target_edge_length, const uint smoothing_steps = 1);
+
+        // removes deleted elements and renumbers the surviving ones (preserving their order)
+        void compact();
+
+        // mesh in its current state (compacted)
+        void export_mesh(std::vector<vec3d> & verts,
+                         std::vector<uint>  & tris,
+                         std::vector<ipair> & feature_edges,
+                         std::vector<int>   & tri_labels);
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        uint   num_verts() const { return nv_alive; }
+        uint   num_polys() const { return nt_alive; }
+        double edge_avg_length() const;
+
+    private:
+
+        uint split_long_edges   (const double max_len);
+        uint collapse_short_edges(const double min_len, const double max_len);
+        uint flip_edges         ();
+        void smooth             ();
+        void edge_stats         (const double l, RemeshIterationStats & stats) const;
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        void edge_split    (const uint vid0, const uint vid1);
+        bool edge_collapse (const uint vid0, const uint vid1, const double max_len);
+        bool edge_flip     (const uint vid0, const uint vid1);
+        bool edge_improves_valence(const uint vid0, const uint vid1) const;
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        static uint64_t edge_key(const uint vid0, const uint vid1);
+
+        void  edges(std::vector<ipair> & e) const; // each alive edge, once
+        uint  edge_tris(const uint vid0, const uint vid1, uint t[2]) const;
+        bool  edge_is_feature(const uint vid0, const uint vid1) const;
+        uint  tri_opposite_vert(const uint tid, const uint vid0, const uint vid1) const;
+        vec3d tri_normal(const uint tid) const; // not normalized (length is twice the area)
+        uint  vert_valence(const uint vid) const;
+        void  vert_neighbors(const uint vid, std::vector<uint> & nbrs) const;
+        void  vert_remove_tri(const uint vid, const uint tid);
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        std::vector<vec3d>             pos;
+        std::vector<uint>              tris;       // three vids per triangle
+        std::vector<int>               labels;     // one per triangle
+        std::vector<std::vector<uint>> v2t;        // vert to triangle adjacency
+        std::vector<uint8_t>           vert_dead;
+        std::vector<uint8_t>           tri_dead;
+        std::vector<uint8_t>           boundary;   // vert on the boundary
+        std::vector<uint8_t>           anchored;   // vert on the boundary or on a feature line (never moved nor removed)
+        std::unordered_set<uint64_t>   features;   // feature edges (see edge_key)
+        uint                           nv_alive = 0;
+        uint                           nt_alive = 0;
+};
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// convenience wrapper: remeshes m in place, returning statistics for each iteration.
+// If the mesh is drawable, call updateGL() afterwards to refresh its rendering
+template<class M, class V, class E, class P>
+CINO_INLINE
+std::vector<RemeshIterationStats> remesh_isotropic(Trimesh<M,V,E,P>    & m,
+                                                   const RemeshOptions & opt = RemeshOptions());
+
+}
+
+#ifndef  CINO_STATIC_LIB
+#include "remesh_isotropic.cpp"
+#endif
+
+#endif // CINO_REMESH_ISOTROPIC_H
@@ -52,6 +52,25 @@ template<class M, class V, class E, class P>
 CINO_INLINE
 void shortest_path_tree(AbstractPolygonMesh<M,V,E,P> & m, const uint root, std::vector<bool> & tree);
 
+// also returns the distance of each vertex from the root and its parent along the tree (-1 for
+// the root). The shortest path from any vertex to the root is obtained by following its parents
+template<class M, class V, class E, class P>
+CINO_INLINE
+void shortest_path_tree(const AbstractPolygonMesh<M,V,E,P> & m,
+                        const uint                           root,
+                              std::vector<bool>            & tree,
+                              std::vector<double>          & dist,
+                              std::vector<int>             & parent);
+
+// builds the tree from precomputed distances from the root (e.g. from dijkstra_exhaustive)
+template<class M, class V, class E, class P>
+CINO_INLINE
+void shortest_path_tree_from_dist(const AbstractPolygonMesh<M,V,E,P> & m,
+                                  const uint                           root,
+                                  const std::vector<double>          & dist,
+                                        std::vector<bool>            & tree,
+                                        std::vector<int>             & parent);
+
 }
 
 #ifndef  CINO_STATIC_LIB
@@ -257,6 +257,9 @@ void mesh_smoother(      AbstractPolygonMesh<M1,V1,E1,P1> & m,
 
     label_features(m);
 
+    // the system changes only if the feature lines do: the symbolic analysis is redone only in that case
+    LinearSolver solver;
+
     for(uint i=0; i<opt.n_iters; ++i)
     {
         //std::cout << "smooth iter #" << i << std::endl;
@@ -290,7 +293,7 @@ void mesh_smoother(      AbstractPolygonMesh<M1,V1,E1,P1> & m,
         Eigen::VectorXd RHS = Eigen::Map<Eigen::VectorXd>(rhs.data(), rhs.size());
         Eigen::VectorXd W   = Eigen::Map<Eigen::VectorXd>(w.data(), w.size());
         Eigen::VectorXd res;
-        solve_weighted_least_squares(A, W, RHS, res);
+        solve_weighted_least_squares(A, W, RHS, res, solver);
 
         uint nv = m.num_verts();
         for(uint vid=0; vid<nv; ++vid)
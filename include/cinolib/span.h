@@ -0,0 +1,110 @@
+/********************************************************************************
+*  This file is part of CinoLib                                                 *
+*  Copyright(C) 2016: Marco Livesu                                              *
+*                                                                               *
+*  The MIT License                                                              *
+*                                                                               *
+*  Permission is hereby granted, free of charge, to any person obtaining a      *
+*  copy of this software and associated documentation files (the "Software"),   *
+*  to deal in the Software without restriction, including without limitation    *
+*  the rights to use, copy, modify, merge, publish, distribute, sublicense,     *
+*  and/or sell copies of the Software, and to permit persons to whom the        *
+*  Software is furnished to do so, subject to the following conditions:         *
+*                                                                               *
+*  The above copyright notice and this permission notice shall be included in   *
+*  all copies or substantial portions of the Software.                          *
+*                                                                               *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR   *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,     *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. IN NO EVENT SHALL THE *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER       *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      *
+*  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS *
+*  IN THE SOFTWARE.                                                             *
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Marco Livesu (marco.livesu@gmail.com)                                     *
+*     http://pers.ge.imati.cnr.it/livesu/                                       *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*********************************************************************************/
+#ifndef CINO_SPAN_H
+#define CINO_SPAN_H
+
+#include <cinolib/cino_inline.h>
+#include <sys/types.h>
+#include <vector>
+#include <stdexcept>
+#include <assert.h>
+
+namespace cinolib
+{
+
+/* Read-only view over a contiguous range of elements (either a row
+ * of a compressed adjacency table or a plain std::vector). It does not
+ * own the memory it points to, therefore it becomes invalid as soon as
+ * the underlying container is modified or released.
+ *
+ * It can be used in range-based for loops, and provides the (const)
+ * subset of the std::vector interface that is commonly used to traverse
+ * mesh adjacencies (size, empty, at, front, back, operator[]). As for
+ * std::vector, at() is bounds checked (and throws std::out_of_range)
+ * while operator[] is not.
+*/
+
+template<typename T>
+class Span
+{
+    public:
+
+        explicit Span() : m_begin(nullptr), m_end(nullptr) {}
+
+        explicit Span(const T * begin, const T * end) : m_begin(begin), m_end(end)
+        {
+            assert(m_begin <= m_end);
+        }
+
+        Span(const std::vector<T> & vec) : m_begin(vec.data()), m_end(vec.data() + vec.size()) {}
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        const T * begin() const { return m_begin; }
+        const T * end()   const { return m_end;   }
+        const T * data()  const { return m_begin; }
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        uint size()  const { return static_cast<uint>(m_end - m_begin); }
+        bool empty() const { return m_begin == m_end; }
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        const T & at(const uint i) const
+        {
+            if(i >= size()) throw std::out_of_range("Span::at() : index out of range");
+            return m_begin[i];
+        }
+
+        const T & operator[](const uint i) const { return m_begin[i]; }
+        const T & front     ()             const { assert(!empty());   return *m_begin;   }
+        const T & back      ()             const { assert(!empty());   return *(m_end-1); }
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        std::vector<T> to_vector() const { return std::vector<T>(m_begin, m_end); }
+        operator std::vector<T>() const  { return to_vector(); }
+
+    private:
+
+        const T * m_begin;
+        const T * m_end;
+};
+
+}
+
+#endif // CINO_SPAN_H
@@ -0,0 +1,141 @@
+/********************************************************************************
+*  This file is part of CinoLib                                                 *
+*  Copyright(C) 2016: Marco Livesu                                              *
+*                                                                               *
+*  The MIT License                                                              *
+*                                                                               *
+*  Permission is hereby granted, free of charge, to any person obtaining a      *
+*  copy of this software and associated documentation files (the "Software"),   *
+*  to deal in the Software without restriction, including without limitation    *
+*  the rights to use, copy, modify, merge, publish, distribute, sublicense,     *
+*  and/or sell copies of the Software, and to permit persons to whom the        *
+*  Software is furnished to do so, subject to the following conditions:         *
+*                                                                               *
+*  The above copyright notice and this permission notice shall be included in   *
+*  all copies or substantial portions of the Software.                          *
+*                                                                               *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR   *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,     *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. IN NO EVENT SHALL THE *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER       *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      *
+*  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS *
+*  IN THE SOFTWARE.                                                             *
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Marco Livesu (marco.livesu@gmail.com)                                     *
+*     http://pers.ge.imati.cnr.it/livesu/                                       *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*********************************************************************************/
+#include <cinolib/sparse_assembler.h>
+#include <cinolib/thread_pool.h>
+#include <algorithm>
+#include <limits>
+
+namespace cinolib
+{
+
+CINO_INLINE
+void SparseAssembler::clear()
+{
+    A = Eigen::SparseMatrix<double>();
+    pattern.clear();
+    std::vector<uint>().swap(slots);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void SparseAssembler::init(const uint n_cols, const AdjacencyCSR & rows)
+{
+    clear();
+
+    // sort and deduplicate the columns of each row
+    uint n_rows = rows.num_rows();
+    pattern.offsets.resize(n_rows+1);
+    pattern.offsets.front() = 0;
+    pattern.entries.reserve(rows.num_entries());
+    for(uint r=0; r<n_rows; ++r)
+    {
+        auto beg = pattern.entries.end() - pattern.entries.begin();
+        for(uint c : rows.row(r))
+        {
+            assert(c < n_cols);
+            pattern.entries.push_back(c);
+        }
+        std::sort(pattern.entries.begin()+beg, pattern.entries.end());
+        pattern.entries.erase(std::unique(pattern.entries.begin()+beg, pattern.entries.end()), pattern.entries.end());
+        pattern.offsets.at(r+1) = pattern.entries.size();
+    }
+    pattern.entries.shrink_to_fit();
+
+    // build the compressed column major structure. Rows are scanned in
+    // ascending order, hence inner indices come out sorted in each column
+    uint nnz = pattern.num_entries();
+    assert(nnz <= (uint)std::numeric_limits<int>::max());
+    A.resize(n_rows, n_cols);
+    A.resizeNonZeros(nnz);
+
+    auto * outer = A.outerIndexPtr();
+    auto * inner = A.innerIndexPtr();
+    std::fill(outer, outer+n_cols+1, 0);
+    for(uint c : pattern.entries) ++outer[c+1];
+    for(uint c=0; c<n_cols; ++c) outer[c+1] += outer[c];
+
+    std::vector<uint> next(outer, outer+n_cols);
+    slots.resize(nnz);
+    for(uint r=0; r<n_rows; ++r)
+    {
+        for(uint i=pattern.offsets[r]; i<pattern.offsets[r+1]; ++i)
+        {
+            uint pos = next[pattern.entries[i]]++;
+            inner[pos] = r;
+            slots[i]   = pos;
+        }
+    }
+
+    set_zero();
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void SparseAssembler::set_zero()
+{
+    double * v = values();
+    parallel_for_ranges(0, num_nonzeros(), [v](const uint b, const uint e, const uint)
+    {
+        std::fill(v+b, v+e, 0.0);
+    }, 1<<16);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+int SparseAssembler::find(const uint row, const uint col) const
+{
+    assert(row < num_rows());
+    auto beg = pattern.entries.begin() + pattern.offsets[row];
+    auto end = pattern.entries.begin() + pattern.offsets[row+1];
+    auto it  = std::lower_bound(beg, end, col);
+    if(it==end || *it!=col) return -1;
+    return slots[it - pattern.entries.begin()];
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+double & SparseAssembler::at(const uint row, const uint col)
+{
+    int pos = find(row, col);
+    assert(pos>=0 && "Entry not in the sparsity pattern!");
+    return values()[pos];
+}
+
+}
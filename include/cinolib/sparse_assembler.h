@@ -0,0 +1,105 @@
+/********************************************************************************
+*  This file is part of CinoLib                                                 *
+*  Copyright(C) 2016: Marco Livesu                                              *
+*                                                                               *
+*  The MIT License                                                              *
+*                                                                               *
+*  Permission is hereby granted, free of charge, to any person obtaining a      *
+*  copy of this software and associated documentation files (the "Software"),   *
+*  to deal in the Software without restriction, including without limitation    *
+*  the rights to use, copy, modify, merge, publish, distribute, sublicense,     *
+*  and/or sell copies of the Software, and to permit persons to whom the        *
+*  Software is furnished to do so, subject to the following conditions:         *
+*                                                                               *
+*  The above copyright notice and this permission notice shall be included in   *
+*  all copies or substantial portions of the Software.                          *
+*                                                                               *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR   *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,     *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. IN NO EVENT SHALL THE *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER       *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      *
+*  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS *
+*  IN THE SOFTWARE.                                                             *
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Marco Livesu (marco.livesu@gmail.com)                                     *
+*     http://pers.ge.imati.cnr.it/livesu/                                       *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*********************************************************************************/
+#ifndef CINO_SPARSE_ASSEMBLER_H
+#define CINO_SPARSE_ASSEMBLER_H
+
+#include <cinolib/cino_inline.h>
+#include <cinolib/meshes/adjacency_csr.h>
+#include <Eigen/Sparse>
+
+namespace cinolib
+{
+
+/* Assembles an Eigen::SparseMatrix<double> whose sparsity pattern is known
+ * in advance and does not change over time, as it happens for differential
+ * operators (Laplacian, mass, gradient...) on meshes with fixed connectivity.
+ *
+ * init() builds the compressed structure of the matrix once, directly from
+ * the lists of non zero columns of each row (duplicates are allowed and will
+ * be merged). After that, values can be refilled as many times as needed by
+ * writing in the value array of the matrix, with no sorting, no triplets and
+ * no allocations. Since each row owns its own slots, distinct rows can safely
+ * be filled by distinct threads.
+ *
+ * The assembled matrix is a regular (column major, compressed) Eigen sparse
+ * matrix, hence it can be passed as is to Eigen solvers and expressions.
+*/
+
+class SparseAssembler
+{
+    public:
+
+        explicit SparseAssembler() {}
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        void clear();
+        void init(const uint n_cols, const AdjacencyCSR & rows);
+        void set_zero();
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        uint num_rows()     const { return pattern.num_rows(); }
+        uint num_cols()     const { return A.cols(); }
+        uint num_nonzeros() const { return pattern.num_entries(); }
+        bool is_empty()     const { return pattern.num_rows()==0; }
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        Span<uint> row_cols(const uint row) const { return pattern.row(row); } // sorted
+        int        find    (const uint row, const uint col) const;             // index in values(), -1 if not in the pattern
+        double   & at      (const uint row, const uint col);                   // asserts if (row,col) is not in the pattern
+        double   & at_slot (const uint row, const uint k) { return values()[slots[pattern.offsets[row]+k]]; } // k-th entry of row_cols(row)
+        double   * values  ()       { return A.valuePtr(); }
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        const Eigen::SparseMatrix<double> & matrix() const { return A; }
+
+    private:
+
+        Eigen::SparseMatrix<double> A;       // compressed, column major
+        AdjacencyCSR                pattern; // sorted non zero columns of each row
+        std::vector<uint>           slots;   // position in A.valuePtr() of each entry of pattern
+};
+
+}
+
+#ifndef  CINO_STATIC_LIB
+#include "sparse_assembler.cpp"
+#endif
+
+#endif // CINO_SPARSE_ASSEMBLER_H
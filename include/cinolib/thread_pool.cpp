@@ -0,0 +1,247 @@
+/********************************************************************************
+*  This file is part of CinoLib                                                 *
+*  Copyright(C) 2016: Marco Livesu                                              *
+*                                                                               *
+*  The MIT License                                                              *
+*                                                                               *
+*  Permission is hereby granted, free of charge, to any person obtaining a      *
+*  copy of this software and associated documentation files (the "Software"),   *
+*  to deal in the Software without restriction, including without limitation    *
+*  the rights to use, copy, modify, merge, publish, distribute, sublicense,     *
+*  and/or sell copies of the Software, and to permit persons to whom the        *
+*  Software is furnished to do so, subject to the following conditions:         *
+*                                                                               *
+*  The above copyright notice and this permission notice shall be included in   *
+*  all copies or substantial portions of the Software.                          *
+*                                                                               *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR   *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,     *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. IN NO EVENT SHALL THE *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER       *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      *
+*  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS *
+*  IN THE SOFTWARE.                                                             *
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Marco Livesu (marco.livesu@gmail.com)                                     *
+*     http://pers.ge.imati.cnr.it/livesu/                                       *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*********************************************************************************/
+#include <cinolib/thread_pool.h>
+#include <iostream>
+#include <memory>
+
+namespace cinolib
+{
+
+// number of pool tasks the calling thread is currently executing (nested ones included)
+CINO_INLINE
+uint & thread_pool_nesting_depth()
+{
+    static thread_local uint depth = 0;
+    return depth;
+}
+
+// increments the nesting depth for the lifetime of the object (exceptions included)
+struct ThreadPoolNestingScope
+{
+    ThreadPoolNestingScope()  { ++thread_pool_nesting_depth(); }
+   ~ThreadPoolNestingScope()  { --thread_pool_nesting_depth(); }
+};
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+ThreadPool::ThreadPool(const uint n_threads) : busy(false), next_chunk(0)
+{
+    for(uint tid=1; tid<std::max(n_threads,1u); ++tid)
+    {
+        workers.push_back(std::thread(&ThreadPool::worker_loop, this, tid));
+    }
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m);
+        quit = true;
+    }
+    cv_start.notify_all();
+    for(auto & w : workers) w.join();
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void ThreadPool::run(const uint n_chunks, const std::function<void(uint,uint)> & task)
+{
+    // sequential execution if there are no workers, if the call is nested (i.e.
+    // issued from a task running on some pool), or if the pool is already busy
+    // with a call from another thread
+    bool idle = false;
+    if(workers.empty() || n_chunks<2 || thread_pool_nesting_depth()>0 || !busy.compare_exchange_strong(idle, true))
+    {
+        ThreadPoolNestingScope scope;
+        for(uint i=0; i<n_chunks; ++i) task(i,0);
+        return;
+    }
+
+    // releases the pool on exit, whatever happens
+    struct BusyGuard
+    {
+        std::atomic<bool> & busy;
+       ~BusyGuard() { busy = false; }
+    }
+    guard{busy};
+
+    {
+        std::lock_guard<std::mutex> lock(m);
+        this->task     = &task;
+        this->n_chunks = n_chunks;
+        next_chunk     = 0;
+        n_running      = workers.size();
+        error          = nullptr;
+        ++generation;
+    }
+    cv_start.notify_all();
+
+    // does not throw: exceptions are stored in error. The task must stay
+    // alive until all workers are done, hence they are rethrown only then
+    process_chunks(0);
+
+    std::exception_ptr e;
+    {
+        std::unique_lock<std::mutex> lock(m);
+        cv_done.wait(lock, [this]{ return n_running==0; });
+        this->task = nullptr;
+        std::swap(e, error);
+    }
+    if(e) std::rethrow_exception(e);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void ThreadPool::process_chunks(const uint thread_id)
+{
+    ThreadPoolNestingScope scope;
+    try
+    {
+        for(uint i=next_chunk++; i<n_chunks; i=next_chunk++)
+        {
+            (*task)(i,thread_id);
+        }
+    }
+    catch(...)
+    {
+        // keep the first exception, and stop handing out chunks
+        std::lock_guard<std::mutex> lock(m);
+        if(!error) error = std::current_exception();
+        next_chunk = n_chunks;
+    }
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void ThreadPool::worker_loop(const uint thread_id)
+{
+    uint last_generation = 0;
+    for(;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m);
+            cv_start.wait(lock, [&]{ return quit || generation!=last_generation; });
+            if(quit) return;
+            last_generation = generation;
+        }
+
+        process_chunks(thread_id);
+
+        bool last = false;
+        {
+            std::lock_guard<std::mutex> lock(m);
+            last = (--n_running==0);
+        }
+        if(last) cv_done.notify_one();
+    }
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// the pool is created lazily, and replaced by set_num_threads()
+CINO_INLINE
+std::unique_ptr<ThreadPool> & global_thread_pool_ptr()
+{
+    static std::unique_ptr<ThreadPool> pool(new ThreadPool(1));
+    return pool;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void set_num_threads(const uint n)
+{
+    uint nt = (n>0) ? n : std::max(std::thread::hardware_concurrency(), 1u);
+    if(nt == get_num_threads()) return;
+    if(thread_pool_nesting_depth()>0 || global_thread_pool().is_busy())
+    {
+        std::cerr << "ERROR : " << __FILE__ << ", line " << __LINE__ << " : set_num_threads() : the thread pool is busy, cannot resize it while it runs" << std::endl;
+        return;
+    }
+    global_thread_pool_ptr().reset(new ThreadPool(nt));
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+uint get_num_threads()
+{
+    return global_thread_pool_ptr()->num_threads();
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+ThreadPool & global_thread_pool()
+{
+    return *global_thread_pool_ptr();
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void parallel_for_ranges(const uint beg,
+                         const uint end,
+                         const std::function<void(uint,uint,uint)> & func,
+                         const uint min_range)
+{
+    if(end<=beg) return;
+    uint n  = end-beg;
+    uint nt = get_num_threads();
+    if(nt<2 || n<=min_range)
+    {
+        func(beg, end, 0);
+        return;
+    }
+
+    // a few ranges per thread help balancing the load
+    uint n_ranges = std::min(4*nt, (n+min_range-1)/min_range);
+    global_thread_pool().run(n_ranges, [&](const uint i, const uint thread_id)
+    {
+        uint b = beg + uint(uint64_t(n)*i    /n_ranges);
+        uint e = beg + uint(uint64_t(n)*(i+1)/n_ranges);
+        func(b, e, thread_id);
+    });
+}
+
+}
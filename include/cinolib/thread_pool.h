@@ -0,0 +1,206 @@
+/********************************************************************************
+*  This file is part of CinoLib                                                 *
+*  Copyright(C) 2016: Marco Livesu                                              *
+*                                                                               *
+*  The MIT License                                                              *
+*                                                                               *
+*  Permission is hereby granted, free of charge, to any person obtaining a      *
+*  copy of this software and associated documentation files (the "Software"),   *
+*  to deal in the Software without restriction, including without limitation    *
+*  the rights to use, copy, modify, merge, publish, distribute, sublicense,     *
+*  and/or sell copies of the Software, and to permit persons to whom the        *
+*  Software is furnished to do so, subject to the following conditions:         *
+*                                                                               *
+*  The above copyright notice and this permission notice shall be included in   *
+*  all copies or substantial portions of the Software.                          *
+*                                                                               *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR   *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,     *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. IN NO EVENT SHALL THE *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER       *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      *
+*  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS *
+*  IN THE SOFTWARE.                                                             *
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Marco Livesu (marco.livesu@gmail.com)                                     *
+*     http://pers.ge.imati.cnr.it/livesu/                                       *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*********************************************************************************/
+#ifndef CINO_THREAD_POOL_H
+#define CINO_THREAD_POOL_H
+
+#include <cinolib/cino_inline.h>
+#include <sys/types.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace cinolib
+{
+
+/* Minimal pool of worker threads (std::thread only, no external dependencies)
+ * used to run per-element loops (e.g. normals, tessellations, adjacency
+ * tables, spatial queries) in parallel.
+ *
+ * Multi-threading is OPT-IN: the library runs sequentially unless the
+ * number of threads is explicitly raised with set_num_threads(), e.g.
+ *
+ *     cinolib::set_num_threads(0);  // use all the available hardware threads
+ *     cinolib::set_num_threads(16); // use 16 threads
+ *     cinolib::set_num_threads(1);  // back to sequential execution (default)
+ *
+ * The thread that calls run() participates to the work, so a pool of n threads
+ * only spawns n-1 workers. Calls to run() issued while the pool is busy (e.g.
+ * nested parallel loops, or concurrent calls from other threads) do not wait:
+ * they are simply executed sequentially by the calling thread.
+ *
+ * If a task throws, the remaining chunks are skipped and, once all the threads
+ * are done, the first exception is rethrown to the caller of run().
+ *
+ * set_num_threads() replaces the global pool, hence it must not be called while
+ * other threads are running parallel algorithms (calls issued while the pool is
+ * busy, or from inside a task, are refused with an error message).
+*/
+
+class ThreadPool
+{
+    public:
+
+        explicit ThreadPool(const uint n_threads = 1);
+                ~ThreadPool();
+
+        ThreadPool(const ThreadPool &) = delete;
+        ThreadPool & operator=(const ThreadPool &) = delete;
+
+        uint num_threads() const { return workers.size()+1; }
+        bool is_busy()     const { return busy; }
+
+        // executes task(chunk,thread_id) for each chunk in [0,n_chunks). Chunks are
+        // dynamically assigned to threads. Thread ids range in [0,num_threads()) and
+        // are unique within a call, hence they can be used to index per-thread data
+        void run(const uint n_chunks, const std::function<void(uint,uint)> & task);
+
+    private:
+
+        void worker_loop(const uint thread_id);
+        void process_chunks(const uint thread_id);
+
+        std::vector<std::thread>            workers;
+        std::atomic<bool>                   busy;     // true for the whole duration of a parallel run()
+        std::mutex                          m;
+        std::condition_variable             cv_start;
+        std::condition_variable             cv_done;
+        const std::function<void(uint,uint)> * task = nullptr;
+        uint                                n_chunks = 0;
+        std::atomic<uint>                   next_chunk;
+        uint                                n_running = 0;
+        uint                                generation = 0;
+        std::exception_ptr                  error;    // first exception thrown by a task
+        bool                                quit = false;
+};
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// sets the number of threads used by the library (0 = all hardware threads)
+CINO_INLINE
+void set_num_threads(const uint n);
+
+CINO_INLINE
+uint get_num_threads();
+
+// the pool shared by all the parallel algorithms of the library
+CINO_INLINE
+ThreadPool & global_thread_pool();
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// Splits [beg,end) into contiguous ranges of at least min_range elements and
+// executes func(range_beg, range_end, thread_id) for each of them. Ranges are
+// processed in parallel by the global pool if it has more than one thread,
+// sequentially otherwise
+
+CINO_INLINE
+void parallel_for_ranges(const uint beg,
+                         const uint end,
+                         const std::function<void(uint,uint,uint)> & func,
+                         const uint min_range = 1024);
+
+// executes func(i) for each i in [beg,end). Iterations must be independent
+
+template<class Func>
+CINO_INLINE
+void parallel_for(const uint beg, const uint end, const Func & func, const uint min_range = 1024)
+{
+    if(get_num_threads()<2 || end-beg<=min_range)
+    {
+        for(uint i=beg; i<end; ++i) func(i);
+        return;
+    }
+    parallel_for_ranges(beg, end, [&func](const uint b, const uint e, const uint)
+    {
+        for(uint i=b; i<e; ++i) func(i);
+    }, min_range);
+}
+
+// sorts [beg,end) by sorting contiguous blocks in parallel and merging them pairwise.
+// Equivalent to std::sort (same result for any strict weak ordering without ties)
+
+template<class Iterator, class Compare>
+CINO_INLINE
+void parallel_sort(Iterator beg, Iterator end, const Compare & comp, const uint min_range = 1<<16)
+{
+    uint n  = std::distance(beg,end);
+    uint nt = get_num_threads();
+    if(nt<2 || n<=min_range)
+    {
+        std::sort(beg, end, comp);
+        return;
+    }
+    uint n_blocks = std::min(nt, (n+min_range-1)/min_range);
+    std::vector<uint> split(n_blocks+1);
+    for(uint i=0; i<=n_blocks; ++i) split[i] = uint(uint64_t(n)*i/n_blocks);
+
+    global_thread_pool().run(n_blocks, [&](const uint b, const uint)
+    {
+        std::sort(beg+split[b], beg+split[b+1], comp);
+    });
+
+    for(uint width=1; width<n_blocks; width*=2)
+    {
+        uint n_merges = (n_blocks+2*width-1)/(2*width);
+        global_thread_pool().run(n_merges, [&](const uint i, const uint)
+        {
+            uint b0 = 2*width*i;
+            uint b1 = std::min(b0+width,   n_blocks);
+            uint b2 = std::min(b0+2*width, n_blocks);
+            if(b1<b2) std::inplace_merge(beg+split[b0], beg+split[b1], beg+split[b2], comp);
+        });
+    }
+}
+
+template<class Iterator>
+CINO_INLINE
+void parallel_sort(Iterator beg, Iterator end)
+{
+    parallel_sort(beg, end, std::less<typename std::iterator_traits<Iterator>::value_type>());
+}
+
+}
+
+#ifndef  CINO_STATIC_LIB
+#include "thread_pool.cpp"
+#endif
+
+#endif // CINO_THREAD_POOL_H
@@ -34,8 +34,6 @@
 *     Italy                                                                     *
 *********************************************************************************/
 #include <cinolib/to_openGL_unified_verts.h>
-#include <map>
-#include <tuple>
 
 namespace cinolib
 {
@@ -58,8 +56,11 @@ void to_openGL_unified_verts(const std::vector<vec3d>             & v_attr_0,
     unified_v2v.clear();
     unified_v2v.reserve(v2v_v_attr_0.size());
 
-    typedef std::pair<uint,uint> v_vt_pair;
-    std::map<v_vt_pair,uint> v_map;
+    // unified verts generated by each v are chained in a list (in practice only
+    // a few per v, along seams), which is faster than any map/hash lookup
+    const uint none = ~0u;
+    std::vector<uint> head(v_attr_0.size(), none);
+    std::vector<uint> next, key_vt;
 
     for(uint pid=0; pid<v2v_v_attr_0.size(); ++pid)
     {
@@ -69,21 +70,19 @@ void to_openGL_unified_verts(const std::vector<vec3d>             & v_attr_0,
         {
             uint v  = v2v_v_attr_0.at(pid).at(off);
             uint vt = v2v_v_attr_1.at(pid).at(off);
-            v_vt_pair key = std::make_pair(v,vt);
 
-            auto query = v_map.find(key);
-            if (query == v_map.end())
+            uint id = head.at(v);
+            while(id!=none && key_vt[id]!=vt) id = next[id];
+            if(id==none)
             {
-                uint fresh_id = unified_v_attr_0.size();
-                v_map[key] = fresh_id;
+                id = unified_v_attr_0.size();
+                next.push_back(head.at(v));
+                key_vt.push_back(vt);
+                head.at(v) = id;
                 unified_v_attr_0.push_back(v_attr_0.at(v));
                 unified_v_attr_1.push_back(v_attr_1.at(vt));
-                poly.push_back(fresh_id);
-            }
-            else
-            {
-                poly.push_back(query->second);
             }
+            poly.push_back(id);
         }
         unified_v2v.push_back(poly);
     }
@@ -110,8 +109,10 @@ void to_openGL_unified_verts(const std::vector<vec3d>             & v_attr_0,
     unified_v2v.clear();
     unified_v2v.reserve(v2v_attr_0.size());
 
-    typedef std::tuple<uint,uint,uint> v_vt_vn;
-    std::map<v_vt_vn,uint> v_map;
+    // see above
+    const uint none = ~0u;
+    std::vector<uint> head(v_attr_0.size(), none);
+    std::vector<uint> next, key_vt, key_vn;
 
     for(uint pid=0; pid<v2v_attr_0.size(); ++pid)
     {
@@ -124,22 +125,21 @@ void to_openGL_unified_verts(const std::vector<vec3d>             & v_attr_0,
             uint v  = v2v_attr_0.at(pid).at(off);
             uint vt = v2v_attr_1.at(pid).at(off);
             uint vn = v2v_attr_2.at(pid).at(off);
-            v_vt_vn key = std::make_tuple(v,vt,vn);
 
-            auto query = v_map.find(key);
-            if (query == v_map.end())
+            uint id = head.at(v);
+            while(id!=none && (key_vt[id]!=vt || key_vn[id]!=vn)) id = next[id];
+            if(id==none)
             {
-                uint fresh_id = unified_v_attr_0.size();
-                v_map[key] = fresh_id;
+                id = unified_v_attr_0.size();
+                next.push_back(head.at(v));
+                key_vt.push_back(vt);
+                key_vn.push_back(vn);
+                head.at(v) = id;
                 unified_v_attr_0.push_back(v_attr_0.at(v));
                 unified_v_attr_1.push_back(v_attr_1.at(vt));
                 unified_v_attr_2.push_back(v_attr_2.at(vn));
-                poly.push_back(fresh_id);
-            }
-            else
-            {
-                poly.push_back(query->second);
             }
+            poly.push_back(id);
         }
         unified_v2v.push_back(poly);
     }
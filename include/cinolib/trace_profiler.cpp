@@ -0,0 +1,281 @@
+/********************************************************************************
+*  This file is part of CinoLib                                                 *
+*  Copyright(C) 2016: Marco Livesu                                              *
+*                                                                               *
+*  The MIT License                                                              *
+*                                                                               *
+*  Permission is hereby granted, free of charge, to any person obtaining a      *
+*  copy of this software and associated documentation files (the "Software"),   *
+*  to deal in the Software without restriction, including without limitation    *
+*  the rights to use, copy, modify, merge, publish, distribute, sublicense,     *
+*  and/or sell copies of the Software, and to permit persons to whom the        *
+*  Software is furnished to do so, subject to the following conditions:         *
+*                                                                               *
+*  The above copyright notice and this permission notice shall be included in   *
+*  all copies or substantial portions of the Software.                          *
+*                                                                               *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR   *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,     *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. IN NO EVENT SHALL THE *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER       *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      *
+*  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS *
+*  IN THE SOFTWARE.                                                             *
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Marco Livesu (marco.livesu@gmail.com)                                     *
+*     http://pers.ge.imati.cnr.it/livesu/                                       *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*********************************************************************************/
+#include <cinolib/trace_profiler.h>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+
+namespace cinolib
+{
+
+CINO_INLINE
+TraceProfiler::TraceProfiler(const uint events_per_thread)
+    : recording(false)
+    , events_per_thread(std::max(events_per_thread,1u))
+    , epoch(std::chrono::steady_clock::now())
+{}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void TraceProfiler::start()
+{
+    recording.store(true);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void TraceProfiler::stop()
+{
+    recording.store(false);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void TraceProfiler::clear()
+{
+    // buffers are kept alive, as threads keep a pointer to them
+    std::lock_guard<std::mutex> lock(mutex);
+    for(auto & b : buffers) b->count = 0;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+uint64_t TraceProfiler::now_ns() const
+{
+    using namespace std::chrono;
+    return duration_cast<nanoseconds>(steady_clock::now() - epoch).count();
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+TraceBuffer & TraceProfiler::thread_buffer()
+{
+    static thread_local const TraceProfiler * owner = nullptr;
+    static thread_local TraceBuffer         * buf   = nullptr;
+    if(owner!=this)
+    {
+        std::unique_ptr<TraceBuffer> b(new TraceBuffer());
+        b->events.resize(events_per_thread);
+        std::lock_guard<std::mutex> lock(mutex);
+        b->thread_id = buffers.size();
+        buf   = b.get();
+        owner = this;
+        buffers.push_back(std::move(b));
+    }
+    return *buf;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void TraceProfiler::collect(std::vector<std::pair<const TraceEvent*,uint>> & events) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    events.clear();
+    for(const auto & b : buffers)
+    {
+        uint64_t n   = b->events.size();
+        uint64_t beg = (b->count > n) ? b->count - n : 0;
+        for(uint64_t i=beg; i<b->count; ++i) events.push_back(std::make_pair(&b->events[i%n], b->thread_id));
+    }
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+uint64_t TraceProfiler::num_events() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    uint64_t n = 0;
+    for(const auto & b : buffers) n += std::min<uint64_t>(b->count, b->events.size());
+    return n;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+uint64_t TraceProfiler::num_dropped() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    uint64_t n = 0;
+    for(const auto & b : buffers) if(b->count > b->events.size()) n += b->count - b->events.size();
+    return n;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+bool TraceProfiler::export_chrome_trace(const char * filename) const
+{
+    std::ofstream f(filename);
+    if(!f.is_open())
+    {
+        std::cerr << "ERROR : " << __FILE__ << ", line " << __LINE__ << " : export_chrome_trace() : couldn't open output file " << filename << std::endl;
+        return false;
+    }
+
+    std::vector<std::pair<const TraceEvent*,uint>> events;
+    collect(events);
+
+    // https://docs.google.com/document/d/1CvAClvFfyA5R-PhYUmn5OOQtYMH4h6I0nSsKchNAySU
+    // complete events ("ph":"X"), with timestamps in microseconds
+    f << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    f.precision(3);
+    f << std::fixed;
+    bool first = true;
+    for(const auto & obj : events)
+    {
+        const TraceEvent & e = *obj.first;
+        std::string name;
+        for(const char * c=e.name; *c; ++c)
+        {
+            if(*c=='"' || *c=='\\') name += '\\';
+            name += *c;
+        }
+        if(!first) f << ",";
+        first = false;
+        f << "\n{\"name\":\"" << name << "\",\"cat\":\"cinolib\",\"ph\":\"X\""
+          << ",\"ts\":"  << e.start_ns*1e-3
+          << ",\"dur\":" << (e.stop_ns-e.start_ns)*1e-3
+          << ",\"pid\":0,\"tid\":" << obj.second << "}";
+    }
+    f << "\n]}\n";
+    return true;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+bool TraceProfiler::export_csv(const char * filename) const
+{
+    std::ofstream f(filename);
+    if(!f.is_open())
+    {
+        std::cerr << "ERROR : " << __FILE__ << ", line " << __LINE__ << " : export_csv() : couldn't open output file " << filename << std::endl;
+        return false;
+    }
+
+    std::vector<std::pair<const TraceEvent*,uint>> events;
+    collect(events);
+
+    typedef struct
+    {
+        uint64_t calls = 0;
+        uint64_t tot   = 0;
+        uint64_t min   = ~uint64_t(0);
+        uint64_t max   = 0;
+    }
+    ZoneStats;
+
+    // zones are identified by name (the same literal may live at different addresses)
+    std::map<std::string,ZoneStats> stats;
+    for(const auto & obj : events)
+    {
+        uint64_t    t = obj.first->stop_ns - obj.first->start_ns;
+        ZoneStats & s = stats[obj.first->name];
+        s.calls += 1;
+        s.tot   += t;
+        s.min    = std::min(s.min, t);
+        s.max    = std::max(s.max, t);
+    }
+
+    // most time consuming first
+    std::vector<std::pair<std::string,ZoneStats>> sorted(stats.begin(), stats.end());
+    std::sort(sorted.begin(), sorted.end(), [](const std::pair<std::string,ZoneStats> & a,
+                                               const std::pair<std::string,ZoneStats> & b)
+    {
+        return a.second.tot > b.second.tot;
+    });
+
+    f << "zone,calls,total_s,mean_s,min_s,max_s\n";
+    f.precision(9);
+    for(const auto & obj : sorted)
+    {
+        const ZoneStats & s = obj.second;
+        f << "\"" << obj.first << "\","
+          << s.calls << ","
+          << s.tot*1e-9 << ","
+          << s.tot*1e-9/s.calls << ","
+          << s.min*1e-9 << ","
+          << s.max*1e-9 << "\n";
+    }
+    return true;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+TraceProfiler & global_trace_profiler()
+{
+    static TraceProfiler profiler;
+    return profiler;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+ProfilerZone::ProfilerZone(const char * name) : name(name)
+{
+    TraceProfiler & p = global_trace_profiler();
+    if(!p.is_recording()) return;
+    buf      = &p.thread_buffer();
+    depth    = buf->depth++;
+    start_ns = p.now_ns();
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+ProfilerZone::~ProfilerZone()
+{
+    if(buf==nullptr) return;
+    TraceEvent & e = buf->events[buf->count % buf->events.size()];
+    e.name     = name;
+    e.start_ns = start_ns;
+    e.stop_ns  = global_trace_profiler().now_ns();
+    e.depth    = depth;
+    ++buf->count;
+    --buf->depth;
+}
+
+}
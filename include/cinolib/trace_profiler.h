@@ -0,0 +1,179 @@
+/********************************************************************************
+*  This file is part of CinoLib                                                 *
+*  Copyright(C) 2016: Marco Livesu                                              *
+*                                                                               *
+*  The MIT License                                                              *
+*                                                                               *
+*  Permission is hereby granted, free of charge, to any person obtaining a      *
+*  copy of this software and associated documentation files (the "Software"),   *
+*  to deal in the Software without restriction, including without limitation    *
+*  the rights to use, copy, modify, merge, publish, distribute, sublicense,     *
+*  and/or sell copies of the Software, and to permit persons to whom the        *
+*  Software is furnished to do so, subject to the following conditions:         *
+*                                                                               *
+*  The above copyright notice and this permission notice shall be included in   *
+*  all copies or substantial portions of the Software.                          *
+*                                                                               *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR   *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,     *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. IN NO EVENT SHALL THE *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER       *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      *
+*  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS *
+*  IN THE SOFTWARE.                                                             *
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Marco Livesu (marco.livesu@gmail.com)                                     *
+*     http://pers.ge.imati.cnr.it/livesu/                                       *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*********************************************************************************/
+#ifndef CINO_TRACE_PROFILER_H
+#define CINO_TRACE_PROFILER_H
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <stdint.h>
+#include <sys/types.h>
+#include <cinolib/cino_inline.h>
+
+namespace cinolib
+{
+
+/* Low overhead, thread aware profiler for production runs (for quick
+ * interactive timings see the Profiler class in profiler.h). Code is
+ * instrumented with scoped zones, which measure the time spent from their
+ * declaration to the end of the enclosing scope:
+ *
+ *      void my_function()
+ *      {
+ *          CINO_PROFILE_ZONE("my_function");
+ *          ...
+ *      }
+ *
+ * Zone names must be string literals (only the pointer is stored). Zones are
+ * recorded in a ring buffer owned by the calling thread, hence there are no
+ * locks, allocations or I/O on the hot path. When a buffer is full the oldest
+ * zones are overwritten. Nothing is recorded until start() is called on the
+ * global_trace_profiler(). Recorded zones can be exported in the Chrome trace
+ * event format (open it with chrome://tracing or https://ui.perfetto.dev) or
+ * as a flat CSV summary with calls and times per zone.
+ *
+ * Zones exist only if CINOLIB_USES_PROFILER is defined. Otherwise
+ * CINO_PROFILE_ZONE expands to nothing and the instrumentation costs nothing.
+ *
+ * NOTE: export and clear only when no thread is recording (i.e. after stop())
+*/
+
+typedef struct
+{
+    const char * name;
+    uint64_t     start_ns;
+    uint64_t     stop_ns;
+    uint         depth;    // number of zones open in the same thread when this one was opened
+}
+TraceEvent;
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+typedef struct
+{
+    std::vector<TraceEvent> events;      // ring buffer
+    uint64_t                count = 0;   // events recorded so far (only the last events.size() are kept)
+    uint                    depth = 0;   // currently open zones
+    uint                    thread_id;   // sequential, in order of first use of the profiler
+}
+TraceBuffer;
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+class TraceProfiler
+{
+    public:
+
+        explicit TraceProfiler(const uint events_per_thread = 1<<16);
+
+        TraceProfiler(const TraceProfiler &) = delete;
+        TraceProfiler & operator=(const TraceProfiler &) = delete;
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        void start();
+        void stop();
+        void clear();
+        bool is_recording() const { return recording.load(std::memory_order_relaxed); }
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        bool     export_chrome_trace(const char * filename) const;
+        bool     export_csv         (const char * filename) const;
+        uint64_t num_events()  const; // events currently stored
+        uint64_t num_dropped() const; // events overwritten because a ring buffer was full
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        uint64_t      now_ns() const;  // time elapsed since the profiler was created
+        TraceBuffer & thread_buffer(); // buffer of the calling thread (created on first use)
+
+    private:
+
+        void collect(std::vector<std::pair<const TraceEvent*,uint>> & events) const;
+
+        std::atomic<bool>                         recording;
+        uint                                      events_per_thread;
+        std::chrono::steady_clock::time_point     epoch;
+        mutable std::mutex                        mutex;   // guards buffers
+        std::vector<std::unique_ptr<TraceBuffer>> buffers; // one per thread
+};
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// the profiler used by CINO_PROFILE_ZONE
+CINO_INLINE
+TraceProfiler & global_trace_profiler();
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+class ProfilerZone
+{
+    public:
+
+        explicit ProfilerZone(const char * name);
+        ~ProfilerZone();
+
+        ProfilerZone(const ProfilerZone &) = delete;
+        ProfilerZone & operator=(const ProfilerZone &) = delete;
+
+    private:
+
+        const char  * name;
+        TraceBuffer * buf = nullptr; // nullptr if the profiler was not recording when the zone opened
+        uint64_t      start_ns;
+        uint          depth;
+};
+
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+#ifdef CINOLIB_USES_PROFILER
+#define CINO_PROFILE_CONCAT_(a,b) a##b
+#define CINO_PROFILE_CONCAT(a,b)  CINO_PROFILE_CONCAT_(a,b)
+#define CINO_PROFILE_ZONE(name)   cinolib::ProfilerZone CINO_PROFILE_CONCAT(cino_profile_zone_,__LINE__)(name)
+#else
+#define CINO_PROFILE_ZONE(name)
+#endif
+
+#ifndef  CINO_STATIC_LIB
+#include "trace_profiler.cpp"
+#endif
+
+#endif // CINO_TRACE_PROFILER_H
@@ -34,48 +34,191 @@
 *     Italy                                                                     *
 *********************************************************************************/
 #include <cinolib/vertex_clustering.h>
-#include <cinolib/bfs.h>
+#include <cinolib/min_max_inf.h>
+#include <cinolib/thread_pool.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <numeric>
 
 namespace cinolib
 {
 
+template<typename real>
+CINO_INLINE
+void vertex_clustering_coords(const vec2<real> & p, double xyz[3])
+{
+    xyz[0] = p[0];
+    xyz[1] = p[1];
+    xyz[2] = 0;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<typename real>
+CINO_INLINE
+void vertex_clustering_coords(const vec3<real> & p, double xyz[3])
+{
+    xyz[0] = p[0];
+    xyz[1] = p[1];
+    xyz[2] = p[2];
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// union-find with path halving. Concurrent calls to unite are safe:
+// roots are always linked to smaller roots with a compare and swap
+CINO_INLINE
+uint vertex_clustering_find(std::vector<std::atomic<uint>> & parent, uint x)
+{
+    while(true)
+    {
+        uint px = parent[x].load();
+        if(px==x) return x;
+        uint gx = parent[px].load();
+        parent[x].compare_exchange_weak(px, gx);
+        x = gx;
+    }
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void vertex_clustering_unite(std::vector<std::atomic<uint>> & parent, uint x, uint y)
+{
+    while(true)
+    {
+        x = vertex_clustering_find(parent, x);
+        y = vertex_clustering_find(parent, y);
+        if(x==y) return;
+        if(x<y) std::swap(x,y);
+        uint expected = x;
+        if(parent[x].compare_exchange_strong(expected, y)) return;
+    }
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
 template<class Vertex>
 CINO_INLINE
-void vertex_clustering(const std::vector<Vertex>             & points,
-                       const double                            proximity_thresh,
-                       std::vector<std::unordered_set<uint>> & clusters)
+uint vertex_clustering(const std::vector<Vertex> & points,
+                       const double                proximity_thresh,
+                       std::vector<uint>         & cluster_id)
 {
-    // build v2v connectivity based on point proximity
-    std::vector<std::vector<uint>> v2v(points.size());
-    for(uint vid0=0;      vid0<points.size()-1; ++vid0)
-    for(uint vid1=vid0+1; vid1<points.size();   ++vid1)
+    uint nv = points.size();
+    cluster_id.resize(nv);
+    if(nv==0) return 0;
+
+    // cell size: the proximity threshold, enlarged if needed so that cell
+    // coordinates fit in 21 bits (neighbors are still in adjacent cells)
+    std::vector<double> xyz(3*nv);
+    double min[3] = {  inf_double,  inf_double,  inf_double };
+    double max[3] = { -inf_double, -inf_double, -inf_double };
+    for(uint vid=0; vid<nv; ++vid)
     {
-        if (points.at(vid0).dist(points.at(vid1)) < proximity_thresh)
+        vertex_clustering_coords(points[vid], &xyz[3*vid]);
+        for(int i=0; i<3; ++i)
         {
-            v2v.at(vid0).push_back(vid1);
-            v2v.at(vid1).push_back(vid0);
+            min[i] = std::min(min[i], xyz[3*vid+i]);
+            max[i] = std::max(max[i], xyz[3*vid+i]);
         }
     }
+    const uint64_t max_cells = (1<<21)-2;
+    double cell = std::max(proximity_thresh, 0.0);
+    for(int i=0; i<3; ++i) cell = std::max(cell, (max[i]-min[i])/double(max_cells-1));
+    if(cell==0) cell = 1; // all points coincide (and proximity_thresh<=0)
+
+    // sort points by cell (cell coordinates are packed in a 64 bits key)
+    std::vector<uint64_t> key(nv);
+    parallel_for(0, nv, [&](const uint vid)
+    {
+        uint64_t c[3];
+        for(int i=0; i<3; ++i) c[i] = std::min(uint64_t((xyz[3*vid+i]-min[i])/cell), max_cells);
+        key[vid] = (c[0]<<42) | (c[1]<<21) | c[2];
+    });
+    std::vector<uint> order(nv);
+    std::iota(order.begin(), order.end(), 0);
+    parallel_sort(order.begin(), order.end(), [&](const uint a, const uint b)
+    {
+        return (key[a]<key[b]) || (key[a]==key[b] && a<b);
+    });
 
-    // visit the resulting graph with BFS to
-    // isolate clusters of adjacent vertices
-    uint nv   = points.size();
-    uint seed = 0;
-    std::vector<bool> visited(nv, false);
-    do
+    // non empty cells, as ranges of order
+    std::vector<uint64_t> cell_key;
+    std::vector<uint>     cell_beg;
+    for(uint i=0; i<nv; ++i)
     {
-        std::unordered_set<uint> cluster;
-        bfs(v2v, seed, cluster);
+        if(i==0 || key[order[i]]!=key[order[i-1]])
+        {
+            cell_key.push_back(key[order[i]]);
+            cell_beg.push_back(i);
+        }
+    }
+    cell_beg.push_back(nv);
 
-        clusters.push_back(cluster);
-        for(uint vid : cluster) visited.at(vid) = true;
+    std::vector<std::atomic<uint>> parent(nv);
+    for(uint vid=0; vid<nv; ++vid) parent[vid].store(vid);
+
+    // each pair of adjacent cells is visited once: a cell is compared with
+    // itself and with the 13 neighbors that follow it in lexicographic order
+    parallel_for(0, cell_key.size(), [&](const uint cid)
+    {
+        uint64_t c[3] = { cell_key[cid]>>42, (cell_key[cid]>>21) & ((1<<21)-1), cell_key[cid] & ((1<<21)-1) };
+        for(int dx=-1; dx<=1; ++dx)
+        for(int dy=-1; dy<=1; ++dy)
+        for(int dz=-1; dz<=1; ++dz)
+        {
+            if(dx<0 || (dx==0 && dy<0) || (dx==0 && dy==0 && dz<0)) continue;
+            if((dy<0 && c[1]==0) || (dz<0 && c[2]==0)) continue;
+            uint64_t nkey = ((c[0]+dx)<<42) | ((c[1]+dy)<<21) | (c[2]+dz);
+            uint nid = cid;
+            if(nkey!=cell_key[cid])
+            {
+                auto it = std::lower_bound(cell_key.begin()+cid, cell_key.end(), nkey);
+                if(it==cell_key.end() || *it!=nkey) continue;
+                nid = it - cell_key.begin();
+            }
+            for(uint i=cell_beg[cid]; i<cell_beg[cid+1]; ++i)
+            for(uint j=(nid==cid ? i+1 : cell_beg[nid]); j<cell_beg[nid+1]; ++j)
+            {
+                uint v0 = order[i];
+                uint v1 = order[j];
+                if(points[v0].dist(points[v1]) < proximity_thresh)
+                {
+                    vertex_clustering_unite(parent, v0, v1);
+                }
+            }
+        }
+    }, 64);
 
-        seed = 0;
-        while (seed < nv && visited.at(seed)) ++seed;
+    // roots are the smallest vertex of each cluster, so numbering
+    // them in increasing order sorts clusters by their smallest vertex
+    uint n_clusters = 0;
+    for(uint vid=0; vid<nv; ++vid)
+    {
+        uint root = vertex_clustering_find(parent, vid);
+        cluster_id[vid] = (root==vid) ? n_clusters++ : cluster_id[root];
     }
-    while (seed < nv);
+    return n_clusters;
 }
 
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<class Vertex>
+CINO_INLINE
+void vertex_clustering(const std::vector<Vertex>             & points,
+                       const double                            proximity_thresh,
+                       std::vector<std::unordered_set<uint>> & clusters)
+{
+    std::vector<uint> cluster_id;
+    uint n_clusters = vertex_clustering(points, proximity_thresh, cluster_id);
 
+    uint offset = clusters.size();
+    clusters.resize(offset + n_clusters);
+    for(uint vid=0; vid<points.size(); ++vid)
+    {
+        clusters.at(offset + cluster_id.at(vid)).insert(vid);
+    }
 }
 
+}
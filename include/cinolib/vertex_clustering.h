@@ -40,6 +40,8 @@
 #include <vector>
 #include <sys/types.h>
 #include <cinolib/cino_inline.h>
+#include <cinolib/geometry/vec2.h>
+#include <cinolib/geometry/vec3.h>
 
 
 namespace cinolib
@@ -48,7 +50,16 @@ namespace cinolib
 /* Groups a list of vertices in clusters of elements closer
  * to each other less than a given proximity threshold
  *
- * NOTE: class Vertex should implement the dist() operator
+ * Neighbors are searched in a uniform grid with cells as big as the
+ * proximity threshold, hence the cost is roughly linear in the number
+ * of points (unless clusters are very dense). Clusters are computed
+ * with a (lock free) union-find, which runs in parallel if the global
+ * thread pool has more than one thread (see thread_pool.h).
+ *
+ * Clusters are sorted by the smallest vertex they contain.
+ *
+ * NOTE: class Vertex should implement the dist() operator, and
+ *       vertex_clustering_coords() (provided for vec2 and vec3)
 */
 
 template<class Vertex>
@@ -57,6 +68,25 @@ void vertex_clustering(const std::vector<Vertex>             & points,
                        const double                            proximity_thresh,
                        std::vector<std::unordered_set<uint>> & clusters);
 
+// same as above, but the clustering is returned as a per vertex cluster ID
+// (in [0,num_clusters)). Returns the number of clusters
+
+template<class Vertex>
+CINO_INLINE
+uint vertex_clustering(const std::vector<Vertex> & points,
+                       const double                proximity_thresh,
+                       std::vector<uint>         & cluster_id);
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+template<typename real>
+CINO_INLINE
+void vertex_clustering_coords(const vec2<real> & p, double xyz[3]);
+
+template<typename real>
+CINO_INLINE
+void vertex_clustering_coords(const vec3<real> & p, double xyz[3]);
+
 }
 
 #ifndef  CINO_STATIC_LIB
@@ -34,6 +34,7 @@
 *     Italy                                                                     *
 *********************************************************************************/
 #include <cinolib/vertex_mass.h>
+#include <cinolib/thread_pool.h>
 
 namespace cinolib
 {
@@ -42,26 +43,50 @@ template<class M, class V, class E, class P>
 CINO_INLINE
 Eigen::SparseMatrix<double> mass_matrix(const AbstractMesh<M,V,E,P> & m, const int n)
 {
-    typedef Eigen::Triplet<double> Entry;
+    SparseAssembler MM;
+    mass_matrix_pattern(m, MM, n);
+    mass_matrix_update(m, MM);
+    return MM.matrix();
+}
 
-    uint nv = m.num_verts();
-    uint base[n];
-    for(int i=0; i<n; ++i) base[i] = nv*i;
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
-    std::vector<Entry>  entries;
-    for(uint vid=0; vid<m.num_verts(); ++vid)
+template<class M, class V, class E, class P>
+CINO_INLINE
+void mass_matrix_pattern(const AbstractMesh<M,V,E,P> & m, SparseAssembler & MM, const int n)
+{
+    assert(n>0);
+    uint nv = n*m.num_verts();
+
+    AdjacencyCSR rows; // diagonal matrix
+    rows.offsets.resize(nv+1);
+    rows.entries.resize(nv);
+    for(uint i=0; i<nv; ++i)
     {
-        double mass = m.vert_mass(vid);
-        for(int i=0; i<n; ++i) entries.push_back(Entry(base[i] + vid, base[i] + vid, mass));
+        rows.offsets.at(i) = i;
+        rows.entries.at(i) = i;
     }
-
-    nv = n*m.num_verts();
-    Eigen::SparseMatrix<double> MM(nv, nv);
-    MM.setFromTriplets(entries.begin(), entries.end());
-
-    return MM;
+    rows.offsets.back() = nv;
+    MM.init(nv, rows);
 }
 
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
 
+template<class M, class V, class E, class P>
+CINO_INLINE
+void mass_matrix_update(const AbstractMesh<M,V,E,P> & m, SparseAssembler & MM)
+{
+    uint nv = m.num_verts();
+    uint n  = (nv>0) ? MM.num_rows()/nv : 0;
+    assert(n*nv == MM.num_rows() && "Mass matrix pattern does not match the mesh!");
+
+    // diagonal pattern: the i-th value is the i-th diagonal entry
+    double * diag = MM.values();
+    parallel_for(0, nv, [&](const uint vid)
+    {
+        double mass = m.vert_mass(vid);
+        for(uint i=0; i<n; ++i) diag[nv*i + vid] = mass;
+    }, 256);
 }
 
+}
@@ -37,6 +37,7 @@
 #define CINO_VERTEX_MASS_H
 
 #include <cinolib/meshes/abstract_mesh.h>
+#include <cinolib/sparse_assembler.h>
 #include <Eigen/Sparse>
 
 namespace cinolib
@@ -52,6 +53,18 @@ Eigen::SparseMatrix<double> mass_matrix(const AbstractMesh<M,V,E,P> & m,
                                                           //          | 0 M |   | 0 M 0 |
                                                           //                    | 0 0 M |
 
+// reusable pattern version of mass_matrix(), for iterative methods (see laplacian_pattern())
+
+template<class M, class V, class E, class P>
+CINO_INLINE
+void mass_matrix_pattern(const AbstractMesh<M,V,E,P> & m,
+                         SparseAssembler             & MM,
+                         const int                     n = 1);
+
+template<class M, class V, class E, class P>
+CINO_INLINE
+void mass_matrix_update(const AbstractMesh<M,V,E,P> & m,
+                        SparseAssembler             & MM);
 }
 
 #ifndef  CINO_STATIC_LIB
@@ -0,0 +1,230 @@
+/********************************************************************************
+*  This file is part of CinoLib                                                 *
+*  Copyright(C) 2016: Marco Livesu                                              *
+*                                                                               *
+*  The MIT License                                                              *
+*                                                                               *
+*  Permission is hereby granted, free of charge, to any person obtaining a      *
+*  copy of this software and associated documentation files (the "Software"),   *
+*  to deal in the Software without restriction, including without limitation    *
+*  the rights to use, copy, modify, merge, publish, distribute, sublicense,     *
+*  and/or sell copies of the Software, and to permit persons to whom the        *
+*  Software is furnished to do so, subject to the following conditions:         *
+*                                                                               *
+*  The above copyright notice and this permission notice shall be included in   *
+*  all copies or substantial portions of the Software.                          *
+*                                                                               *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR   *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,     *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. IN NO EVENT SHALL THE *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER       *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      *
+*  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS *
+*  IN THE SOFTWARE.                                                             *
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Marco Livesu (marco.livesu@gmail.com)                                     *
+*     http://pers.ge.imati.cnr.it/livesu/                                       *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*********************************************************************************/
+#include <cinolib/weld_vertices.h>
+#include <cinolib/thread_pool.h>
+#include <cmath>
+#include <cstring>
+
+namespace cinolib
+{
+
+CINO_INLINE
+uint64_t weld_hash(const vec3d & p)
+{
+    uint64_t h = 0;
+    for(int i=0; i<3; ++i)
+    {
+        double   c = p[i] + 0.0; // -0 => +0
+        uint64_t b;
+        std::memcpy(&b, &c, sizeof(double));
+        // splitmix64 finalizer (all bits of the coordinate affect all bits of the hash)
+        h ^= b + 0x9e3779b97f4a7c15ull + (h<<6) + (h>>2);
+        h ^= h >> 30; h *= 0xbf58476d1ce4e5b9ull;
+        h ^= h >> 27; h *= 0x94d049bb133111ebull;
+        h ^= h >> 31;
+    }
+    return h;
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+VertexHashTable::VertexHashTable(const uint expected_size)
+{
+    // keep the load factor below 1/2
+    uint64_t n = 16;
+    while(n < 2*uint64_t(expected_size)) n <<= 1;
+    slots.assign(n, 0);
+    mask = n-1;
+    pts.reserve(expected_size);
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+int VertexHashTable::find(const vec3d & p) const
+{
+    for(uint64_t i=weld_hash(p)&mask; ; i=(i+1)&mask)
+    {
+        uint s = slots[i];
+        if(s==0)           return -1;
+        if(pts[s-1] == p)  return s-1;
+    }
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+uint VertexHashTable::find_or_insert(const vec3d & p)
+{
+    if(2*(pts.size()+1) > slots.size()) grow();
+
+    for(uint64_t i=weld_hash(p)&mask; ; i=(i+1)&mask)
+    {
+        uint s = slots[i];
+        if(s==0)
+        {
+            pts.push_back(p);
+            slots[i] = pts.size();
+            return pts.size()-1;
+        }
+        if(pts[s-1] == p) return s-1;
+    }
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void VertexHashTable::grow()
+{
+    slots.assign(2*slots.size(), 0);
+    mask = slots.size()-1;
+    for(uint id=0; id<pts.size(); ++id)
+    {
+        uint64_t i = weld_hash(pts[id])&mask;
+        while(slots[i]!=0) i=(i+1)&mask;
+        slots[i] = id+1;
+    }
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void weld_vertices_eps(const std::vector<vec3d> & points,
+                             std::vector<vec3d> & verts,
+                             std::vector<uint>  & ids,
+                       const double               eps)
+{
+    // grid hash: each cell stores the list of unique points inside it
+    // (cells are hashed by their integer coordinates, stored as doubles)
+    VertexHashTable   cells(points.size()/4);
+    std::vector<uint> cell_head; // first unique point in each cell (-1 if none)
+    std::vector<uint> next;      // next unique point in the same cell
+    const uint        none = ~0u;
+
+    verts.clear();
+    ids.resize(points.size());
+    for(uint i=0; i<points.size(); ++i)
+    {
+        const vec3d & p = points[i];
+        vec3d c(std::floor(p.x()/eps), std::floor(p.y()/eps), std::floor(p.z()/eps));
+
+        uint best = none;
+        for(int dx=-1; dx<=1; ++dx)
+        for(int dy=-1; dy<=1; ++dy)
+        for(int dz=-1; dz<=1; ++dz)
+        {
+            int cid = cells.find(c + vec3d(dx,dy,dz));
+            if(cid<0) continue;
+            for(uint vid=cell_head[cid]; vid!=none; vid=next[vid])
+            {
+                if(vid<best && verts[vid].dist(p)<=eps) best = vid;
+            }
+        }
+
+        if(best==none)
+        {
+            best = verts.size();
+            verts.push_back(p);
+            uint cid = cells.find_or_insert(c);
+            if(cid==cell_head.size()) cell_head.push_back(none);
+            next.push_back(cell_head[cid]);
+            cell_head[cid] = best;
+        }
+        ids[i] = best;
+    }
+}
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+void weld_vertices(const std::vector<vec3d> & points,
+                         std::vector<vec3d> & verts,
+                         std::vector<uint>  & ids,
+                   const double               eps)
+{
+    if(eps>0)
+    {
+        weld_vertices_eps(points, verts, ids, eps);
+        return;
+    }
+
+    ids.resize(points.size());
+
+    uint n  = points.size();
+    uint nt = get_num_threads();
+    if(nt<2 || n<(1<<16))
+    {
+        VertexHashTable table(n/4);
+        for(uint i=0; i<n; ++i) ids[i] = table.find_or_insert(points[i]);
+        verts.swap(table.points());
+        return;
+    }
+
+    // weld each chunk separately (ids are local to the chunk)...
+    uint n_chunks = 4*nt;
+    auto chunk_beg = [&](const uint c) { return uint(uint64_t(n)*c/n_chunks); };
+    std::vector<VertexHashTable> tables(n_chunks);
+    global_thread_pool().run(n_chunks, [&](const uint c, const uint)
+    {
+        uint beg = chunk_beg(c);
+        uint end = chunk_beg(c+1);
+        VertexHashTable table((end-beg)/4);
+        for(uint i=beg; i<end; ++i) ids[i] = table.find_or_insert(points[i]);
+        std::swap(tables[c], table);
+    });
+
+    // ...merge chunks in order (this preserves the order of first appearance)...
+    VertexHashTable table(n/4);
+    std::vector<std::vector<uint>> local2global(n_chunks);
+    for(uint c=0; c<n_chunks; ++c)
+    {
+        for(const vec3d & p : tables[c].points())
+        {
+            local2global[c].push_back(table.find_or_insert(p));
+        }
+        tables[c] = VertexHashTable();
+    }
+    verts.swap(table.points());
+
+    // ...and make ids global
+    global_thread_pool().run(n_chunks, [&](const uint c, const uint)
+    {
+        for(uint i=chunk_beg(c); i<chunk_beg(c+1); ++i) ids[i] = local2global[c][ids[i]];
+    });
+}
+
+}
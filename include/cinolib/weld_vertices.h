@@ -0,0 +1,111 @@
+/********************************************************************************
+*  This file is part of CinoLib                                                 *
+*  Copyright(C) 2016: Marco Livesu                                              *
+*                                                                               *
+*  The MIT License                                                              *
+*                                                                               *
+*  Permission is hereby granted, free of charge, to any person obtaining a      *
+*  copy of this software and associated documentation files (the "Software"),   *
+*  to deal in the Software without restriction, including without limitation    *
+*  the rights to use, copy, modify, merge, publish, distribute, sublicense,     *
+*  and/or sell copies of the Software, and to permit persons to whom the        *
+*  Software is furnished to do so, subject to the following conditions:         *
+*                                                                               *
+*  The above copyright notice and this permission notice shall be included in   *
+*  all copies or substantial portions of the Software.                          *
+*                                                                               *
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR   *
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,     *
+*  FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. IN NO EVENT SHALL THE *
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER       *
+*  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING      *
+*  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS *
+*  IN THE SOFTWARE.                                                             *
+*                                                                               *
+*  Author(s):                                                                   *
+*                                                                               *
+*     Marco Livesu (marco.livesu@gmail.com)                                     *
+*     http://pers.ge.imati.cnr.it/livesu/                                       *
+*                                                                               *
+*     Italian National Research Council (CNR)                                   *
+*     Institute for Applied Mathematics and Information Technologies (IMATI)    *
+*     Via de Marini, 6                                                          *
+*     16149 Genoa,                                                              *
+*     Italy                                                                     *
+*********************************************************************************/
+#ifndef CINO_WELD_VERTICES_H
+#define CINO_WELD_VERTICES_H
+
+#include <vector>
+#include <stdint.h>
+#include <sys/types.h>
+#include <cinolib/cino_inline.h>
+#include <cinolib/geometry/vec3.h>
+
+namespace cinolib
+{
+
+/* Welds the coincident points of a list (typically, the corners of a polygon
+ * soup read from a STL file). verts receives the unique points, in order of
+ * first appearance, and ids maps each input point to its position in verts.
+ *
+ * If eps is zero, points are welded only if they are exactly coincident
+ * (-0 and +0 are considered the same coordinate). Lookups use an open
+ * addressing hash table. Big inputs are split in chunks that are welded in
+ * parallel and merged afterwards (see thread_pool.h). The output does not
+ * depend on the number of threads.
+ *
+ * If eps is positive, each point is welded to the first unique point (in
+ * input order) closer than eps, if any. Candidates are searched in a grid
+ * hash with cells as big as eps.
+*/
+
+CINO_INLINE
+void weld_vertices(const std::vector<vec3d> & points,
+                         std::vector<vec3d> & verts,
+                         std::vector<uint>  & ids,
+                   const double               eps = 0.0);
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+// Open addressing (linear probing) hash table that assigns consecutive
+// ids to distinct points, in order of insertion
+
+class VertexHashTable
+{
+    public:
+
+        explicit VertexHashTable(const uint expected_size = 0);
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        uint find_or_insert(const vec3d & p);
+        int  find          (const vec3d & p) const; // -1 if not found
+
+        //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+        uint                       size()   const { return pts.size(); }
+        const std::vector<vec3d> & points() const { return pts; }
+              std::vector<vec3d> & points()       { return pts; }
+
+    private:
+
+        void grow();
+
+        std::vector<uint>  slots; // point id + 1 (0 marks an empty slot)
+        std::vector<vec3d> pts;
+        uint64_t           mask;
+};
+
+//::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+CINO_INLINE
+uint64_t weld_hash(const vec3d & p);
+
+}
+
+#ifndef  CINO_STATIC_LIB
+#include "weld_vertices.cpp"
+#endif
+
+#endif // CINO_WELD_VERTICES_H